@@ -0,0 +1,297 @@
+#include <Arduino.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include "platform/Platform.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point& startTime() {
+  static const Clock::time_point start = Clock::now();
+  return start;
+}
+
+std::mt19937& rng() {
+  static std::mt19937 engine(0xC057A2U);
+  return engine;
+}
+
+bool serialQuiet() {
+  static const bool value = std::getenv("COSTAR_HOST_QUIET") != nullptr;
+  return value;
+}
+
+std::string integerToString(unsigned long long value, bool negative, unsigned char base) {
+  if (base < 2 || base > 36) {
+    base = 10;
+  }
+  std::string out;
+  do {
+    const unsigned digit = static_cast<unsigned>(value % base);
+    out.push_back(static_cast<char>(digit < 10 ? '0' + digit : 'a' + digit - 10));
+    value /= base;
+  } while (value > 0);
+  if (negative) {
+    out.push_back('-');
+  }
+  std::reverse(out.begin(), out.end());
+  return out;
+}
+
+std::string signedToString(long long value, unsigned char base) {
+  if (value < 0 && base == 10) {
+    return integerToString(0ULL - static_cast<unsigned long long>(value), true, base);
+  }
+  return integerToString(static_cast<unsigned long long>(value), false, base);
+}
+
+std::string floatToString(double value, unsigned int decimalPlaces) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", static_cast<int>(decimalPlaces), value);
+  return buf;
+}
+
+}  // namespace
+
+HostSerial Serial;
+HostEsp ESP;
+
+uint32_t millis() {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime()).count());
+}
+
+uint32_t micros() {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime()).count());
+}
+
+void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+void yield() { std::this_thread::yield(); }
+
+long random(long howBig) {
+  if (howBig <= 0) {
+    return 0;
+  }
+  return std::uniform_int_distribution<long>(0, howBig - 1)(rng());
+}
+
+long random(long howSmall, long howBig) {
+  if (howSmall >= howBig) {
+    return howSmall;
+  }
+  return howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed) { rng().seed(static_cast<std::mt19937::result_type>(seed)); }
+
+size_t HostSerial::write(uint8_t c) { return write(&c, 1); }
+
+size_t HostSerial::write(const uint8_t* buffer, size_t size) {
+  if (serialQuiet()) {
+    return size;
+  }
+  return std::fwrite(buffer, 1, size, stdout);
+}
+
+uint32_t HostEsp::getFreeHeap() const { return platform::freeHeapBytes(); }
+
+uint32_t HostEsp::getMinFreeHeap() const { return platform::minFreeHeapBytes(); }
+
+uint32_t HostEsp::getMaxAllocHeap() const { return platform::freeHeapBytes(); }
+
+void HostEsp::restart() const { std::exit(0); }
+
+size_t Print::write(const char* str) {
+  if (str == nullptr) {
+    return 0;
+  }
+  return write(reinterpret_cast<const uint8_t*>(str), std::strlen(str));
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  const int n = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (n <= 0) {
+    return 0;
+  }
+  if (n < static_cast<int>(sizeof(buffer))) {
+    return write(reinterpret_cast<const uint8_t*>(buffer), static_cast<size_t>(n));
+  }
+  std::string dynamic(static_cast<size_t>(n) + 1U, '\0');
+  va_start(args, format);
+  vsnprintf(&dynamic[0], dynamic.size(), format, args);
+  va_end(args);
+  return write(reinterpret_cast<const uint8_t*>(dynamic.data()), static_cast<size_t>(n));
+}
+
+String::String(unsigned char value, unsigned char base)
+    : s_(integerToString(value, false, base)) {}
+String::String(int value, unsigned char base) : s_(signedToString(value, base)) {}
+String::String(unsigned int value, unsigned char base)
+    : s_(integerToString(value, false, base)) {}
+String::String(long value, unsigned char base) : s_(signedToString(value, base)) {}
+String::String(unsigned long value, unsigned char base)
+    : s_(integerToString(value, false, base)) {}
+String::String(long long value, unsigned char base) : s_(signedToString(value, base)) {}
+String::String(unsigned long long value, unsigned char base)
+    : s_(integerToString(value, false, base)) {}
+String::String(float value, unsigned int decimalPlaces)
+    : s_(floatToString(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces)
+    : s_(floatToString(value, decimalPlaces)) {}
+
+bool String::equalsIgnoreCase(const String& s) const {
+  if (s_.size() != s.s_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < s_.size(); ++i) {
+    if (std::tolower(static_cast<unsigned char>(s_[i])) !=
+        std::tolower(static_cast<unsigned char>(s.s_[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+  if (offset > s_.size() || prefix.s_.size() > s_.size() - offset) {
+    return false;
+  }
+  return s_.compare(offset, prefix.s_.size(), prefix.s_) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  if (suffix.s_.size() > s_.size()) {
+    return false;
+  }
+  return s_.compare(s_.size() - suffix.s_.size(), suffix.s_.size(), suffix.s_) == 0;
+}
+
+char& String::operator[](unsigned int index) {
+  static char dummy = '\0';
+  if (index >= s_.size()) {
+    dummy = '\0';
+    return dummy;
+  }
+  return s_[index];
+}
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const {
+  if (buf == nullptr || bufsize == 0) {
+    return;
+  }
+  if (index >= s_.size()) {
+    buf[0] = '\0';
+    return;
+  }
+  const size_t n = std::min<size_t>(bufsize - 1U, s_.size() - index);
+  std::memcpy(buf, s_.data() + index, n);
+  buf[n] = '\0';
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  const size_t pos = s_.find(ch, fromIndex);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+  if (fromIndex > s_.size()) {
+    return -1;
+  }
+  const size_t pos = s_.find(str.s_, fromIndex);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(char ch) const {
+  const size_t pos = s_.rfind(ch);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(char ch, unsigned int fromIndex) const {
+  const size_t pos = s_.rfind(ch, fromIndex);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(const String& str) const {
+  const size_t pos = s_.rfind(str.s_);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(const String& str, unsigned int fromIndex) const {
+  const size_t pos = s_.rfind(str.s_, fromIndex);
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex) {
+    std::swap(beginIndex, endIndex);
+  }
+  if (beginIndex >= s_.size()) {
+    return String();
+  }
+  endIndex = std::min<unsigned int>(endIndex, length());
+  return String(s_.data() + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(char find, char replaceWith) {
+  std::replace(s_.begin(), s_.end(), find, replaceWith);
+}
+
+void String::replace(const String& find, const String& replaceWith) {
+  if (find.s_.empty()) {
+    return;
+  }
+  size_t pos = 0;
+  while ((pos = s_.find(find.s_, pos)) != std::string::npos) {
+    s_.replace(pos, find.s_.size(), replaceWith.s_);
+    pos += replaceWith.s_.size();
+  }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= s_.size()) {
+    return;
+  }
+  s_.erase(index, count);
+}
+
+void String::toLowerCase() {
+  for (char& c : s_) {
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+}
+
+void String::toUpperCase() {
+  for (char& c : s_) {
+    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  }
+}
+
+void String::trim() {
+  size_t begin = 0;
+  while (begin < s_.size() && std::isspace(static_cast<unsigned char>(s_[begin]))) {
+    ++begin;
+  }
+  size_t end = s_.size();
+  while (end > begin && std::isspace(static_cast<unsigned char>(s_[end - 1]))) {
+    --end;
+  }
+  s_ = s_.substr(begin, end - begin);
+}
+
+long String::toInt() const { return std::strtol(s_.c_str(), nullptr, 10); }
+
+float String::toFloat() const { return static_cast<float>(toDouble()); }
+
+double String::toDouble() const { return std::strtod(s_.c_str(), nullptr); }
@@ -0,0 +1,556 @@
+// POSIX-socket implementation of the esp_http_client subset declared in
+// stubs/esp_http_client.h, for the SSE streams in every build and, with COSTAR_HOST_LIVE_HTTP,
+// the device HttpJsonClient and HttpConnectionPool against a local HTTP server.
+
+#include <esp_heap_caps.h>
+#include <esp_http_client.h>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "platform/Platform.h"
+
+struct HostHttpClient {
+  std::string scheme;
+  std::string host;
+  int port = 80;
+  std::string path;
+  esp_http_client_method_t method = HTTP_METHOD_GET;
+  std::vector<std::pair<std::string, std::string>> headers;
+  http_event_handle_cb handler = nullptr;
+  void* userData = nullptr;
+  int timeoutMs = 5000;
+
+  int fd = -1;
+  std::string connectedHost;
+  int connectedPort = 0;
+
+  std::string rbuf;
+  size_t rpos = 0;
+  int status = -1;
+  long long contentLength = -1;
+  bool chunked = false;
+  long long chunkRemaining = 0;
+  // The CRLF after a chunk's data has not been read yet.
+  bool chunkCrlfPending = false;
+  // The last socket read hit timeoutMs (read() returns 0 then, as ESP-IDF does).
+  bool timedOut = false;
+  bool bodyDone = false;
+  bool serverClose = false;
+  std::string location;
+};
+
+namespace {
+
+std::atomic<uint32_t> sConnectCount{0};
+
+std::string lower(std::string text) {
+  std::transform(text.begin(), text.end(), text.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return text;
+}
+
+bool parseUrl(const char* url, HostHttpClient& c) {
+  if (url == nullptr) {
+    return false;
+  }
+  const std::string text(url);
+  const size_t schemeEnd = text.find("://");
+  if (schemeEnd == std::string::npos) {
+    return false;
+  }
+  c.scheme = lower(text.substr(0, schemeEnd));
+  const size_t hostStart = schemeEnd + 3;
+  size_t pathStart = text.find_first_of("/?#", hostStart);
+  std::string authority =
+      text.substr(hostStart, pathStart == std::string::npos ? std::string::npos
+                                                            : pathStart - hostStart);
+  const size_t at = authority.rfind('@');
+  if (at != std::string::npos) {
+    authority = authority.substr(at + 1);
+  }
+  c.port = c.scheme == "https" ? 443 : 80;
+  const size_t colon = authority.rfind(':');
+  if (colon != std::string::npos) {
+    c.port = std::atoi(authority.c_str() + colon + 1);
+    authority = authority.substr(0, colon);
+  }
+  c.host = lower(authority);
+  c.path = pathStart == std::string::npos ? "/" : text.substr(pathStart);
+  if (c.path[0] != '/') {
+    c.path = "/" + c.path;
+  }
+  const size_t hash = c.path.find('#');
+  if (hash != std::string::npos) {
+    c.path.resize(hash);
+  }
+  return !c.host.empty();
+}
+
+void closeSocket(HostHttpClient& c) {
+  if (c.fd >= 0) {
+    ::close(c.fd);
+    c.fd = -1;
+  }
+  c.rbuf.clear();
+  c.rpos = 0;
+}
+
+bool connectSocket(HostHttpClient& c) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* result = nullptr;
+  const std::string port = std::to_string(c.port);
+  if (getaddrinfo(c.host.c_str(), port.c_str(), &hints, &result) != 0) {
+    return false;
+  }
+  for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+    const int fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    timeval tv{};
+    tv.tv_sec = c.timeoutMs / 1000;
+    tv.tv_usec = (c.timeoutMs % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+      c.fd = fd;
+      break;
+    }
+    ::close(fd);
+  }
+  freeaddrinfo(result);
+  if (c.fd < 0) {
+    return false;
+  }
+  c.connectedHost = c.host;
+  c.connectedPort = c.port;
+  sConnectCount.fetch_add(1);
+  return true;
+}
+
+bool sendAll(int fd, const char* data, size_t len) {
+  while (len > 0) {
+    const ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    len -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Makes at least one more byte available in rbuf; false on EOF or error.
+bool fillBuffer(HostHttpClient& c) {
+  if (c.rpos > 0 && c.rpos >= c.rbuf.size()) {
+    c.rbuf.clear();
+    c.rpos = 0;
+  }
+  char chunk[1024];
+  const ssize_t n = ::recv(c.fd, chunk, sizeof(chunk), 0);
+  c.timedOut = n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+  if (n <= 0) {
+    return false;
+  }
+  c.rbuf.append(chunk, static_cast<size_t>(n));
+  return true;
+}
+
+bool readLine(HostHttpClient& c, std::string& line) {
+  for (;;) {
+    const size_t eol = c.rbuf.find("\r\n", c.rpos);
+    if (eol != std::string::npos) {
+      line = c.rbuf.substr(c.rpos, eol - c.rpos);
+      c.rpos = eol + 2;
+      return true;
+    }
+    if (c.fd < 0 || !fillBuffer(c)) {
+      return false;
+    }
+  }
+}
+
+const char* methodName(esp_http_client_method_t method) {
+  switch (method) {
+    case HTTP_METHOD_POST:
+      return "POST";
+    case HTTP_METHOD_PUT:
+      return "PUT";
+    case HTTP_METHOD_PATCH:
+      return "PATCH";
+    case HTTP_METHOD_DELETE:
+      return "DELETE";
+    case HTTP_METHOD_HEAD:
+      return "HEAD";
+    default:
+      return "GET";
+  }
+}
+
+}  // namespace
+
+const char* esp_err_to_name(esp_err_t code) {
+  switch (code) {
+    case ESP_OK:
+      return "ESP_OK";
+    case ESP_FAIL:
+      return "ESP_FAIL";
+    case ESP_ERR_INVALID_ARG:
+      return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_NOT_SUPPORTED:
+      return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_HTTP_CONNECT:
+      return "ESP_ERR_HTTP_CONNECT";
+    case ESP_ERR_HTTP_WRITE_DATA:
+      return "ESP_ERR_HTTP_WRITE_DATA";
+    case ESP_ERR_HTTP_FETCH_HEADER:
+      return "ESP_ERR_HTTP_FETCH_HEADER";
+    case ESP_ERR_HTTP_EAGAIN:
+      return "ESP_ERR_HTTP_EAGAIN";
+    default:
+      return "UNKNOWN ERROR";
+  }
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  (void)caps;
+  return platform::freeHeapBytes();
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t* config) {
+  if (config == nullptr) {
+    return nullptr;
+  }
+  HostHttpClient* c = new HostHttpClient();
+  if (!parseUrl(config->url, *c)) {
+    delete c;
+    return nullptr;
+  }
+  c->handler = config->event_handler;
+  c->userData = config->user_data;
+  if (config->timeout_ms > 0) {
+    c->timeoutMs = config->timeout_ms;
+  }
+  return c;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client) {
+  if (client == nullptr) {
+    return ESP_FAIL;
+  }
+  closeSocket(*client);
+  delete client;
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char* url) {
+  if (client == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const std::string oldHost = client->host;
+  const int oldPort = client->port;
+  if (!parseUrl(url, *client)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (client->host != oldHost || client->port != oldPort) {
+    closeSocket(*client);
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_method(esp_http_client_handle_t client,
+                                     esp_http_client_method_t method) {
+  if (client == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  client->method = method;
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char* key,
+                                     const char* value) {
+  if (client == nullptr || key == nullptr || value == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const std::string name = lower(key);
+  for (auto& header : client->headers) {
+    if (lower(header.first) == name) {
+      header.second = value;
+      return ESP_OK;
+    }
+  }
+  client->headers.emplace_back(key, value);
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char* key) {
+  if (client == nullptr || key == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const std::string name = lower(key);
+  client->headers.erase(std::remove_if(client->headers.begin(), client->headers.end(),
+                                       [&](const std::pair<std::string, std::string>& h) {
+                                         return lower(h.first) == name;
+                                       }),
+                        client->headers.end());
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_timeout_ms(esp_http_client_handle_t client, int timeout_ms) {
+  if (client == nullptr || timeout_ms <= 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  client->timeoutMs = timeout_ms;
+  if (client->fd >= 0) {
+    timeval tv{};
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    setsockopt(client->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(client->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_user_data(esp_http_client_handle_t client, void* data) {
+  if (client == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  client->userData = data;
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len) {
+  if (client == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (client->scheme != "http") {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+  client->status = -1;
+  client->contentLength = -1;
+  client->chunked = false;
+  client->chunkRemaining = 0;
+  client->chunkCrlfPending = false;
+  client->bodyDone = false;
+  client->serverClose = false;
+  client->location.clear();
+  if (client->fd >= 0 && client->rpos < client->rbuf.size()) {
+    // Unread bytes from the last response: the connection is out of sync.
+    closeSocket(*client);
+  }
+  client->rbuf.clear();
+  client->rpos = 0;
+  if (client->fd < 0 && !connectSocket(*client)) {
+    return ESP_ERR_HTTP_CONNECT;
+  }
+
+  std::string request = std::string(methodName(client->method)) + " " + client->path +
+                        " HTTP/1.1\r\nHost: " + client->host;
+  if (client->port != 80) {
+    request += ":" + std::to_string(client->port);
+  }
+  request += "\r\n";
+  for (const auto& header : client->headers) {
+    request += header.first + ": " + header.second + "\r\n";
+  }
+  if (write_len > 0 || client->method == HTTP_METHOD_POST || client->method == HTTP_METHOD_PUT ||
+      client->method == HTTP_METHOD_PATCH) {
+    request += "Content-Length: " + std::to_string(write_len > 0 ? write_len : 0) + "\r\n";
+  }
+  request += "\r\n";
+  if (!sendAll(client->fd, request.data(), request.size())) {
+    closeSocket(*client);
+    return ESP_ERR_HTTP_WRITE_DATA;
+  }
+  return ESP_OK;
+}
+
+int esp_http_client_write(esp_http_client_handle_t client, const char* buffer, int len) {
+  if (client == nullptr || client->fd < 0 || buffer == nullptr || len < 0) {
+    return -1;
+  }
+  return sendAll(client->fd, buffer, static_cast<size_t>(len)) ? len : -1;
+}
+
+int esp_http_client_fetch_headers(esp_http_client_handle_t client) {
+  if (client == nullptr || client->fd < 0) {
+    return ESP_FAIL;
+  }
+  std::string line;
+  do {
+    // Skip interim 1xx responses.
+    if (!readLine(*client, line)) {
+      closeSocket(*client);
+      return ESP_FAIL;
+    }
+    const size_t space = line.find(' ');
+    client->status = space == std::string::npos ? -1 : std::atoi(line.c_str() + space + 1);
+    if (client->status >= 100 && client->status < 200) {
+      while (readLine(*client, line) && !line.empty()) {
+      }
+    }
+  } while (client->status >= 100 && client->status < 200);
+
+  for (;;) {
+    if (!readLine(*client, line)) {
+      client->status = -1;
+      closeSocket(*client);
+      return ESP_FAIL;
+    }
+    if (line.empty()) {
+      break;
+    }
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    std::string key = line.substr(0, colon);
+    std::string value = line.substr(colon + 1);
+    value.erase(0, value.find_first_not_of(" \t"));
+    const std::string name = lower(key);
+    if (name == "content-length") {
+      client->contentLength = std::atoll(value.c_str());
+    } else if (name == "transfer-encoding" && lower(value).find("chunked") != std::string::npos) {
+      client->chunked = true;
+    } else if (name == "connection" && lower(value) == "close") {
+      client->serverClose = true;
+    } else if (name == "location") {
+      client->location = value;
+    }
+    if (client->handler != nullptr) {
+      esp_http_client_event_t evt{};
+      evt.event_id = HTTP_EVENT_ON_HEADER;
+      evt.client = client;
+      evt.user_data = client->userData;
+      evt.header_key = &key[0];
+      evt.header_value = &value[0];
+      client->handler(&evt);
+    }
+  }
+
+  if (client->method == HTTP_METHOD_HEAD || client->status == 204 || client->status == 304 ||
+      (!client->chunked && client->contentLength == 0)) {
+    client->bodyDone = true;
+  }
+  if (client->chunked) {
+    return 0;
+  }
+  return client->contentLength > 0 ? static_cast<int>(client->contentLength) : 0;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client) {
+  return client != nullptr ? client->status : -1;
+}
+
+int esp_http_client_read(esp_http_client_handle_t client, char* buffer, int len) {
+  if (client == nullptr || buffer == nullptr || len <= 0 || client->bodyDone) {
+    return 0;
+  }
+
+  // A read timeout returns -ESP_ERR_HTTP_EAGAIN, as ESP-IDF 5 does; -1 means the connection is
+  // gone.
+  size_t want = static_cast<size_t>(len);
+  if (client->chunked) {
+    if (client->chunkRemaining == 0) {
+      std::string sizeLine;
+      if (client->chunkCrlfPending) {
+        if (!readLine(*client, sizeLine)) {
+          return client->timedOut ? -ESP_ERR_HTTP_EAGAIN : -1;
+        }
+        client->chunkCrlfPending = false;
+      }
+      if (!readLine(*client, sizeLine)) {
+        return client->timedOut ? -ESP_ERR_HTTP_EAGAIN : -1;
+      }
+      client->chunkRemaining = std::strtoll(sizeLine.c_str(), nullptr, 16);
+      if (client->chunkRemaining == 0) {
+        std::string trailer;
+        while (readLine(*client, trailer) && !trailer.empty()) {
+        }
+        client->bodyDone = true;
+        return 0;
+      }
+    }
+    want = std::min<size_t>(want, static_cast<size_t>(client->chunkRemaining));
+  } else if (client->contentLength >= 0) {
+    want = std::min<size_t>(want, static_cast<size_t>(client->contentLength));
+  }
+
+  if (client->rpos >= client->rbuf.size() && !fillBuffer(*client)) {
+    if (client->timedOut) {
+      return -ESP_ERR_HTTP_EAGAIN;
+    }
+    // Without a length the body ends when the server closes the connection.
+    if (client->contentLength < 0 && !client->chunked) {
+      client->bodyDone = true;
+      client->serverClose = true;
+      return 0;
+    }
+    return -1;
+  }
+  const size_t take = std::min(want, client->rbuf.size() - client->rpos);
+  std::memcpy(buffer, client->rbuf.data() + client->rpos, take);
+  client->rpos += take;
+
+  if (client->chunked) {
+    client->chunkRemaining -= static_cast<long long>(take);
+    client->chunkCrlfPending = client->chunkRemaining == 0;
+  } else if (client->contentLength >= 0) {
+    client->contentLength -= static_cast<long long>(take);
+    if (client->contentLength == 0) {
+      client->bodyDone = true;
+    }
+  }
+  return static_cast<int>(take);
+}
+
+bool esp_http_client_is_complete_data_received(esp_http_client_handle_t client) {
+  if (client == nullptr || !client->bodyDone) {
+    return false;
+  }
+  if (client->serverClose) {
+    closeSocket(*client);
+  }
+  return true;
+}
+
+esp_err_t esp_http_client_set_redirection(esp_http_client_handle_t client) {
+  if (client == nullptr || client->location.empty()) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::string target = client->location;
+  if (target.find("://") == std::string::npos) {
+    std::string base = client->scheme + "://" + client->host + ":" + std::to_string(client->port);
+    if (target[0] != '/') {
+      const size_t slash = client->path.rfind('/');
+      target = client->path.substr(0, slash + 1) + target;
+    }
+    target = base + target;
+  }
+  return esp_http_client_set_url(client, target.c_str());
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client) {
+  if (client == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  closeSocket(*client);
+  return ESP_OK;
+}
+
+uint32_t esp_http_client_host_connect_count() { return sConnectCount.load(); }
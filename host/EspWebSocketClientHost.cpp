@@ -0,0 +1,374 @@
+// POSIX-socket implementation of the esp_websocket_client subset declared in
+// stubs/esp_websocket_client.h, so services/HaWebSocket can run against a local server
+// (host/HaMockServer.cpp). Each started client runs one std::thread that connects, reads
+// frames, sends pings and reconnects, delivering events on that thread like the device task.
+
+#include <esp_websocket_client.h>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "HostWebSocket.h"
+
+esp_event_base_t const WEBSOCKET_EVENTS = "WEBSOCKET_EVENTS";
+
+struct esp_websocket_client {
+  std::string scheme;
+  std::string host;
+  int port = 80;
+  std::string path;
+  std::string headers;
+  bool autoReconnect = true;
+  void* userContext = nullptr;
+  size_t bufferSize = 1024;
+  int pingIntervalS = 10;
+  int pingPongTimeoutS = 20;
+  bool pingPongDisconnect = true;
+  int reconnectMs = 10000;
+  int networkTimeoutMs = 10000;
+
+  esp_event_handler_t handler = nullptr;
+  void* handlerArg = nullptr;
+
+  std::thread thread;
+  std::thread::id threadId;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+  bool running = false;
+  int fd = -1;
+  std::atomic<bool> connected{false};
+  // Sends come from the event handler (client thread) and from other tasks.
+  std::recursive_mutex sendMutex;
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+constexpr int kPollSliceMs = 50;
+
+bool parseUri(const char* uri, esp_websocket_client& c) {
+  if (uri == nullptr) {
+    return false;
+  }
+  const std::string text(uri);
+  const size_t sep = text.find("://");
+  if (sep == std::string::npos) {
+    return false;
+  }
+  c.scheme = text.substr(0, sep);
+  if (c.scheme != "ws" && c.scheme != "wss") {
+    return false;
+  }
+  const size_t hostStart = sep + 3;
+  const size_t pathStart = text.find('/', hostStart);
+  std::string authority = text.substr(hostStart, pathStart == std::string::npos
+                                                     ? std::string::npos
+                                                     : pathStart - hostStart);
+  c.path = pathStart == std::string::npos ? "/" : text.substr(pathStart);
+  c.port = c.scheme == "wss" ? 443 : 80;
+  const size_t colon = authority.rfind(':');
+  if (colon != std::string::npos) {
+    c.port = std::atoi(authority.c_str() + colon + 1);
+    authority.resize(colon);
+  }
+  c.host = authority;
+  return !c.host.empty() && c.port > 0;
+}
+
+void post(esp_websocket_client& c, esp_websocket_event_id_t id,
+          esp_websocket_event_data_t* data = nullptr) {
+  if (c.handler == nullptr) {
+    return;
+  }
+  esp_websocket_event_data_t empty{};
+  if (data == nullptr) {
+    data = &empty;
+  }
+  data->client = &c;
+  data->user_context = c.userContext;
+  c.handler(c.handlerArg, WEBSOCKET_EVENTS, id, data);
+}
+
+bool stopping(esp_websocket_client& c) {
+  std::lock_guard<std::mutex> lock(c.mutex);
+  return c.stopping;
+}
+
+int openSocket(const esp_websocket_client& c) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* result = nullptr;
+  const std::string port = std::to_string(c.port);
+  if (getaddrinfo(c.host.c_str(), port.c_str(), &hints, &result) != 0) {
+    return -1;
+  }
+  int fd = -1;
+  for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+    fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    timeval tv{};
+    tv.tv_sec = c.networkTimeoutMs / 1000;
+    tv.tv_usec = (c.networkTimeoutMs % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+      break;
+    }
+    ::close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(result);
+  return fd;
+}
+
+bool handshake(esp_websocket_client& c, int fd) {
+  static thread_local std::mt19937 rng{std::random_device{}()};
+  uint8_t nonce[16];
+  for (uint8_t& byte : nonce) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  const std::string key = hostws::base64(nonce, sizeof(nonce));
+  std::string request = "GET " + c.path + " HTTP/1.1\r\nHost: " + c.host + ":" +
+                        std::to_string(c.port) +
+                        "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                        "Sec-WebSocket-Version: 13\r\nSec-WebSocket-Key: " +
+                        key + "\r\n" + c.headers + "\r\n";
+  std::string head;
+  if (!hostws::writeAll(fd, request.data(), request.size()) || !hostws::readHttpHead(fd, head)) {
+    return false;
+  }
+  return head.compare(0, 12, "HTTP/1.1 101") == 0 &&
+         hostws::headerValue(head, "Sec-WebSocket-Accept") == hostws::acceptKey(key);
+}
+
+bool sendFrame(esp_websocket_client& c, uint8_t opcode, const void* data, size_t len) {
+  std::lock_guard<std::recursive_mutex> lock(c.sendMutex);
+  int fd;
+  {
+    std::lock_guard<std::mutex> state(c.mutex);
+    fd = c.fd;
+  }
+  return fd >= 0 && hostws::writeFrame(fd, opcode, data, len, true, true);
+}
+
+// Reads frames until the connection drops, the server closes it or the client is stopped.
+void readLoop(esp_websocket_client& c, int fd) {
+  std::vector<char> buffer(c.bufferSize);
+  Clock::time_point lastPing = Clock::now();
+  Clock::time_point pongDue = Clock::time_point::max();
+  for (;;) {
+    if (stopping(c)) {
+      sendFrame(c, hostws::kOpClose, nullptr, 0);
+      return;
+    }
+    pollfd pfd{fd, POLLIN, 0};
+    const int ready = ::poll(&pfd, 1, kPollSliceMs);
+    const Clock::time_point now = Clock::now();
+    if (ready <= 0) {
+      if (c.pingIntervalS > 0 && now - lastPing >= std::chrono::seconds(c.pingIntervalS)) {
+        lastPing = now;
+        if (!sendFrame(c, hostws::kOpPing, nullptr, 0)) {
+          return;
+        }
+        if (pongDue == Clock::time_point::max()) {
+          pongDue = now + std::chrono::seconds(c.pingPongTimeoutS);
+        }
+      }
+      if (c.pingPongDisconnect && now >= pongDue) {
+        return;
+      }
+      continue;
+    }
+
+    hostws::FrameHeader header;
+    if (!hostws::readFrameHeader(fd, header)) {
+      return;
+    }
+    if (header.opcode == hostws::kOpPong) {
+      pongDue = Clock::time_point::max();
+    }
+    uint64_t offset = 0;
+    do {
+      const size_t chunk =
+          static_cast<size_t>(std::min<uint64_t>(header.length - offset, buffer.size()));
+      if (!hostws::readPayload(fd, header, offset, buffer.data(), chunk)) {
+        return;
+      }
+      esp_websocket_event_data_t data{};
+      data.data_ptr = buffer.data();
+      data.data_len = static_cast<int>(chunk);
+      data.fin = header.fin;
+      data.op_code = header.opcode;
+      data.payload_len = static_cast<int>(header.length);
+      data.payload_offset = static_cast<int>(offset);
+      if (header.opcode == hostws::kOpPing) {
+        sendFrame(c, hostws::kOpPong, buffer.data(), chunk);
+      }
+      post(c, WEBSOCKET_EVENT_DATA, &data);
+      offset += chunk;
+    } while (offset < header.length);
+    if (header.opcode == hostws::kOpClose) {
+      sendFrame(c, hostws::kOpClose, nullptr, 0);
+      post(c, WEBSOCKET_EVENT_CLOSED);
+      return;
+    }
+  }
+}
+
+void clientLoop(esp_websocket_client* client) {
+  esp_websocket_client& c = *client;
+  while (!stopping(c)) {
+    const int fd = c.scheme == "ws" ? openSocket(c) : -1;
+    if (fd >= 0 && handshake(c, fd)) {
+      {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        c.fd = fd;
+      }
+      c.connected.store(true);
+      post(c, WEBSOCKET_EVENT_CONNECTED);
+      readLoop(c, fd);
+      c.connected.store(false);
+      {
+        std::lock_guard<std::recursive_mutex> send(c.sendMutex);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        c.fd = -1;
+      }
+    } else {
+      post(c, WEBSOCKET_EVENT_ERROR);
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    post(c, WEBSOCKET_EVENT_DISCONNECTED);
+    if (!c.autoReconnect) {
+      break;
+    }
+    std::unique_lock<std::mutex> lock(c.mutex);
+    c.wake.wait_for(lock, std::chrono::milliseconds(c.reconnectMs), [&c] { return c.stopping; });
+  }
+}
+
+}  // namespace
+
+esp_websocket_client_handle_t esp_websocket_client_init(
+    const esp_websocket_client_config_t* config) {
+  if (config == nullptr) {
+    return nullptr;
+  }
+  auto* c = new esp_websocket_client();
+  if (!parseUri(config->uri, *c)) {
+    delete c;
+    return nullptr;
+  }
+  if (config->headers != nullptr) {
+    c->headers = config->headers;
+  }
+  c->autoReconnect = !config->disable_auto_reconnect;
+  c->userContext = config->user_context;
+  if (config->buffer_size > 0) {
+    c->bufferSize = static_cast<size_t>(config->buffer_size);
+  }
+  if (config->ping_interval_sec > 0) {
+    c->pingIntervalS = config->ping_interval_sec;
+  }
+  if (config->pingpong_timeout_sec > 0) {
+    c->pingPongTimeoutS = config->pingpong_timeout_sec;
+  }
+  c->pingPongDisconnect = !config->disable_pingpong_discon;
+  if (config->reconnect_timeout_ms > 0) {
+    c->reconnectMs = config->reconnect_timeout_ms;
+  }
+  if (config->network_timeout_ms > 0) {
+    c->networkTimeoutMs = config->network_timeout_ms;
+  }
+  return c;
+}
+
+esp_err_t esp_websocket_register_events(esp_websocket_client_handle_t client,
+                                        esp_websocket_event_id_t event,
+                                        esp_event_handler_t event_handler,
+                                        void* event_handler_arg) {
+  (void)event;
+  if (client == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  client->handler = event_handler;
+  client->handlerArg = event_handler_arg;
+  return ESP_OK;
+}
+
+esp_err_t esp_websocket_client_start(esp_websocket_client_handle_t client) {
+  if (client == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lock(client->mutex);
+  if (client->running) {
+    return ESP_FAIL;
+  }
+  client->stopping = false;
+  client->running = true;
+  client->thread = std::thread(clientLoop, client);
+  client->threadId = client->thread.get_id();
+  return ESP_OK;
+}
+
+esp_err_t esp_websocket_client_stop(esp_websocket_client_handle_t client) {
+  if (client == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  {
+    std::lock_guard<std::mutex> lock(client->mutex);
+    if (!client->running) {
+      return ESP_FAIL;
+    }
+    if (std::this_thread::get_id() == client->threadId) {
+      return ESP_FAIL;
+    }
+    client->stopping = true;
+  }
+  client->wake.notify_all();
+  client->thread.join();
+  std::lock_guard<std::mutex> lock(client->mutex);
+  client->running = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_websocket_client_destroy(esp_websocket_client_handle_t client) {
+  if (client == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  esp_websocket_client_stop(client);
+  delete client;
+  return ESP_OK;
+}
+
+int esp_websocket_client_send_text(esp_websocket_client_handle_t client, const char* data,
+                                   int len, TickType_t timeout) {
+  (void)timeout;
+  if (client == nullptr || data == nullptr || len < 0 || !client->connected.load()) {
+    return -1;
+  }
+  return sendFrame(*client, hostws::kOpText, data, static_cast<size_t>(len)) ? len : -1;
+}
+
+bool esp_websocket_client_is_connected(esp_websocket_client_handle_t client) {
+  return client != nullptr && client->connected.load();
+}
@@ -0,0 +1,120 @@
+// Expression microbenchmark: times dsl::evalExpression (re-parses the string every call)
+// against dsl::compileExpression + dsl::evalCompiled for the expressions shipped in the clock
+// DSLs and a few heavier ones. Reports ns/eval, heap allocations per eval and whether both
+// paths produce identical results. See host/README.md.
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include "HostHeap.h"
+#include "dsl/DslExpr.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kExpressions[] = {
+    "(hour % 12) * 30 + minute * 0.5",
+    "minute*6",
+    "second * 6",
+    "30*h + 0.5*m",
+    "6*m + 0.1*s",
+    "sin(minute * 6) * 40 + cos((hour % 12) * 30) * 40",
+    "round(meters_to_miles(haversine_m(lat, lon, 37.6213, -122.3790)))",
+    "max(0, min(100, (value - lo) / (hi - lo) * 100))",
+};
+
+bool resolveVar(void* ctx, const String& name, float& out) {
+  const auto* vars = static_cast<const std::map<String, float>*>(ctx);
+  auto it = vars->find(name);
+  if (it == vars->end()) {
+    return false;
+  }
+  out = it->second;
+  return true;
+}
+
+struct Result {
+  double nsPerEval = 0.0;
+  double allocsPerEval = 0.0;
+  float value = 0.0f;
+  bool ok = false;
+};
+
+template <typename Fn>
+Result measure(uint32_t iterations, Fn&& fn) {
+  Result r;
+  r.ok = fn(r.value);
+  const hostheap::Snapshot before = hostheap::snapshot();
+  const Clock::time_point start = Clock::now();
+  volatile float sink = 0.0f;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    float v = 0.0f;
+    fn(v);
+    sink = sink + v;
+  }
+  const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  const hostheap::Snapshot after = hostheap::snapshot();
+  r.nsPerEval = ns / iterations;
+  r.allocsPerEval = static_cast<double>(after.allocCount - before.allocCount) / iterations;
+  return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  uint32_t iterations = 200000;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else {
+      std::fprintf(stderr, "usage: %s [--iterations N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (iterations == 0) {
+    iterations = 1;
+  }
+
+  std::map<String, float> vars = {
+      {"hour", 14.0f}, {"minute", 37.0f}, {"second", 12.0f}, {"h", 2.0f},
+      {"m", 37.0f},    {"s", 12.0f},      {"lat", 37.7749f}, {"lon", -122.4194f},
+      {"value", 62.5f}, {"lo", 10.0f},    {"hi", 90.0f},
+  };
+  dsl::ExprContext ctx;
+  ctx.resolver = &resolveVar;
+  ctx.ctx = &vars;
+
+  std::printf("%-64s %10s %10s %8s %8s %8s %s\n", "expr", "interp_ns", "bytecode_ns", "speedup",
+              "i_alloc", "b_alloc", "match");
+  int failures = 0;
+  for (const char* text : kExpressions) {
+    const String expr(text);
+    dsl::CompiledExpr program;
+    String error;
+    if (!dsl::compileExpression(expr, program, &error)) {
+      std::printf("%-64s compile failed: %s\n", text, error.c_str());
+      ++failures;
+      continue;
+    }
+
+    const Result interp =
+        measure(iterations, [&](float& out) { return dsl::evalExpression(expr, ctx, out); });
+    const Result compiled =
+        measure(iterations, [&](float& out) { return dsl::evalCompiled(program, ctx, out); });
+    const bool match = interp.ok == compiled.ok && interp.value == compiled.value;
+    if (!match) {
+      ++failures;
+    }
+    std::printf("%-64s %10.1f %10.1f %7.1fx %8.2f %8.2f %s\n", text, interp.nsPerEval,
+                compiled.nsPerEval,
+                compiled.nsPerEval > 0.0 ? interp.nsPerEval / compiled.nsPerEval : 0.0,
+                interp.allocsPerEval, compiled.allocsPerEval, match ? "yes" : "NO");
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <Arduino.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct HostSemaphore {
+  std::timed_mutex mutex;
+};
+
+struct HostTask {
+  std::string name;
+  std::thread thread;
+  std::atomic<bool> stopRequested{false};
+  std::mutex notifyMutex;
+  std::condition_variable notifyCv;
+  uint32_t notifyCount = 0;
+};
+
+namespace {
+
+// Thrown inside a task thread to unwind it when the task is deleted.
+struct TaskStop {};
+
+thread_local HostTask* tCurrentTask = nullptr;
+
+struct TaskStart {
+  TaskFunction_t fn;
+  void* arg;
+  HostTask* task;
+};
+
+void taskTrampoline(TaskStart start) {
+  tCurrentTask = start.task;
+  try {
+    start.fn(start.arg);
+  } catch (const TaskStop&) {
+  }
+}
+
+}  // namespace
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new HostSemaphore(); }
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  if (sem == nullptr) {
+    return pdFALSE;
+  }
+  if (ticks == portMAX_DELAY) {
+    sem->mutex.lock();
+    return pdTRUE;
+  }
+  return sem->mutex.try_lock_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS)) ? pdTRUE
+                                                                                       : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  if (sem == nullptr) {
+    return pdFALSE;
+  }
+  sem->mutex.unlock();
+  return pdTRUE;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* outHandle,
+                                   BaseType_t coreId) {
+  (void)stackDepth;
+  (void)priority;
+  (void)coreId;
+  if (fn == nullptr) {
+    return pdFAIL;
+  }
+  HostTask* task = new HostTask();
+  task->name = name != nullptr ? name : "";
+  task->thread = std::thread(taskTrampoline, TaskStart{fn, arg, task});
+  if (outHandle != nullptr) {
+    *outHandle = task;
+  }
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                       UBaseType_t priority, TaskHandle_t* outHandle) {
+  return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, outHandle, 0);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr || task == tCurrentTask) {
+    if (tCurrentTask != nullptr) {
+      tCurrentTask->thread.detach();
+      throw TaskStop{};
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(task->notifyMutex);
+    task->stopRequested.store(true);
+  }
+  task->notifyCv.notify_all();
+  if (task->thread.joinable()) {
+    task->thread.join();
+  }
+  delete task;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks * portTICK_PERIOD_MS);
+  if (tCurrentTask != nullptr && tCurrentTask->stopRequested.load()) {
+    throw TaskStop{};
+  }
+}
+
+TickType_t xTaskGetTickCount() { return static_cast<TickType_t>(millis() / portTICK_PERIOD_MS); }
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  if (task == nullptr) {
+    return pdFAIL;
+  }
+  {
+    std::lock_guard<std::mutex> lock(task->notifyMutex);
+    ++task->notifyCount;
+  }
+  task->notifyCv.notify_one();
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticks) {
+  HostTask* task = tCurrentTask;
+  if (task == nullptr) {
+    return 0;
+  }
+  std::unique_lock<std::mutex> lock(task->notifyMutex);
+  const auto ready = [task] { return task->notifyCount != 0 || task->stopRequested.load(); };
+  if (ticks == portMAX_DELAY) {
+    task->notifyCv.wait(lock, ready);
+  } else {
+    task->notifyCv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready);
+  }
+  if (task->stopRequested.load()) {
+    throw TaskStop{};
+  }
+  const uint32_t count = task->notifyCount;
+  if (count != 0) {
+    task->notifyCount = clearCountOnExit != pdFALSE ? 0 : count - 1;
+  }
+  return count;
+}
@@ -0,0 +1,191 @@
+#include "platform/Fs.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace {
+
+std::string& hostRoot() {
+  static std::string root = [] {
+    const char* env = std::getenv("COSTAR_HOST_FS_ROOT");
+    return std::string(env != nullptr && *env != '\0' ? env : "data");
+  }();
+  return root;
+}
+
+std::string buildPath(const char* input) {
+  if (input == nullptr || *input == '\0') {
+    return std::string();
+  }
+  if (input[0] == '/') {
+    return hostRoot() + input;
+  }
+  return hostRoot() + "/" + input;
+}
+
+bool isDirectoryPath(const std::string& full) {
+  struct stat st = {};
+  return ::stat(full.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+}  // namespace
+
+namespace fs {
+
+File::File(std::FILE* handle, bool isDirectory, const String& path)
+    : handle_(handle, [](std::FILE* f) {
+        if (f != nullptr) {
+          std::fclose(f);
+        }
+      }),
+      isDirectory_(isDirectory),
+      path_(path) {
+  if (handle == nullptr) {
+    handle_.reset();
+  }
+}
+
+size_t File::size() const {
+  if (!handle_) {
+    return 0;
+  }
+  const long pos = std::ftell(handle_.get());
+  std::fseek(handle_.get(), 0, SEEK_END);
+  const long end = std::ftell(handle_.get());
+  std::fseek(handle_.get(), pos, SEEK_SET);
+  return end < 0 ? 0 : static_cast<size_t>(end);
+}
+
+size_t File::position() const {
+  if (!handle_) {
+    return 0;
+  }
+  const long pos = std::ftell(handle_.get());
+  return pos < 0 ? 0 : static_cast<size_t>(pos);
+}
+
+bool File::seek(uint32_t pos) {
+  return handle_ && std::fseek(handle_.get(), static_cast<long>(pos), SEEK_SET) == 0;
+}
+
+void File::close() {
+  handle_.reset();
+  isDirectory_ = false;
+}
+
+int File::available() {
+  if (!handle_) {
+    return 0;
+  }
+  const size_t total = size();
+  const size_t pos = position();
+  return pos < total ? static_cast<int>(total - pos) : 0;
+}
+
+int File::read() {
+  if (!handle_) {
+    return -1;
+  }
+  const int c = std::fgetc(handle_.get());
+  return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+  if (!handle_) {
+    return -1;
+  }
+  const int c = std::fgetc(handle_.get());
+  if (c == EOF) {
+    return -1;
+  }
+  std::ungetc(c, handle_.get());
+  return c;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+  if (!handle_ || buf == nullptr) {
+    return 0;
+  }
+  return std::fread(buf, 1, size, handle_.get());
+}
+
+size_t File::readBytes(char* buffer, size_t length) {
+  return read(reinterpret_cast<uint8_t*>(buffer), length);
+}
+
+size_t File::write(uint8_t c) { return write(&c, 1); }
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!handle_ || buf == nullptr) {
+    return 0;
+  }
+  return std::fwrite(buf, 1, size, handle_.get());
+}
+
+void File::flush() {
+  if (handle_) {
+    std::fflush(handle_.get());
+  }
+}
+
+}  // namespace fs
+
+namespace platform::fs {
+
+void setHostRoot(const char* dir) {
+  if (dir != nullptr && *dir != '\0') {
+    hostRoot() = dir;
+  }
+}
+
+bool begin(bool formatOnFail) {
+  if (isDirectoryPath(hostRoot())) {
+    return true;
+  }
+  return formatOnFail && ::mkdir(hostRoot().c_str(), 0755) == 0;
+}
+
+bool exists(const char* path) {
+  const std::string full = buildPath(path);
+  struct stat st = {};
+  return !full.empty() && ::stat(full.c_str(), &st) == 0;
+}
+bool exists(const String& path) { return exists(path.c_str()); }
+
+bool mkdir(const char* path) {
+  const std::string full = buildPath(path);
+  return !full.empty() && (::mkdir(full.c_str(), 0755) == 0 || isDirectoryPath(full));
+}
+bool mkdir(const String& path) { return mkdir(path.c_str()); }
+
+bool remove(const char* path) {
+  const std::string full = buildPath(path);
+  return !full.empty() && std::remove(full.c_str()) == 0;
+}
+bool remove(const String& path) { return remove(path.c_str()); }
+
+bool rename(const char* from, const char* to) {
+  const std::string fullFrom = buildPath(from);
+  const std::string fullTo = buildPath(to);
+  return !fullFrom.empty() && !fullTo.empty() &&
+         std::rename(fullFrom.c_str(), fullTo.c_str()) == 0;
+}
+bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+
+File open(const String& path, const char* mode) {
+  const std::string full = buildPath(path.c_str());
+  if (full.empty()) {
+    return File();
+  }
+  if (isDirectoryPath(full)) {
+    return File(nullptr, true, path);
+  }
+  std::string fopenMode = mode != nullptr ? mode : FILE_READ;
+  fopenMode += "b";
+  return File(std::fopen(full.c_str(), fopenMode.c_str()), false, path);
+}
+
+}  // namespace platform::fs
@@ -0,0 +1,401 @@
+#include "HaMockServer.h"
+
+#include <ArduinoJson.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+
+#include "HostWebSocket.h"
+
+namespace {
+// Arbitrary fixed epoch, so timestamps in a run are predictable.
+constexpr double kEpochBase = 1760000000.0;
+constexpr size_t kMaxMessageBytes = 64 * 1024;
+}  // namespace
+
+struct HaMockServer::Entity {
+  std::string id;
+  std::string state;
+  JsonDocument attributes;
+  std::string context;
+  double lastChanged = 0;
+  double lastUpdated = 0;
+};
+
+struct HaMockServer::Client {
+  int fd = -1;
+  bool authed = false;
+  // subscription id -> entity_ids
+  std::map<int, std::set<std::string>> subscriptions;
+  std::mutex sendMutex;
+};
+
+HaMockServer::HaMockServer(std::string token) : token_(std::move(token)) {}
+
+HaMockServer::~HaMockServer() { stop(); }
+
+bool HaMockServer::start() {
+  listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (listenFd_ < 0) {
+    return false;
+  }
+  const int one = 1;
+  setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      ::listen(listenFd_, 8) != 0 ||
+      ::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    ::close(listenFd_);
+    listenFd_ = -1;
+    return false;
+  }
+  port_ = ntohs(addr.sin_port);
+  acceptThread_ = std::thread(&HaMockServer::acceptLoop, this);
+  return true;
+}
+
+void HaMockServer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || listenFd_ < 0) {
+      return;
+    }
+    stopping_ = true;
+  }
+  ::shutdown(listenFd_, SHUT_RDWR);
+  if (acceptThread_.joinable()) {
+    acceptThread_.join();
+  }
+  ::close(listenFd_);
+  dropClients();
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads.swap(clientThreads_);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void HaMockServer::acceptLoop() {
+  for (;;) {
+    const int fd = ::accept(listenFd_, nullptr, nullptr);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd < 0 || stopping_) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+      return;
+    }
+    auto client = std::make_shared<Client>();
+    client->fd = fd;
+    clients_.push_back(client);
+    ++stats_.connections;
+    clientThreads_.emplace_back(&HaMockServer::serveClient, this, client);
+  }
+}
+
+void HaMockServer::serveClient(const std::shared_ptr<Client>& client) {
+  std::string head;
+  bool upgraded = false;
+  if (hostws::readHttpHead(client->fd, head) && head.compare(0, 4, "GET ") == 0) {
+    const std::string key = hostws::headerValue(head, "Sec-WebSocket-Key");
+    const std::string response =
+        "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: " +
+        hostws::acceptKey(key) + "\r\n\r\n";
+    upgraded = !key.empty() && hostws::writeAll(client->fd, response.data(), response.size()) &&
+               sendText(*client, R"({"type":"auth_required","ha_version":"2025.10.0"})");
+  }
+
+  std::string message;
+  while (upgraded) {
+    hostws::FrameHeader header;
+    if (!hostws::readFrameHeader(client->fd, header) || header.length > kMaxMessageBytes) {
+      break;
+    }
+    std::string payload(static_cast<size_t>(header.length), '\0');
+    if (!hostws::readPayload(client->fd, header, 0, &payload[0], payload.size())) {
+      break;
+    }
+    if (header.opcode == hostws::kOpClose) {
+      std::lock_guard<std::mutex> send(client->sendMutex);
+      hostws::writeFrame(client->fd, hostws::kOpClose, nullptr, 0, true, false);
+      break;
+    }
+    if (header.opcode == hostws::kOpPing) {
+      std::lock_guard<std::mutex> send(client->sendMutex);
+      hostws::writeFrame(client->fd, hostws::kOpPong, payload.data(), payload.size(), true,
+                         false);
+      continue;
+    }
+    if (header.opcode == hostws::kOpText) {
+      message = payload;
+    } else if (header.opcode == hostws::kOpContinuation) {
+      message += payload;
+    } else {
+      continue;
+    }
+    if (header.fin) {
+      handleMessage(client, message);
+      message.clear();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  clients_.erase(std::remove(clients_.begin(), clients_.end(), client), clients_.end());
+  std::lock_guard<std::mutex> send(client->sendMutex);
+  if (client->fd >= 0) {
+    ::close(client->fd);
+    client->fd = -1;
+  }
+}
+
+void HaMockServer::handleMessage(const std::shared_ptr<Client>& client, const std::string& text) {
+  JsonDocument msg;
+  if (deserializeJson(msg, text)) {
+    return;
+  }
+  const std::string type = msg["type"] | "";
+  const int id = msg["id"] | 0;
+
+  if (type == "auth") {
+    const std::string token = msg["access_token"] | "";
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (token == token_) {
+      ++stats_.auths;
+      client->authed = true;
+      sendText(*client, R"({"type":"auth_ok","ha_version":"2025.10.0"})");
+    } else {
+      ++stats_.authFailures;
+      sendText(*client, R"({"type":"auth_invalid","message":"Invalid access token"})");
+      // HA closes the socket after a failed auth.
+      ::shutdown(client->fd, SHUT_RDWR);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!client->authed) {
+    ::shutdown(client->fd, SHUT_RDWR);
+    return;
+  }
+  JsonDocument reply;
+  reply["id"] = id;
+  if (type == "ping") {
+    reply["type"] = "pong";
+    std::string out;
+    serializeJson(reply, out);
+    sendText(*client, out);
+    return;
+  }
+  reply["type"] = "result";
+  if (type == "subscribe_entities") {
+    ++stats_.subscribes;
+    stats_.lastSubscribe.clear();
+    std::set<std::string>& wanted = client->subscriptions[id];
+    for (JsonVariantConst entityId : msg["entity_ids"].as<JsonArrayConst>()) {
+      wanted.insert(entityId.as<std::string>());
+      stats_.lastSubscribe.push_back(entityId.as<std::string>());
+    }
+    reply["success"] = true;
+    reply["result"] = nullptr;
+    std::string out;
+    serializeJson(reply, out);
+    sendText(*client, out);
+
+    std::string event = "{\"id\":" + std::to_string(id) + ",\"type\":\"event\",\"event\":{\"a\":{";
+    bool first = true;
+    for (const auto& entity : entities_) {
+      if (wanted.count(entity->id) == 0) {
+        continue;
+      }
+      event += (first ? "\"" : ",\"") + entity->id + "\":" + entityJson(*entity);
+      first = false;
+    }
+    event += "}}}";
+    sendText(*client, event);
+    return;
+  }
+  if (type == "unsubscribe_events") {
+    ++stats_.unsubscribes;
+    const int subscription = msg["subscription"] | 0;
+    const bool found = client->subscriptions.erase(subscription) > 0;
+    reply["success"] = found;
+    if (found) {
+      reply["result"] = nullptr;
+    } else {
+      reply["error"]["code"] = "not_found";
+      reply["error"]["message"] = "Subscription not found.";
+    }
+    std::string out;
+    serializeJson(reply, out);
+    sendText(*client, out);
+    return;
+  }
+  reply["success"] = false;
+  reply["error"]["code"] = "unknown_command";
+  reply["error"]["message"] = "Unknown command.";
+  std::string out;
+  serializeJson(reply, out);
+  sendText(*client, out);
+}
+
+bool HaMockServer::sendText(Client& client, const std::string& text) {
+  std::lock_guard<std::mutex> send(client.sendMutex);
+  if (client.fd < 0) {
+    return false;
+  }
+  const size_t fragment = fragmentBytes_.load();
+  if (fragment == 0 || text.size() <= fragment) {
+    return hostws::writeFrame(client.fd, hostws::kOpText, text.data(), text.size(), true, false);
+  }
+  for (size_t offset = 0; offset < text.size(); offset += fragment) {
+    const size_t len = std::min(fragment, text.size() - offset);
+    const uint8_t opcode = offset == 0 ? hostws::kOpText : hostws::kOpContinuation;
+    if (!hostws::writeFrame(client.fd, opcode, text.data() + offset, len,
+                            offset + len == text.size(), false)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string HaMockServer::entityJson(const Entity& entity) const {
+  JsonDocument doc;
+  doc["s"] = entity.state;
+  doc["a"] = entity.attributes.as<JsonObjectConst>();
+  doc["c"] = entity.context;
+  doc["lc"] = entity.lastChanged;
+  if (entity.lastUpdated != entity.lastChanged) {
+    doc["lu"] = entity.lastUpdated;
+  }
+  std::string out;
+  serializeJson(doc, out);
+  return out;
+}
+
+double HaMockServer::nowEpoch() const {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return kEpochBase + duration<double>(steady_clock::now() - start).count();
+}
+
+void HaMockServer::setState(const std::string& entityId, const std::string& state,
+                            const std::string& attributesJson,
+                            const std::vector<std::string>& removeAttributes) {
+  JsonDocument changes;
+  deserializeJson(changes, attributesJson);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(entities_.begin(), entities_.end(),
+                         [&](const std::unique_ptr<Entity>& e) { return e->id == entityId; });
+  const double now = nowEpoch();
+  if (it == entities_.end()) {
+    auto entity = std::make_unique<Entity>();
+    entity->id = entityId;
+    entity->state = state;
+    entity->attributes.to<JsonObject>();
+    for (JsonPairConst kv : changes.as<JsonObjectConst>()) {
+      entity->attributes[kv.key()] = kv.value();
+    }
+    entity->context = "ctx" + std::to_string(++contextSeq_);
+    entity->lastChanged = now;
+    entity->lastUpdated = now;
+    entities_.push_back(std::move(entity));
+    return;
+  }
+
+  Entity& entity = **it;
+  JsonDocument delta;
+  JsonObject plus = delta["+"].to<JsonObject>();
+  if (entity.state != state) {
+    entity.state = state;
+    entity.lastChanged = now;
+    plus["s"] = state;
+    plus["lc"] = now;
+  } else {
+    plus["lu"] = now;
+  }
+  entity.lastUpdated = now;
+  entity.context = "ctx" + std::to_string(++contextSeq_);
+  plus["c"] = entity.context;
+  if (changes.as<JsonObjectConst>().size() > 0) {
+    JsonObject attrs = plus["a"].to<JsonObject>();
+    for (JsonPairConst kv : changes.as<JsonObjectConst>()) {
+      entity.attributes[kv.key()] = kv.value();
+      attrs[kv.key()] = kv.value();
+    }
+  }
+  if (!removeAttributes.empty()) {
+    JsonArray removed = delta["-"]["a"].to<JsonArray>();
+    for (const std::string& key : removeAttributes) {
+      entity.attributes.remove(key);
+      removed.add(key);
+    }
+  }
+
+  std::string body;
+  serializeJson(delta, body);
+  for (const auto& client : clients_) {
+    for (const auto& sub : client->subscriptions) {
+      if (sub.second.count(entityId) == 0) {
+        continue;
+      }
+      ++stats_.deltas;
+      sendText(*client, "{\"id\":" + std::to_string(sub.first) +
+                            ",\"type\":\"event\",\"event\":{\"c\":{\"" + entityId + "\":" + body +
+                            "}}}");
+    }
+  }
+}
+
+void HaMockServer::removeEntity(const std::string& entityId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entities_.erase(std::remove_if(entities_.begin(), entities_.end(),
+                                 [&](const std::unique_ptr<Entity>& e) {
+                                   return e->id == entityId;
+                                 }),
+                  entities_.end());
+  for (const auto& client : clients_) {
+    for (const auto& sub : client->subscriptions) {
+      if (sub.second.count(entityId) != 0) {
+        sendText(*client, "{\"id\":" + std::to_string(sub.first) +
+                              ",\"type\":\"event\",\"event\":{\"r\":[\"" + entityId + "\"]}}");
+      }
+    }
+  }
+}
+
+void HaMockServer::dropClients() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& client : clients_) {
+    if (client->fd >= 0) {
+      ::shutdown(client->fd, SHUT_RDWR);
+    }
+  }
+}
+
+void HaMockServer::setFragmentBytes(size_t bytes) { fragmentBytes_.store(bytes); }
+
+size_t HaMockServer::activeClients() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return clients_.size();
+}
+
+HaMockServer::Stats HaMockServer::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Just enough of the Home Assistant WebSocket API for host checks of services/HaWebSocket:
+// token auth, subscribe_entities (compressed states and deltas), unsubscribe_events and ping,
+// on 127.0.0.1. setState() pushes a delta to every subscription holding the entity, the way
+// HA does when a state changes.
+class HaMockServer {
+ public:
+  struct Stats {
+    uint32_t connections = 0;
+    uint32_t auths = 0;
+    uint32_t authFailures = 0;
+    uint32_t subscribes = 0;
+    uint32_t unsubscribes = 0;
+    uint32_t deltas = 0;
+    // entity_ids of the latest subscribe_entities, in request order.
+    std::vector<std::string> lastSubscribe;
+  };
+
+  explicit HaMockServer(std::string token);
+  ~HaMockServer();
+
+  // Listens on an ephemeral port.
+  bool start();
+  void stop();
+  uint16_t port() const { return port_; }
+
+  // Creates or updates an entity. `attributesJson` (an object) is merged into its attributes
+  // and `removeAttributes` are dropped; subscribers get the change as one delta.
+  void setState(const std::string& entityId, const std::string& state,
+                const std::string& attributesJson = "{}",
+                const std::vector<std::string>& removeAttributes = {});
+  void removeEntity(const std::string& entityId);
+  // Cuts every client off without a close frame, like HA restarting.
+  void dropClients();
+  // Messages longer than this go out as several continuation frames (0 = one frame).
+  void setFragmentBytes(size_t bytes);
+
+  size_t activeClients() const;
+  Stats stats() const;
+
+ private:
+  struct Entity;
+  struct Client;
+
+  void acceptLoop();
+  void serveClient(const std::shared_ptr<Client>& client);
+  void handleMessage(const std::shared_ptr<Client>& client, const std::string& text);
+  bool sendText(Client& client, const std::string& text);
+  std::string entityJson(const Entity& entity) const;
+  double nowEpoch() const;
+
+  std::string token_;
+  int listenFd_ = -1;
+  uint16_t port_ = 0;
+  std::thread acceptThread_;
+  mutable std::mutex mutex_;
+  bool stopping_ = false;
+  std::vector<std::unique_ptr<Entity>> entities_;
+  std::vector<std::shared_ptr<Client>> clients_;
+  std::vector<std::thread> clientThreads_;
+  std::atomic<size_t> fragmentBytes_{0};
+  uint32_t contextSeq_ = 0;
+  Stats stats_;
+};
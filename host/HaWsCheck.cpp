@@ -0,0 +1,142 @@
+// Home Assistant WebSocket check: runs the stock HA widgets (source "ha_ws") against a local
+// mock HA (HaMockServer.cpp) and checks that they share one authenticated socket subscribed
+// to the union of their entities, pick up initial states and pushed deltas, survive a server
+// drop, widen the subscription for widgets added later, stop on a rejected token, and never
+// poll over HTTP. See host/README.md.
+
+#include <Arduino.h>
+
+#include <cstdio>
+
+#include "HaMockServer.h"
+#include "HostFixtures.h"
+#include "services/HaWebSocket.h"
+#include "widgets/DslWidget.h"
+
+namespace {
+
+using hostfx::check;
+using hostfx::widgetStatus;
+using hostfx::widgetValue;
+
+constexpr char kToken[] = "host-check-token";
+
+DslWidget& addEntity(hostfx::WidgetHarness& h, const char* id, const char* dsl,
+                     const String& baseUrl, const char* entity, const char* token) {
+  WidgetConfig cfg = hostfx::dslWidgetConfig(id, dsl, 160, 80);
+  cfg.settings["ha_base_url"] = baseUrl;
+  cfg.settings["entity_id"] = entity;
+  cfg.settings["ha_token"] = token;
+  return h.add(cfg);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (const int rc = hostfx::beginCheck(argc, argv)) {
+    return rc;
+  }
+
+  HaMockServer ha(kToken);
+  if (!ha.start()) {
+    std::fprintf(stderr, "mock HA server failed to start\n");
+    return 1;
+  }
+  // Small enough that the initial states arrive as continuation frames.
+  ha.setFragmentBytes(96);
+  ha.setState("light.kitchen", "on", R"({"friendly_name":"Kitchen","icon":"mdi:lightbulb"})");
+  ha.setState("sensor.outdoor_temp", "21.5",
+              R"({"friendly_name":"Outdoor","unit_of_measurement":"°C"})");
+  ha.setState("media_player.den", "playing",
+              R"({"friendly_name":"Den Speaker","icon":"mdi:speaker"})");
+  const String base = "http://127.0.0.1:" + String(static_cast<unsigned>(ha.port()));
+
+  hostfx::WidgetHarness h;
+  DslWidget& kitchen = addEntity(h, "kitchen", "homeassistant_control_card.json", base,
+                                 "light.kitchen", kToken);
+  DslWidget& kitchen2 = addEntity(h, "kitchen-2", "homeassistant_control_card.json", base,
+                                  "light.kitchen", kToken);
+  DslWidget& outdoor = addEntity(h, "outdoor", "homeassistant_entity.json", base,
+                                 "sensor.outdoor_temp", kToken);
+  DslWidget& den = addEntity(h, "den", "ha_speaker_card.json", base, "media_player.den", kToken);
+
+  const long initialMs = h.runUntil([&] {
+    return widgetStatus(kitchen) == "ok" && widgetStatus(kitchen2) == "ok" &&
+           widgetStatus(outdoor) == "ok" && widgetStatus(den) == "ok";
+  });
+  HaMockServer::Stats stats = ha.stats();
+  check(initialMs >= 0, "initial states applied");
+  check(stats.connections == 1 && stats.auths == 1, "one socket, one auth for four widgets");
+  check(stats.subscribes == 1 && stats.lastSubscribe.size() == 3,
+        "one subscribe_entities for the three entities");
+  check(widgetValue(kitchen, "name") == "Kitchen" && widgetValue(kitchen, "state") == "on" &&
+            widgetValue(kitchen, "entity") == "light.kitchen",
+        "control card fields");
+  check(widgetValue(outdoor, "state") == "21.5" && widgetValue(outdoor, "unit") == "°C" &&
+            widgetValue(outdoor, "when").startsWith("2025-10-"),
+        "entity card fields (REST-shaped last_updated)");
+  check(widgetValue(den, "name") == "Den Speaker", "speaker card fields");
+
+  ha.setState("light.kitchen", "off");
+  const long deltaMs = h.runUntil([&] {
+    return widgetValue(kitchen, "state") == "off" && widgetValue(kitchen2, "state") == "off";
+  });
+  check(deltaMs >= 0 && deltaMs < 500, "state delta reaches both cards within 500 ms");
+  check(widgetValue(kitchen, "name") == "Kitchen", "delta keeps untouched attributes");
+
+  ha.setState("sensor.outdoor_temp", "22.0", "{}", {"unit_of_measurement"});
+  check(h.runUntil([&] {
+          return widgetValue(outdoor, "state") == "22.0" && widgetValue(outdoor, "unit").isEmpty();
+        }) >= 0,
+        "attribute removal applied");
+
+  ha.dropClients();
+  check(h.runUntil([&] { return widgetStatus(kitchen) == "net err"; }) >= 0,
+        "drop shows as net err");
+  ha.setState("media_player.den", "idle");
+  const long reconnectMs = h.runUntil(
+      [&] { return widgetValue(den, "state") == "idle" && widgetStatus(den) == "ok"; }, 12000);
+  stats = ha.stats();
+  check(reconnectMs >= 0 && stats.connections == 2 && stats.subscribes == 2,
+        "reconnects, resubscribes and catches up");
+
+  ha.setState("sensor.hall_humidity", "48", R"({"friendly_name":"Hall"})");
+  DslWidget& hall = addEntity(h, "hall", "homeassistant_entity.json", base,
+                              "sensor.hall_humidity", kToken);
+  check(h.runUntil([&] { return widgetValue(hall, "state") == "48"; }) >= 0,
+        "widget added later gets its entity");
+  stats = ha.stats();
+  check(stats.connections == 2 && stats.subscribes == 3 && stats.unsubscribes == 1 &&
+            stats.lastSubscribe.size() == 4,
+        "late entity widens the subscription in place");
+
+  DslWidget& bad = addEntity(h, "bad-token", "homeassistant_entity.json", base,
+                             "sensor.outdoor_temp", "wrong-token");
+  check(h.runUntil([&] { return widgetStatus(bad) == "auth err"; }) >= 0,
+        "rejected token shows as auth err");
+  // Longer than the client's reconnect delay: a stopped client does not try again.
+  h.runUntil([] { return false; }, 7000);
+  stats = ha.stats();
+  check(stats.authFailures == 1, "rejected token is not retried");
+  check(widgetStatus(outdoor) == "ok", "good socket unaffected");
+
+  const uint32_t requests = hostfx::requestCount();
+  check(requests == 0, "no HTTP polling");
+
+  const haws::Stats ws = haws::stats();
+  h.clear();
+  check(h.runUntil([&] { return ha.activeClients() == 0; }) >= 0,
+        "socket closed with its last widget");
+  ha.stop();
+
+  stats = ha.stats();
+  std::printf("initial_ms=%ld delta_ms=%ld reconnect_ms=%ld connections=%u auths=%u "
+              "auth_failures=%u subscribes=%u unsubscribes=%u deltas=%u ws_messages=%u "
+              "http_requests=%u result=%s\n",
+              initialMs, deltaMs, reconnectMs, static_cast<unsigned>(stats.connections),
+              static_cast<unsigned>(stats.auths), static_cast<unsigned>(stats.authFailures),
+              static_cast<unsigned>(stats.subscribes), static_cast<unsigned>(stats.unsubscribes),
+              static_cast<unsigned>(stats.deltas), static_cast<unsigned>(ws.messages),
+              static_cast<unsigned>(requests), hostfx::checkFailures() == 0 ? "ok" : "fail");
+  return hostfx::checkFailures() == 0 ? 0 : 1;
+}
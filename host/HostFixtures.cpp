@@ -0,0 +1,177 @@
+#include "HostFixtures.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "platform/Fs.h"
+#include "widgets/DslRuntimeCaches.h"
+#include "widgets/DslWidget.h"
+
+namespace {
+
+struct Fixture {
+  String urlPrefix;
+  hostfx::Response response;
+};
+
+std::mutex sFixtureMutex;
+std::vector<Fixture> sFixtures;
+uint32_t sRequestCount = 0;
+
+constexpr uint32_t kTickMs = 5;
+uint32_t sCheckFailures = 0;
+
+}  // namespace
+
+class DslWidgetProbe {
+ public:
+  static const std::map<String, String>& values(const DslWidget& widget) {
+    return widget.values_;
+  }
+  static const String& status(const DslWidget& widget) { return widget.status_; }
+};
+
+namespace hostfx {
+
+void setResponse(const String& urlPrefix, int statusCode, const String& body,
+                 const String& contentType) {
+  std::lock_guard<std::mutex> lock(sFixtureMutex);
+  for (Fixture& fixture : sFixtures) {
+    if (fixture.urlPrefix == urlPrefix) {
+      fixture.response = Response{statusCode, body, contentType};
+      return;
+    }
+  }
+  sFixtures.push_back(Fixture{urlPrefix, Response{statusCode, body, contentType}});
+}
+
+bool loadResponseFile(const String& urlPrefix, const char* filePath, int statusCode) {
+  std::ifstream in(filePath, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  std::ostringstream body;
+  body << in.rdbuf();
+  setResponse(urlPrefix, statusCode, String(body.str().c_str()));
+  return true;
+}
+
+void clear() {
+  std::lock_guard<std::mutex> lock(sFixtureMutex);
+  sFixtures.clear();
+  sRequestCount = 0;
+}
+
+uint32_t requestCount() {
+  std::lock_guard<std::mutex> lock(sFixtureMutex);
+  return sRequestCount;
+}
+
+bool lookup(const String& url, Response& out) {
+  std::lock_guard<std::mutex> lock(sFixtureMutex);
+  ++sRequestCount;
+  const Fixture* best = nullptr;
+  for (const Fixture& fixture : sFixtures) {
+    if (url.startsWith(fixture.urlPrefix) &&
+        (best == nullptr || fixture.urlPrefix.length() > best->urlPrefix.length())) {
+      best = &fixture;
+    }
+  }
+  if (best == nullptr) {
+    return false;
+  }
+  out = best->response;
+  return true;
+}
+
+int beginCheck(int argc, char** argv) {
+  const char* root = "data";
+  bool verbose = false;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--root") == 0 && i + 1 < argc) {
+      root = argv[++i];
+    } else if (std::strcmp(argv[i], "--verbose") == 0) {
+      verbose = true;
+    } else {
+      std::fprintf(stderr, "usage: %s [--root DIR] [--verbose]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (!verbose) {
+    setenv("COSTAR_HOST_QUIET", "1", 0);
+  }
+  platform::fs::setHostRoot(root);
+  if (!platform::fs::begin(false)) {
+    std::fprintf(stderr, "data root '%s' not found\n", root);
+    return 1;
+  }
+  setDslFieldCacheEnabled(false);
+  return 0;
+}
+
+void check(bool ok, const char* what) {
+  std::printf("%-52s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok) {
+    ++sCheckFailures;
+  }
+}
+
+uint32_t checkFailures() { return sCheckFailures; }
+
+String widgetValue(const DslWidget& widget, const char* key) {
+  const std::map<String, String>& values = DslWidgetProbe::values(widget);
+  auto it = values.find(key);
+  return it == values.end() ? String() : it->second;
+}
+
+const String& widgetStatus(const DslWidget& widget) { return DslWidgetProbe::status(widget); }
+
+WidgetConfig dslWidgetConfig(const char* id, const char* dslFile, int16_t w, int16_t h) {
+  WidgetConfig cfg;
+  cfg.type = "dsl";
+  cfg.id = id;
+  cfg.w = w;
+  cfg.h = h;
+  cfg.settings["dsl_path"] = String("/dsl_available/") + dslFile;
+  return cfg;
+}
+
+WidgetHarness::WidgetHarness() = default;
+
+WidgetHarness::~WidgetHarness() = default;
+
+DslWidget& WidgetHarness::add(const WidgetConfig& cfg) {
+  widgets_.push_back(std::make_unique<DslWidget>(cfg));
+  widgets_.back()->begin();
+  return *widgets_.back();
+}
+
+long WidgetHarness::runUntil(const std::function<bool()>& done, uint32_t timeoutMs) {
+  const auto start = std::chrono::steady_clock::now();
+  for (;;) {
+    for (auto& widget : widgets_) {
+      widget->tick(millis());
+    }
+    const long elapsed = static_cast<long>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+    if (done()) {
+      return elapsed;
+    }
+    if (elapsed > static_cast<long>(timeoutMs)) {
+      return -1;
+    }
+    delay(kTickMs);
+  }
+}
+
+void WidgetHarness::clear() { widgets_.clear(); }
+
+}  // namespace hostfx
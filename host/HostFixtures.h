@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "WidgetTypes.h"
+
+class DslWidget;
+
+// Canned HTTP responses for the host build. HttpJsonClient::get() serves the fixture whose
+// URL prefix is the longest match for the requested URL.
+namespace hostfx {
+
+struct Response {
+  int statusCode = 200;
+  String body;
+  String contentType;
+};
+
+void setResponse(const String& urlPrefix, int statusCode, const String& body,
+                 const String& contentType = "application/json");
+bool loadResponseFile(const String& urlPrefix, const char* filePath, int statusCode = 200);
+void clear();
+uint32_t requestCount();
+// Longest-prefix match for `url`; every call counts toward requestCount().
+bool lookup(const String& url, Response& out);
+
+// Shared by the push-source check tools (HaWsCheck.cpp, SseCheck.cpp).
+
+// Parses `[--root DIR] [--verbose]`, quiets runtime logs unless --verbose, mounts the data root
+// and turns the DSL field cache off. Returns 0 to go on, else the exit code to stop with.
+int beginCheck(int argc, char** argv);
+// Prints one result line; failed lines are counted in checkFailures().
+void check(bool ok, const char* what);
+uint32_t checkFailures();
+
+// A bound field value ("" when unset) and the status shown by the widget's dot.
+String widgetValue(const DslWidget& widget, const char* key);
+const String& widgetStatus(const DslWidget& widget);
+
+// A "dsl" widget config for /dsl_available/<dslFile>.
+WidgetConfig dslWidgetConfig(const char* id, const char* dslFile, int16_t w, int16_t h);
+
+// Owns the widgets under check and ticks them like DisplayManager's network task.
+class WidgetHarness {
+ public:
+  static constexpr uint32_t kWaitMs = 3000;
+
+  WidgetHarness();
+  ~WidgetHarness();
+
+  // Creates the widget and calls begin().
+  DslWidget& add(const WidgetConfig& cfg);
+  // Ticks every widget until `done` holds; returns the time it took, or -1 on timeout.
+  long runUntil(const std::function<bool()>& done, uint32_t timeoutMs = kWaitMs);
+  // Destroys every widget, releasing their sources.
+  void clear();
+
+ private:
+  std::vector<std::unique_ptr<DslWidget>> widgets_;
+};
+
+}  // namespace hostfx
@@ -0,0 +1,180 @@
+#include "HostHeap.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include <unistd.h>
+
+// AddressSanitizer owns malloc, so sanitizer builds count operator new only.
+#if defined(__SANITIZE_ADDRESS__)
+#define COSTAR_HOSTHEAP_C_ALLOC 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define COSTAR_HOSTHEAP_C_ALLOC 0
+#endif
+#endif
+#ifndef COSTAR_HOSTHEAP_C_ALLOC
+#define COSTAR_HOSTHEAP_C_ALLOC 1
+#endif
+
+#if COSTAR_HOSTHEAP_C_ALLOC
+// glibc's own entry points, which the replacements below forward to.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+#endif
+
+namespace {
+
+std::atomic<uint64_t> sAllocCount{0};
+std::atomic<uint64_t> sAllocBytes{0};
+std::atomic<size_t> sLiveBytes{0};
+std::atomic<size_t> sPeakLiveBytes{0};
+
+void noteAlloc(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  const size_t usable = malloc_usable_size(ptr);
+  sAllocCount.fetch_add(1, std::memory_order_relaxed);
+  sAllocBytes.fetch_add(usable, std::memory_order_relaxed);
+  const size_t live = sLiveBytes.fetch_add(usable, std::memory_order_relaxed) + usable;
+  size_t peak = sPeakLiveBytes.load(std::memory_order_relaxed);
+  while (live > peak && !sPeakLiveBytes.compare_exchange_weak(peak, live)) {
+  }
+}
+
+void noteFree(void* ptr) {
+  if (ptr != nullptr) {
+    sLiveBytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+  }
+}
+
+#if !COSTAR_HOSTHEAP_C_ALLOC
+void* trackedAlloc(size_t size) {
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  noteAlloc(ptr);
+  return ptr;
+}
+
+void trackedFree(void* ptr) {
+  noteFree(ptr);
+  std::free(ptr);
+}
+#endif
+
+}  // namespace
+
+namespace hostheap {
+
+Snapshot snapshot() {
+  Snapshot out;
+  out.allocCount = sAllocCount.load();
+  out.allocBytes = sAllocBytes.load();
+  out.liveBytes = sLiveBytes.load();
+  out.peakLiveBytes = sPeakLiveBytes.load();
+  return out;
+}
+
+void resetPeak() { sPeakLiveBytes.store(sLiveBytes.load()); }
+
+}  // namespace hostheap
+
+#if COSTAR_HOSTHEAP_C_ALLOC
+
+// Replacing the C allocator also covers operator new (libstdc++ allocates with malloc),
+// heap_caps_malloc and ArduinoJson's default allocator.
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+  void* ptr = __libc_malloc(size);
+  noteAlloc(ptr);
+  return ptr;
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+  void* ptr = __libc_calloc(count, size);
+  noteAlloc(ptr);
+  return ptr;
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+  const size_t before = ptr != nullptr ? malloc_usable_size(ptr) : 0;
+  void* out = __libc_realloc(ptr, size);
+  // realloc(ptr, 0) frees; a failed realloc leaves ptr allocated.
+  if (out != nullptr || size == 0) {
+    sLiveBytes.fetch_sub(before, std::memory_order_relaxed);
+    noteAlloc(out);
+  }
+  return out;
+}
+
+void free(void* ptr) noexcept {
+  noteFree(ptr);
+  __libc_free(ptr);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+  void* ptr = __libc_memalign(alignment, size);
+  noteAlloc(ptr);
+  return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept { return memalign(alignment, size); }
+
+int posix_memalign(void** out, size_t alignment, size_t size) noexcept {
+  if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  void* ptr = memalign(alignment, size);
+  if (ptr == nullptr) {
+    return ENOMEM;
+  }
+  *out = ptr;
+  return 0;
+}
+
+void* valloc(size_t size) noexcept {
+  return memalign(static_cast<size_t>(sysconf(_SC_PAGESIZE)), size);
+}
+
+void* pvalloc(size_t size) noexcept {
+  const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return memalign(page, (size + page - 1) / page * page);
+}
+
+}  // extern "C"
+
+#else
+
+void* operator new(size_t size) { return trackedAlloc(size); }
+void* operator new[](size_t size) { return trackedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return trackedAlloc(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return trackedAlloc(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { trackedFree(ptr); }
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Heap accounting for host benchmarks: replaces the C allocator (malloc, calloc, realloc,
+// free and the aligned variants), so operator new, heap_caps_malloc and ArduinoJson pools are
+// all counted. Sanitizer builds count operator new only, since ASan owns malloc. Only linked
+// into tools that compile HostHeap.cpp; counters are process-wide.
+namespace hostheap {
+
+struct Snapshot {
+  uint64_t allocCount = 0;
+  uint64_t allocBytes = 0;
+  size_t liveBytes = 0;
+  size_t peakLiveBytes = 0;
+};
+
+Snapshot snapshot();
+// Restarts peak tracking from the current live byte count.
+void resetPeak();
+
+}  // namespace hostheap
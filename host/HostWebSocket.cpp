@@ -0,0 +1,261 @@
+#include "HostWebSocket.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <random>
+
+namespace hostws {
+
+namespace {
+
+constexpr char kHandshakeGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+constexpr size_t kMaxHeadBytes = 8192;
+
+uint32_t rotl(uint32_t v, int bits) { return (v << bits) | (v >> (32 - bits)); }
+
+void sha1(const std::string& text, uint8_t out[20]) {
+  uint32_t h[5] = {0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u, 0xC3D2E1F0u};
+  std::string msg = text;
+  const uint64_t bits = static_cast<uint64_t>(text.size()) * 8u;
+  msg += static_cast<char>(0x80);
+  while (msg.size() % 64 != 56) {
+    msg += static_cast<char>(0);
+  }
+  for (int i = 7; i >= 0; --i) {
+    msg += static_cast<char>((bits >> (i * 8)) & 0xFF);
+  }
+  for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; ++i) {
+      const uint8_t* p = reinterpret_cast<const uint8_t*>(msg.data() + chunk + i * 4);
+      w[i] = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+             (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+    for (int i = 16; i < 80; ++i) {
+      w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+    uint32_t a = h[0];
+    uint32_t b = h[1];
+    uint32_t c = h[2];
+    uint32_t d = h[3];
+    uint32_t e = h[4];
+    for (int i = 0; i < 80; ++i) {
+      uint32_t f;
+      uint32_t k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999u;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1u;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDCu;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6u;
+      }
+      const uint32_t t = rotl(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rotl(b, 30);
+      b = a;
+      a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+  for (int i = 0; i < 5; ++i) {
+    out[i * 4] = static_cast<uint8_t>(h[i] >> 24);
+    out[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+    out[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+    out[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+  }
+}
+
+}  // namespace
+
+std::string base64(const uint8_t* data, size_t len) {
+  static const char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < len; i += 3) {
+    const uint32_t n = (static_cast<uint32_t>(data[i]) << 16) |
+                       (i + 1 < len ? static_cast<uint32_t>(data[i + 1]) << 8 : 0) |
+                       (i + 2 < len ? data[i + 2] : 0);
+    out += kAlphabet[(n >> 18) & 63];
+    out += kAlphabet[(n >> 12) & 63];
+    out += i + 1 < len ? kAlphabet[(n >> 6) & 63] : '=';
+    out += i + 2 < len ? kAlphabet[n & 63] : '=';
+  }
+  return out;
+}
+
+std::string acceptKey(const std::string& key) {
+  uint8_t digest[20];
+  sha1(key + kHandshakeGuid, digest);
+  return base64(digest, sizeof(digest));
+}
+
+bool writeAll(int fd, const void* data, size_t len) {
+  const char* p = static_cast<const char*>(data);
+  while (len > 0) {
+    const ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    len -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool readExact(int fd, void* out, size_t len) {
+  char* p = static_cast<char*>(out);
+  while (len > 0) {
+    const ssize_t n = ::recv(fd, p, len, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    len -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool writeFrame(int fd, uint8_t opcode, const void* data, size_t len, bool fin, bool mask) {
+  std::string frame;
+  frame += static_cast<char>((fin ? 0x80 : 0x00) | (opcode & 0x0F));
+  const uint8_t maskBit = mask ? 0x80 : 0x00;
+  if (len < 126) {
+    frame += static_cast<char>(maskBit | len);
+  } else if (len <= 0xFFFF) {
+    frame += static_cast<char>(maskBit | 126);
+    frame += static_cast<char>((len >> 8) & 0xFF);
+    frame += static_cast<char>(len & 0xFF);
+  } else {
+    frame += static_cast<char>(maskBit | 127);
+    for (int i = 7; i >= 0; --i) {
+      frame += static_cast<char>((static_cast<uint64_t>(len) >> (i * 8)) & 0xFF);
+    }
+  }
+  uint8_t key[4] = {0, 0, 0, 0};
+  if (mask) {
+    static thread_local std::mt19937 rng{std::random_device{}()};
+    const uint32_t r = rng();
+    std::memcpy(key, &r, sizeof(key));
+    frame.append(reinterpret_cast<const char*>(key), sizeof(key));
+  }
+  const size_t header = frame.size();
+  frame.append(static_cast<const char*>(data), len);
+  if (mask) {
+    for (size_t i = 0; i < len; ++i) {
+      frame[header + i] = static_cast<char>(frame[header + i] ^ key[i % 4]);
+    }
+  }
+  return writeAll(fd, frame.data(), frame.size());
+}
+
+bool readFrameHeader(int fd, FrameHeader& out) {
+  uint8_t b[2];
+  if (!readExact(fd, b, sizeof(b))) {
+    return false;
+  }
+  out.fin = (b[0] & 0x80) != 0;
+  out.opcode = b[0] & 0x0F;
+  out.masked = (b[1] & 0x80) != 0;
+  uint64_t len = b[1] & 0x7F;
+  if (len == 126) {
+    uint8_t ext[2];
+    if (!readExact(fd, ext, sizeof(ext))) {
+      return false;
+    }
+    len = (static_cast<uint64_t>(ext[0]) << 8) | ext[1];
+  } else if (len == 127) {
+    uint8_t ext[8];
+    if (!readExact(fd, ext, sizeof(ext))) {
+      return false;
+    }
+    len = 0;
+    for (uint8_t byte : ext) {
+      len = (len << 8) | byte;
+    }
+  }
+  out.length = len;
+  return !out.masked || readExact(fd, out.mask, sizeof(out.mask));
+}
+
+bool readPayload(int fd, const FrameHeader& header, uint64_t offset, void* out, size_t len) {
+  if (!readExact(fd, out, len)) {
+    return false;
+  }
+  if (header.masked) {
+    uint8_t* p = static_cast<uint8_t*>(out);
+    for (size_t i = 0; i < len; ++i) {
+      p[i] ^= header.mask[(offset + i) % 4];
+    }
+  }
+  return true;
+}
+
+bool readHttpHead(int fd, std::string& out) {
+  out.clear();
+  char c;
+  while (out.size() < kMaxHeadBytes) {
+    if (!readExact(fd, &c, 1)) {
+      return false;
+    }
+    out += c;
+    if (out.size() >= 4 && out.compare(out.size() - 4, 4, "\r\n\r\n") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string headerValue(const std::string& head, const char* name) {
+  const size_t nameLen = std::strlen(name);
+  size_t pos = head.find("\r\n");
+  while (pos != std::string::npos && pos + 2 < head.size()) {
+    const size_t start = pos + 2;
+    const size_t end = head.find("\r\n", start);
+    if (end == std::string::npos) {
+      break;
+    }
+    const size_t colon = head.find(':', start);
+    if (colon != std::string::npos && colon < end && colon - start == nameLen) {
+      bool same = true;
+      for (size_t i = 0; i < nameLen; ++i) {
+        if (std::tolower(static_cast<unsigned char>(head[start + i])) !=
+            std::tolower(static_cast<unsigned char>(name[i]))) {
+          same = false;
+          break;
+        }
+      }
+      if (same) {
+        size_t v = colon + 1;
+        while (v < end && head[v] == ' ') {
+          ++v;
+        }
+        return head.substr(v, end - v);
+      }
+    }
+    pos = end;
+  }
+  return std::string();
+}
+
+}  // namespace hostws
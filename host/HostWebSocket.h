@@ -0,0 +1,44 @@
+#pragma once
+
+// RFC 6455 pieces shared by the host WebSocket client (EspWebSocketClientHost.cpp) and the
+// mock Home Assistant server (HaMockServer.cpp). Blocking I/O on connected sockets.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hostws {
+
+constexpr uint8_t kOpContinuation = 0x0;
+constexpr uint8_t kOpText = 0x1;
+constexpr uint8_t kOpBinary = 0x2;
+constexpr uint8_t kOpClose = 0x8;
+constexpr uint8_t kOpPing = 0x9;
+constexpr uint8_t kOpPong = 0xA;
+
+struct FrameHeader {
+  bool fin = true;
+  uint8_t opcode = 0;
+  bool masked = false;
+  uint8_t mask[4] = {0, 0, 0, 0};
+  uint64_t length = 0;
+};
+
+std::string base64(const uint8_t* data, size_t len);
+// Sec-WebSocket-Accept for a Sec-WebSocket-Key.
+std::string acceptKey(const std::string& key);
+
+bool writeAll(int fd, const void* data, size_t len);
+bool readExact(int fd, void* out, size_t len);
+// Clients mask their frames, servers do not.
+bool writeFrame(int fd, uint8_t opcode, const void* data, size_t len, bool fin, bool mask);
+bool readFrameHeader(int fd, FrameHeader& out);
+// Reads a frame payload, unmasking it when the header says so.
+bool readPayload(int fd, const FrameHeader& header, uint64_t offset, void* out, size_t len);
+
+// Reads an HTTP request or response head up to the blank line (at most 8 KB).
+bool readHttpHead(int fd, std::string& out);
+// Value of header `name` (case-insensitive) in an HTTP head; empty when absent.
+std::string headerValue(const std::string& head, const char* name);
+
+}  // namespace hostws
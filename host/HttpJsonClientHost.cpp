@@ -0,0 +1,114 @@
+#include "services/HttpJsonClient.h"
+
+#include "HostFixtures.h"
+
+namespace {
+// Strong validator derived from the fixture body, so conditional polls of an unchanged
+// fixture get a 304 just like a real server would answer.
+String fixtureEtag(const String& body) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < body.length(); ++i) {
+    hash ^= static_cast<uint8_t>(body[i]);
+    hash *= 16777619u;
+  }
+  char buf[12];
+  snprintf(buf, sizeof(buf), "\"%08lx\"", static_cast<unsigned long>(hash));
+  return String(buf);
+}
+}  // namespace
+
+bool HttpJsonClient::get(const String& url, JsonDocument& outDoc, String* errorMessage,
+                         HttpFetchMeta* meta,
+                         const std::map<String, String>* extraHeaders,
+                         const JsonDocument* filter,
+                         const HttpValidators* validators) const {
+  (void)extraHeaders;
+  if (meta != nullptr) {
+    *meta = HttpFetchMeta();
+  }
+  const uint32_t startMs = millis();
+
+  hostfx::Response match;
+  if (!hostfx::lookup(url, match)) {
+    if (meta != nullptr) {
+      meta->statusCode = -1;
+      meta->transportReason = "host-no-fixture";
+      meta->elapsedMs = millis() - startMs;
+    }
+    if (errorMessage != nullptr) {
+      *errorMessage = "HTTP transport failure (no host fixture for '" + url + "')";
+    }
+    return false;
+  }
+
+  const bool success = match.statusCode >= 200 && match.statusCode < 300;
+  const String etag = success ? fixtureEtag(match.body) : String();
+  if (validators != nullptr && !etag.isEmpty() && validators->etag == etag) {
+    if (meta != nullptr) {
+      meta->statusCode = 304;
+      meta->notModified = true;
+      meta->contentLengthBytes = 0;
+      meta->validators = *validators;
+      meta->elapsedMs = millis() - startMs;
+    }
+    return true;
+  }
+
+  if (meta != nullptr) {
+    meta->statusCode = match.statusCode;
+    meta->validators.etag = etag;
+    meta->contentType = match.contentType;
+    meta->contentLengthBytes = static_cast<int>(match.body.length());
+    meta->payloadBytes = match.body.length();
+    meta->elapsedMs = millis() - startMs;
+  }
+
+  if (!success) {
+    if (errorMessage != nullptr) {
+      *errorMessage = "HTTP status " + String(match.statusCode);
+    }
+    return false;
+  }
+
+  const DeserializationError err =
+      filter != nullptr ? deserializeJson(outDoc, match.body, DeserializationOption::Filter(*filter))
+                        : deserializeJson(outDoc, match.body);
+  if (err) {
+    if (errorMessage != nullptr) {
+      *errorMessage = "JSON parse failed (" + String(err.c_str()) + ")";
+    }
+    return false;
+  }
+  return true;
+}
+
+bool HttpJsonClient::send(const String& method, const String& url, const String& body,
+                          const String& contentType,
+                          const std::map<String, String>* extraHeaders, int* statusOut,
+                          String* errorMessage) const {
+  (void)method;
+  (void)body;
+  (void)contentType;
+  (void)extraHeaders;
+  hostfx::Response match;
+  if (!hostfx::lookup(url, match)) {
+    if (statusOut != nullptr) {
+      *statusOut = -1;
+    }
+    if (errorMessage != nullptr) {
+      *errorMessage = "status=-1 reason='host-no-fixture'";
+    }
+    return false;
+  }
+  if (statusOut != nullptr) {
+    *statusOut = match.statusCode;
+  }
+  if (match.statusCode < 200 || match.statusCode >= 300) {
+    if (errorMessage != nullptr) {
+      *errorMessage = "status=" + String(match.statusCode) + " body='" +
+                      match.body.substring(0, 72) + "'";
+    }
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,76 @@
+// Connection-reuse probe for COSTAR_HOST_LIVE_HTTP builds: issues repeated HttpJsonClient
+// requests against a live (plain HTTP) server through the device connection pool and reports
+// how many TCP connections they needed. With --conditional each GET replays the validators of
+// the previous response and 304s are counted. See host/README.md.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_http_client.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "services/HttpJsonClient.h"
+
+int main(int argc, char** argv) {
+  String url;
+  String postUrl;
+  uint32_t count = 10;
+  bool conditional = false;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--url") == 0 && i + 1 < argc) {
+      url = argv[++i];
+    } else if (std::strcmp(argv[i], "--post-url") == 0 && i + 1 < argc) {
+      postUrl = argv[++i];
+    } else if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+      count = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--conditional") == 0) {
+      conditional = true;
+    } else {
+      url = String();
+      break;
+    }
+  }
+  if (url.isEmpty() || count == 0) {
+    std::fprintf(stderr, "usage: %s --url URL [--post-url URL] [--count N] [--conditional]\n",
+                 argv[0]);
+    return 2;
+  }
+
+  HttpJsonClient http;
+  uint32_t requests = 0;
+  uint32_t failures = 0;
+  uint32_t notModified = 0;
+  HttpValidators validators;
+  for (uint32_t i = 0; i < count; ++i) {
+    JsonDocument doc;
+    String error;
+    HttpFetchMeta meta;
+    ++requests;
+    if (!http.get(url, doc, &error, &meta, nullptr, nullptr,
+                  conditional && !validators.empty() ? &validators : nullptr)) {
+      ++failures;
+      std::fprintf(stderr, "get %u failed: %s\n", static_cast<unsigned>(i), error.c_str());
+    } else {
+      validators = meta.validators;
+      if (meta.notModified) {
+        ++notModified;
+      }
+    }
+    if (!postUrl.isEmpty()) {
+      ++requests;
+      if (!http.send("POST", postUrl, "{\"probe\":true}", "application/json", nullptr, nullptr,
+                     &error)) {
+        ++failures;
+        std::fprintf(stderr, "post %u failed: %s\n", static_cast<unsigned>(i), error.c_str());
+      }
+    }
+  }
+
+  std::printf("requests=%u failures=%u not_modified=%u connections=%u\n",
+              static_cast<unsigned>(requests), static_cast<unsigned>(failures),
+              static_cast<unsigned>(notModified),
+              static_cast<unsigned>(esp_http_client_host_connect_count()));
+  return failures == 0 ? 0 : 1;
+}
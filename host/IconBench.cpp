@@ -0,0 +1,412 @@
+// Icon format benchmark: for every icon under <root>/icons and <root>/icon_cache, compares the
+// raw RGB565 file with the packed format (widgets/DslIconCodec.h) on size and on load time the
+// way DslWidget loads and draws them: read the file, then validate and decode it strip by strip
+// into the blit buffer when packed. With --pack, also checks an icon pack blob against the
+// built-in icons. See host/README.md.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "platform/IconPack.h"
+#include "widgets/DslIconCodec.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kBlitPixels = 1024;
+constexpr size_t kMaxRun = 128;
+
+struct Options {
+  std::string root = "data";
+  uint32_t iterations = 2000;
+  // Modelled LittleFS read throughput on the device.
+  double flashKBps = 1000.0;
+  // Icon pack blob (tools/pack_icon_partition.py) to check against the icons.
+  std::string pack;
+};
+
+// What the icon pack should hold for one built-in icon.
+struct PackExpect {
+  std::string name;
+  uint16_t w = 0;
+  uint16_t h = 0;
+  std::vector<uint8_t> bytes;
+};
+
+bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+  FILE* f = std::fopen(path.c_str(), "rb");
+  if (f == nullptr) {
+    return false;
+  }
+  out.clear();
+  uint8_t buf[4096];
+  size_t n = 0;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+    out.insert(out.end(), buf, buf + n);
+  }
+  std::fclose(f);
+  return true;
+}
+
+bool writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+  FILE* f = std::fopen(path.c_str(), "wb");
+  if (f == nullptr) {
+    return false;
+  }
+  const bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+  return std::fclose(f) == 0 && ok;
+}
+
+void listIcons(const std::string& dir, std::vector<std::string>& out) {
+  DIR* d = opendir(dir.c_str());
+  if (d == nullptr) {
+    return;
+  }
+  while (dirent* entry = readdir(d)) {
+    const std::string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    const std::string path = dir + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+      continue;
+    }
+    if (S_ISDIR(st.st_mode)) {
+      listIcons(path, out);
+    } else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".raw") == 0) {
+      out.push_back(path);
+    }
+  }
+  closedir(d);
+}
+
+void put16(std::vector<uint8_t>& out, uint16_t v) {
+  out.push_back(static_cast<uint8_t>(v & 0xFF));
+  out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+// Same encoder as tools/icon_pack.py and the image proxy, without the raw fallback.
+std::vector<uint8_t> pack(const std::vector<uint16_t>& pixels, uint16_t w, uint16_t h) {
+  std::vector<uint16_t> palette;
+  std::vector<int> index(65536, -1);
+  for (uint16_t v : pixels) {
+    if (index[v] < 0) {
+      index[v] = static_cast<int>(palette.size());
+      palette.push_back(v);
+    }
+  }
+  const bool usePalette = palette.size() <= 256;
+
+  std::vector<uint8_t> out = {'C', 'I', 'C', '1'};
+  put16(out, w);
+  put16(out, h);
+  put16(out, usePalette ? static_cast<uint16_t>(palette.size()) : 0);
+  if (usePalette) {
+    for (uint16_t v : palette) {
+      put16(out, v);
+    }
+  }
+  auto value = [&](uint16_t v) {
+    if (usePalette) {
+      out.push_back(static_cast<uint8_t>(index[v]));
+    } else {
+      put16(out, v);
+    }
+  };
+  std::vector<uint16_t> literal;
+  auto flush = [&] {
+    if (literal.empty()) {
+      return;
+    }
+    out.push_back(static_cast<uint8_t>(literal.size() - 1));
+    for (uint16_t v : literal) {
+      value(v);
+    }
+    literal.clear();
+  };
+  for (size_t i = 0; i < pixels.size();) {
+    size_t run = 1;
+    while (i + run < pixels.size() && run < kMaxRun && pixels[i + run] == pixels[i]) {
+      ++run;
+    }
+    if (run >= 2) {
+      flush();
+      out.push_back(static_cast<uint8_t>(0x80 | (run - 1)));
+      value(pixels[i]);
+      i += run;
+      continue;
+    }
+    literal.push_back(pixels[i++]);
+    if (literal.size() == kMaxRun) {
+      flush();
+    }
+  }
+  flush();
+  return out;
+}
+
+// Mirrors loadIconFromFile + blitIcon for a packed icon, minus the panel push.
+bool loadPacked(const std::string& path, uint16_t w, uint16_t h, std::vector<uint8_t>& file,
+                uint16_t* blit) {
+  if (!readFile(path, file) || !iconcodec::validate(file.data(), file.size(), w, h)) {
+    return false;
+  }
+  iconcodec::Decoder decoder(file.data(), file.size());
+  const uint16_t stripRows = static_cast<uint16_t>(kBlitPixels / w > 0 ? kBlitPixels / w : 1);
+  for (uint16_t row = 0; row < h; row += stripRows) {
+    const uint16_t rows = static_cast<uint16_t>(h - row < stripRows ? h - row : stripRows);
+    if (!decoder.read(blit, static_cast<size_t>(w) * rows)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Load>
+double timeUs(uint32_t iterations, Load load) {
+  const Clock::time_point start = Clock::now();
+  for (uint32_t i = 0; i < iterations; ++i) {
+    load();
+  }
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+  for (int i = 1; i < argc; ++i) {
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (std::strcmp(argv[i], "--root") == 0 && value != nullptr) {
+      opts.root = value;
+    } else if (std::strcmp(argv[i], "--iterations") == 0 && value != nullptr) {
+      opts.iterations = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (std::strcmp(argv[i], "--flash-kbps") == 0 && value != nullptr) {
+      opts.flashKBps = std::strtod(value, nullptr);
+    } else if (std::strcmp(argv[i], "--pack") == 0 && value != nullptr) {
+      opts.pack = value;
+    } else {
+      return false;
+    }
+    ++i;
+  }
+  if (opts.iterations == 0) {
+    opts.iterations = 1;
+  }
+  return opts.flashKBps > 0.0;
+}
+
+// Reads the blob through the host icon pack backend (mmap, as on the device) and checks that it
+// holds exactly the built-in icons, byte for byte, and that damaged blobs are rejected. Times a
+// lookup plus decode against loading the same icon from a file. Returns the failure count.
+int checkPack(const Options& opts, const std::vector<PackExpect>& expected,
+              const std::string& packedPath) {
+  std::vector<uint8_t> blob;
+  if (!readFile(opts.pack, blob)) {
+    std::fprintf(stderr, "cannot read icon pack '%s'\n", opts.pack.c_str());
+    return 1;
+  }
+  platform::iconpack::setHostPackFile(opts.pack.c_str());
+  if (!platform::iconpack::begin()) {
+    std::fprintf(stderr, "%s: not a valid icon pack\n", opts.pack.c_str());
+    return 1;
+  }
+
+  int failures = 0;
+  size_t found = 0;
+  double lookupUs = 0.0;
+  double fileUs = 0.0;
+  std::vector<uint8_t> scratch;
+  uint16_t blit[kBlitPixels];
+  for (const PackExpect& want : expected) {
+    platform::iconpack::Icon icon;
+    if (!platform::iconpack::find(want.name.c_str(), icon) || icon.w != want.w ||
+        icon.h != want.h || icon.bytes != want.bytes.size() ||
+        std::memcmp(icon.data, want.bytes.data(), icon.bytes) != 0) {
+      std::fprintf(stderr, "%s: missing or different in the icon pack\n", want.name.c_str());
+      ++failures;
+      continue;
+    }
+    ++found;
+    const bool packed = icon.bytes < static_cast<size_t>(icon.w) * icon.h * 2U;
+    lookupUs += timeUs(opts.iterations, [&] {
+      platform::iconpack::Icon hit;
+      platform::iconpack::find(want.name.c_str(), hit);
+      if (packed) {
+        iconcodec::Decoder decoder(hit.data, hit.bytes);
+        decoder.read(blit, std::min<size_t>(kBlitPixels, static_cast<size_t>(hit.w) * hit.h));
+      }
+    });
+    if (!writeFile(packedPath, want.bytes)) {
+      std::perror("write");
+      return failures + 1;
+    }
+    fileUs += timeUs(opts.iterations, [&] {
+      readFile(packedPath, scratch);
+      if (packed) {
+        iconcodec::Decoder decoder(scratch.data(), scratch.size());
+        decoder.read(blit, std::min<size_t>(kBlitPixels, static_cast<size_t>(want.w) * want.h));
+      }
+    });
+  }
+
+  platform::iconpack::Icon stray;
+  const size_t count = platform::iconpack::format::le16(blob.data() + 6);
+  if (count != expected.size() || platform::iconpack::find("/icons/missing.raw", stray)) {
+    std::fprintf(stderr, "icon pack holds %zu icons, expected %zu\n", count, expected.size());
+    ++failures;
+  }
+
+  // Damaged copies: truncated, bad magic, a name that no longer matches its hash.
+  namespace fmt = platform::iconpack::format;
+  size_t rejected = 0;
+  std::vector<uint8_t> bad = blob;
+  rejected += fmt::validate(bad.data(), bad.size() - 1) == 0 ? 1 : 0;
+  bad[0] = 'X';
+  rejected += fmt::validate(bad.data(), bad.size()) == 0 ? 1 : 0;
+  bad = blob;
+  if (count > 0) {
+    bad[fmt::le32(bad.data() + fmt::kHeaderBytes + 4)] ^= 0x20;
+  }
+  rejected += fmt::validate(bad.data(), bad.size()) == 0 ? 1 : 0;
+  if (rejected != 3) {
+    ++failures;
+  }
+  platform::iconpack::setHostPackFile(nullptr);
+
+  const double n = found > 0 ? static_cast<double>(found) : 1.0;
+  std::printf("pack: icons=%zu found=%zu blob_bytes=%zu lookup_us=%.2f file_us=%.2f "
+              "damaged_rejected=%zu/3 result=%s\n",
+              expected.size(), found, blob.size(), lookupUs / n, fileUs / n, rejected,
+              failures == 0 ? "ok" : "FAIL");
+  return failures;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts;
+  if (!parseArgs(argc, argv, opts)) {
+    std::fprintf(stderr,
+                 "usage: %s [--root DIR] [--iterations N] [--flash-kbps KBPS] [--pack FILE]\n",
+                 argv[0]);
+    return 2;
+  }
+
+  std::vector<std::string> icons;
+  listIcons(opts.root + "/icons", icons);
+  listIcons(opts.root + "/icon_cache", icons);
+  std::sort(icons.begin(), icons.end());
+  if (icons.empty()) {
+    std::fprintf(stderr, "no icons under %s/icons or %s/icon_cache\n", opts.root.c_str(),
+                 opts.root.c_str());
+    return 1;
+  }
+
+  char tmpl[] = "/tmp/costar_icon_bench.XXXXXX";
+  const char* tmpDir = mkdtemp(tmpl);
+  if (tmpDir == nullptr) {
+    std::perror("mkdtemp");
+    return 1;
+  }
+  const std::string rawPath = std::string(tmpDir) + "/icon.raw";
+  const std::string packedPath = std::string(tmpDir) + "/icon.packed";
+
+  std::printf("%-44s %7s %6s %6s %6s %8s %8s %9s %9s %5s\n", "icon", "size", "raw_b", "pack_b",
+              "ratio", "raw_us", "pack_us", "fl_raw_us", "fl_pk_us", "match");
+  int failures = 0;
+  size_t totalRaw = 0;
+  size_t totalFile = 0;
+  size_t totalPacked = 0;
+  std::vector<uint8_t> file;
+  std::vector<uint8_t> scratch;
+  std::vector<PackExpect> builtins;
+  uint16_t blit[kBlitPixels];
+  for (const std::string& path : icons) {
+    if (!readFile(path, file)) {
+      continue;
+    }
+    iconcodec::Header header;
+    const bool filePacked = iconcodec::readHeader(file.data(), file.size(), header);
+    uint16_t w = header.w;
+    uint16_t h = header.h;
+    std::vector<uint16_t> pixels;
+    if (filePacked) {
+      pixels.resize(static_cast<size_t>(w) * h);
+      iconcodec::Decoder decoder(file.data(), file.size());
+      if (!iconcodec::validate(file.data(), file.size(), w, h) ||
+          !decoder.read(pixels.data(), pixels.size())) {
+        std::fprintf(stderr, "%s: malformed packed icon\n", path.c_str());
+        ++failures;
+        continue;
+      }
+    } else {
+      const size_t side = static_cast<size_t>(std::sqrt(static_cast<double>(file.size() / 2)));
+      if (side * side * 2 != file.size()) {
+        std::fprintf(stderr, "%s: not a square raw icon, skipped\n", path.c_str());
+        continue;
+      }
+      w = h = static_cast<uint16_t>(side);
+      pixels.resize(side * side);
+      for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = iconcodec::readLe16(file.data() + 2 * i);
+      }
+    }
+
+    const std::vector<uint8_t> packed = pack(pixels, w, h);
+    std::vector<uint8_t> raw;
+    for (uint16_t v : pixels) {
+      put16(raw, v);
+    }
+    // Packed files must be what the tools would write today, and decode back to the pixels.
+    bool match = !filePacked || packed == file;
+    match = match && iconcodec::validate(packed.data(), packed.size(), w, h);
+    if (!writeFile(rawPath, raw) || !writeFile(packedPath, packed)) {
+      std::perror("write");
+      return 1;
+    }
+    match = match && loadPacked(packedPath, w, h, scratch, blit);
+
+    const double rawUs = timeUs(opts.iterations, [&] { readFile(rawPath, scratch); });
+    const double packedUs =
+        timeUs(opts.iterations, [&] { loadPacked(packedPath, w, h, scratch, blit); });
+    const double flashRawUs = raw.size() * 1e6 / (opts.flashKBps * 1024.0);
+    const double flashPackedUs = packed.size() * 1e6 / (opts.flashKBps * 1024.0);
+
+    std::string name = path.substr(opts.root.size());
+    char size[16];
+    std::snprintf(size, sizeof(size), "%ux%u", static_cast<unsigned>(w),
+                  static_cast<unsigned>(h));
+    std::printf("%-44s %7s %6zu %6zu %6.3f %8.2f %8.2f %9.1f %9.1f %5s\n", name.c_str(), size,
+                raw.size(), packed.size(), static_cast<double>(packed.size()) / raw.size(),
+                rawUs, packedUs, flashRawUs, flashPackedUs, match ? "ok" : "FAIL");
+    if (!match) {
+      ++failures;
+    }
+    if (name.compare(0, 7, "/icons/") == 0) {
+      builtins.push_back(PackExpect{name, w, h, packed.size() < raw.size() ? packed : raw});
+    }
+    totalRaw += raw.size();
+    totalFile += file.size();
+    totalPacked += packed.size() < raw.size() ? packed.size() : raw.size();
+  }
+
+  std::printf("total: icons=%zu raw_bytes=%zu on_disk_bytes=%zu packed_bytes=%zu saved_pct=%.1f\n",
+              icons.size(), totalRaw, totalFile, totalPacked,
+              totalRaw > 0 ? 100.0 * (1.0 - static_cast<double>(totalPacked) / totalRaw) : 0.0);
+  if (!opts.pack.empty()) {
+    failures += checkPack(opts, builtins, packedPath);
+  }
+  std::remove(rawPath.c_str());
+  std::remove(packedPath.c_str());
+  rmdir(tmpDir);
+  return failures == 0 ? 0 : 1;
+}
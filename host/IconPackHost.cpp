@@ -0,0 +1,79 @@
+#include "platform/IconPack.h"
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+bool sTried = false;
+const uint8_t* sBlob = nullptr;
+void* sMapped = nullptr;
+size_t sMappedSize = 0;
+
+std::string& packFile() {
+  static std::string path = [] {
+    const char* env = std::getenv("COSTAR_HOST_ICON_PACK");
+    return std::string(env != nullptr ? env : "");
+  }();
+  return path;
+}
+
+void unmap() {
+  if (sMapped != nullptr) {
+    munmap(sMapped, sMappedSize);
+  }
+  sMapped = nullptr;
+  sMappedSize = 0;
+  sBlob = nullptr;
+}
+
+}  // namespace
+
+namespace platform::iconpack {
+
+void setHostPackFile(const char* path) {
+  unmap();
+  packFile() = path != nullptr ? path : "";
+  sTried = false;
+}
+
+// Maps the file read-only, like the partition on the device.
+bool begin() {
+  if (sTried) {
+    return sBlob != nullptr;
+  }
+  sTried = true;
+  if (packFile().empty()) {
+    return false;
+  }
+  const int fd = open(packFile().c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st = {};
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+  void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  sMapped = mapped;
+  sMappedSize = static_cast<size_t>(st.st_size);
+  if (format::validate(static_cast<const uint8_t*>(mapped), sMappedSize) == 0) {
+    unmap();
+    return false;
+  }
+  sBlob = static_cast<const uint8_t*>(mapped);
+  return true;
+}
+
+bool find(const char* path, Icon& out) { return begin() && format::find(sBlob, path, out); }
+
+}  // namespace platform::iconpack
@@ -0,0 +1,38 @@
+#include "platform/Net.h"
+
+#include <esp_crt_bundle.h>
+
+namespace platform::net {
+
+// HTTP is served from fixtures (HttpJsonClientHost.cpp) unless COSTAR_HOST_LIVE_HTTP is set,
+// and WebSockets only reach local servers, so the network always reports as connected.
+bool isConnected() { return true; }
+
+int rssi() { return -50; }
+
+bool getSsid(std::string& out) {
+  out = "host";
+  return true;
+}
+
+bool getLocalIp(std::string& out) {
+  out = "127.0.0.1";
+  return true;
+}
+
+bool resolveHostByName(const char* host, std::string& outIp) {
+  if (host == nullptr || *host == '\0') {
+    outIp.clear();
+    return false;
+  }
+  outIp = "127.0.0.1";
+  return true;
+}
+
+}  // namespace platform::net
+
+// Certificates are never checked: the host HTTP and WebSocket clients only speak plain TCP.
+esp_err_t arduino_esp_crt_bundle_attach(void* conf) {
+  (void)conf;
+  return ESP_OK;
+}
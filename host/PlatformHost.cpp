@@ -0,0 +1,104 @@
+#include "platform/Platform.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace platform {
+namespace {
+
+// The ESP32 build has ~320 KB of internal heap; report a fixed value so heap guards in the
+// runtime (TLS headroom checks, icon cache budgets) take their normal paths.
+constexpr uint32_t kHostHeapBytes = 320U * 1024U;
+
+bool quiet() {
+  static const bool value = std::getenv("COSTAR_HOST_QUIET") != nullptr;
+  return value;
+}
+
+void vlogLevel(const char* level, const char* tag, const char* fmt, va_list args) {
+  if (fmt == nullptr || quiet()) {
+    return;
+  }
+  va_list copy;
+  va_copy(copy, args);
+  const int n = std::vsnprintf(nullptr, 0, fmt, copy);
+  va_end(copy);
+  if (n <= 0) {
+    return;
+  }
+  std::string buffer(static_cast<size_t>(n) + 1U, '\0');
+  std::vsnprintf(&buffer[0], buffer.size(), fmt, args);
+  std::printf("%s (%lu) %s: %s\n", level != nullptr ? level : "I",
+              static_cast<unsigned long>(millisMs()), tag != nullptr ? tag : "app",
+              buffer.c_str());
+}
+
+}  // namespace
+
+void serialBegin(uint32_t baudRate) { (void)baudRate; }
+
+uint32_t millisMs() { return millis(); }
+
+void sleepMs(uint32_t ms) { delay(ms); }
+
+void log(const char* msg) {
+  if (msg == nullptr || quiet()) {
+    return;
+  }
+  std::printf("%s\n", msg);
+}
+
+void logf(const char* fmt, ...) {
+  if (fmt == nullptr || quiet()) {
+    return;
+  }
+  va_list args;
+  va_start(args, fmt);
+  std::vprintf(fmt, args);
+  va_end(args);
+}
+
+void logi(const char* tag, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vlogLevel("I", tag, fmt, args);
+  va_end(args);
+}
+
+void logw(const char* tag, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vlogLevel("W", tag, fmt, args);
+  va_end(args);
+}
+
+void loge(const char* tag, const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vlogLevel("E", tag, fmt, args);
+  va_end(args);
+}
+
+uint32_t freeHeapBytes() { return kHostHeapBytes; }
+
+uint32_t minFreeHeapBytes() { return kHostHeapBytes; }
+
+int wifiRssi() { return -50; }
+
+}  // namespace platform
+
+// esp32dev has no PSRAM: MALLOC_CAP_SPIRAM requests fail unless COSTAR_HOST_PSRAM is set.
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+  static const bool psram = std::getenv("COSTAR_HOST_PSRAM") != nullptr;
+  if ((caps & MALLOC_CAP_SPIRAM) != 0 && !psram) {
+    return nullptr;
+  }
+  return std::malloc(size);
+}
+
+void heap_caps_free(void* ptr) { std::free(ptr); }
@@ -0,0 +1,306 @@
+// Poll scheduler simulation: drives services/PollScheduler.h with a simulated clock and a set
+// of sources spread over a few hosts, injects a transport outage on one host and a 429 with
+// Retry-After on another, and compares the request pattern with fixed-interval polling (every
+// source on its own timer, retrying on the next tick). See host/README.md.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "AppConfig.h"
+#include "services/PollScheduler.h"
+
+namespace {
+
+struct Options {
+  uint32_t minutes = 30;
+  uint32_t stepMs = 15;
+  uint32_t latencyMs = 400;
+  uint32_t seed = 7;
+};
+
+struct SimSource {
+  const char* url;
+  uint32_t pollMs;
+};
+
+// Roughly the mix of a two-page layout: Home Assistant entities, weather, ADS-B, slow feeds.
+const SimSource kSources[] = {
+    {"http://homeassistant.local:8123/api/states/sensor.power", 5000},
+    {"http://homeassistant.local:8123/api/states/sensor.solar", 10000},
+    {"http://homeassistant.local:8123/api/states/sun.sun", 30000},
+    {"http://homeassistant.local:8123/api/states/weather.home", 30000},
+    {"http://homeassistant.local:8123/api/states/light.desk", 15000},
+    {"https://api.open-meteo.com/v1/forecast?current=temperature_2m", 60000},
+    {"https://api.open-meteo.com/v1/forecast?daily=weather_code", 60000},
+    {"https://api.open-meteo.com/v1/forecast?hourly=precipitation", 60000},
+    {"https://api.open-meteo.com/v1/air-quality?current=pm2_5", 60000},
+    {"https://api.airplanes.live/v2/point/37.4220/-122.0841/40", 15000},
+    {"https://api.coingecko.com/api/v3/simple/price?ids=bitcoin", 300000},
+    {"https://api.coingecko.com/api/v3/simple/price?ids=ethereum", 300000},
+};
+constexpr size_t kSourceCount = sizeof(kSources) / sizeof(kSources[0]);
+
+// Home Assistant drops off the network for two minutes; open-meteo throttles for one.
+constexpr uint32_t kOutageStartMs = 300000;
+constexpr uint32_t kOutageEndMs = 420000;
+constexpr char kOutageHost[] = "homeassistant.local";
+constexpr uint32_t kThrottleStartMs = 900000;
+constexpr uint32_t kThrottleEndMs = 960000;
+constexpr char kThrottleHost[] = "api.open-meteo.com";
+constexpr uint32_t kRetryAfterS = 90;
+
+struct Response {
+  int status = 200;
+  String retryAfter;
+};
+
+Response serve(const String& host, uint32_t atMs) {
+  Response r;
+  if (host == kOutageHost && atMs >= kOutageStartMs && atMs < kOutageEndMs) {
+    r.status = -1;
+  } else if (host == kThrottleHost && atMs >= kThrottleStartMs && atMs < kThrottleEndMs) {
+    r.status = 429;
+    r.retryAfter = String(kRetryAfterS);
+  }
+  return r;
+}
+
+struct Report {
+  uint32_t requests = 0;
+  uint32_t peak1s = 0;
+  uint32_t peak10s = 0;
+  uint32_t firstRoundMs = 0;      // until every source has sent its first request
+  uint32_t outageRequests = 0;    // sent to the failing host during its outage
+  uint32_t retryAfterViolations = 0;
+  uint32_t recoveryMs = 0;        // outage end to the last outage-host source being fresh
+  uint32_t maxGapMs = 0;          // longest wait beyond its interval on an unaffected host
+};
+
+class Recorder {
+ public:
+  explicit Recorder(Report& report) : report_(report) {
+    firstSent_.assign(kSourceCount, false);
+    recovered_.assign(kSourceCount, false);
+    lastOkMs_.assign(kSourceCount, 0);
+  }
+
+  void sent(size_t index, const String& host, uint32_t atMs) {
+    ++report_.requests;
+    window1s_.push_back(atMs);
+    window10s_.push_back(atMs);
+    while (atMs - window1s_.front() >= 1000) window1s_.pop_front();
+    while (atMs - window10s_.front() >= 10000) window10s_.pop_front();
+    report_.peak1s = std::max<uint32_t>(report_.peak1s, window1s_.size());
+    report_.peak10s = std::max<uint32_t>(report_.peak10s, window10s_.size());
+    if (!firstSent_[index]) {
+      firstSent_[index] = true;
+      if (std::count(firstSent_.begin(), firstSent_.end(), true) ==
+          static_cast<long>(kSourceCount)) {
+        report_.firstRoundMs = atMs;
+      }
+    }
+    if (host == kOutageHost && atMs >= kOutageStartMs && atMs < kOutageEndMs) {
+      ++report_.outageRequests;
+    }
+    if (host == kThrottleHost && atMs < throttledUntilMs_) {
+      ++report_.retryAfterViolations;
+    }
+  }
+
+  void answered(size_t index, const String& host, const Response& r, uint32_t atMs) {
+    if (r.status == 429) {
+      throttledUntilMs_ = std::max(throttledUntilMs_, atMs + kRetryAfterS * 1000U);
+    }
+    if (r.status != 200) {
+      return;
+    }
+    const uint32_t pollMs = kSources[index].pollMs;
+    const bool faulted = host == kOutageHost || host == kThrottleHost;
+    if (lastOkMs_[index] != 0 && !faulted && atMs - lastOkMs_[index] > pollMs) {
+      report_.maxGapMs = std::max(report_.maxGapMs, atMs - lastOkMs_[index] - pollMs);
+    }
+    lastOkMs_[index] = atMs;
+    if (host == kOutageHost && atMs >= kOutageEndMs && !recovered_[index]) {
+      recovered_[index] = true;
+      report_.recoveryMs = std::max(report_.recoveryMs, atMs - kOutageEndMs);
+    }
+  }
+
+ private:
+  Report& report_;
+  std::deque<uint32_t> window1s_;
+  std::deque<uint32_t> window10s_;
+  std::vector<bool> firstSent_;
+  std::vector<bool> recovered_;
+  std::vector<uint32_t> lastOkMs_;
+  uint32_t throttledUntilMs_ = 0;
+};
+
+struct Pending {
+  size_t index;
+  uint32_t doneMs;
+  Response response;
+};
+
+Report runFixed(const Options& opts) {
+  Report report;
+  Recorder rec(report);
+  std::vector<uint32_t> nextMs(kSourceCount, 0);
+  std::vector<bool> busy(kSourceCount, false);
+  std::vector<Pending> pending;
+  const uint32_t endMs = opts.minutes * 60000U;
+  for (uint32_t now = 0; now < endMs; now += opts.stepMs) {
+    for (size_t i = 0; i < pending.size();) {
+      if (pending[i].doneMs > now) {
+        ++i;
+        continue;
+      }
+      const size_t index = pending[i].index;
+      busy[index] = false;
+      rec.answered(index, PollScheduler::hostOf(kSources[index].url), pending[i].response, now);
+      pending.erase(pending.begin() + i);
+    }
+    for (size_t i = 0; i < kSourceCount; ++i) {
+      if (busy[i] || now < nextMs[i]) {
+        continue;
+      }
+      const String host = PollScheduler::hostOf(kSources[i].url);
+      rec.sent(i, host, now);
+      busy[i] = true;
+      nextMs[i] = now + kSources[i].pollMs;
+      pending.push_back({i, now + opts.latencyMs, serve(host, now)});
+    }
+  }
+  return report;
+}
+
+Report runScheduled(const Options& opts, PollScheduler::Stats& stats) {
+  Report report;
+  Recorder rec(report);
+  PollScheduler scheduler(opts.seed);
+  std::vector<PollScheduler::SourceId> ids;
+  for (const SimSource& source : kSources) {
+    ids.push_back(scheduler.add(source.url, source.pollMs));
+  }
+  std::vector<bool> started(kSourceCount, false);
+  std::vector<bool> busy(kSourceCount, false);
+  std::vector<Pending> pending;
+  const uint32_t endMs = opts.minutes * 60000U;
+  for (uint32_t now = 0; now < endMs; now += opts.stepMs) {
+    for (size_t i = 0; i < pending.size();) {
+      if (pending[i].doneMs > now) {
+        ++i;
+        continue;
+      }
+      const size_t index = pending[i].index;
+      const Response& r = pending[i].response;
+      busy[index] = false;
+      // As HttpJsonClient reports them.
+      if (r.status <= 0) {
+        scheduler.noteTransportFailure(now);
+      } else {
+        scheduler.noteTransportSuccess();
+      }
+      scheduler.complete(ids[index], now, r.status == 200, r.status, r.retryAfter);
+      rec.answered(index, PollScheduler::hostOf(kSources[index].url), r, now);
+      pending.erase(pending.begin() + i);
+    }
+    // Widgets update in layout order every loop, as DisplayManager runs them.
+    for (size_t i = 0; i < kSourceCount; ++i) {
+      if (busy[i] || !scheduler.acquire(ids[i], now, !started[i])) {
+        continue;
+      }
+      started[i] = true;
+      const String host = PollScheduler::hostOf(kSources[i].url);
+      rec.sent(i, host, now);
+      busy[i] = true;
+      pending.push_back({i, now + opts.latencyMs, serve(host, now)});
+    }
+  }
+  stats = scheduler.stats();
+  return report;
+}
+
+void print(const char* mode, const Report& r) {
+  std::printf(
+      "mode=%s requests=%u peak_1s=%u peak_10s=%u first_round_ms=%u outage_requests=%u "
+      "retry_after_violations=%u recovery_ms=%u max_gap_ms=%u\n",
+      mode, static_cast<unsigned>(r.requests), static_cast<unsigned>(r.peak1s),
+      static_cast<unsigned>(r.peak10s), static_cast<unsigned>(r.firstRoundMs),
+      static_cast<unsigned>(r.outageRequests),
+      static_cast<unsigned>(r.retryAfterViolations), static_cast<unsigned>(r.recoveryMs),
+      static_cast<unsigned>(r.maxGapMs));
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--verbose") == 0) {
+      continue;
+    }
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const uint32_t value = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+    if (std::strcmp(argv[i], "--minutes") == 0) {
+      opts.minutes = value;
+    } else if (std::strcmp(argv[i], "--step-ms") == 0) {
+      opts.stepMs = value;
+    } else if (std::strcmp(argv[i], "--latency-ms") == 0) {
+      opts.latencyMs = value;
+    } else if (std::strcmp(argv[i], "--seed") == 0) {
+      opts.seed = value;
+    } else {
+      return false;
+    }
+    ++i;
+  }
+  // The fault windows must fall inside the run.
+  return opts.stepMs > 0 && opts.minutes * 60000U >= kThrottleEndMs + 120000U;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts;
+  if (!parseArgs(argc, argv, opts)) {
+    std::fprintf(stderr,
+                 "usage: %s [--minutes N (>= 18)] [--step-ms MS] [--latency-ms MS] [--seed N] "
+                 "[--verbose]\n",
+                 argv[0]);
+    return 2;
+  }
+  bool verbose = false;
+  for (int i = 1; i < argc; ++i) {
+    verbose = verbose || std::strcmp(argv[i], "--verbose") == 0;
+  }
+  if (!verbose) {
+    // Silences the scheduler's "[poll] ..." lines.
+    setenv("COSTAR_HOST_QUIET", "1", 0);
+  }
+
+  const Report fixed = runFixed(opts);
+  PollScheduler::Stats stats;
+  const Report scheduled = runScheduled(opts, stats);
+  print("fixed", fixed);
+  print("scheduler", scheduled);
+
+  // Any window of n * interval holds at most burst + n requests.
+  const bool budgetOk = scheduled.peak1s <= AppConfig::kPollBudgetBurst &&
+                        scheduled.peak10s <= AppConfig::kPollBudgetBurst +
+                                                 10000U / AppConfig::kPollBudgetIntervalMs;
+  const bool backoffOk = scheduled.outageRequests < fixed.outageRequests &&
+                         scheduled.retryAfterViolations == 0;
+  const bool recoveryOk = scheduled.recoveryMs <= AppConfig::kPollBackoffMaxMs;
+  const bool ok = budgetOk && backoffOk && recoveryOk;
+  std::printf("granted=%u budget_delayed=%u max_budget_wait_ms=%u host_failures=%u "
+              "retry_afters=%u outages=%u result=%s\n",
+              static_cast<unsigned>(stats.granted), static_cast<unsigned>(stats.budgetDelayed),
+              static_cast<unsigned>(stats.maxBudgetWaitMs),
+              static_cast<unsigned>(stats.hostFailures), static_cast<unsigned>(stats.retryAfters),
+              static_cast<unsigned>(stats.outages), ok ? "ok" : "fail");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include "platform/Prefs.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace platform::prefs {
+namespace {
+
+// Process-local stand-in for NVS: values live until exit.
+std::mutex sMutex;
+std::map<std::string, std::string> sValues;
+
+std::string makeKey(const char* ns, const char* key) { return std::string(ns) + "/" + key; }
+
+bool lookup(const char* ns, const char* key, std::string& out) {
+  if (ns == nullptr || key == nullptr) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(sMutex);
+  auto it = sValues.find(makeKey(ns, key));
+  if (it == sValues.end()) {
+    return false;
+  }
+  out = it->second;
+  return true;
+}
+
+bool store(const char* ns, const char* key, const std::string& value) {
+  if (ns == nullptr || key == nullptr) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(sMutex);
+  sValues[makeKey(ns, key)] = value;
+  return true;
+}
+
+}  // namespace
+
+bool getBool(const char* ns, const char* key, bool defaultValue) {
+  std::string raw;
+  return lookup(ns, key, raw) ? raw == "1" : defaultValue;
+}
+
+uint32_t getUInt(const char* ns, const char* key, uint32_t defaultValue) {
+  std::string raw;
+  return lookup(ns, key, raw) ? static_cast<uint32_t>(std::stoul(raw)) : defaultValue;
+}
+
+int32_t getInt(const char* ns, const char* key, int32_t defaultValue) {
+  std::string raw;
+  return lookup(ns, key, raw) ? static_cast<int32_t>(std::stol(raw)) : defaultValue;
+}
+
+float getFloat(const char* ns, const char* key, float defaultValue) {
+  std::string raw;
+  return lookup(ns, key, raw) ? std::stof(raw) : defaultValue;
+}
+
+std::string getString(const char* ns, const char* key, const char* defaultValue) {
+  std::string raw;
+  if (lookup(ns, key, raw)) {
+    return raw;
+  }
+  return std::string(defaultValue != nullptr ? defaultValue : "");
+}
+
+bool putBool(const char* ns, const char* key, bool value) {
+  return store(ns, key, value ? "1" : "0");
+}
+
+bool putUInt(const char* ns, const char* key, uint32_t value) {
+  return store(ns, key, std::to_string(value));
+}
+
+bool putInt(const char* ns, const char* key, int32_t value) {
+  return store(ns, key, std::to_string(value));
+}
+
+bool putFloat(const char* ns, const char* key, float value) {
+  return store(ns, key, std::to_string(value));
+}
+
+bool putString(const char* ns, const char* key, const char* value) {
+  return store(ns, key, value != nullptr ? value : "");
+}
+
+}  // namespace platform::prefs
@@ -0,0 +1,216 @@
+// Rasterizer microbenchmark: draws the arc, moon-phase and thick-line shapes the DSL uses
+// with the previous per-pixel / stacked-line code and with the span fills in
+// widgets/DslSpanRaster.h (plain and 2x2 anti-aliased), straight to the host panel. Reports
+// time, bus transactions and pixels per node, a modelled SPI time and how many pixels differ
+// from the old output. See host/README.md.
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "widgets/DslSpanRaster.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int16_t kCanvas = 200;
+constexpr int32_t kCx = kCanvas / 2;
+constexpr int32_t kCy = kCanvas / 2;
+// CASET + PASET + RAMWR framing per transaction, and the panel's 40 MHz SPI clock.
+constexpr uint32_t kSetupBytes = 11;
+constexpr double kSpiMhz = 40.0;
+
+enum class Shape { kArc, kMoon, kLine };
+
+struct Case {
+  const char* name;
+  Shape shape;
+  int16_t radius;     // arc/moon radius, line length
+  int16_t thickness;  // arc ring width, line thickness, moon outline when > 0
+  float a;            // arc start, moon phase, line angle
+  float b;            // arc end
+  // The span fill is meant to reproduce the old pixels exactly.
+  bool expectIdentical;
+};
+
+const Case kCases[] = {
+    {"ring_r28_t2", Shape::kArc, 28, 2, 0.0f, 360.0f, false},
+    {"gauge_r60_t6_270", Shape::kArc, 60, 6, 0.0f, 270.0f, false},
+    {"gauge_r40_t3_240", Shape::kArc, 40, 3, -120.0f, 120.0f, false},
+    {"moon_r20_waxing", Shape::kMoon, 20, 0, 0.3f, 0.0f, true},
+    {"moon_r40_waning", Shape::kMoon, 40, 1, 0.8f, 0.0f, true},
+    {"hand_l60_t3", Shape::kLine, 60, 3, 37.0f, 0.0f, false},
+    {"hand_l80_t2", Shape::kLine, 80, 2, 122.0f, 0.0f, false},
+    {"hand_l50_t5", Shape::kLine, 50, 5, 250.0f, 0.0f, false},
+};
+
+constexpr uint16_t kColor = TFT_WHITE;
+constexpr uint16_t kBg = TFT_BLACK;
+
+// The drawing code DslWidget used before the span rasterizer.
+void drawLegacy(TFT_eSPI& tft, const Case& c) {
+  if (c.shape == Shape::kArc) {
+    const float span = fabsf(c.b - c.a);
+    const int thickness = c.thickness > 0 ? c.thickness : 1;
+    const float step = span > 120.0f ? 2.0f : 1.0f;
+    for (int t = 0; t < thickness; ++t) {
+      const int rr = c.radius - t;
+      for (float a = c.a; a <= c.b; a += step) {
+        const float rad = (a - 90.0f) * (3.14159265f / 180.0f);
+        tft.drawPixel(kCx + static_cast<int16_t>(cosf(rad) * rr),
+                      kCy + static_cast<int16_t>(sinf(rad) * rr), kColor);
+      }
+    }
+    return;
+  }
+  if (c.shape == Shape::kMoon) {
+    const int16_t r = c.radius;
+    tft.fillCircle(kCx, kCy, r, kBg);
+    const bool waxing = c.a <= 0.5f;
+    const float threshold = waxing ? r * (1.0f - 2.0f * c.a) : -r * (2.0f * c.a - 1.0f);
+    for (int16_t dy = -r; dy <= r; ++dy) {
+      for (int16_t dx = -r; dx <= r; ++dx) {
+        if (dx * dx + dy * dy > r * r) {
+          continue;
+        }
+        if (waxing ? (dx > threshold) : (dx < threshold)) {
+          tft.drawPixel(kCx + dx, kCy + dy, kColor);
+        }
+      }
+    }
+    if (c.thickness > 0) {
+      tft.drawCircle(kCx, kCy, r, kColor);
+    }
+    return;
+  }
+  const float radians = (c.a - 90.0f) * (3.14159265f / 180.0f);
+  const int32_t x2 = kCx + static_cast<int16_t>(cosf(radians) * c.radius);
+  const int32_t y2 = kCy + static_cast<int16_t>(sinf(radians) * c.radius);
+  const float dx = static_cast<float>(x2 - kCx);
+  const float dy = static_cast<float>(y2 - kCy);
+  const float len = sqrtf(dx * dx + dy * dy);
+  const float nx = -dy / len;
+  const float ny = dx / len;
+  for (int i = -(c.thickness / 2); i <= (c.thickness / 2); ++i) {
+    const int16_t ox = static_cast<int16_t>(nx * i);
+    const int16_t oy = static_cast<int16_t>(ny * i);
+    tft.drawLine(kCx + ox, kCy + oy, x2 + ox, y2 + oy, kColor);
+  }
+}
+
+// Mirrors the kArc / kMoonPhase / kLine branches of DslWidget::drawNode.
+void drawSpans(TFT_eSPI& tft, const Case& c, bool antialias) {
+  if (c.shape == Shape::kArc) {
+    spanraster::fillShape(tft, kCx, kCy, spanraster::RingSector(c.radius, c.thickness, c.a, c.b),
+                          kColor, antialias, kBg);
+    return;
+  }
+  if (c.shape == Shape::kMoon) {
+    const int16_t r = c.radius;
+    tft.fillCircle(kCx, kCy, r, kBg);
+    const bool waxing = c.a <= 0.5f;
+    const float threshold = waxing ? r * (1.0f - 2.0f * c.a) : -r * (2.0f * c.a - 1.0f);
+    spanraster::fillShape(tft, kCx, kCy, spanraster::LitDisc(r, threshold, waxing), kColor,
+                          antialias, kBg);
+    if (c.thickness > 0) {
+      tft.drawCircle(kCx, kCy, r, kColor);
+    }
+    return;
+  }
+  const float radians = (c.a - 90.0f) * (3.14159265f / 180.0f);
+  const int32_t x2 = kCx + static_cast<int16_t>(cosf(radians) * c.radius);
+  const int32_t y2 = kCy + static_cast<int16_t>(sinf(radians) * c.radius);
+  const float width = static_cast<float>(2 * (c.thickness / 2) + 1);
+  spanraster::fillShape(tft, kCx, kCy,
+                        spanraster::WideLine(static_cast<float>(x2 - kCx),
+                                             static_cast<float>(y2 - kCy), width),
+                        kColor, antialias, kBg);
+}
+
+struct Result {
+  double usPerNode = 0.0;
+  double transactions = 0.0;
+  double pixels = 0.0;
+  std::vector<uint16_t> frame;
+};
+
+template <typename Draw>
+Result run(TFT_eSPI& tft, uint32_t iterations, Draw draw) {
+  Result out;
+  tft.fillScreen(kBg);
+  tft.resetStats();
+  draw();
+  out.transactions = tft.stats().busTransactions;
+  out.pixels = static_cast<double>(tft.stats().pixelsWritten);
+  out.frame.assign(tft.framebuffer(), tft.framebuffer() + kCanvas * kCanvas);
+
+  const Clock::time_point start = Clock::now();
+  for (uint32_t i = 0; i < iterations; ++i) {
+    draw();
+  }
+  const double us =
+      std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+  out.usPerNode = us / iterations;
+  return out;
+}
+
+uint32_t diffPixels(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b) {
+  uint32_t n = 0;
+  for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+    n += a[i] != b[i] ? 1 : 0;
+  }
+  return n;
+}
+
+double busUs(const Result& r) {
+  return (r.transactions * kSetupBytes + r.pixels * 2.0) * 8.0 / kSpiMhz;
+}
+
+void print(const char* name, const char* mode, const Result& r, uint32_t diff) {
+  std::printf("%-18s %-7s %9.2f %7.0f %7.0f %9.1f %8u\n", name, mode, r.usPerNode,
+              r.transactions, r.pixels, busUs(r), static_cast<unsigned>(diff));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  uint32_t iterations = 2000;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else {
+      std::fprintf(stderr, "usage: %s [--iterations N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (iterations == 0) {
+    iterations = 1;
+  }
+
+  TFT_eSPI tft(kCanvas, kCanvas);
+  int failures = 0;
+  std::printf("%-18s %-7s %9s %7s %7s %9s %8s\n", "case", "mode", "us/node", "bus_tx",
+              "pixels", "spi_us", "diff_px");
+  for (const Case& c : kCases) {
+    const Result legacy = run(tft, iterations, [&] { drawLegacy(tft, c); });
+    const Result spans = run(tft, iterations, [&] { drawSpans(tft, c, false); });
+    const Result aa = run(tft, iterations, [&] { drawSpans(tft, c, true); });
+    const uint32_t spanDiff = diffPixels(legacy.frame, spans.frame);
+    print(c.name, "legacy", legacy, 0);
+    print(c.name, "spans", spans, spanDiff);
+    print(c.name, "aa", aa, diffPixels(legacy.frame, aa.frame));
+    if ((c.expectIdentical && spanDiff != 0) || spans.pixels == 0 || aa.pixels == 0) {
+      std::fprintf(stderr, "%s: unexpected span output (diff_px=%u)\n", c.name,
+                   static_cast<unsigned>(spanDiff));
+      ++failures;
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,560 @@
+// Render-path benchmark: loads every DSL under <root>/dsl_available and every widget region of
+// <root>/screen_layout_*.json, feeds canned payloads from host/fixtures and times
+// applyFieldsFromDoc, template binding and render per frame. Writes one CSV row per widget.
+// See host/README.md.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <TFT_eSPI.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <malloc.h>
+#include <string>
+#include <vector>
+
+#include "HostHeap.h"
+#include "RuntimeGeo.h"
+#include "platform/Fs.h"
+#include "widgets/DslRuntimeCaches.h"
+#include "widgets/DslWidget.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::string root = "data";
+  std::string fixtures = "host/fixtures";
+  std::string csvPath;
+  std::string commit;
+  std::string runId = "bench-01";
+  uint32_t frames = 50;
+  bool verbose = false;
+  bool noFilter = false;
+  bool fullRepaint = false;
+  // Modals repaint the whole widget as they open and close (setDslSaveUnderBudget(0)).
+  bool noSaveUnder = false;
+  // Forces use_sprite with this many sprite rows (0 = widget's own choice); -1 keeps layouts.
+  int32_t spriteRows = -1;
+};
+
+// Tracks the heap a JsonDocument holds itself (its pools and copied strings), apart from
+// whatever else the parse allocates and frees along the way.
+class CountingJsonAllocator : public ArduinoJson::Allocator {
+ public:
+  void* allocate(size_t size) override {
+    void* ptr = std::malloc(size);
+    if (ptr != nullptr) {
+      liveBytes_ += malloc_usable_size(ptr);
+    }
+    return ptr;
+  }
+  void deallocate(void* ptr) override {
+    if (ptr != nullptr) {
+      liveBytes_ -= malloc_usable_size(ptr);
+    }
+    std::free(ptr);
+  }
+  void* reallocate(void* ptr, size_t newSize) override {
+    const size_t before = ptr != nullptr ? malloc_usable_size(ptr) : 0;
+    void* out = std::realloc(ptr, newSize);
+    if (out != nullptr) {
+      liveBytes_ += malloc_usable_size(out) - before;
+    }
+    return out;
+  }
+  size_t liveBytes() const { return liveBytes_; }
+
+ private:
+  size_t liveBytes_ = 0;
+};
+
+struct BenchCase {
+  String layout;
+  String dslPath;
+  WidgetConfig cfg;
+  String notes;
+};
+
+struct BenchRow {
+  String layout;
+  String widget;
+  String dslPath;
+  String source;
+  int16_t w = 0;
+  int16_t h = 0;
+  uint32_t frames = 0;
+  double loadUs = 0.0;
+  double applyUsAvg = 0.0;
+  double bindUsAvg = 0.0;
+  double renderUsAvg = 0.0;
+  double renderUsMax = 0.0;
+  double allocsPerFrame = 0.0;
+  double allocBytesPerFrame = 0.0;
+  size_t heapRetainedBytes = 0;
+  size_t heapPeakFrameBytes = 0;
+  size_t payloadDocBytes = 0;
+  double pixelsPerFrame = 0.0;
+  double busTxPerFrame = 0.0;
+  uint32_t fbHash = 0;
+  size_t spriteBytes = 0;
+  uint32_t partialFrames = 0;
+  double pushedPxRatio = 0.0;
+  // Whether a forced full repaint of the final state reproduces the framebuffer.
+  bool repaintMatches = true;
+  // Label bitmap cache hits over all label draws, and cache size after the last frame.
+  double labelHitRate = 0.0;
+  size_t labelCacheBytes = 0;
+  // Icon cache lookups served from memory, and icons evicted to stay in budget.
+  double iconHitRate = 0.0;
+  uint32_t iconEvictions = 0;
+  // Widgets with modals: opening and dismissing the first one over the final state, averaged
+  // over kModalRounds, and whether dismissing restored the framebuffer ("-" without modals).
+  double modalOpenUs = 0.0;
+  double modalCloseUs = 0.0;
+  double modalClosePx = 0.0;
+  double modalCloseTx = 0.0;
+  String modalCheck = "-";
+  String notes;
+};
+
+constexpr uint32_t kModalRounds = 5;
+
+double elapsedUs(Clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+String basename(const String& path) {
+  const int slash = path.lastIndexOf('/');
+  return slash >= 0 ? path.substring(static_cast<unsigned int>(slash + 1)) : path;
+}
+
+String stem(const String& path) {
+  String name = basename(path);
+  const int dot = name.lastIndexOf('.');
+  return dot > 0 ? name.substring(0, static_cast<unsigned int>(dot)) : name;
+}
+
+std::vector<String> listJson(const std::string& dir, const char* prefix) {
+  std::vector<String> out;
+  DIR* d = opendir(dir.c_str());
+  if (d == nullptr) {
+    return out;
+  }
+  while (dirent* entry = readdir(d)) {
+    const String name(entry->d_name);
+    if (name.endsWith(".json") && (prefix == nullptr || name.startsWith(prefix))) {
+      out.push_back(name);
+    }
+  }
+  closedir(d);
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+bool loadJsonFile(const std::string& path, JsonDocument& doc,
+                  const JsonDocument* filter = nullptr) {
+  std::FILE* f = std::fopen(path.c_str(), "rb");
+  if (f == nullptr) {
+    return false;
+  }
+  std::string body;
+  char buf[1024];
+  size_t n = 0;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+    body.append(buf, n);
+  }
+  std::fclose(f);
+  if (filter != nullptr) {
+    return !deserializeJson(doc, body.c_str(), DeserializationOption::Filter(*filter));
+  }
+  return !deserializeJson(doc, body.c_str());
+}
+
+String csvQuote(const String& value) {
+  String out = "\"";
+  for (unsigned int i = 0; i < value.length(); ++i) {
+    const char c = value[i];
+    if (c == '"') {
+      out += "\"\"";
+    } else {
+      out += c;
+    }
+  }
+  out += "\"";
+  return out;
+}
+
+std::vector<BenchCase> collectCases(const Options& opts) {
+  std::vector<BenchCase> cases;
+
+  for (const String& name : listJson(opts.root + "/dsl_available", nullptr)) {
+    BenchCase c;
+    c.layout = "-";
+    c.dslPath = "/dsl_available/" + name;
+    c.cfg.id = stem(name);
+    c.cfg.type = "dsl";
+    c.cfg.x = 0;
+    c.cfg.y = 0;
+    c.cfg.w = 320;
+    c.cfg.h = 240;
+    c.cfg.drawBorder = false;
+    c.cfg.settings["dsl_path"] = c.dslPath;
+    cases.push_back(c);
+  }
+
+  for (const String& name : listJson(opts.root, "screen_layout_")) {
+    JsonDocument doc;
+    if (!loadJsonFile(opts.root + "/" + name.c_str(), doc)) {
+      continue;
+    }
+    const JsonObjectConst defs = doc["widget_defs"];
+    for (JsonObjectConst region : doc["screen"]["regions"].as<JsonArrayConst>()) {
+      const String ref = region["widget"] | String();
+      const JsonObjectConst def = defs[ref];
+      if (def.isNull() || String(def["type"] | "") != "dsl") {
+        continue;
+      }
+      BenchCase c;
+      c.layout = name;
+      c.cfg.type = "dsl";
+      c.cfg.id = region["id"] | ref;
+      c.cfg.x = region["x"] | 0;
+      c.cfg.y = region["y"] | 0;
+      c.cfg.w = region["w"] | 120;
+      c.cfg.h = region["h"] | 80;
+      c.cfg.drawBorder = region["draw_border"] | (def["draw_border"] | true);
+      for (JsonPairConst item : def["settings"].as<JsonObjectConst>()) {
+        c.cfg.settings[String(item.key().c_str())] = item.value().as<String>();
+      }
+      c.dslPath = c.cfg.settings["dsl_path"];
+      // Layouts may point at provisioned paths (/dsl/...) that only exist on-device.
+      if (!platform::fs::exists(c.dslPath)) {
+        const String fallback = "/dsl_available/" + basename(c.dslPath);
+        if (platform::fs::exists(fallback)) {
+          c.notes = "dsl_path remapped from " + c.dslPath;
+          c.dslPath = fallback;
+          c.cfg.settings["dsl_path"] = fallback;
+        }
+      }
+      cases.push_back(c);
+    }
+  }
+  if (opts.spriteRows >= 0) {
+    for (BenchCase& c : cases) {
+      c.cfg.settings["use_sprite"] = "true";
+      c.cfg.settings["sprite_rows"] = String(static_cast<long>(opts.spriteRows));
+    }
+  }
+  return cases;
+}
+
+}  // namespace
+
+class DslWidgetBench {
+ public:
+  static BenchRow run(const BenchCase& bench, const Options& opts) {
+    BenchRow row;
+    row.layout = bench.layout;
+    row.widget = bench.cfg.id;
+    row.dslPath = bench.dslPath;
+    row.w = bench.cfg.w;
+    row.h = bench.cfg.h;
+    row.frames = opts.frames;
+    row.notes = bench.notes;
+
+    clearDslRuntimeCaches();
+    TFT_eSPI tft;
+    tft.setRotation(1);
+
+    const hostheap::Snapshot beforeLoad = hostheap::snapshot();
+    const Clock::time_point loadStart = Clock::now();
+    DslWidget widget(bench.cfg);
+    widget.begin();
+    row.loadUs = elapsedUs(loadStart);
+    if (!widget.dslLoaded_) {
+      row.source = "?";
+      row.notes = row.notes.isEmpty() ? String("dsl load failed") : row.notes + "; dsl load failed";
+      return row;
+    }
+    row.source = widget.dsl_.source;
+
+    JsonDocument payload;
+    const String fixturePath =
+        String(opts.fixtures.c_str()) + "/" + stem(bench.dslPath) + ".json";
+    const bool liveSource = widget.dsl_.source == "local_time";
+    if (!liveSource) {
+      // Same filter the widget hands to HttpJsonClient::get.
+      const JsonDocument* filter =
+          (widget.hasFetchFilter_ && !opts.noFilter) ? &widget.fetchFilter_ : nullptr;
+      CountingJsonAllocator rawAllocator;
+      JsonDocument raw(&rawAllocator);
+      if (!loadJsonFile(fixturePath.c_str(), raw, filter)) {
+        row.notes = row.notes.isEmpty() ? String("no fixture") : row.notes + "; no fixture";
+      } else if (widget.dsl_.source == "adsb_nearest") {
+        row.payloadDocBytes = rawAllocator.liveBytes();
+        String error;
+        widget.buildAdsbNearestDoc(raw, payload, error);
+      } else {
+        row.payloadDocBytes = rawAllocator.liveBytes();
+        payload = raw;
+      }
+    }
+
+    double applyUs = 0.0;
+    double bindUs = 0.0;
+    double renderUs = 0.0;
+    uint64_t allocCount = 0;
+    uint64_t allocBytes = 0;
+    uint64_t pixels = 0;
+    uint64_t busTx = 0;
+    const DslLabelCacheStats labelsBefore = dslLabelCacheStats();
+    const DslIconCacheStats iconsBefore = dslIconCacheStats();
+    for (uint32_t frame = 0; frame < opts.frames; ++frame) {
+      if (liveSource) {
+        payload.clear();
+        String error;
+        widget.buildLocalTimeDoc(payload, error);
+      }
+      hostheap::resetPeak();
+      const hostheap::Snapshot frameStart = hostheap::snapshot();
+      tft.resetStats();
+
+      Clock::time_point t = Clock::now();
+      bool changed = false;
+      widget.applyFieldsFromDoc(payload, changed);
+      applyUs += elapsedUs(t);
+
+      t = Clock::now();
+      for (const dsl::Node& node : widget.dsl_.nodes) {
+        if (!node.text.isEmpty()) {
+          widget.bindPlan(node.textPlan, node.text, true, widget.bindScratch_);
+        }
+        if (!node.path.isEmpty()) {
+          widget.bindPlan(node.pathPlan, node.path, true, widget.bindScratch_);
+        }
+      }
+      bindUs += elapsedUs(t);
+
+      t = Clock::now();
+      if (opts.fullRepaint) {
+        widget.invalidatePanel();
+      }
+      widget.render(tft);
+      const double frameRenderUs = elapsedUs(t);
+      renderUs += frameRenderUs;
+      row.renderUsMax = std::max(row.renderUsMax, frameRenderUs);
+
+      const hostheap::Snapshot frameEnd = hostheap::snapshot();
+      allocCount += frameEnd.allocCount - frameStart.allocCount;
+      allocBytes += frameEnd.allocBytes - frameStart.allocBytes;
+      row.heapPeakFrameBytes = std::max(row.heapPeakFrameBytes, frameEnd.peakLiveBytes);
+      pixels += tft.stats().pixelsWritten;
+      busTx += tft.stats().busTransactions;
+    }
+
+    const DslLabelCacheStats labelsAfter = dslLabelCacheStats();
+    const uint32_t labelHits = labelsAfter.hits - labelsBefore.hits;
+    const uint32_t labelDraws = labelHits + labelsAfter.misses - labelsBefore.misses;
+    if (labelDraws > 0) {
+      row.labelHitRate = static_cast<double>(labelHits) / static_cast<double>(labelDraws);
+    }
+    row.labelCacheBytes = labelsAfter.bytes;
+    const DslIconCacheStats iconsAfter = dslIconCacheStats();
+    const uint32_t iconHits = iconsAfter.hits - iconsBefore.hits;
+    const uint32_t iconLookups = iconHits + iconsAfter.misses - iconsBefore.misses;
+    if (iconLookups > 0) {
+      row.iconHitRate = static_cast<double>(iconHits) / static_cast<double>(iconLookups);
+    }
+    row.iconEvictions = iconsAfter.evictions - iconsBefore.evictions;
+
+    const double n = opts.frames > 0 ? static_cast<double>(opts.frames) : 1.0;
+    row.applyUsAvg = applyUs / n;
+    row.bindUsAvg = bindUs / n;
+    row.renderUsAvg = renderUs / n;
+    row.allocsPerFrame = static_cast<double>(allocCount) / n;
+    row.allocBytesPerFrame = static_cast<double>(allocBytes) / n;
+    row.pixelsPerFrame = static_cast<double>(pixels) / n;
+    row.busTxPerFrame = static_cast<double>(busTx) / n;
+    const size_t baseline = beforeLoad.liveBytes;
+    const size_t retained = hostheap::snapshot().liveBytes;
+    row.heapRetainedBytes = retained > baseline ? retained - baseline : 0;
+    row.heapPeakFrameBytes =
+        row.heapPeakFrameBytes > baseline ? row.heapPeakFrameBytes - baseline : 0;
+    row.fbHash = tft.framebufferHash();
+    if (widget.spriteReady_) {
+      row.spriteBytes = static_cast<size_t>(widget.config_.w) * widget.spriteRows_ * 2;
+    }
+    row.partialFrames = widget.paintStats_.partialFrames;
+    if (widget.paintStats_.pixelsFullRepaint > 0) {
+      row.pushedPxRatio = static_cast<double>(widget.paintStats_.pixelsPushed) /
+                          static_cast<double>(widget.paintStats_.pixelsFullRepaint);
+    }
+    widget.invalidatePanel();
+    widget.render(tft);
+    row.repaintMatches = tft.framebufferHash() == row.fbHash;
+
+    if (!widget.dsl_.modals.empty()) {
+      const uint32_t underHash = tft.framebufferHash();
+      double openUs = 0.0;
+      double closeUs = 0.0;
+      uint64_t closePx = 0;
+      uint64_t closeTx = 0;
+      bool restored = true;
+      for (uint32_t round = 0; round < kModalRounds; ++round) {
+        widget.activeModalId_ = widget.dsl_.modals.front().id;
+        widget.modalVisible_ = true;
+        Clock::time_point t = Clock::now();
+        widget.render(tft);
+        openUs += elapsedUs(t);
+
+        widget.modalVisible_ = false;
+        widget.activeModalId_ = "";
+        tft.resetStats();
+        t = Clock::now();
+        widget.render(tft);
+        closeUs += elapsedUs(t);
+        closePx += tft.stats().pixelsWritten;
+        closeTx += tft.stats().busTransactions;
+        restored = restored && tft.framebufferHash() == underHash;
+      }
+      row.modalOpenUs = openUs / kModalRounds;
+      row.modalCloseUs = closeUs / kModalRounds;
+      row.modalClosePx = static_cast<double>(closePx) / kModalRounds;
+      row.modalCloseTx = static_cast<double>(closeTx) / kModalRounds;
+      row.modalCheck = restored ? "ok" : "mismatch";
+    }
+    return row;
+  }
+};
+
+namespace {
+
+void printUsage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--root DIR] [--fixtures DIR] [--frames N] [--csv FILE]\n"
+               "          [--commit SHA] [--run-id ID] [--no-filter] [--full-repaint]\n"
+               "          [--sprite-rows N] [--no-save-under] [--verbose]\n",
+               argv0);
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (std::strcmp(arg, "--verbose") == 0) {
+      opts.verbose = true;
+      continue;
+    }
+    if (std::strcmp(arg, "--no-filter") == 0) {
+      opts.noFilter = true;
+      continue;
+    }
+    if (std::strcmp(arg, "--full-repaint") == 0) {
+      opts.fullRepaint = true;
+      continue;
+    }
+    if (std::strcmp(arg, "--no-save-under") == 0) {
+      opts.noSaveUnder = true;
+      continue;
+    }
+    if (value == nullptr) {
+      return false;
+    }
+    if (std::strcmp(arg, "--root") == 0) {
+      opts.root = value;
+    } else if (std::strcmp(arg, "--fixtures") == 0) {
+      opts.fixtures = value;
+    } else if (std::strcmp(arg, "--frames") == 0) {
+      opts.frames = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (std::strcmp(arg, "--csv") == 0) {
+      opts.csvPath = value;
+    } else if (std::strcmp(arg, "--commit") == 0) {
+      opts.commit = value;
+    } else if (std::strcmp(arg, "--run-id") == 0) {
+      opts.runId = value;
+    } else if (std::strcmp(arg, "--sprite-rows") == 0) {
+      opts.spriteRows = static_cast<int32_t>(std::strtol(value, nullptr, 10));
+    } else {
+      return false;
+    }
+    ++i;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts;
+  if (!parseArgs(argc, argv, opts)) {
+    printUsage(argv[0]);
+    return 2;
+  }
+  if (!opts.verbose) {
+    setenv("COSTAR_HOST_QUIET", "1", 0);
+  }
+
+  platform::fs::setHostRoot(opts.root.c_str());
+  if (!platform::fs::begin(false)) {
+    std::fprintf(stderr, "data root '%s' not found\n", opts.root.c_str());
+    return 1;
+  }
+  RuntimeGeo::setLocation(37.7749f, -122.4194f, "PST8PDT,M3.2.0,M11.1.0", -480, true,
+                          "San Francisco");
+
+  setDslFieldCacheEnabled(false);
+  if (opts.noSaveUnder) {
+    setDslSaveUnderBudget(0);
+  }
+
+  std::FILE* out = stdout;
+  if (!opts.csvPath.empty()) {
+    out = std::fopen(opts.csvPath.c_str(), "w");
+    if (out == nullptr) {
+      std::fprintf(stderr, "cannot write '%s'\n", opts.csvPath.c_str());
+      return 1;
+    }
+  }
+
+  char date[16];
+  const std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%d", std::localtime(&now));
+
+  std::fprintf(out,
+               "date,firmware_commit,run_id,layout,widget,dsl_path,source,w,h,frames,load_us,"
+               "apply_us_avg,bind_us_avg,render_us_avg,render_us_max,allocs_per_frame,"
+               "alloc_bytes_per_frame,heap_retained_bytes,heap_peak_frame_bytes,"
+               "payload_doc_bytes,pixels_per_frame,bus_tx_per_frame,fb_hash,partial_frames,"
+               "pushed_px_ratio,repaint_check,sprite_bytes,label_hit_rate,label_cache_bytes,"
+               "icon_hit_rate,icon_evictions,modal_open_us,modal_close_us,modal_close_px,"
+               "modal_close_tx,modal_check,notes\n");
+  for (const BenchCase& bench : collectCases(opts)) {
+    const BenchRow row = DslWidgetBench::run(bench, opts);
+    std::fprintf(out,
+                 "%s,%s,%s,%s,%s,%s,%s,%d,%d,%lu,%.1f,%.2f,%.2f,%.2f,%.2f,%.1f,%.0f,%zu,%zu,%zu,"
+                 "%.0f,%.1f,%08lx,%lu,%.3f,%s,%zu,%.3f,%zu,%.3f,%lu,%.2f,%.2f,%.0f,%.1f,%s,%s\n",
+                 date, opts.commit.c_str(), opts.runId.c_str(), row.layout.c_str(),
+                 row.widget.c_str(), row.dslPath.c_str(), row.source.c_str(), row.w, row.h,
+                 static_cast<unsigned long>(row.frames), row.loadUs, row.applyUsAvg,
+                 row.bindUsAvg, row.renderUsAvg, row.renderUsMax, row.allocsPerFrame,
+                 row.allocBytesPerFrame, row.heapRetainedBytes, row.heapPeakFrameBytes,
+                 row.payloadDocBytes, row.pixelsPerFrame, row.busTxPerFrame, static_cast<unsigned long>(row.fbHash),
+                 static_cast<unsigned long>(row.partialFrames), row.pushedPxRatio,
+                 row.repaintMatches ? "ok" : "mismatch", row.spriteBytes, row.labelHitRate,
+                 row.labelCacheBytes, row.iconHitRate,
+                 static_cast<unsigned long>(row.iconEvictions), row.modalOpenUs, row.modalCloseUs,
+                 row.modalClosePx, row.modalCloseTx, row.modalCheck.c_str(), csvQuote(row.notes).c_str());
+  }
+
+  if (out != stdout) {
+    std::fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,195 @@
+#include "SpiMasterHost.h"
+
+#include <driver/gpio.h>
+#include <driver/spi_master.h>
+#include <esp_heap_caps.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+
+struct HostSpiDevice {
+  uint32_t clockHz = 1;
+  size_t queueSize = 1;
+};
+
+namespace {
+
+struct Transfer {
+  spi_transaction_t* trans = nullptr;
+  int dc = 1;
+  uint64_t endNs = 0;
+  bool captured = false;
+};
+
+HostSpiDevice sDevice;
+// Queued transfers not yet collected through spi_device_get_trans_result, oldest first.
+std::deque<Transfer> sQueued;
+uint64_t sNowNs = 0;
+uint64_t sBusFreeNs = 0;
+int sDcPin = -1;
+int sDcLevel = 1;
+spimock::Stats sStats;
+std::vector<spimock::WireChunk> sWire;
+
+uint64_t transferNs(const spi_transaction_t& trans) {
+  return static_cast<uint64_t>(trans.length) * 1000000000ULL / sDevice.clockHz;
+}
+
+void capture(int dc, const spi_transaction_t& trans) {
+  const size_t bytes = (trans.length + 7U) / 8U;
+  const uint8_t* data = static_cast<const uint8_t*>(trans.tx_buffer);
+  if (sWire.empty() || sWire.back().dc != dc) {
+    sWire.emplace_back();
+    sWire.back().dc = dc;
+  }
+  if (data != nullptr) {
+    sWire.back().bytes.insert(sWire.back().bytes.end(), data, data + bytes);
+  }
+}
+
+// Captures queued transfers that have finished by now.
+void advanceBus() {
+  for (Transfer& t : sQueued) {
+    if (t.endNs > sNowNs) {
+      break;
+    }
+    if (!t.captured) {
+      capture(t.dc, *t.trans);
+      t.captured = true;
+    }
+  }
+}
+
+// Blocks the CPU until the bus reaches `ns`.
+void waitUntil(uint64_t ns) {
+  if (ns > sNowNs) {
+    sStats.blockedNs += ns - sNowNs;
+    sNowNs = ns;
+  }
+  advanceBus();
+}
+
+uint64_t scheduleTransfer(const spi_transaction_t& trans) {
+  const uint64_t duration = transferNs(trans);
+  const uint64_t start = std::max(sNowNs, sBusFreeNs);
+  sBusFreeNs = start + duration;
+  sStats.busNs += duration;
+  return sBusFreeNs;
+}
+
+}  // namespace
+
+namespace spimock {
+
+void setDcPin(int pin) { sDcPin = pin; }
+
+void cpuWork(uint64_t ns) {
+  sNowNs += ns;
+  sStats.cpuWorkNs += ns;
+  advanceBus();
+}
+
+uint64_t nowNs() { return sNowNs; }
+
+const Stats& stats() { return sStats; }
+
+const std::vector<WireChunk>& wire() { return sWire; }
+
+void resetStats() {
+  sStats = Stats{};
+  sWire.clear();
+}
+
+}  // namespace spimock
+
+esp_err_t gpio_config(const gpio_config_t* config) {
+  return config != nullptr ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) {
+  if (pin != sDcPin) {
+    return ESP_OK;
+  }
+  advanceBus();
+  const int dc = level != 0 ? 1 : 0;
+  for (const Transfer& t : sQueued) {
+    if (!t.captured && t.dc != dc) {
+      ++sStats.dcHazards;
+      break;
+    }
+  }
+  sDcLevel = dc;
+  return ESP_OK;
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* config,
+                             int dmaChan) {
+  (void)host;
+  (void)dmaChan;
+  return config != nullptr ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* config,
+                             spi_device_handle_t* outHandle) {
+  (void)host;
+  if (config == nullptr || outHandle == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  sDevice.clockHz = config->clock_speed_hz > 0 ? static_cast<uint32_t>(config->clock_speed_hz) : 1U;
+  sDevice.queueSize = config->queue_size > 0 ? static_cast<size_t>(config->queue_size) : 1U;
+  *outHandle = &sDevice;
+  return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t* trans,
+                                 TickType_t ticksToWait) {
+  (void)ticksToWait;
+  if (handle == nullptr || trans == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (sQueued.size() >= sDevice.queueSize) {
+    ++sStats.violations;
+    return ESP_ERR_TIMEOUT;
+  }
+  Transfer t;
+  t.trans = trans;
+  t.dc = sDcLevel;
+  t.endNs = scheduleTransfer(*trans);
+  sQueued.push_back(t);
+  ++sStats.queued;
+  const size_t inFlight = static_cast<size_t>(std::count_if(
+      sQueued.begin(), sQueued.end(), [](const Transfer& q) { return !q.captured; }));
+  sStats.maxInFlight = std::max<uint32_t>(sStats.maxInFlight, static_cast<uint32_t>(inFlight));
+  return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t** outTrans,
+                                      TickType_t ticksToWait) {
+  (void)ticksToWait;
+  if (handle == nullptr || outTrans == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (sQueued.empty()) {
+    ++sStats.violations;
+    return ESP_ERR_TIMEOUT;
+  }
+  waitUntil(sQueued.front().endNs);
+  *outTrans = sQueued.front().trans;
+  sQueued.pop_front();
+  return ESP_OK;
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t* trans) {
+  if (handle == nullptr || trans == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!sQueued.empty()) {
+    ++sStats.violations;
+    return ESP_ERR_INVALID_STATE;
+  }
+  waitUntil(scheduleTransfer(*trans));
+  capture(sDcLevel, *trans);
+  ++sStats.polled;
+  return ESP_OK;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// Simulated SPI bus behind host/stubs/driver/spi_master.h. Time is virtual: transfers take
+// bits / clock_speed_hz on the bus, and CPU time only advances through cpuWork() or when the
+// caller blocks on the bus (polling transmits, spi_device_get_trans_result). Queued transfers
+// run back to back in FIFO order; their bytes are captured when they complete, so a driver that
+// rewrites a buffer still on the wire shows up as corrupted output.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spimock {
+
+struct WireChunk {
+  int dc = 1;
+  std::vector<uint8_t> bytes;
+};
+
+struct Stats {
+  uint64_t busNs = 0;       // time the bus spent transferring
+  uint64_t cpuWorkNs = 0;   // time charged through cpuWork()
+  uint64_t blockedNs = 0;   // time the CPU waited on the bus
+  uint32_t queued = 0;
+  uint32_t polled = 0;
+  uint32_t maxInFlight = 0;
+  // Protocol violations: DC changed under an active transfer, polling with transfers queued,
+  // queue overflow, or results fetched with nothing queued.
+  uint32_t dcHazards = 0;
+  uint32_t violations = 0;
+};
+
+// Pin whose level is sampled as the panel's data/command line for each transfer.
+void setDcPin(int pin);
+// Charges CPU work and lets the bus make progress meanwhile.
+void cpuWork(uint64_t ns);
+uint64_t nowNs();
+const Stats& stats();
+const std::vector<WireChunk>& wire();
+// Clears statistics and captured bytes; pending transfers must have been collected.
+void resetStats();
+
+}  // namespace spimock
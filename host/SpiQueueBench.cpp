@@ -0,0 +1,190 @@
+// SPI queue bench: drives the ESP-IDF panel driver (idf/main/DisplaySpiEspIdf.cpp) against the
+// simulated bus in SpiMasterHost.cpp. Frames are pushed band by band with a modelled
+// rasterization cost per band; the captured command/pixel stream is decoded back into a
+// framebuffer and compared with what was drawn, and the report shows how much bus time
+// overlapped CPU work. See host/README.md.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "AppConfig.h"
+#include "DisplaySpiEspIdf.h"
+#include "SpiMasterHost.h"
+
+namespace {
+
+struct Options {
+  uint32_t frames = 4;
+  uint32_t bandRows = 16;
+  uint32_t rasterUs = 600;
+};
+
+// Replays ILI9341 CASET/PASET/RAMWR sequences from the captured wire into fb.
+void decodeWire(uint16_t w, uint16_t h, std::vector<uint16_t>& fb) {
+  uint8_t cmd = 0;
+  uint8_t args[4] = {};
+  size_t argCount = 0;
+  uint16_t xs = 0, xe = 0, ys = 0, ye = 0;
+  uint32_t cx = 0, cy = 0;
+  int pixelHalf = -1;
+  for (const spimock::WireChunk& chunk : spimock::wire()) {
+    for (uint8_t b : chunk.bytes) {
+      if (chunk.dc == 0) {
+        cmd = b;
+        argCount = 0;
+        pixelHalf = -1;
+        cx = xs;
+        cy = ys;
+        continue;
+      }
+      if (cmd == 0x2A || cmd == 0x2B) {
+        if (argCount < sizeof(args)) {
+          args[argCount++] = b;
+        }
+        if (argCount == sizeof(args)) {
+          const uint16_t lo = static_cast<uint16_t>((args[0] << 8) | args[1]);
+          const uint16_t hi = static_cast<uint16_t>((args[2] << 8) | args[3]);
+          if (cmd == 0x2A) {
+            xs = lo;
+            xe = hi;
+          } else {
+            ys = lo;
+            ye = hi;
+          }
+        }
+        continue;
+      }
+      if (cmd != 0x2C) {
+        continue;
+      }
+      if (pixelHalf < 0) {
+        pixelHalf = b;
+        continue;
+      }
+      const uint16_t color = static_cast<uint16_t>((pixelHalf << 8) | b);
+      pixelHalf = -1;
+      if (cx < w && cy < h && cy <= ye) {
+        fb[static_cast<size_t>(cy) * w + cx] = color;
+      }
+      if (++cx > xe) {
+        cx = xs;
+        ++cy;
+      }
+    }
+  }
+}
+
+uint16_t patternColor(uint32_t x, uint32_t y, uint32_t frame) {
+  return static_cast<uint16_t>(((x + frame * 7U) * 31U) ^ ((y + frame) * 2053U));
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+  for (int i = 1; i < argc; ++i) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const uint32_t value = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+    if (std::strcmp(argv[i], "--frames") == 0) {
+      opts.frames = value;
+    } else if (std::strcmp(argv[i], "--band-rows") == 0) {
+      opts.bandRows = value;
+    } else if (std::strcmp(argv[i], "--raster-us") == 0) {
+      opts.rasterUs = value;
+    } else {
+      return false;
+    }
+    ++i;
+  }
+  return opts.bandRows > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts;
+  if (!parseArgs(argc, argv, opts)) {
+    std::fprintf(stderr, "usage: %s [--frames N] [--band-rows N] [--raster-us US]\n", argv[0]);
+    return 2;
+  }
+
+  spimock::setDcPin(AppConfig::kTftDcPin);
+  if (!display_spi::initPanel() || !display_spi::waitIdle()) {
+    std::fprintf(stderr, "panel init failed\n");
+    return 1;
+  }
+  spimock::resetStats();
+  const uint64_t startNs = spimock::nowNs();
+
+  const uint16_t w = display_spi::width();
+  const uint16_t h = display_spi::height();
+  std::vector<uint16_t> expected(static_cast<size_t>(w) * h, 0);
+  std::vector<uint16_t> band(static_cast<size_t>(w) * opts.bandRows);
+  bool ok = display_spi::clear(0x0000) && display_spi::fillRect(10, 10, 50, 30, 0xF800);
+  for (uint32_t y = 10; y < 40; ++y) {
+    for (uint32_t x = 10; x < 60; ++x) {
+      expected[y * w + x] = 0xF800;
+    }
+  }
+
+  uint32_t bands = 0;
+  for (uint32_t frame = 0; ok && frame < opts.frames; ++frame) {
+    for (uint32_t top = 0; ok && top < h; top += opts.bandRows) {
+      const uint32_t rows = std::min<uint32_t>(opts.bandRows, h - top);
+      for (uint32_t y = 0; y < rows; ++y) {
+        for (uint32_t x = 0; x < w; ++x) {
+          const uint16_t c = patternColor(x, top + y, frame);
+          band[y * w + x] = c;
+          expected[(top + y) * w + x] = c;
+        }
+      }
+      spimock::cpuWork(static_cast<uint64_t>(opts.rasterUs) * 1000U);
+      ok = display_spi::pushImage(0, static_cast<uint16_t>(top), w, static_cast<uint16_t>(rows),
+                                  band.data());
+      ++bands;
+    }
+  }
+
+  // Clipped at the right edge: only the on-panel columns of each row go out.
+  const uint16_t tileW = 40;
+  const uint16_t tileH = 12;
+  std::vector<uint16_t> tile(static_cast<size_t>(tileW) * tileH);
+  for (uint32_t i = 0; i < tile.size(); ++i) {
+    tile[i] = static_cast<uint16_t>(0x1234U + i * 17U);
+  }
+  const uint16_t tileX = static_cast<uint16_t>(w - tileW / 2);
+  ok = ok && display_spi::pushImage(tileX, 100, tileW, tileH, tile.data());
+  for (uint32_t y = 0; y < tileH; ++y) {
+    for (uint32_t x = 0; tileX + x < w; ++x) {
+      expected[(100 + y) * w + tileX + x] = tile[y * tileW + x];
+    }
+  }
+  ok = ok && display_spi::waitIdle();
+
+  std::vector<uint16_t> actual(expected.size(), 0);
+  decodeWire(w, h, actual);
+  const bool orderOk = ok && actual == expected;
+
+  const spimock::Stats& stats = spimock::stats();
+  const double busUs = static_cast<double>(stats.busNs) / 1000.0;
+  const double cpuUs = static_cast<double>(stats.cpuWorkNs) / 1000.0;
+  const double wallUs = static_cast<double>(spimock::nowNs() - startNs) / 1000.0;
+  const double serialUs = busUs + cpuUs;
+  const double overlapBase = std::min(busUs, cpuUs);
+  const double overlapPct = overlapBase > 0.0 ? 100.0 * (serialUs - wallUs) / overlapBase : 0.0;
+  size_t bytes = 0;
+  for (const spimock::WireChunk& chunk : spimock::wire()) {
+    bytes += chunk.bytes.size();
+  }
+  std::printf(
+      "frames=%u bands=%u bytes=%zu bus_us=%.0f cpu_us=%.0f wall_us=%.0f serial_us=%.0f "
+      "overlap_pct=%.1f queued=%u polled=%u max_in_flight=%u dc_hazards=%u violations=%u "
+      "order=%s\n",
+      static_cast<unsigned>(opts.frames), static_cast<unsigned>(bands), bytes, busUs, cpuUs,
+      wallUs, serialUs, overlapPct, static_cast<unsigned>(stats.queued),
+      static_cast<unsigned>(stats.polled), static_cast<unsigned>(stats.maxInFlight),
+      static_cast<unsigned>(stats.dcHazards), static_cast<unsigned>(stats.violations),
+      orderOk ? "ok" : "mismatch");
+  return (orderOk && stats.dcHazards == 0 && stats.violations == 0) ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+// Server-Sent Events check: runs the stock service_status_stream widget (source "sse") against
+// a local event-stream server (SseMockServer.cpp) and checks that widgets on one URL share one
+// stream, apply events split anywhere across reads, skip other event types and oversized or
+// malformed events, resume with Last-Event-ID after a drop, stop on a rejected response, and
+// never poll over HTTP. See host/README.md.
+
+#include <Arduino.h>
+
+#include <cstdio>
+#include <string>
+
+#include "HostFixtures.h"
+#include "SseMockServer.h"
+#include "services/SseStream.h"
+#include "widgets/DslWidget.h"
+
+namespace {
+
+using hostfx::check;
+using hostfx::widgetStatus;
+using hostfx::widgetValue;
+
+constexpr uint32_t kRetryMs = 300;
+
+std::string statusJson(const char* state, int latencyMs) {
+  return std::string(R"({"service":"api","state":")") + state + R"(","latency_ms":)" +
+         std::to_string(latencyMs) + R"(,"detail":"all checks passing"})";
+}
+
+DslWidget& addStream(hostfx::WidgetHarness& h, const char* id, const String& url) {
+  WidgetConfig cfg = hostfx::dslWidgetConfig(id, "service_status_stream.json", 160, 100);
+  cfg.settings["status_stream_url"] = url;
+  return h.add(cfg);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (const int rc = hostfx::beginCheck(argc, argv)) {
+    return rc;
+  }
+
+  SseMockServer server;
+  if (!server.start()) {
+    std::fprintf(stderr, "mock SSE server failed to start\n");
+    return 1;
+  }
+  server.setRetryMs(kRetryMs);
+  server.publish("/status", "status", statusJson("up", 41));
+  const String base = "http://127.0.0.1:" + String(static_cast<unsigned>(server.port()));
+
+  hostfx::WidgetHarness h;
+  DslWidget& a = addStream(h, "status-a", base + "/status");
+  DslWidget& b = addStream(h, "status-b", base + "/status");
+
+  const long initialMs = h.runUntil([&] {
+    return widgetStatus(a) == "ok" && widgetStatus(b) == "ok" && widgetValue(b, "state") == "up";
+  });
+  SseMockServer::Stats stats = server.stats();
+  check(initialMs >= 0, "newest event applied on connect");
+  check(stats.streams == 1 && stats.connections == 1, "one stream for two widgets");
+  check(stats.lastAccept == "text/event-stream", "requests Accept: text/event-stream");
+  check(widgetValue(a, "service") == "api" && widgetValue(a, "latency") == "41 ms",
+        "fields and formats through the DSL paths");
+
+  server.publish("/status", "status", statusJson("degraded", 350));
+  const long eventMs = h.runUntil([&] {
+    return widgetValue(a, "state") == "degraded" && widgetValue(b, "state") == "degraded";
+  });
+  check(eventMs >= 0 && eventMs < 500, "event reaches both widgets within 500 ms");
+
+  // CRLF line ends, data split over two data: lines, sent a few bytes at a time.
+  server.setSplitBytes(7);
+  server.publish("/status", "status",
+                 "{\"service\":\"api\",\"state\":\"up\",\n\"latency_ms\":12,\"detail\":\"ok\"}",
+                 "\r\n");
+  check(h.runUntil([&] { return widgetValue(a, "latency") == "12 ms"; }) >= 0,
+        "split CRLF event with multi-line data");
+  server.setSplitBytes(0);
+
+  server.publish("/status", "heartbeat", R"({"state":"ignored"})");
+  server.publishRaw("/status", ": keep-alive\n\n");
+  server.publish("/status", "status", statusJson("up", 13));
+  check(h.runUntil([&] { return widgetValue(a, "latency") == "13 ms"; }) >= 0 &&
+            widgetValue(a, "state") == "up",
+        "other event types and comments skipped");
+
+  server.publish("/status", "status", "{\"state\":");
+  check(h.runUntil([&] { return widgetStatus(a) == "data err"; }) >= 0 &&
+            widgetValue(a, "latency") == "13 ms",
+        "malformed event keeps fields, shows data err");
+  server.publish("/status", "status", "{\"state\":\"" + std::string(9000, 'x') + "\"}");
+  server.publish("/status", "status", statusJson("up", 14));
+  const long nextMs = h.runUntil(
+      [&] { return widgetStatus(a) == "ok" && widgetValue(a, "latency") == "14 ms"; });
+  check(nextMs >= 0 && sse::stats().dropped == 1, "oversized event dropped, next event applied");
+
+  // Held at 503 while the gap is published, so the reconnect cannot beat it.
+  server.setStatus("/status", 503);
+  server.dropClients();
+  check(h.runUntil([&] { return widgetStatus(a) == "net err"; }) >= 0, "drop shows as net err");
+  server.publish("/status", "status", statusJson("down", 0));
+  const std::string lastId = server.publish("/status", "status", statusJson("recovering", 90));
+  server.setStatus("/status", 0);
+  const long resumeMs = h.runUntil([&] {
+    return widgetStatus(a) == "ok" && widgetValue(a, "state") == "recovering" &&
+           widgetValue(b, "state") == "recovering";
+  });
+  stats = server.stats();
+  check(resumeMs >= 0 && stats.streams == 2, "reconnects after the server's retry");
+  check(stats.lastEventIds.size() == 2 && !stats.lastEventIds.back().empty() &&
+            std::stoul(stats.lastEventIds.back()) + 2 == std::stoul(lastId) &&
+            stats.replayed == 2,
+        "resumes with Last-Event-ID and replays the gap");
+
+  server.setStatus("/gone", 404);
+  server.setStatus("/busy", 503);
+  DslWidget& gone = addStream(h, "gone", base + "/gone");
+  DslWidget& busy = addStream(h, "busy", base + "/busy");
+  check(h.runUntil([&] { return widgetStatus(gone) == "http err"; }) >= 0,
+        "rejected stream shows as http err");
+  // Longer than the default reconnect delay: 404 is final, 503 is retried.
+  h.runUntil([] { return false; }, 4500);
+  stats = server.stats();
+  check(stats.requests["/gone"] == 1, "rejected stream is not retried");
+  check(stats.requests["/busy"] >= 2 && widgetStatus(busy) == "net err", "503 is retried");
+  // Seconds without an event: empty read slices must not count as a lost stream.
+  check(widgetStatus(a) == "ok" && stats.streams == 2, "quiet stream stays open");
+
+  const uint32_t requests = hostfx::requestCount();
+  check(requests == 0, "no HTTP polling");
+
+  const sse::Stats sseStats = sse::stats();
+  h.clear();
+  check(h.runUntil([&] { return server.activeClients() == 0; }) >= 0,
+        "stream closed with its last widget");
+  server.stop();
+
+  stats = server.stats();
+  std::printf("initial_ms=%ld event_ms=%ld resume_ms=%ld connections=%u streams=%u "
+              "replayed=%u sse_connects=%u sse_resumes=%u sse_events=%u sse_dropped=%u "
+              "http_requests=%u result=%s\n",
+              initialMs, eventMs, resumeMs, static_cast<unsigned>(stats.connections),
+              static_cast<unsigned>(stats.streams), static_cast<unsigned>(stats.replayed),
+              static_cast<unsigned>(sseStats.connects), static_cast<unsigned>(sseStats.resumes),
+              static_cast<unsigned>(sseStats.events), static_cast<unsigned>(sseStats.dropped),
+              static_cast<unsigned>(requests), hostfx::checkFailures() == 0 ? "ok" : "fail");
+  return hostfx::checkFailures() == 0 ? 0 : 1;
+}
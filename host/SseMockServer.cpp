@@ -0,0 +1,267 @@
+#include "SseMockServer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "HostWebSocket.h"
+
+namespace {
+constexpr int kSplitPauseMs = 2;
+}  // namespace
+
+struct SseMockServer::Client {
+  int fd = -1;
+  std::string path;
+  // Past the response head and backlog, so publish() may write to it.
+  bool streaming = false;
+  std::mutex sendMutex;
+};
+
+SseMockServer::SseMockServer() = default;
+
+SseMockServer::~SseMockServer() { stop(); }
+
+bool SseMockServer::start() {
+  listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (listenFd_ < 0) {
+    return false;
+  }
+  const int one = 1;
+  setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      ::listen(listenFd_, 8) != 0 ||
+      ::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    ::close(listenFd_);
+    listenFd_ = -1;
+    return false;
+  }
+  port_ = ntohs(addr.sin_port);
+  acceptThread_ = std::thread(&SseMockServer::acceptLoop, this);
+  return true;
+}
+
+void SseMockServer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || listenFd_ < 0) {
+      return;
+    }
+    stopping_ = true;
+  }
+  ::shutdown(listenFd_, SHUT_RDWR);
+  if (acceptThread_.joinable()) {
+    acceptThread_.join();
+  }
+  ::close(listenFd_);
+  dropClients();
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads.swap(clientThreads_);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void SseMockServer::setStatus(const std::string& path, int status) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  statuses_[path] = status;
+}
+
+void SseMockServer::setRetryMs(uint32_t ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  retryMs_ = ms;
+}
+
+void SseMockServer::setSplitBytes(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  splitBytes_ = bytes;
+}
+
+void SseMockServer::acceptLoop() {
+  for (;;) {
+    const int fd = ::accept(listenFd_, nullptr, nullptr);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd < 0 || stopping_) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+      return;
+    }
+    auto client = std::make_shared<Client>();
+    client->fd = fd;
+    clients_.push_back(client);
+    ++stats_.connections;
+    clientThreads_.emplace_back(&SseMockServer::serveClient, this, client);
+  }
+}
+
+void SseMockServer::serveClient(const std::shared_ptr<Client>& client) {
+  std::string head;
+  if (hostws::readHttpHead(client->fd, head) && head.compare(0, 4, "GET ") == 0) {
+    const size_t pathEnd = head.find(' ', 4);
+    const std::string path = head.substr(4, pathEnd == std::string::npos ? 0 : pathEnd - 4);
+    const std::string lastId = hostws::headerValue(head, "Last-Event-ID");
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++stats_.requests[path];
+    stats_.lastAccept = hostws::headerValue(head, "Accept");
+    auto status = statuses_.find(path);
+    if (status != statuses_.end() && status->second != 0) {
+      const std::string response = "HTTP/1.1 " + std::to_string(status->second) +
+                                   " Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+      hostws::writeAll(client->fd, response.data(), response.size());
+      ::shutdown(client->fd, SHUT_WR);
+    } else {
+      ++stats_.streams;
+      stats_.lastEventIds.push_back(lastId);
+      std::string backlog = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                            "Cache-Control: no-cache\r\nTransfer-Encoding: chunked\r\n\r\n";
+      std::string events;
+      if (retryMs_ != 0) {
+        events += "retry: " + std::to_string(retryMs_) + "\n\n";
+      }
+      const std::vector<Event>& log = logs_[path];
+      auto from = log.end();
+      if (!lastId.empty()) {
+        from = std::find_if(log.begin(), log.end(),
+                            [&](const Event& event) { return event.id == lastId; });
+        if (from != log.end()) {
+          ++from;
+          stats_.replayed += static_cast<uint32_t>(log.end() - from);
+        }
+      }
+      if (from == log.end() && lastId.empty() && !log.empty()) {
+        from = log.end() - 1;
+      }
+      for (auto it = from; it != log.end(); ++it) {
+        events += it->text;
+      }
+      if (!events.empty()) {
+        // A zero-size chunk would end the response.
+        char size[16];
+        std::snprintf(size, sizeof(size), "%zx\r\n", events.size());
+        backlog += size + events + "\r\n";
+      }
+      client->path = path;
+      client->streaming = true;
+      // Held until the backlog is out, so events published meanwhile queue up behind it.
+      std::lock_guard<std::mutex> send(client->sendMutex);
+      lock.unlock();
+      hostws::writeAll(client->fd, backlog.data(), backlog.size());
+    }
+  }
+
+  // Streams stay open until the client or dropClients() closes them.
+  char buf[256];
+  while (::recv(client->fd, buf, sizeof(buf), 0) > 0) {
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  clients_.erase(std::remove(clients_.begin(), clients_.end(), client), clients_.end());
+  std::lock_guard<std::mutex> send(client->sendMutex);
+  if (client->fd >= 0) {
+    ::close(client->fd);
+    client->fd = -1;
+  }
+}
+
+bool SseMockServer::sendChunked(Client& client, const std::string& text) {
+  size_t split;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    split = splitBytes_ == 0 ? text.size() : splitBytes_;
+  }
+  std::lock_guard<std::mutex> send(client.sendMutex);
+  for (size_t pos = 0; pos < text.size(); pos += split) {
+    const std::string piece = text.substr(pos, split);
+    char size[16];
+    std::snprintf(size, sizeof(size), "%zx\r\n", piece.size());
+    const std::string chunk = size + piece + "\r\n";
+    if (client.fd < 0 || !hostws::writeAll(client.fd, chunk.data(), chunk.size())) {
+      return false;
+    }
+    if (pos + split < text.size()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(kSplitPauseMs));
+    }
+  }
+  return true;
+}
+
+std::string SseMockServer::publish(const std::string& path, const std::string& event,
+                                   const std::string& data, const std::string& eol) {
+  Event entry;
+  std::vector<std::shared_ptr<Client>> targets;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry.id = std::to_string(nextId_++);
+    if (!event.empty()) {
+      entry.text += "event: " + event + eol;
+    }
+    size_t start = 0;
+    for (;;) {
+      const size_t end = data.find('\n', start);
+      entry.text += "data: " + data.substr(start, end - start) + eol;
+      if (end == std::string::npos) {
+        break;
+      }
+      start = end + 1;
+    }
+    entry.text += "id: " + entry.id + eol + eol;
+    logs_[path].push_back(entry);
+    for (const auto& client : clients_) {
+      if (client->streaming && client->path == path) {
+        targets.push_back(client);
+      }
+    }
+  }
+  for (const auto& client : targets) {
+    sendChunked(*client, entry.text);
+  }
+  return entry.id;
+}
+
+void SseMockServer::publishRaw(const std::string& path, const std::string& text) {
+  std::vector<std::shared_ptr<Client>> targets;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& client : clients_) {
+      if (client->streaming && client->path == path) {
+        targets.push_back(client);
+      }
+    }
+  }
+  for (const auto& client : targets) {
+    sendChunked(*client, text);
+  }
+}
+
+void SseMockServer::dropClients() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& client : clients_) {
+    if (client->fd >= 0) {
+      ::shutdown(client->fd, SHUT_RDWR);
+    }
+  }
+}
+
+size_t SseMockServer::activeClients() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return clients_.size();
+}
+
+SseMockServer::Stats SseMockServer::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
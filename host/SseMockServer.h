@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Server-Sent Events endpoint for host checks of services/SseStream, on 127.0.0.1. Every path
+// is its own stream with an event log: a new request gets the newest event, one carrying
+// Last-Event-ID gets every event after that id, and publish() sends to the open streams of
+// its path. Responses are chunked, like most SSE servers behind HTTP/1.1.
+class SseMockServer {
+ public:
+  struct Stats {
+    uint32_t connections = 0;
+    uint32_t streams = 0;   // requests answered with an event stream
+    uint32_t replayed = 0;  // events resent after a Last-Event-ID
+    // Requests per path, and the Last-Event-ID of each stream request ("" when absent).
+    std::map<std::string, uint32_t> requests;
+    std::vector<std::string> lastEventIds;
+    std::string lastAccept;
+  };
+
+  SseMockServer();
+  ~SseMockServer();
+
+  // Listens on an ephemeral port.
+  bool start();
+  void stop();
+  uint16_t port() const { return port_; }
+
+  // Requests for `path` get `status` (0 = stream again) and no body.
+  void setStatus(const std::string& path, int status);
+  // Sent as `retry:` at the start of every stream (0 = none).
+  void setRetryMs(uint32_t ms);
+  // Events go out in sends of at most this many bytes, a few ms apart (0 = one send).
+  void setSplitBytes(size_t bytes);
+
+  // Logs an event with the next id and sends it to the open streams of `path`. Lines of
+  // `data` become data: lines; every line ends with `eol`. Returns the id.
+  std::string publish(const std::string& path, const std::string& event, const std::string& data,
+                      const std::string& eol = "\n");
+  // Sends `text` as is to the open streams of `path`, without logging it.
+  void publishRaw(const std::string& path, const std::string& text);
+  // Cuts every stream off, like a server restart.
+  void dropClients();
+
+  size_t activeClients() const;
+  Stats stats() const;
+
+ private:
+  struct Event {
+    std::string id;
+    std::string text;
+  };
+  struct Client;
+
+  void acceptLoop();
+  void serveClient(const std::shared_ptr<Client>& client);
+  bool sendChunked(Client& client, const std::string& text);
+
+  int listenFd_ = -1;
+  uint16_t port_ = 0;
+  std::thread acceptThread_;
+  mutable std::mutex mutex_;
+  bool stopping_ = false;
+  std::map<std::string, std::vector<Event>> logs_;
+  std::map<std::string, int> statuses_;
+  std::vector<std::shared_ptr<Client>> clients_;
+  std::vector<std::thread> clientThreads_;
+  uint32_t retryMs_ = 0;
+  size_t splitBytes_ = 0;
+  uint32_t nextId_ = 1;
+  Stats stats_;
+};
@@ -0,0 +1,474 @@
+#include <TFT_eSPI.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+struct GlyphMetrics {
+  int16_t advance;
+  int16_t height;
+};
+
+// Approximate cell sizes of the TFT_eSPI built-in fonts.
+GlyphMetrics metricsForFont(uint8_t font) {
+  switch (font) {
+    case 2:
+      return {7, 16};
+    case 4:
+      return {14, 26};
+    case 6:
+      return {26, 48};
+    case 7:
+      return {32, 48};
+    case 8:
+      return {55, 75};
+    case 1:
+    default:
+      return {6, 8};
+  }
+}
+
+}  // namespace
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h) { resize(w, h); }
+
+void TFT_eSPI::resize(int16_t w, int16_t h) {
+  width_ = w < 0 ? 0 : w;
+  height_ = h < 0 ? 0 : h;
+  fb_.assign(static_cast<size_t>(width_) * static_cast<size_t>(height_), TFT_BLACK);
+  resetViewport();
+}
+
+void TFT_eSPI::setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum) {
+  (void)vpDatum;
+  clipX0_ = std::max<int32_t>(0, x);
+  clipY0_ = std::max<int32_t>(0, y);
+  clipX1_ = std::min<int32_t>(width_, x + std::max<int32_t>(0, w));
+  clipY1_ = std::min<int32_t>(height_, y + std::max<int32_t>(0, h));
+  clipX1_ = std::max(clipX0_, clipX1_);
+  clipY1_ = std::max(clipY0_, clipY1_);
+}
+
+void TFT_eSPI::resetViewport() {
+  clipX0_ = 0;
+  clipY0_ = 0;
+  clipX1_ = width_;
+  clipY1_ = height_;
+}
+
+void TFT_eSPI::setRotation(uint8_t r) {
+  const uint8_t next = r & 3U;
+  if ((next & 1U) != (rotation_ & 1U)) {
+    resize(height_, width_);
+  }
+  rotation_ = next;
+}
+
+void TFT_eSPI::notePanelWrite(uint64_t pixels, uint32_t transactions) {
+  stats_.pixelsWritten += pixels;
+  stats_.busTransactions += transactions;
+}
+
+void TFT_eSPI::writeSpan(int32_t x, int32_t y, int32_t w, uint16_t color) {
+  if (y < clipY0_ || y >= clipY1_ || w <= 0) {
+    return;
+  }
+  int32_t x0 = std::max<int32_t>(clipX0_, x);
+  int32_t x1 = std::min<int32_t>(clipX1_, x + w);
+  if (x1 <= x0) {
+    return;
+  }
+  std::fill(fb_.begin() + static_cast<size_t>(y) * width_ + x0,
+            fb_.begin() + static_cast<size_t>(y) * width_ + x1, color);
+}
+
+void TFT_eSPI::fillRectRaw(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+  for (int32_t row = 0; row < h; ++row) {
+    writeSpan(x, y + row, w, color);
+  }
+}
+
+void TFT_eSPI::fillScreen(uint32_t color) { fillRect(0, 0, width_, height_, color); }
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (!inClip(x, y)) {
+    return;
+  }
+  fb_[static_cast<size_t>(y) * width_ + x] = static_cast<uint16_t>(color);
+  notePanelWrite(1);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+  const int32_t dx = std::abs(x1 - x0);
+  const int32_t dy = -std::abs(y1 - y0);
+  const int32_t sx = x0 < x1 ? 1 : -1;
+  const int32_t sy = y0 < y1 ? 1 : -1;
+  int32_t err = dx + dy;
+  uint64_t pixels = 0;
+  // TFT_eSPI opens one address window per straight run along the major axis.
+  const bool steep = -dy > dx;
+  uint32_t runs = 0;
+  int32_t runMinor = 0;
+  while (true) {
+    if (inClip(x0, y0)) {
+      fb_[static_cast<size_t>(y0) * width_ + x0] = static_cast<uint16_t>(color);
+      const int32_t minor = steep ? x0 : y0;
+      if (pixels == 0 || minor != runMinor) {
+        ++runs;
+        runMinor = minor;
+      }
+      ++pixels;
+    }
+    if (x0 == x1 && y0 == y1) {
+      break;
+    }
+    const int32_t e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+  notePanelWrite(pixels, runs);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (w <= 0 || h <= 0) {
+    return;
+  }
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (w <= 0 || h <= 0) {
+    return;
+  }
+  const int32_t x0 = std::max<int32_t>(clipX0_, x);
+  const int32_t y0 = std::max<int32_t>(clipY0_, y);
+  const int32_t x1 = std::min<int32_t>(clipX1_, x + w);
+  const int32_t y1 = std::min<int32_t>(clipY1_, y + h);
+  if (x1 <= x0 || y1 <= y0) {
+    return;
+  }
+  fillRectRaw(x0, y0, x1 - x0, y1 - y0, static_cast<uint16_t>(color));
+  notePanelWrite(static_cast<uint64_t>(x1 - x0) * static_cast<uint64_t>(y1 - y0));
+}
+
+void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  if (r < 0) {
+    return;
+  }
+  int32_t x = r;
+  int32_t y = 0;
+  int32_t err = 1 - r;
+  uint64_t pixels = 0;
+  auto plot = [&](int32_t px, int32_t py) {
+    if (inClip(px, py)) {
+      fb_[static_cast<size_t>(py) * width_ + px] = static_cast<uint16_t>(color);
+      ++pixels;
+    }
+  };
+  while (x >= y) {
+    plot(x0 + x, y0 + y);
+    plot(x0 + y, y0 + x);
+    plot(x0 - y, y0 + x);
+    plot(x0 - x, y0 + y);
+    plot(x0 - x, y0 - y);
+    plot(x0 - y, y0 - x);
+    plot(x0 + y, y0 - x);
+    plot(x0 + x, y0 - y);
+    ++y;
+    if (err < 0) {
+      err += 2 * y + 1;
+    } else {
+      --x;
+      err += 2 * (y - x) + 1;
+    }
+  }
+  notePanelWrite(pixels);
+}
+
+void TFT_eSPI::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  if (r < 0) {
+    return;
+  }
+  uint64_t pixels = 0;
+  uint32_t rows = 0;
+  for (int32_t dy = -r; dy <= r; ++dy) {
+    int32_t half = 0;
+    while ((half + 1) * (half + 1) + dy * dy <= r * r) {
+      ++half;
+    }
+    const int32_t y = y0 + dy;
+    if (y < clipY0_ || y >= clipY1_) {
+      continue;
+    }
+    const int32_t xa = std::max<int32_t>(clipX0_, x0 - half);
+    const int32_t xb = std::min<int32_t>(clipX1_ - 1, x0 + half);
+    if (xb >= xa) {
+      writeSpan(xa, y, xb - xa + 1, static_cast<uint16_t>(color));
+      pixels += static_cast<uint64_t>(xb - xa + 1);
+      ++rows;
+    }
+  }
+  notePanelWrite(pixels, rows);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  pushImageImpl(x, y, w, h, data, false, 0);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data,
+                         uint16_t transp) {
+  pushImageImpl(x, y, w, h, data, true, transp);
+}
+
+void TFT_eSPI::pushImageImpl(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data,
+                             bool useTransp, uint16_t transp) {
+  if (data == nullptr || w <= 0 || h <= 0) {
+    return;
+  }
+  uint64_t pixels = 0;
+  for (int32_t row = 0; row < h; ++row) {
+    const int32_t py = y + row;
+    if (py < clipY0_ || py >= clipY1_) {
+      continue;
+    }
+    for (int32_t col = 0; col < w; ++col) {
+      const int32_t px = x + col;
+      if (px < clipX0_ || px >= clipX1_) {
+        continue;
+      }
+      uint16_t c = data[static_cast<size_t>(row) * w + col];
+      if (swapBytes_) {
+        c = static_cast<uint16_t>((c >> 8) | (c << 8));
+      }
+      if (useTransp && c == transp) {
+        continue;
+      }
+      fb_[static_cast<size_t>(py) * width_ + px] = c;
+      ++pixels;
+    }
+  }
+  notePanelWrite(pixels);
+}
+
+void TFT_eSPI::readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data) const {
+  if (data == nullptr) {
+    return;
+  }
+  for (int32_t row = 0; row < h; ++row) {
+    for (int32_t col = 0; col < w; ++col) {
+      *data++ = pixelAt(x + col, y + row);
+    }
+  }
+}
+
+void TFT_eSPI::setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+  addrX_ = x;
+  addrY_ = y;
+  addrW_ = w;
+  addrH_ = h;
+  addrCursor_ = 0;
+}
+
+void TFT_eSPI::pushPixels(const void* data, uint32_t len) {
+  if (data == nullptr || addrW_ <= 0 || addrH_ <= 0) {
+    return;
+  }
+  const uint16_t* src = static_cast<const uint16_t*>(data);
+  const uint32_t area = static_cast<uint32_t>(addrW_) * static_cast<uint32_t>(addrH_);
+  uint64_t pixels = 0;
+  for (uint32_t i = 0; i < len && addrCursor_ < area; ++i, ++addrCursor_) {
+    const int32_t px = addrX_ + static_cast<int32_t>(addrCursor_ % addrW_);
+    const int32_t py = addrY_ + static_cast<int32_t>(addrCursor_ / addrW_);
+    if (!inClip(px, py)) {
+      continue;
+    }
+    uint16_t c = src[i];
+    if (swapBytes_) {
+      c = static_cast<uint16_t>((c >> 8) | (c << 8));
+    }
+    fb_[static_cast<size_t>(py) * width_ + px] = c;
+    ++pixels;
+  }
+  notePanelWrite(pixels);
+}
+
+void TFT_eSPI::setTextColor(uint16_t fg, uint16_t bg, bool bgfill) {
+  textFg_ = fg;
+  textBg_ = bg;
+  textBgFill_ = bgfill;
+}
+
+int16_t TFT_eSPI::textWidth(const char* text, uint8_t font) const {
+  if (text == nullptr) {
+    return 0;
+  }
+  const GlyphMetrics m = metricsForFont(font);
+  return static_cast<int16_t>(std::strlen(text) * m.advance * textSize_);
+}
+
+int16_t TFT_eSPI::fontHeight(int16_t font) const {
+  return static_cast<int16_t>(metricsForFont(static_cast<uint8_t>(font)).height * textSize_);
+}
+
+int16_t TFT_eSPI::drawString(const char* text, int32_t x, int32_t y, uint8_t font) {
+  if (text == nullptr) {
+    return 0;
+  }
+  const GlyphMetrics m = metricsForFont(font);
+  const int32_t adv = m.advance * textSize_;
+  const int32_t h = m.height * textSize_;
+  const int32_t w = textWidth(text, font);
+
+  const uint8_t datum = textDatum_;
+  if (datum == TC_DATUM || datum == MC_DATUM || datum == BC_DATUM || datum == C_BASELINE) {
+    x -= w / 2;
+  } else if (datum == TR_DATUM || datum == MR_DATUM || datum == BR_DATUM ||
+             datum == R_BASELINE) {
+    x -= w;
+  }
+  if (datum == ML_DATUM || datum == MC_DATUM || datum == MR_DATUM) {
+    y -= h / 2;
+  } else if (datum == BL_DATUM || datum == BC_DATUM || datum == BR_DATUM) {
+    y -= h;
+  } else if (datum >= L_BASELINE) {
+    y -= (h * 3) / 4;
+  }
+
+  ++stats_.textDraws;
+  if (textBgFill_ || textBg_ != textFg_) {
+    fillRect(x, y, w, h, textBg_);
+  }
+  // Each glyph is an inset box; spaces leave the background untouched.
+  const int32_t insetX = adv > 3 ? 1 : 0;
+  const int32_t insetY = h > 3 ? 1 : 0;
+  uint64_t pixels = 0;
+  for (const char* p = text; *p != '\0'; ++p, x += adv) {
+    if (*p == ' ') {
+      continue;
+    }
+    const int32_t gx = x + insetX;
+    const int32_t gy = y + insetY;
+    const int32_t gw = adv - 2 * insetX;
+    const int32_t gh = h - 2 * insetY;
+    for (int32_t row = 0; row < gh; ++row) {
+      const int32_t py = gy + row;
+      if (py < clipY0_ || py >= clipY1_) {
+        continue;
+      }
+      const int32_t xa = std::max<int32_t>(clipX0_, gx);
+      const int32_t xb = std::min<int32_t>(clipX1_, gx + gw);
+      if (xb > xa) {
+        writeSpan(xa, py, xb - xa, textFg_);
+        pixels += static_cast<uint64_t>(xb - xa);
+      }
+    }
+  }
+  notePanelWrite(pixels);
+  return static_cast<int16_t>(w);
+}
+
+uint16_t TFT_eSPI::pixelAt(int32_t x, int32_t y) const {
+  if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+    return 0;
+  }
+  return fb_[static_cast<size_t>(y) * width_ + x];
+}
+
+uint32_t TFT_eSPI::framebufferHash() const {
+  uint32_t hash = 2166136261UL;
+  for (const uint16_t px : fb_) {
+    hash = (hash ^ (px & 0xFFU)) * 16777619UL;
+    hash = (hash ^ (px >> 8)) * 16777619UL;
+  }
+  return hash;
+}
+
+bool TFT_eSPI::writePpm(const char* path) const {
+  if (path == nullptr) {
+    return false;
+  }
+  std::FILE* out = std::fopen(path, "wb");
+  if (out == nullptr) {
+    return false;
+  }
+  std::fprintf(out, "P6\n%d %d\n255\n", width_, height_);
+  for (const uint16_t px : fb_) {
+    const uint8_t rgb[3] = {static_cast<uint8_t>(((px >> 11) & 0x1F) * 255 / 31),
+                            static_cast<uint8_t>(((px >> 5) & 0x3F) * 255 / 63),
+                            static_cast<uint8_t>((px & 0x1F) * 255 / 31)};
+    std::fwrite(rgb, 1, sizeof(rgb), out);
+  }
+  return std::fclose(out) == 0;
+}
+
+TFT_eSprite::TFT_eSprite(TFT_eSPI* parent) : TFT_eSPI(0, 0), parent_(parent) {}
+
+void* TFT_eSprite::createSprite(int16_t w, int16_t h) {
+  if (w <= 0 || h <= 0) {
+    return nullptr;
+  }
+  resize(w, h);
+  created_ = true;
+  return fb_.data();
+}
+
+void TFT_eSprite::deleteSprite() {
+  resize(0, 0);
+  fb_.shrink_to_fit();
+  created_ = false;
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) {
+  if (!created_ || parent_ == nullptr) {
+    return;
+  }
+  const bool swap = parent_->getSwapBytes();
+  parent_->setSwapBytes(false);
+  parent_->pushImage(x, y, width_, height_, fb_.data());
+  parent_->setSwapBytes(swap);
+}
+
+bool TFT_eSprite::pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw,
+                             int32_t sh) {
+  if (!created_ || parent_ == nullptr) {
+    return false;
+  }
+  const int32_t x0 = std::max<int32_t>(0, sx);
+  const int32_t y0 = std::max<int32_t>(0, sy);
+  const int32_t x1 = std::min<int32_t>(width_, sx + sw);
+  const int32_t y1 = std::min<int32_t>(height_, sy + sh);
+  if (x1 <= x0 || y1 <= y0) {
+    return false;
+  }
+  const int32_t w = x1 - x0;
+  std::vector<uint16_t> rows(static_cast<size_t>(w) * static_cast<size_t>(y1 - y0));
+  for (int32_t row = y0; row < y1; ++row) {
+    std::copy(fb_.begin() + static_cast<size_t>(row) * width_ + x0,
+              fb_.begin() + static_cast<size_t>(row) * width_ + x1,
+              rows.begin() + static_cast<size_t>(row - y0) * w);
+  }
+  const bool swap = parent_->getSwapBytes();
+  parent_->setSwapBytes(false);
+  parent_->pushImage(tx + (x0 - sx), ty + (y0 - sy), w, y1 - y0, rows.data());
+  parent_->setSwapBytes(swap);
+  return true;
+}
@@ -0,0 +1,142 @@
+// Host runner: loads a screen layout from a data directory, drives DisplayManager for a number
+// of frames against the framebuffer TFT stub, and prints a framebuffer hash for regression
+// checks. See host/README.md.
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "HostFixtures.h"
+#include "RuntimeGeo.h"
+#include "core/DisplayManager.h"
+#include "platform/Fs.h"
+#include "platform/IconPack.h"
+#include "widgets/DslRuntimeCaches.h"
+
+namespace {
+
+struct Options {
+  const char* root = "data";
+  const char* layout = "/screen_layout_b.json";
+  const char* outPpm = nullptr;
+  uint32_t frames = 10;
+  uint32_t frameMs = 50;
+  // Read and write widget field caches under ROOT/dsl_cache (off so runs are reproducible).
+  bool fieldCache = false;
+};
+
+void printUsage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--root DIR] [--layout PATH] [--frames N] [--frame-ms MS]\n"
+               "          [--fixture URL_PREFIX=FILE]... [--icon-pack FILE] [--field-cache]\n"
+               "          [--out FILE.ppm]\n",
+               argv0);
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (std::strcmp(arg, "--root") == 0 && value != nullptr) {
+      opts.root = value;
+    } else if (std::strcmp(arg, "--layout") == 0 && value != nullptr) {
+      opts.layout = value;
+    } else if (std::strcmp(arg, "--frames") == 0 && value != nullptr) {
+      opts.frames = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (std::strcmp(arg, "--frame-ms") == 0 && value != nullptr) {
+      opts.frameMs = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (std::strcmp(arg, "--field-cache") == 0) {
+      opts.fieldCache = true;
+      continue;
+    } else if (std::strcmp(arg, "--out") == 0 && value != nullptr) {
+      opts.outPpm = value;
+    } else if (std::strcmp(arg, "--icon-pack") == 0 && value != nullptr) {
+      platform::iconpack::setHostPackFile(value);
+    } else if (std::strcmp(arg, "--fixture") == 0 && value != nullptr) {
+      const char* eq = std::strchr(value, '=');
+      if (eq == nullptr) {
+        return false;
+      }
+      const String prefix(value, static_cast<unsigned int>(eq - value));
+      if (!hostfx::loadResponseFile(prefix, eq + 1)) {
+        std::fprintf(stderr, "cannot read fixture file '%s'\n", eq + 1);
+        return false;
+      }
+    } else {
+      return false;
+    }
+    ++i;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts;
+  if (!parseArgs(argc, argv, opts)) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  platform::fs::setHostRoot(opts.root);
+  if (!platform::fs::begin(false)) {
+    std::fprintf(stderr, "data root '%s' not found\n", opts.root);
+    return 1;
+  }
+  setDslFieldCacheEnabled(opts.fieldCache);
+  RuntimeGeo::setLocation(37.7749f, -122.4194f, "PST8PDT,M3.2.0,M11.1.0", -480, true,
+                          "San Francisco");
+
+  TFT_eSPI tft;
+  tft.init();
+  tft.setRotation(1);
+  tft.fillScreen(TFT_BLACK);
+
+  uint32_t hash = 0;
+  FrameScheduler::Stats frame;
+  DisplayManager::PaintMilestones paint;
+  {
+    DisplayManager display(tft, opts.layout);
+    if (!display.begin()) {
+      std::fprintf(stderr, "layout '%s' failed to load\n", opts.layout);
+      return 1;
+    }
+    for (uint32_t frame = 0; frame < opts.frames; ++frame) {
+      display.loop(millis());
+      delay(opts.frameMs);
+    }
+    display.loop(millis());
+    hash = tft.framebufferHash();
+    frame = display.frameStats();
+    paint = display.paintMilestones();
+  }
+
+  const TftHostStats& stats = tft.stats();
+  std::printf("frames=%lu fb_hash=%08lx pixels_written=%llu bus_transactions=%lu "
+              "http_requests=%lu\n",
+              static_cast<unsigned long>(opts.frames), static_cast<unsigned long>(hash),
+              static_cast<unsigned long long>(stats.pixelsWritten),
+              static_cast<unsigned long>(stats.busTransactions),
+              static_cast<unsigned long>(hostfx::requestCount()));
+  std::printf("frame_p50_us=%lu frame_p90_us=%lu frame_p99_us=%lu renders=%lu deferred=%lu "
+              "coalesced=%lu deadline_misses=%lu/%lu/%lu first_paint_ms=%lu fresh_paint_ms=%lu\n",
+              static_cast<unsigned long>(frame.p50Us), static_cast<unsigned long>(frame.p90Us),
+              static_cast<unsigned long>(frame.p99Us), static_cast<unsigned long>(frame.renders),
+              static_cast<unsigned long>(frame.deferred),
+              static_cast<unsigned long>(frame.coalesced),
+              static_cast<unsigned long>(frame.misses[0]),
+              static_cast<unsigned long>(frame.misses[1]),
+              static_cast<unsigned long>(frame.misses[2]),
+              static_cast<unsigned long>(paint.firstPaintMs),
+              static_cast<unsigned long>(paint.freshPaintMs));
+
+  if (opts.outPpm != nullptr && !tft.writePpm(opts.outPpm)) {
+    std::fprintf(stderr, "cannot write '%s'\n", opts.outPpm);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// Host stand-in for the subset of the Arduino core used by the shared runtime in src/.
+// Timing and logging are routed through the host platform backend (host/PlatformHost.cpp).
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Stream.h"
+#include "WString.h"
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void yield();
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+class HostSerial : public Stream {
+ public:
+  void begin(unsigned long baud) { (void)baud; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  explicit operator bool() const { return true; }
+};
+
+extern HostSerial Serial;
+
+class HostEsp {
+ public:
+  uint32_t getFreeHeap() const;
+  uint32_t getMinFreeHeap() const;
+  uint32_t getMaxAllocHeap() const;
+  void restart() const;
+};
+
+extern HostEsp ESP;
@@ -0,0 +1,47 @@
+#pragma once
+
+// Host stand-in for the Arduino `fs::File` handle. Files are plain host files rooted at the
+// directory configured through platform::fs::setHostRoot() (see host/FsHost.cpp).
+
+#include <cstdio>
+#include <memory>
+
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class File : public Stream {
+ public:
+  File() = default;
+  File(std::FILE* handle, bool isDirectory, const String& path);
+
+  explicit operator bool() const { return handle_ != nullptr || isDirectory_; }
+  bool isDirectory() const { return isDirectory_; }
+  size_t size() const;
+  size_t position() const;
+  bool seek(uint32_t pos);
+  const char* name() const { return path_.c_str(); }
+  const char* path() const { return path_.c_str(); }
+  void close();
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t* buf, size_t size);
+  size_t readBytes(char* buffer, size_t length) override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  using Print::write;
+  void flush();
+
+ private:
+  std::shared_ptr<std::FILE> handle_;
+  bool isDirectory_ = false;
+  String path_;
+};
+
+}  // namespace fs
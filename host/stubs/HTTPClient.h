@@ -0,0 +1,66 @@
+#pragma once
+
+// Host stand-in for the Arduino HTTPClient. begin() always fails so callers take their
+// existing "HTTP begin failed" paths; see host/README.md.
+
+#include "Arduino.h"
+#include "WiFiClientSecure.h"
+
+enum followRedirects_t {
+  HTTPC_DISABLE_FOLLOW_REDIRECTS,
+  HTTPC_STRICT_FOLLOW_REDIRECTS,
+  HTTPC_FORCE_FOLLOW_REDIRECTS,
+};
+
+#define HTTP_CODE_OK 200
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+class HTTPClient {
+ public:
+  bool begin(const String& url) {
+    (void)url;
+    return false;
+  }
+  bool begin(WiFiClient& client, const String& url) {
+    (void)client;
+    (void)url;
+    return false;
+  }
+  void setFollowRedirects(followRedirects_t follow) { (void)follow; }
+  void setRedirectLimit(uint16_t limit) { (void)limit; }
+  void setConnectTimeout(int32_t timeoutMs) { (void)timeoutMs; }
+  void setTimeout(uint16_t timeoutMs) { (void)timeoutMs; }
+  void useHTTP10(bool enable = true) { (void)enable; }
+  void setReuse(bool reuse) { (void)reuse; }
+  void collectHeaders(const char* headerKeys[], size_t count) {
+    (void)headerKeys;
+    (void)count;
+  }
+  void addHeader(const String& name, const String& value) {
+    (void)name;
+    (void)value;
+  }
+  int GET() { return HTTPC_ERROR_CONNECTION_REFUSED; }
+  int POST(const String& payload) {
+    (void)payload;
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+  int PUT(const String& payload) {
+    (void)payload;
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+  int sendRequest(const char* method, const String& payload) {
+    (void)method;
+    (void)payload;
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+  String getString() { return String(); }
+  String header(const char* name) {
+    (void)name;
+    return String();
+  }
+  int getSize() { return -1; }
+  WiFiClient* getStreamPtr() { return nullptr; }
+  bool connected() { return false; }
+  void end() {}
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+// Host stand-ins for the Arduino Print/Stream interfaces (used by ArduinoJson and fs::File).
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+#include "WString.h"
+
+class Print {
+ public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size-- > 0) {
+      n += write(*buffer++);
+    }
+    return n;
+  }
+  size_t write(const char* str);
+
+  size_t print(const char* str) { return write(str); }
+  size_t print(const String& str) { return write(str.c_str()); }
+  size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+  size_t print(int value) { return print(String(value)); }
+  size_t print(unsigned int value) { return print(String(value)); }
+  size_t print(long value) { return print(String(value)); }
+  size_t print(unsigned long value) { return print(String(value)); }
+  size_t print(double value, int digits = 2) { return print(String(value, digits)); }
+  size_t println() { return write("\n"); }
+  template <typename T>
+  size_t println(const T& value) {
+    const size_t n = print(value);
+    return n + println();
+  }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual size_t readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+      const int c = read();
+      if (c < 0) {
+        break;
+      }
+      *buffer++ = static_cast<char>(c);
+      ++count;
+    }
+    return count;
+  }
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    return readBytes(reinterpret_cast<char*>(buffer), length);
+  }
+  void setTimeout(unsigned long timeoutMs) { timeoutMs_ = timeoutMs; }
+
+ protected:
+  unsigned long timeoutMs_ = 1000;
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+// Host stand-in for TFT_eSPI / TFT_eSprite. Both draw into an in-memory RGB565 framebuffer so
+// render paths can be exercised, hashed and measured off-target (see host/TftHost.cpp).
+// Glyphs are drawn as filled cells using fixed per-font metrics; pixel output is therefore not
+// identical to the panel, but is deterministic and sensitive to layout changes.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Arduino.h"
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define CL_DATUM 3
+#define MC_DATUM 4
+#define CC_DATUM 4
+#define MR_DATUM 5
+#define CR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+#define L_BASELINE 9
+#define C_BASELINE 10
+#define R_BASELINE 11
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_DARKCYAN 0x03EF
+#define TFT_MAROON 0x7800
+#define TFT_PURPLE 0x780F
+#define TFT_OLIVE 0x7BE0
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_DARKGREY 0x7BEF
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+#define TFT_TRANSPARENT 0x0120
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 240
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 320
+#endif
+
+// Counters for everything that reaches the (simulated) panel. Sprite drawing is local memory
+// and only counted when the sprite is pushed.
+struct TftHostStats {
+  uint64_t pixelsWritten = 0;
+  uint32_t busTransactions = 0;
+  uint32_t textDraws = 0;
+};
+
+class TFT_eSPI {
+ public:
+  explicit TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+  virtual ~TFT_eSPI() = default;
+
+  void init() {}
+  void begin() { init(); }
+  void setRotation(uint8_t r);
+  uint8_t getRotation() const { return rotation_; }
+  void invertDisplay(bool invert) { (void)invert; }
+  int16_t width() const { return width_; }
+  int16_t height() const { return height_; }
+
+  void startWrite() {}
+  void endWrite() {}
+  void setSwapBytes(bool swap) { swapBytes_ = swap; }
+  bool getSwapBytes() const { return swapBytes_; }
+
+  void fillScreen(uint32_t color);
+  void drawPixel(int32_t x, int32_t y, uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+  // Skips pixels equal to transp (compared after any byte swap, as TFT_eSPI does).
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data,
+                 uint16_t transp);
+  uint16_t readPixel(int32_t x, int32_t y) const { return pixelAt(x, y); }
+  void readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data) const;
+  void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h);
+  // Clips all drawing to the given window. Only vpDatum == false (screen coordinates, no
+  // origin shift) is modelled, which is how the runtime uses it.
+  void setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum = true);
+  void resetViewport();
+  void pushPixels(const void* data, uint32_t len);
+
+  void setTextColor(uint16_t fg) { setTextColor(fg, fg, false); }
+  void setTextColor(uint16_t fg, uint16_t bg, bool bgfill = false);
+  void setTextDatum(uint8_t datum) { textDatum_ = datum; }
+  uint8_t getTextDatum() const { return textDatum_; }
+  void setTextFont(uint8_t font) { textFont_ = font; }
+  void setTextSize(uint8_t size) { textSize_ = size == 0 ? 1 : size; }
+  int16_t textWidth(const char* text, uint8_t font) const;
+  int16_t textWidth(const char* text) const { return textWidth(text, textFont_); }
+  int16_t textWidth(const String& text, uint8_t font) const { return textWidth(text.c_str(), font); }
+  int16_t textWidth(const String& text) const { return textWidth(text.c_str(), textFont_); }
+  int16_t fontHeight(int16_t font) const;
+  int16_t fontHeight() const { return fontHeight(textFont_); }
+  int16_t drawString(const char* text, int32_t x, int32_t y, uint8_t font);
+  int16_t drawString(const char* text, int32_t x, int32_t y) {
+    return drawString(text, x, y, textFont_);
+  }
+  int16_t drawString(const String& text, int32_t x, int32_t y, uint8_t font) {
+    return drawString(text.c_str(), x, y, font);
+  }
+  int16_t drawString(const String& text, int32_t x, int32_t y) {
+    return drawString(text.c_str(), x, y, textFont_);
+  }
+
+  static uint16_t color565(uint8_t r, uint8_t g, uint8_t b) {
+    return static_cast<uint16_t>(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+  }
+
+  // Host-only helpers.
+  const uint16_t* framebuffer() const { return fb_.data(); }
+  uint16_t pixelAt(int32_t x, int32_t y) const;
+  const TftHostStats& stats() const { return stats_; }
+  void resetStats() { stats_ = TftHostStats{}; }
+  uint32_t framebufferHash() const;
+  bool writePpm(const char* path) const;
+
+ protected:
+  // Counts bus transactions on the panel: one per primitive, except drawLine (one per straight
+  // run) and fillCircle (one per row), which TFT_eSPI splits into several address windows.
+  // Sprites override to count nothing.
+  virtual void notePanelWrite(uint64_t pixels, uint32_t transactions = 1);
+  void resize(int16_t w, int16_t h);
+  void writeSpan(int32_t x, int32_t y, int32_t w, uint16_t color);
+  void fillRectRaw(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+  void pushImageImpl(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data,
+                     bool useTransp, uint16_t transp);
+  bool inClip(int32_t x, int32_t y) const {
+    return x >= clipX0_ && y >= clipY0_ && x < clipX1_ && y < clipY1_;
+  }
+
+  int16_t width_ = 0;
+  int16_t height_ = 0;
+  uint8_t rotation_ = 0;
+  std::vector<uint16_t> fb_;
+  TftHostStats stats_;
+  int32_t clipX0_ = 0;
+  int32_t clipY0_ = 0;
+  int32_t clipX1_ = 0;
+  int32_t clipY1_ = 0;
+
+ private:
+  bool swapBytes_ = false;
+  uint16_t textFg_ = TFT_WHITE;
+  uint16_t textBg_ = TFT_BLACK;
+  bool textBgFill_ = false;
+  uint8_t textDatum_ = TL_DATUM;
+  uint8_t textFont_ = 1;
+  uint8_t textSize_ = 1;
+  int32_t addrX_ = 0;
+  int32_t addrY_ = 0;
+  int32_t addrW_ = 0;
+  int32_t addrH_ = 0;
+  uint32_t addrCursor_ = 0;
+};
+
+class TFT_eSprite : public TFT_eSPI {
+ public:
+  explicit TFT_eSprite(TFT_eSPI* parent);
+
+  void setColorDepth(int8_t depth) { (void)depth; }
+  void* createSprite(int16_t w, int16_t h);
+  void deleteSprite();
+  void fillSprite(uint32_t color) { fillRect(0, 0, width_, height_, color); }
+  bool created() const { return created_; }
+  void* getPointer() { return created_ ? fb_.data() : nullptr; }
+  void pushSprite(int32_t x, int32_t y);
+  // Pushes the sw x sh area at (sx, sy) of the sprite to (tx, ty) on the parent.
+  bool pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh);
+
+ protected:
+  void notePanelWrite(uint64_t pixels, uint32_t transactions) override {
+    (void)pixels;
+    (void)transactions;
+  }
+
+ private:
+  TFT_eSPI* parent_ = nullptr;
+  bool created_ = false;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+// Host stand-in for the Arduino `String` class, backed by std::string.
+// Only the surface used by the shared runtime (src/) and ArduinoJson is provided.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#ifndef DEC
+#define DEC 10
+#endif
+#ifndef HEX
+#define HEX 16
+#endif
+#ifndef OCT
+#define OCT 8
+#endif
+#ifndef BIN
+#define BIN 2
+#endif
+
+class String {
+ public:
+  String() = default;
+  String(const char* cstr) : s_(cstr != nullptr ? cstr : "") {}
+  String(const char* cstr, unsigned int length) : s_(cstr != nullptr ? cstr : "", length) {}
+  String(const String& other) = default;
+  String(String&& other) noexcept = default;
+  explicit String(char c) : s_(1, c) {}
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value, unsigned char base = 10);
+  explicit String(unsigned long long value, unsigned char base = 10);
+  explicit String(float value, unsigned int decimalPlaces = 2);
+  explicit String(double value, unsigned int decimalPlaces = 2);
+
+  String& operator=(const String& rhs) = default;
+  String& operator=(String&& rhs) noexcept = default;
+  String& operator=(const char* cstr) {
+    s_ = cstr != nullptr ? cstr : "";
+    return *this;
+  }
+
+  bool reserve(unsigned int size) {
+    s_.reserve(size);
+    return true;
+  }
+  unsigned int length() const { return static_cast<unsigned int>(s_.size()); }
+  bool isEmpty() const { return s_.empty(); }
+  const char* c_str() const { return s_.c_str(); }
+  char* begin() { return &s_[0]; }
+  char* end() { return &s_[0] + s_.size(); }
+  const char* begin() const { return s_.data(); }
+  const char* end() const { return s_.data() + s_.size(); }
+
+  bool concat(const String& str) {
+    s_ += str.s_;
+    return true;
+  }
+  bool concat(const char* cstr) {
+    if (cstr != nullptr) {
+      s_ += cstr;
+    }
+    return true;
+  }
+  bool concat(const char* cstr, unsigned int length) {
+    if (cstr != nullptr) {
+      s_.append(cstr, length);
+    }
+    return true;
+  }
+  bool concat(char c) {
+    s_ += c;
+    return true;
+  }
+  template <typename T,
+            typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, char>::value,
+                                    int>::type = 0>
+  bool concat(T value) {
+    return concat(String(value));
+  }
+
+  String& operator+=(const String& rhs) {
+    concat(rhs);
+    return *this;
+  }
+  String& operator+=(const char* cstr) {
+    concat(cstr);
+    return *this;
+  }
+  String& operator+=(char c) {
+    concat(c);
+    return *this;
+  }
+  template <typename T,
+            typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, char>::value,
+                                    int>::type = 0>
+  String& operator+=(T value) {
+    concat(value);
+    return *this;
+  }
+
+  int compareTo(const String& s) const { return s_.compare(s.s_); }
+  bool equals(const String& s) const { return s_ == s.s_; }
+  bool equals(const char* cstr) const { return s_ == (cstr != nullptr ? cstr : ""); }
+  bool equalsIgnoreCase(const String& s) const;
+  bool startsWith(const String& prefix) const { return startsWith(prefix, 0); }
+  bool startsWith(const String& prefix, unsigned int offset) const;
+  bool endsWith(const String& suffix) const;
+
+  char charAt(unsigned int index) const { return index < s_.size() ? s_[index] : '\0'; }
+  void setCharAt(unsigned int index, char c) {
+    if (index < s_.size()) {
+      s_[index] = c;
+    }
+  }
+  char operator[](unsigned int index) const { return charAt(index); }
+  char& operator[](unsigned int index);
+  void getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index = 0) const;
+  void toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const {
+    getBytes(reinterpret_cast<unsigned char*>(buf), bufsize, index);
+  }
+
+  int indexOf(char ch) const { return indexOf(ch, 0); }
+  int indexOf(char ch, unsigned int fromIndex) const;
+  int indexOf(const String& str) const { return indexOf(str, 0); }
+  int indexOf(const String& str, unsigned int fromIndex) const;
+  int lastIndexOf(char ch) const;
+  int lastIndexOf(char ch, unsigned int fromIndex) const;
+  int lastIndexOf(const String& str) const;
+  int lastIndexOf(const String& str, unsigned int fromIndex) const;
+
+  String substring(unsigned int beginIndex) const { return substring(beginIndex, length()); }
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  void replace(char find, char replaceWith);
+  void replace(const String& find, const String& replaceWith);
+  void remove(unsigned int index) { remove(index, length()); }
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const;
+  float toFloat() const;
+  double toDouble() const;
+
+  const std::string& str() const { return s_; }
+
+ private:
+  std::string s_;
+};
+
+class StringSumHelper : public String {
+ public:
+  StringSumHelper(const String& s) : String(s) {}
+  StringSumHelper(const char* p) : String(p) {}
+};
+
+inline String operator+(const String& lhs, const String& rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+inline String operator+(const String& lhs, const char* rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+inline String operator+(const char* lhs, const String& rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+inline String operator+(const String& lhs, char rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+template <typename T,
+          typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, char>::value,
+                                  int>::type = 0>
+inline String operator+(const String& lhs, T rhs) {
+  String out(lhs);
+  out.concat(rhs);
+  return out;
+}
+
+inline bool operator==(const String& a, const String& b) { return a.equals(b); }
+inline bool operator==(const String& a, const char* b) { return a.equals(b); }
+inline bool operator==(const char* a, const String& b) { return b.equals(a); }
+inline bool operator!=(const String& a, const String& b) { return !a.equals(b); }
+inline bool operator!=(const String& a, const char* b) { return !a.equals(b); }
+inline bool operator!=(const char* a, const String& b) { return !b.equals(a); }
+inline bool operator<(const String& a, const String& b) { return a.compareTo(b) < 0; }
+inline bool operator>(const String& a, const String& b) { return a.compareTo(b) > 0; }
+inline bool operator<=(const String& a, const String& b) { return a.compareTo(b) <= 0; }
+inline bool operator>=(const String& a, const String& b) { return a.compareTo(b) >= 0; }
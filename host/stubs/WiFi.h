@@ -0,0 +1,15 @@
+#pragma once
+
+// Host stand-in for the Arduino WiFi object; reconnects are no-ops.
+
+class HostWiFi {
+ public:
+  bool disconnect(bool wifiOff = false, bool eraseAp = false) {
+    (void)wifiOff;
+    (void)eraseAp;
+    return true;
+  }
+  bool reconnect() { return true; }
+};
+
+inline HostWiFi WiFi;
@@ -0,0 +1,25 @@
+#pragma once
+
+// Host stand-in for the Arduino WiFi client classes. There is no socket behind them: the host
+// build serves JSON through host/HttpJsonClientHost.cpp and Arduino HTTPClient requests fail.
+
+#include "Arduino.h"
+
+class WiFiClient : public Stream {
+ public:
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override {
+    (void)c;
+    return 0;
+  }
+  using Print::write;
+  bool connected() { return false; }
+  void stop() {}
+};
+
+class WiFiClientSecure : public WiFiClient {
+ public:
+  void setInsecure() {}
+};
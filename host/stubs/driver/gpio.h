@@ -0,0 +1,26 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF GPIO driver. Levels are only tracked by the SPI bus model
+// (host/SpiMasterHost.h), which watches the panel DC pin.
+
+#include <cstdint>
+
+#include "esp_err.h"
+
+using gpio_num_t = int;
+
+enum gpio_mode_t { GPIO_MODE_DISABLE = 0, GPIO_MODE_INPUT = 1, GPIO_MODE_OUTPUT = 2 };
+enum gpio_pullup_t { GPIO_PULLUP_DISABLE = 0, GPIO_PULLUP_ENABLE = 1 };
+enum gpio_pulldown_t { GPIO_PULLDOWN_DISABLE = 0, GPIO_PULLDOWN_ENABLE = 1 };
+enum gpio_int_type_t { GPIO_INTR_DISABLE = 0 };
+
+struct gpio_config_t {
+  uint64_t pin_bit_mask;
+  gpio_mode_t mode;
+  gpio_pullup_t pull_up_en;
+  gpio_pulldown_t pull_down_en;
+  gpio_int_type_t intr_type;
+};
+
+esp_err_t gpio_config(const gpio_config_t* config);
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level);
@@ -0,0 +1,55 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF SPI master driver. Transfers run on a simulated bus clock
+// instead of hardware; see host/SpiMasterHost.h for the timing and ordering model.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+using spi_host_device_t = int;
+
+#define SPI2_HOST 1
+#define SPI3_HOST 2
+#define SPI_DMA_CH_AUTO 3
+#define SPI_DEVICE_NO_DUMMY (1U << 6)
+
+struct spi_bus_config_t {
+  int mosi_io_num;
+  int miso_io_num;
+  int sclk_io_num;
+  int quadwp_io_num;
+  int quadhd_io_num;
+  int max_transfer_sz;
+};
+
+struct spi_device_interface_config_t {
+  uint8_t mode;
+  int clock_speed_hz;
+  int spics_io_num;
+  uint32_t flags;
+  int queue_size;
+};
+
+struct spi_transaction_t {
+  uint32_t flags;
+  size_t length;  // bits
+  size_t rxlength;
+  void* user;
+  const void* tx_buffer;
+  void* rx_buffer;
+};
+
+struct HostSpiDevice;
+using spi_device_handle_t = HostSpiDevice*;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t* config, int dmaChan);
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* config,
+                             spi_device_handle_t* outHandle);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t* trans,
+                                 TickType_t ticksToWait);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t** outTrans,
+                                      TickType_t ticksToWait);
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t* trans);
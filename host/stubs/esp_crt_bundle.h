@@ -0,0 +1,6 @@
+#pragma once
+
+#include "esp_err.h"
+
+// Host stand-in; the host HTTP and WebSocket clients only speak plain TCP.
+esp_err_t arduino_esp_crt_bundle_attach(void* conf);
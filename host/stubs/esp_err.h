@@ -0,0 +1,20 @@
+#pragma once
+
+// Host stand-in for ESP-IDF error codes (live HTTP client and SPI bus model).
+
+#include <cstdint>
+
+using esp_err_t = int;
+
+#define ESP_OK 0
+#define ESP_FAIL (-1)
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_NOT_SUPPORTED 0x106
+#define ESP_ERR_TIMEOUT 0x107
+#define ESP_ERR_HTTP_CONNECT 0x7002
+#define ESP_ERR_HTTP_WRITE_DATA 0x7003
+#define ESP_ERR_HTTP_FETCH_HEADER 0x7004
+#define ESP_ERR_HTTP_EAGAIN 0x7007
+
+const char* esp_err_to_name(esp_err_t code);
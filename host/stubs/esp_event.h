@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for the esp_event handler types used by esp_websocket_client.
+
+#include <cstdint>
+
+using esp_event_base_t = const char*;
+using esp_event_handler_t = void (*)(void* event_handler_arg, esp_event_base_t event_base,
+                                     int32_t event_id, void* event_data);
+
+#define ESP_EVENT_DECLARE_BASE(id) extern esp_event_base_t const id
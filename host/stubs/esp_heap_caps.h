@@ -0,0 +1,15 @@
+#pragma once
+
+// Host stand-in: the host heap is never fragmented, so the largest block is the free heap.
+// There is no PSRAM unless COSTAR_HOST_PSRAM is set (see PlatformHost.cpp).
+
+#include <cstddef>
+#include <cstdint>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+void* heap_caps_malloc(size_t size, uint32_t caps);
+void heap_caps_free(void* ptr);
@@ -0,0 +1,80 @@
+#pragma once
+
+// Host implementation of the esp_http_client API subset used by src/services over POSIX
+// sockets (EspHttpClientHost.cpp). Plain HTTP/1.1 only: https URLs fail to connect.
+// Connections stay open between requests until close(), a URL with another host/port, or a
+// "Connection: close" response, mirroring ESP-IDF keep-alive behaviour.
+
+#include <cstdint>
+
+#include "esp_err.h"
+
+struct HostHttpClient;
+using esp_http_client_handle_t = HostHttpClient*;
+
+enum esp_http_client_event_id_t {
+  HTTP_EVENT_ERROR = 0,
+  HTTP_EVENT_ON_CONNECTED,
+  HTTP_EVENT_HEADERS_SENT,
+  HTTP_EVENT_ON_HEADER,
+  HTTP_EVENT_ON_DATA,
+  HTTP_EVENT_ON_FINISH,
+  HTTP_EVENT_DISCONNECTED,
+};
+
+struct esp_http_client_event_t {
+  esp_http_client_event_id_t event_id;
+  esp_http_client_handle_t client;
+  void* data;
+  int data_len;
+  void* user_data;
+  char* header_key;
+  char* header_value;
+};
+
+using http_event_handle_cb = esp_err_t (*)(esp_http_client_event_t* evt);
+
+enum esp_http_client_method_t {
+  HTTP_METHOD_GET = 0,
+  HTTP_METHOD_POST,
+  HTTP_METHOD_PUT,
+  HTTP_METHOD_PATCH,
+  HTTP_METHOD_DELETE,
+  HTTP_METHOD_HEAD,
+};
+
+struct esp_http_client_config_t {
+  const char* url;
+  int timeout_ms;
+  bool disable_auto_redirect;
+  int max_redirection_count;
+  http_event_handle_cb event_handler;
+  void* user_data;
+  int buffer_size;
+  int buffer_size_tx;
+  bool skip_cert_common_name_check;
+  bool keep_alive_enable;
+  esp_err_t (*crt_bundle_attach)(void* conf);
+};
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t* config);
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client);
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char* url);
+esp_err_t esp_http_client_set_method(esp_http_client_handle_t client,
+                                     esp_http_client_method_t method);
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char* key,
+                                     const char* value);
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char* key);
+esp_err_t esp_http_client_set_timeout_ms(esp_http_client_handle_t client, int timeout_ms);
+esp_err_t esp_http_client_set_user_data(esp_http_client_handle_t client, void* data);
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len);
+int esp_http_client_write(esp_http_client_handle_t client, const char* buffer, int len);
+int esp_http_client_fetch_headers(esp_http_client_handle_t client);
+int esp_http_client_get_status_code(esp_http_client_handle_t client);
+int esp_http_client_read(esp_http_client_handle_t client, char* buffer, int len);
+bool esp_http_client_is_complete_data_received(esp_http_client_handle_t client);
+esp_err_t esp_http_client_set_redirection(esp_http_client_handle_t client);
+esp_err_t esp_http_client_close(esp_http_client_handle_t client);
+
+// Host-only: TCP connections opened so far, for checking connection reuse.
+uint32_t esp_http_client_host_connect_count();
@@ -0,0 +1,9 @@
+#pragma once
+
+// Host stand-in for ESP-IDF logging; routed through the platform log (COSTAR_HOST_QUIET applies).
+
+#include "platform/Platform.h"
+
+#define ESP_LOGI(tag, fmt, ...) platform::logi(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) platform::logw(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGE(tag, fmt, ...) platform::loge(tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,68 @@
+#pragma once
+
+// Host implementation of the esp_websocket_client API subset used by src/services over POSIX
+// sockets (see host/EspWebSocketClientHost.cpp). Plain ws:// only: wss URLs fail to connect.
+// As on the device, events are delivered on the client's own thread, which reconnects after
+// reconnect_timeout_ms unless disable_auto_reconnect is set.
+
+#include <cstdint>
+
+#include "esp_err.h"
+#include "esp_event.h"
+#include "freertos/FreeRTOS.h"
+
+struct esp_websocket_client;
+using esp_websocket_client_handle_t = esp_websocket_client*;
+
+ESP_EVENT_DECLARE_BASE(WEBSOCKET_EVENTS);
+
+enum esp_websocket_event_id_t {
+  WEBSOCKET_EVENT_ANY = -1,
+  WEBSOCKET_EVENT_ERROR = 0,
+  WEBSOCKET_EVENT_CONNECTED,
+  WEBSOCKET_EVENT_DISCONNECTED,
+  WEBSOCKET_EVENT_DATA,
+  WEBSOCKET_EVENT_CLOSED,
+  WEBSOCKET_EVENT_MAX,
+};
+
+struct esp_websocket_event_data_t {
+  const char* data_ptr;
+  int data_len;
+  bool fin;
+  uint8_t op_code;
+  esp_websocket_client_handle_t client;
+  void* user_context;
+  int payload_len;
+  int payload_offset;
+};
+
+struct esp_websocket_client_config_t {
+  const char* uri;
+  bool disable_auto_reconnect;
+  void* user_context;
+  int task_prio;
+  int task_stack;
+  int buffer_size;
+  const char* headers;
+  int pingpong_timeout_sec;
+  bool disable_pingpong_discon;
+  int ping_interval_sec;
+  int reconnect_timeout_ms;
+  int network_timeout_ms;
+  esp_err_t (*crt_bundle_attach)(void* conf);
+};
+
+esp_websocket_client_handle_t esp_websocket_client_init(
+    const esp_websocket_client_config_t* config);
+esp_err_t esp_websocket_register_events(esp_websocket_client_handle_t client,
+                                        esp_websocket_event_id_t event,
+                                        esp_event_handler_t event_handler,
+                                        void* event_handler_arg);
+esp_err_t esp_websocket_client_start(esp_websocket_client_handle_t client);
+// Must not be called from the client's event handler.
+esp_err_t esp_websocket_client_stop(esp_websocket_client_handle_t client);
+esp_err_t esp_websocket_client_destroy(esp_websocket_client_handle_t client);
+int esp_websocket_client_send_text(esp_websocket_client_handle_t client, const char* data,
+                                   int len, TickType_t timeout);
+bool esp_websocket_client_is_connected(esp_websocket_client_handle_t client);
@@ -0,0 +1,18 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS kernel types used by the shared runtime.
+// Tasks map to std::thread and mutexes to std::timed_mutex (see host/FreeRtosHost.cpp).
+
+#include <cstdint>
+
+using TickType_t = uint32_t;
+using BaseType_t = int;
+using UBaseType_t = unsigned int;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+struct HostSemaphore;
+using SemaphoreHandle_t = HostSemaphore*;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+struct HostTask;
+using TaskHandle_t = HostTask*;
+using TaskFunction_t = void (*)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* outHandle,
+                                   BaseType_t coreId);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                       UBaseType_t priority, TaskHandle_t* outHandle);
+// Deleting another task stops it at its next vTaskDelay() or ulTaskNotifyTake() and joins it;
+// nullptr deletes the caller.
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+// Direct-to-task notifications, counting form only (the notification value as a semaphore).
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticks);
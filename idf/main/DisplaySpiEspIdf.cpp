@@ -4,10 +4,12 @@
 
 #include "driver/gpio.h"
 #include "driver/spi_master.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include <algorithm>
 #include <climits>
 #include <cstddef>
 #include <cstdint>
@@ -18,10 +20,28 @@ constexpr spi_host_device_t kTftHost = SPI3_HOST;
 constexpr int kDmaChannel = SPI_DMA_CH_AUTO;
 constexpr int kPanelClockHz = 40 * 1000 * 1000;
 constexpr uint32_t kDmaChunkRows = 16;
+constexpr size_t kDmaChunkBytes =
+    static_cast<size_t>(AppConfig::kPanelWidth) * kDmaChunkRows * 2U;
+constexpr size_t kDmaChunkPixels = kDmaChunkBytes / 2U;
+// Pixel data is double-buffered: one chunk on the wire while the next is filled.
+constexpr size_t kDmaSlotCount = 2;
+
+struct DmaSlot {
+  uint8_t* buffer = nullptr;
+  spi_transaction_t trans = {};
+  bool inFlight = false;
+};
 
 spi_device_handle_t sTftDevice = nullptr;
 bool sBusInitialized = false;
 bool sPanelInitialized = false;
+DmaSlot sDmaSlots[kDmaSlotCount];
+bool sDmaReady = false;
+size_t sNextSlot = 0;
+size_t sSlotsInFlight = 0;
+// Chunk being filled by appendPixels(); queued when full or on flushPixels().
+DmaSlot* sFillSlot = nullptr;
+size_t sFillPixels = 0;
 
 static_assert(AppConfig::kPanelWidth <= UINT16_MAX, "panel width must fit 16-bit column addressing");
 static_assert(AppConfig::kPanelHeight <= UINT16_MAX,
@@ -82,10 +102,83 @@ bool setGpioOutput(int8_t pin, int level) {
   return gpio_set_level(static_cast<gpio_num_t>(pin), level) == ESP_OK;
 }
 
+bool allocDmaSlots() {
+  if (sDmaReady) {
+    return true;
+  }
+  for (DmaSlot& slot : sDmaSlots) {
+    slot.buffer = static_cast<uint8_t*>(heap_caps_malloc(kDmaChunkBytes, MALLOC_CAP_DMA));
+    if (slot.buffer == nullptr) {
+      for (DmaSlot& other : sDmaSlots) {
+        heap_caps_free(other.buffer);
+        other.buffer = nullptr;
+      }
+      ESP_LOGW(kTag, "dma buffers unavailable (%u bytes); pixel pushes poll",
+               static_cast<unsigned>(kDmaChunkBytes * kDmaSlotCount));
+      return false;
+    }
+  }
+  sDmaReady = true;
+  return true;
+}
+
+// Waits for the oldest queued chunk; transactions complete in queue order.
+bool reclaimOldestSlot() {
+  spi_transaction_t* done = nullptr;
+  if (spi_device_get_trans_result(sTftDevice, &done, portMAX_DELAY) != ESP_OK || done == nullptr) {
+    return false;
+  }
+  static_cast<DmaSlot*>(done->user)->inFlight = false;
+  --sSlotsInFlight;
+  return true;
+}
+
+bool drainDmaQueue() {
+  while (sSlotsInFlight > 0) {
+    if (!reclaimOldestSlot()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+DmaSlot* acquireDmaSlot() {
+  DmaSlot& slot = sDmaSlots[sNextSlot];
+  while (slot.inFlight) {
+    if (!reclaimOldestSlot()) {
+      return nullptr;
+    }
+  }
+  sNextSlot = (sNextSlot + 1) % kDmaSlotCount;
+  return &slot;
+}
+
+// DC stays high for queued pixel data; commands drain the queue before pulling it low.
+bool queueDmaSlot(DmaSlot& slot, size_t bytes) {
+  if (AppConfig::kTftDcPin >= 0 &&
+      gpio_set_level(static_cast<gpio_num_t>(AppConfig::kTftDcPin), 1) != ESP_OK) {
+    return false;
+  }
+  slot.trans = {};
+  slot.trans.length = bytes * 8U;
+  slot.trans.tx_buffer = slot.buffer;
+  slot.trans.user = &slot;
+  if (spi_device_queue_trans(sTftDevice, &slot.trans, portMAX_DELAY) != ESP_OK) {
+    return false;
+  }
+  slot.inFlight = true;
+  ++sSlotsInFlight;
+  return true;
+}
+
 bool writeSpiBytes(int dcLevel, const uint8_t* data, size_t size) {
   if (sTftDevice == nullptr || data == nullptr || size == 0) {
     return false;
   }
+  // Polling transfers may not start while queued ones are pending.
+  if (!drainDmaQueue()) {
+    return false;
+  }
   if (AppConfig::kTftDcPin >= 0) {
     if (gpio_set_level(static_cast<gpio_num_t>(AppConfig::kTftDcPin), dcLevel) != ESP_OK) {
       return false;
@@ -214,7 +307,84 @@ bool setAddressWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
   return writeCommand(0x2C);  // RAMWR
 }
 
+bool flushPixels() {
+  if (sFillSlot == nullptr || sFillPixels == 0) {
+    return true;
+  }
+  DmaSlot* slot = sFillSlot;
+  const size_t bytes = sFillPixels * 2U;
+  sFillSlot = nullptr;
+  sFillPixels = 0;
+  return queueDmaSlot(*slot, bytes);
+}
+
+// Converts RGB565 pixels to panel byte order into the DMA chunk being filled, queueing each
+// chunk as it fills. Without DMA buffers the pixels go out through polling transfers.
+bool appendPixels(const uint16_t* pixels, uint32_t count) {
+  if (!sDmaReady) {
+    static constexpr size_t kLinePixels = 96;
+    uint8_t line[kLinePixels * 2];
+    while (count > 0) {
+      const size_t now = count > kLinePixels ? kLinePixels : count;
+      for (size_t i = 0; i < now; ++i) {
+        line[i * 2] = static_cast<uint8_t>(pixels[i] >> 8);
+        line[i * 2 + 1] = static_cast<uint8_t>(pixels[i] & 0xFF);
+      }
+      if (!writeData(line, now * 2U)) {
+        return false;
+      }
+      pixels += now;
+      count -= static_cast<uint32_t>(now);
+    }
+    return true;
+  }
+
+  while (count > 0) {
+    if (sFillSlot == nullptr) {
+      sFillSlot = acquireDmaSlot();
+      if (sFillSlot == nullptr) {
+        return false;
+      }
+    }
+    const size_t room = kDmaChunkPixels - sFillPixels;
+    const size_t now = count > room ? room : count;
+    uint8_t* out = sFillSlot->buffer + sFillPixels * 2U;
+    for (size_t i = 0; i < now; ++i) {
+      out[i * 2] = static_cast<uint8_t>(pixels[i] >> 8);
+      out[i * 2 + 1] = static_cast<uint8_t>(pixels[i] & 0xFF);
+    }
+    sFillPixels += now;
+    pixels += now;
+    count -= static_cast<uint32_t>(now);
+    if (sFillPixels == kDmaChunkPixels && !flushPixels()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool fillColor565(uint16_t color, uint32_t pixelCount) {
+  if (sDmaReady) {
+    const uint8_t hi = static_cast<uint8_t>(color >> 8);
+    const uint8_t lo = static_cast<uint8_t>(color & 0xFF);
+    while (pixelCount > 0) {
+      DmaSlot* slot = acquireDmaSlot();
+      if (slot == nullptr) {
+        return false;
+      }
+      const size_t now = pixelCount > kDmaChunkPixels ? kDmaChunkPixels : pixelCount;
+      for (size_t i = 0; i < now; ++i) {
+        slot->buffer[i * 2] = hi;
+        slot->buffer[i * 2 + 1] = lo;
+      }
+      if (!queueDmaSlot(*slot, now * 2U)) {
+        return false;
+      }
+      pixelCount -= static_cast<uint32_t>(now);
+    }
+    return true;
+  }
+
   static constexpr size_t kChunkPixels = 96;
   uint8_t line[kChunkPixels * 2];
   const uint8_t hi = static_cast<uint8_t>(color >> 8);
@@ -280,6 +450,7 @@ bool init() {
 
   ESP_LOGI(kTag, "panel spi device ready cs=%d dc=%d rst=%d hz=%d", AppConfig::kTftCsPin,
            AppConfig::kTftDcPin, AppConfig::kTftRstPin, devCfg.clock_speed_hz);
+  (void)allocDmaSlots();
   return true;
 }
 
@@ -391,6 +562,68 @@ bool clear(uint16_t color565) {
   return fillRect(0, 0, logicalWidth(), logicalHeight(), color565);
 }
 
+bool pushImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels565) {
+  if (w == 0 || h == 0) {
+    return true;
+  }
+  if (pixels565 == nullptr) {
+    return false;
+  }
+  if (!sPanelInitialized && !initPanel()) {
+    return false;
+  }
+
+  const uint32_t panelW = logicalWidth();
+  const uint32_t panelH = logicalHeight();
+  if (x >= panelW || y >= panelH) {
+    return false;
+  }
+  const uint32_t cw = std::min<uint32_t>(w, panelW - x);
+  const uint32_t ch = std::min<uint32_t>(h, panelH - y);
+  if (!setAddressWindow(x, y, static_cast<uint16_t>(x + cw - 1U),
+                        static_cast<uint16_t>(y + ch - 1U))) {
+    return false;
+  }
+
+  bool ok = true;
+  if (cw == w) {
+    ok = appendPixels(pixels565, cw * ch);
+  } else {
+    for (uint32_t row = 0; ok && row < ch; ++row) {
+      ok = appendPixels(pixels565 + row * w, cw);
+    }
+  }
+  return flushPixels() && ok;
+}
+
+bool setWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  if (w == 0 || h == 0) {
+    return false;
+  }
+  if (!sPanelInitialized && !initPanel()) {
+    return false;
+  }
+  const uint32_t x1 = static_cast<uint32_t>(x) + w - 1U;
+  const uint32_t y1 = static_cast<uint32_t>(y) + h - 1U;
+  if (x1 >= logicalWidth() || y1 >= logicalHeight()) {
+    return false;
+  }
+  return setAddressWindow(x, y, static_cast<uint16_t>(x1), static_cast<uint16_t>(y1));
+}
+
+bool pushPixels(const uint16_t* pixels565, uint32_t count) {
+  if (count == 0) {
+    return true;
+  }
+  if (pixels565 == nullptr || !sPanelInitialized) {
+    return false;
+  }
+  const bool ok = appendPixels(pixels565, count);
+  return flushPixels() && ok;
+}
+
+bool waitIdle() { return flushPixels() && drainDmaQueue(); }
+
 uint16_t width() { return logicalWidth(); }
 
 uint16_t height() { return logicalHeight(); }
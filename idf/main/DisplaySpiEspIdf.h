@@ -9,6 +9,15 @@ bool initPanel();
 bool drawSanityPattern();
 bool fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color565);
 bool clear(uint16_t color565 = 0x0000);
+// Pixel pushes convert RGB565 into double-buffered DMA chunks and return once the last chunk
+// is queued, so the caller can rasterize the next band while it is on the wire. The source
+// buffer may be reused as soon as the call returns.
+bool pushImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels565);
+// Window for pushPixels(); must lie fully on the panel.
+bool setWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+bool pushPixels(const uint16_t* pixels565, uint32_t count);
+// Blocks until every queued transfer has completed.
+bool waitIdle();
 uint16_t width();
 uint16_t height();
 
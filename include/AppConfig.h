@@ -15,6 +15,32 @@ constexpr float kDefaultLatitude = 37.4220f;
 constexpr float kDefaultLongitude = -122.0841f;
 
 constexpr uint32_t kLoopDelayMs = 15;
+// Frame scheduler (core/FrameScheduler.h): no new widget render starts once a frame has used
+// kFrameBudgetMs; a dirty widget waiting longer than its class deadline counts as a miss.
+constexpr uint32_t kFrameBudgetMs = 20;
+constexpr uint32_t kModalDeadlineMs = 50;
+constexpr uint32_t kClockDeadlineMs = 250;
+constexpr uint32_t kDataDeadlineMs = 1000;
+constexpr uint32_t kFrameStatsLogPeriodMs = 30000;
+// Widget field cache (widgets/DslWidgetCache.cpp): after its first save of a boot a widget
+// rewrites its file at most every kFieldCacheWriteMinMs; files older than kFieldCacheMaxAgeS
+// are ignored once the clock is set.
+constexpr uint32_t kFieldCacheWriteMinMs = 300000;
+constexpr uint32_t kFieldCacheMaxAgeS = 24UL * 3600UL;
+// Poll scheduler (services/PollScheduler.h): kPollBudgetBurst requests may go back to back,
+// then one per kPollBudgetIntervalMs. Failing hosts back off from kPollBackoffBaseMs, doubling
+// up to kPollBackoffMaxMs; Retry-After is honoured up to kPollRetryAfterMaxMs. A TLS preflight
+// refusal (low heap, not the host's fault) retries after kPollLocalRetryMs.
+constexpr uint8_t kPollBudgetBurst = 6;
+constexpr uint32_t kPollBudgetIntervalMs = 1000;
+constexpr uint32_t kPollBackoffBaseMs = 3000;
+constexpr uint32_t kPollBackoffMaxMs = 120000;
+constexpr uint32_t kPollRetryAfterMaxMs = 600000;
+constexpr uint32_t kPollLocalRetryMs = 5000;
+// kTransportOutageThreshold transport failures in a row stop all requests for
+// kTransportOutageCooldownMs.
+constexpr uint8_t kTransportOutageThreshold = 6;
+constexpr uint32_t kTransportOutageCooldownMs = 12000;
 constexpr uint16_t kScreenWidth = 320;
 constexpr uint16_t kScreenHeight = 240;
 // Raw panel dimensions before software rotation.
@@ -1,6 +1,6 @@
 #pragma once
 
-#ifdef ARDUINO
+#if defined(ARDUINO) || defined(COSTAR_HOST)
 #include <Arduino.h>
 #include <FS.h>
 #endif
@@ -13,7 +13,7 @@ bool mkdir(const char* path);
 bool remove(const char* path);
 bool rename(const char* from, const char* to);
 
-#ifdef ARDUINO
+#if defined(ARDUINO) || defined(COSTAR_HOST)
 using File = ::fs::File;
 bool exists(const String& path);
 bool mkdir(const String& path);
@@ -22,4 +22,10 @@ bool rename(const String& from, const String& to);
 File open(const String& path, const char* mode = FILE_READ);
 #endif
 
+#ifdef COSTAR_HOST
+// Host build only: directory that stands in for the LittleFS root (defaults to
+// $COSTAR_HOST_FS_ROOT, then "data").
+void setHostRoot(const char* dir);
+#endif
+
 }  // namespace platform::fs
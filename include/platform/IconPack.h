@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Built-in icons packed into one read-only blob by tools/pack_icon_partition.py and flashed to
+// the "icons" partition. The device memory-maps the partition, so these icons are drawn
+// straight from flash without a filesystem open or a heap copy. Boards without the partition
+// (e.g. the default Arduino partition table) read the same icons from LittleFS instead.
+//
+// Blob layout (little-endian):
+//   0  "CIPK", version (uint16, 1), entry count (uint16), blob size (uint32), reserved (uint32)
+//  16  entries, 24 bytes each, sorted by hash then name:
+//        hash (uint32, FNV-1a of the path), name offset (uint32), name length (uint16),
+//        width (uint16), height (uint16), reserved (uint16), data offset (uint32),
+//        data length (uint32)
+//      then the names (LittleFS paths such as "/icons/meteocons/rain.raw", not terminated) and
+//      the icon files as stored on LittleFS (raw or packed, see widgets/DslIconCodec.h), each
+//      starting on a 4-byte boundary.
+namespace platform::iconpack {
+
+struct Icon {
+  const uint8_t* data = nullptr;
+  size_t bytes = 0;
+  uint16_t w = 0;
+  uint16_t h = 0;
+};
+
+// Maps the pack on first use; false when there is none (every find() then misses).
+bool begin();
+// Looks up a built-in icon by its LittleFS path.
+bool find(const char* path, Icon& out);
+
+#ifdef COSTAR_HOST
+// Host build only: blob file that stands in for the partition (defaults to
+// $COSTAR_HOST_ICON_PACK; none when unset). Takes effect on the next begin().
+void setHostPackFile(const char* path);
+#endif
+
+namespace format {
+
+constexpr size_t kHeaderBytes = 16;
+constexpr size_t kEntryBytes = 24;
+constexpr uint16_t kVersion = 1;
+
+inline uint16_t le16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+inline uint32_t le32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint32_t pathHash(const char* path, size_t len) {
+  uint32_t hash = 2166136261U;
+  for (size_t i = 0; i < len; ++i) {
+    hash ^= static_cast<uint8_t>(path[i]);
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+// Checks the header and that every entry points inside the blob, in order. A region larger than
+// the blob (a partition) is fine. Returns the blob size, or 0 when it is not a valid pack.
+inline size_t validate(const uint8_t* region, size_t regionSize) {
+  if (region == nullptr || regionSize < kHeaderBytes || memcmp(region, "CIPK", 4) != 0 ||
+      le16(region + 4) != kVersion) {
+    return 0;
+  }
+  const size_t count = le16(region + 6);
+  const size_t size = le32(region + 8);
+  if (size > regionSize || kHeaderBytes + count * kEntryBytes > size) {
+    return 0;
+  }
+  uint32_t lastHash = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const uint8_t* e = region + kHeaderBytes + i * kEntryBytes;
+    const uint32_t hash = le32(e);
+    const size_t nameOffset = le32(e + 4);
+    const size_t nameLength = le16(e + 8);
+    const size_t dataOffset = le32(e + 16);
+    const size_t dataLength = le32(e + 20);
+    if ((i > 0 && hash < lastHash) || nameOffset > size || nameLength > size - nameOffset ||
+        dataOffset > size || dataLength > size - dataOffset ||
+        pathHash(reinterpret_cast<const char*>(region + nameOffset), nameLength) != hash) {
+      return 0;
+    }
+    lastHash = hash;
+  }
+  return size;
+}
+
+// Binary search over a blob that passed validate().
+inline bool find(const uint8_t* blob, const char* path, Icon& out) {
+  if (blob == nullptr || path == nullptr) {
+    return false;
+  }
+  const size_t len = strlen(path);
+  const uint32_t hash = pathHash(path, len);
+  size_t lo = 0;
+  size_t hi = le16(blob + 6);
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (le32(blob + kHeaderBytes + mid * kEntryBytes) < hash) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  for (size_t i = lo; i < le16(blob + 6); ++i) {
+    const uint8_t* e = blob + kHeaderBytes + i * kEntryBytes;
+    if (le32(e) != hash) {
+      break;
+    }
+    if (le16(e + 8) != len || memcmp(blob + le32(e + 4), path, len) != 0) {
+      continue;
+    }
+    out.data = blob + le32(e + 16);
+    out.bytes = le32(e + 20);
+    out.w = le16(e + 10);
+    out.h = le16(e + 12);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace format
+}  // namespace platform::iconpack
@@ -2,10 +2,13 @@
 
 #include <ArduinoJson.h>
 
+#include <algorithm>
+
 #include "AppConfig.h"
 #include "core/WidgetFactory.h"
 #include "platform/Fs.h"
 #include "platform/Platform.h"
+#include "services/HttpRequestQueue.h"
 #include "widgets/DslRuntimeCaches.h"
 
 DisplayManager::DisplayManager(TFT_eSPI& tft, const String& layoutPath)
@@ -34,6 +37,8 @@ bool DisplayManager::begin() {
     return false;
   }
 
+  // Widgets only queue requests from the network task; the worker performs them.
+  httpq::begin();
   if (networkTaskHandle_ == nullptr) {
     xTaskCreatePinnedToCore(DisplayManager::networkTaskEntry, "widget-net", 8192, this, 1,
                             &networkTaskHandle_, 0);
@@ -51,8 +56,9 @@ void DisplayManager::loop(uint32_t nowMs) {
     if (!widget->isNetworkWidget()) {
       widget->tick(nowMs);
     }
-    widget->renderIfDirty(tft_);
   }
+  scheduler_.renderFrame(widgets_, tft_);
+  notePaintMilestones(nowMs);
 
   if (touchOverlay_) {
     tft_.drawRect(0, 0, AppConfig::kScreenWidth, AppConfig::kScreenHeight, TFT_MAGENTA);
@@ -60,6 +66,61 @@ void DisplayManager::loop(uint32_t nowMs) {
     tft_.drawString("Touch debug ON", 4, AppConfig::kScreenHeight - 16, 2);
   }
   xSemaphoreGive(widgetsMutex_);
+  scheduler_.maybeLog(nowMs);
+}
+
+FrameScheduler::Stats DisplayManager::frameStats() {
+  if (widgetsMutex_ == nullptr) {
+    return scheduler_.stats();
+  }
+  xSemaphoreTake(widgetsMutex_, portMAX_DELAY);
+  const FrameScheduler::Stats stats = scheduler_.stats();
+  xSemaphoreGive(widgetsMutex_);
+  return stats;
+}
+
+DisplayManager::PaintMilestones DisplayManager::paintMilestones() {
+  if (widgetsMutex_ == nullptr) {
+    return milestones_;
+  }
+  xSemaphoreTake(widgetsMutex_, portMAX_DELAY);
+  const PaintMilestones milestones = milestones_;
+  xSemaphoreGive(widgetsMutex_);
+  return milestones;
+}
+
+void DisplayManager::notePaintMilestones(uint32_t nowMs) {
+  if (milestones_.freshPaintMs != 0 || widgets_.empty()) {
+    return;
+  }
+  Widget::Content least = Widget::Content::kFresh;
+  size_t stale = 0;
+  for (const auto& widget : widgets_) {
+    if (widget->isDirty()) {
+      // Whatever it has now is not on screen yet.
+      return;
+    }
+    const Widget::Content content = widget->content();
+    if (content == Widget::Content::kStale) {
+      ++stale;
+    }
+    least = std::min(least, content);
+  }
+  if (least == Widget::Content::kNone) {
+    return;
+  }
+  const uint32_t elapsedMs = std::max<uint32_t>(1, nowMs - layoutStartMs_);
+  if (milestones_.firstPaintMs == 0) {
+    milestones_.firstPaintMs = elapsedMs;
+    platform::logf("[paint] layout=%s first_paint_ms=%lu stale_widgets=%u/%u\n",
+                   layoutPath_.c_str(), static_cast<unsigned long>(elapsedMs),
+                   static_cast<unsigned>(stale), static_cast<unsigned>(widgets_.size()));
+  }
+  if (least == Widget::Content::kFresh) {
+    milestones_.freshPaintMs = elapsedMs;
+    platform::logf("[paint] layout=%s fresh_paint_ms=%lu\n", layoutPath_.c_str(),
+                   static_cast<unsigned long>(elapsedMs));
+  }
 }
 
 bool DisplayManager::reloadLayout() {
@@ -128,6 +189,8 @@ bool DisplayManager::loadLayout() {
   xSemaphoreTake(widgetsMutex_, portMAX_DELAY);
   widgets_.clear();
   clearDslRuntimeCaches();
+  layoutStartMs_ = platform::millisMs();
+  milestones_ = PaintMilestones();
 
   platform::fs::File manifest = platform::fs::open(layoutPath_, FILE_READ);
   if (!manifest || manifest.isDirectory()) {
@@ -191,6 +254,7 @@ bool DisplayManager::loadLayout() {
   for (const auto& widget : widgets_) {
     widget->forceRender(tft_);
   }
+  notePaintMilestones(platform::millisMs());
   xSemaphoreGive(widgetsMutex_);
   return true;
 }
@@ -9,10 +9,18 @@
 #include <memory>
 #include <vector>
 
+#include "FrameScheduler.h"
 #include "Widget.h"
 
 class DisplayManager {
  public:
+  // Milestones of the current layout in ms since it started loading, 0 until reached: every
+  // widget on screen with something to show (cached fields count), then with fresh data.
+  struct PaintMilestones {
+    uint32_t firstPaintMs = 0;
+    uint32_t freshPaintMs = 0;
+  };
+
   DisplayManager(TFT_eSPI& tft, const String& layoutPath);
   ~DisplayManager();
 
@@ -22,6 +30,8 @@ class DisplayManager {
   bool reloadLayout(const String& layoutPath);
   void setLayoutPath(const String& layoutPath);
   void onTouch(uint16_t rawX, uint16_t rawY);
+  FrameScheduler::Stats frameStats();
+  PaintMilestones paintMilestones();
 
  private:
   static void networkTaskEntry(void* arg);
@@ -31,10 +41,14 @@ class DisplayManager {
   bool parseRegionConfig(const JsonObjectConst& region, const JsonObjectConst& widgetDefs,
                          WidgetConfig& outCfg) const;
   void drawBootMessage(const String& line1, const String& line2 = "");
+  void notePaintMilestones(uint32_t nowMs);
 
   TFT_eSPI& tft_;
   String layoutPath_;
   std::vector<std::unique_ptr<Widget>> widgets_;
+  FrameScheduler scheduler_;
+  uint32_t layoutStartMs_ = 0;
+  PaintMilestones milestones_;
   bool touchOverlay_ = false;
   TaskHandle_t networkTaskHandle_ = nullptr;
   SemaphoreHandle_t widgetsMutex_ = nullptr;
@@ -0,0 +1,142 @@
+#include "core/FrameScheduler.h"
+
+#include <Arduino.h>
+
+#include <algorithm>
+
+#include "AppConfig.h"
+#include "platform/Platform.h"
+
+namespace {
+
+uint32_t percentile(const uint32_t* sorted, size_t count, uint32_t pct) {
+  if (count == 0) {
+    return 0;
+  }
+  const size_t index = (count * pct + 99) / 100;
+  return sorted[index == 0 ? 0 : index - 1];
+}
+
+}  // namespace
+
+uint32_t FrameScheduler::deadlineMs(Widget::RenderClass cls) {
+  switch (cls) {
+    case Widget::RenderClass::kModal:
+      return AppConfig::kModalDeadlineMs;
+    case Widget::RenderClass::kClock:
+      return AppConfig::kClockDeadlineMs;
+    case Widget::RenderClass::kData:
+    default:
+      return AppConfig::kDataDeadlineMs;
+  }
+}
+
+void FrameScheduler::renderFrame(const std::vector<std::unique_ptr<Widget>>& widgets,
+                                 TFT_eSPI& tft) {
+  const uint32_t startUs = micros();
+  const uint32_t nowMs = platform::millisMs();
+
+  queue_.clear();
+  for (size_t i = 0; i < widgets.size(); ++i) {
+    Widget* widget = widgets[i].get();
+    if (widget == nullptr || !widget->isDirty()) {
+      continue;
+    }
+    const Widget::RenderClass cls = widget->renderClass();
+    const uint32_t dueMs = widget->dirtySinceMs() + deadlineMs(cls);
+    // Overdue widgets go first so a busy clock cannot starve a data widget indefinitely.
+    const bool overdue = static_cast<int32_t>(nowMs - dueMs) >= 0;
+    const uint8_t rank =
+        static_cast<uint8_t>((overdue ? 0 : Widget::kRenderClassCount) + static_cast<uint8_t>(cls));
+    queue_.push_back({widget, rank, dueMs, static_cast<uint16_t>(i)});
+  }
+  if (queue_.empty()) {
+    return;
+  }
+  std::sort(queue_.begin(), queue_.end(), [](const Pending& a, const Pending& b) {
+    if (a.rank != b.rank) {
+      return a.rank < b.rank;
+    }
+    if (a.dueMs != b.dueMs) {
+      return static_cast<int32_t>(a.dueMs - b.dueMs) < 0;
+    }
+    return a.order < b.order;
+  });
+
+  const uint32_t budgetUs = AppConfig::kFrameBudgetMs * 1000UL;
+  bool rendered = false;
+  for (size_t i = 0; i < queue_.size(); ++i) {
+    // Always start at least one render so a slow widget still makes progress.
+    if (rendered && micros() - startUs >= budgetUs) {
+      stats_.deferred += static_cast<uint32_t>(queue_.size() - i);
+      break;
+    }
+    Widget* widget = queue_[i].widget;
+    const uint32_t marks = widget->dirtyMarks();
+    const uint8_t cls = queue_[i].rank % Widget::kRenderClassCount;
+    const uint32_t dueMs = queue_[i].dueMs;
+    if (!widget->renderIfDirty(tft)) {
+      // Busy on the network task; retried next frame.
+      continue;
+    }
+    rendered = true;
+    ++stats_.renders;
+    if (marks > 1) {
+      stats_.coalesced += marks - 1;
+    }
+    if (static_cast<int32_t>(platform::millisMs() - dueMs) > 0) {
+      ++stats_.misses[cls];
+    }
+  }
+  if (!rendered) {
+    return;
+  }
+
+  const uint32_t frameUs = micros() - startUs;
+  ++stats_.frames;
+  if (frameUs > budgetUs) {
+    ++stats_.overBudget;
+  }
+  stats_.maxUs = std::max(stats_.maxUs, frameUs);
+  samples_[nextSample_] = frameUs;
+  nextSample_ = (nextSample_ + 1) % kWindow;
+  sampleCount_ = std::min(sampleCount_ + 1, kWindow);
+}
+
+void FrameScheduler::updatePercentiles() {
+  std::copy(samples_, samples_ + sampleCount_, sorted_);
+  std::sort(sorted_, sorted_ + sampleCount_);
+  stats_.p50Us = percentile(sorted_, sampleCount_, 50);
+  stats_.p90Us = percentile(sorted_, sampleCount_, 90);
+  stats_.p99Us = percentile(sorted_, sampleCount_, 99);
+}
+
+FrameScheduler::Stats FrameScheduler::stats() {
+  updatePercentiles();
+  return stats_;
+}
+
+void FrameScheduler::maybeLog(uint32_t nowMs) {
+  if ((nowMs - lastLogMs_) < AppConfig::kFrameStatsLogPeriodMs) {
+    return;
+  }
+  lastLogMs_ = nowMs;
+  if (stats_.frames == 0) {
+    return;
+  }
+
+  updatePercentiles();
+  platform::logf("[frame] p50_us=%lu p90_us=%lu p99_us=%lu max_us=%lu frames=%lu renders=%lu "
+                 "deferred=%lu coalesced=%lu over_budget=%lu miss_modal=%lu miss_clock=%lu "
+                 "miss_data=%lu\n",
+                 static_cast<unsigned long>(stats_.p50Us), static_cast<unsigned long>(stats_.p90Us),
+                 static_cast<unsigned long>(stats_.p99Us), static_cast<unsigned long>(stats_.maxUs),
+                 static_cast<unsigned long>(stats_.frames),
+                 static_cast<unsigned long>(stats_.renders),
+                 static_cast<unsigned long>(stats_.deferred),
+                 static_cast<unsigned long>(stats_.coalesced),
+                 static_cast<unsigned long>(stats_.overBudget),
+                 static_cast<unsigned long>(stats_.misses[0]),
+                 static_cast<unsigned long>(stats_.misses[1]),
+                 static_cast<unsigned long>(stats_.misses[2]));
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <TFT_eSPI.h>
+
+#include <memory>
+#include <vector>
+
+#include "Widget.h"
+
+// Decides which dirty widgets DisplayManager renders each frame. Widgets are taken in priority
+// order (open modals, then clocks, then data widgets; anything already past its deadline
+// first) until the frame budget is spent; the rest stay dirty for the next frame, so repeated
+// dirty marks collapse into one render. Frame times and deadline misses are logged as
+// "[frame] ..." lines.
+class FrameScheduler {
+ public:
+  struct Stats {
+    uint32_t frames = 0;          // frames that rendered at least one widget
+    uint32_t renders = 0;
+    uint32_t deferred = 0;        // renders pushed to a later frame by the budget
+    uint32_t coalesced = 0;       // dirty marks absorbed by an already pending render
+    uint32_t overBudget = 0;      // frames that took longer than the budget
+    uint32_t misses[Widget::kRenderClassCount] = {};
+    uint32_t p50Us = 0;           // frame time percentiles over the recent window
+    uint32_t p90Us = 0;
+    uint32_t p99Us = 0;
+    uint32_t maxUs = 0;
+  };
+
+  void renderFrame(const std::vector<std::unique_ptr<Widget>>& widgets, TFT_eSPI& tft);
+  // Logs a stats line at most once per period.
+  void maybeLog(uint32_t nowMs);
+  // Totals since start, with percentiles over the last kWindow frames.
+  Stats stats();
+
+  static uint32_t deadlineMs(Widget::RenderClass cls);
+
+ private:
+  static constexpr size_t kWindow = 128;
+
+  struct Pending {
+    Widget* widget;
+    uint8_t rank;
+    uint32_t dueMs;
+    uint16_t order;
+  };
+
+  void updatePercentiles();
+
+  std::vector<Pending> queue_;
+  uint32_t samples_[kWindow] = {};
+  uint32_t sorted_[kWindow] = {};
+  size_t sampleCount_ = 0;
+  size_t nextSample_ = 0;
+  Stats stats_;
+  uint32_t lastLogMs_ = 0;
+};
@@ -12,6 +12,11 @@
 class Widget {
  public:
   enum class TouchType : uint8_t { kTap };
+  // Frame scheduler class (core/FrameScheduler.h), most urgent first.
+  enum class RenderClass : uint8_t { kModal, kClock, kData };
+  static constexpr size_t kRenderClassCount = 3;
+  // What the widget has to show since begin(), for the paint milestones in DisplayManager.
+  enum class Content : uint8_t { kNone, kStale, kFresh };
 
   explicit Widget(const WidgetConfig& cfg) : config_(cfg) { mutex_ = xSemaphoreCreateMutex(); }
   virtual ~Widget() {
@@ -23,11 +28,15 @@ class Widget {
 
   virtual void begin() {
     dirty_ = true;
+    dirtySinceMs_ = platform::millisMs();
+    dirtyMarks_ = 1;
     // Force first update immediately instead of waiting a full polling interval.
     lastUpdateMs_ = platform::millisMs() - config_.updateMs;
   }
   virtual bool isNetworkWidget() const { return false; }
   virtual bool wantsImmediateUpdate() const { return false; }
+  virtual RenderClass renderClass() const { return RenderClass::kData; }
+  virtual Content content() const { return Content::kFresh; }
   virtual bool onTouch(uint16_t localX, uint16_t localY, TouchType type) {
     (void)localX;
     (void)localY;
@@ -47,16 +56,19 @@ class Widget {
 
     lastUpdateMs_ = nowMs;
     if (update(nowMs)) {
-      dirty_ = true;
+      noteDirty();
     }
     xSemaphoreGive(mutex_);
   }
 
   bool isDirty() const { return dirty_; }
+  // When the pending render was first requested, and how many dirty marks it covers.
+  uint32_t dirtySinceMs() const { return dirtySinceMs_; }
+  uint32_t dirtyMarks() const { return dirtyMarks_; }
   const WidgetConfig& config() const { return config_; }
 
   void clearDirty() { dirty_ = false; }
-  void markDirty() { dirty_ = true; }
+  void markDirty() { noteDirty(); }
 
   bool renderIfDirty(TFT_eSPI& tft) {
     if (!dirty_ || mutex_ == nullptr) {
@@ -78,21 +90,26 @@ class Widget {
     return false;
   }
 
+  // Full repaint for when the panel under the widget may have been drawn over.
   void forceRender(TFT_eSPI& tft) {
     if (mutex_ != nullptr) {
       xSemaphoreTake(mutex_, portMAX_DELAY);
+      invalidatePanel();
       render(tft);
       dirty_ = false;
       xSemaphoreGive(mutex_);
       return;
     }
 
+    invalidatePanel();
     render(tft);
     dirty_ = false;
   }
 
   virtual bool update(uint32_t nowMs) = 0;
   virtual void render(TFT_eSPI& tft) = 0;
+  // Widgets that repaint only what changed must drop that state here.
+  virtual void invalidatePanel() {}
 
  protected:
   String widgetName() const {
@@ -102,7 +119,7 @@ class Widget {
     return config_.type;
   }
 
-  String logTimestamp() const {
+  static String logTimestamp() {
     const time_t now = time(nullptr);
     if (now > 946684800) {
       struct tm nowTm;
@@ -124,6 +141,15 @@ class Widget {
                    logTimestamp().c_str(), statusCode);
   }
 
+  void noteDirty() {
+    if (!dirty_) {
+      dirty_ = true;
+      dirtySinceMs_ = platform::millisMs();
+      dirtyMarks_ = 0;
+    }
+    ++dirtyMarks_;
+  }
+
   void drawPanel(TFT_eSPI& tft, const String& title) const {
     (void)title;
     tft.fillRect(config_.x, config_.y, config_.w, config_.h, TFT_BLACK);
@@ -134,6 +160,8 @@ class Widget {
 
   const WidgetConfig config_;
   bool dirty_ = true;
+  uint32_t dirtySinceMs_ = 0;
+  uint32_t dirtyMarks_ = 0;
   uint32_t lastUpdateMs_ = 0;
   SemaphoreHandle_t mutex_ = nullptr;
 };
@@ -32,6 +32,126 @@ bool parseIdentifier(const String& s, int& pos, String& out) {
   return true;
 }
 
+struct FunctionInfo {
+  const char* name;
+  ExprFn fn;
+  uint8_t arity;
+};
+
+constexpr FunctionInfo kFunctions[] = {
+    {"sin", ExprFn::kSin, 1},
+    {"cos", ExprFn::kCos, 1},
+    {"tan", ExprFn::kTan, 1},
+    {"asin", ExprFn::kAsin, 1},
+    {"acos", ExprFn::kAcos, 1},
+    {"atan", ExprFn::kAtan, 1},
+    {"abs", ExprFn::kAbs, 1},
+    {"sqrt", ExprFn::kSqrt, 1},
+    {"floor", ExprFn::kFloor, 1},
+    {"ceil", ExprFn::kCeil, 1},
+    {"round", ExprFn::kRound, 1},
+    {"min", ExprFn::kMin, 2},
+    {"max", ExprFn::kMax, 2},
+    {"pow", ExprFn::kPow, 2},
+    {"rad", ExprFn::kRad, 1},
+    {"deg", ExprFn::kDeg, 1},
+    {"haversine_m", ExprFn::kHaversineM, 4},
+    {"meters_to_miles", ExprFn::kMetersToMiles, 1},
+    {"miles_to_meters", ExprFn::kMilesToMeters, 1},
+};
+
+constexpr int kMaxArgs = 4;
+
+bool lookupFunction(const String& name, ExprFn& fn, uint8_t& arity) {
+  for (const FunctionInfo& info : kFunctions) {
+    if (name == info.name) {
+      fn = info.fn;
+      arity = info.arity;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool applyFunction(ExprFn fn, const float* args, float& out) {
+  const float degToRad = static_cast<float>(M_PI / 180.0);
+  const float a = args[0];
+  const float b = args[1];
+  switch (fn) {
+    case ExprFn::kSin:
+      out = sinf(a * degToRad);
+      return true;
+    case ExprFn::kCos:
+      out = cosf(a * degToRad);
+      return true;
+    case ExprFn::kTan:
+      out = tanf(a * degToRad);
+      return true;
+    case ExprFn::kAsin:
+      out = asinf(a) / degToRad;
+      return true;
+    case ExprFn::kAcos:
+      out = acosf(a) / degToRad;
+      return true;
+    case ExprFn::kAtan:
+      out = atanf(a) / degToRad;
+      return true;
+    case ExprFn::kAbs:
+      out = fabsf(a);
+      return true;
+    case ExprFn::kSqrt:
+      if (a < 0.0f) return false;
+      out = sqrtf(a);
+      return true;
+    case ExprFn::kFloor:
+      out = floorf(a);
+      return true;
+    case ExprFn::kCeil:
+      out = ceilf(a);
+      return true;
+    case ExprFn::kRound:
+      out = roundf(a);
+      return true;
+    case ExprFn::kMin:
+      out = fminf(a, b);
+      return true;
+    case ExprFn::kMax:
+      out = fmaxf(a, b);
+      return true;
+    case ExprFn::kPow:
+      out = powf(a, b);
+      return true;
+    case ExprFn::kRad:
+      out = a * degToRad;
+      return true;
+    case ExprFn::kDeg:
+      out = a / degToRad;
+      return true;
+    case ExprFn::kHaversineM: {
+      const float lat1 = args[0];
+      const float lon1 = args[1];
+      const float lat2 = args[2];
+      const float lon2 = args[3];
+      const float dLat = (lat2 - lat1) * degToRad;
+      const float dLon = (lon2 - lon1) * degToRad;
+      const float s1 = sinf(dLat * 0.5f);
+      const float s2 = sinf(dLon * 0.5f);
+      float hv = (s1 * s1) + cosf(lat1 * degToRad) * cosf(lat2 * degToRad) * (s2 * s2);
+      hv = fmaxf(0.0f, fminf(1.0f, hv));
+      const float c = 2.0f * atan2f(sqrtf(hv), sqrtf(fmaxf(0.0f, 1.0f - hv)));
+      out = 6371000.0f * c;
+      return true;
+    }
+    case ExprFn::kMetersToMiles:
+      out = a * 0.000621371f;
+      return true;
+    case ExprFn::kMilesToMeters:
+      out = a * 1609.344f;
+      return true;
+  }
+  return false;
+}
+
 bool parseExpr(const String& s, int& pos, const ExprContext& ctx, float& out);
 
 bool parseFunction(const String& name, const String& s, int& pos, const ExprContext& ctx, float& out) {
@@ -42,7 +162,7 @@ bool parseFunction(const String& name, const String& s, int& pos, const ExprCont
   ++pos;
   skipSpaces(s, pos);
 
-  float args[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  float args[kMaxArgs] = {0.0f, 0.0f, 0.0f, 0.0f};
   int argc = 0;
 
   if (pos < s.length() && s[pos] == ')') {
@@ -50,7 +170,7 @@ bool parseFunction(const String& name, const String& s, int& pos, const ExprCont
     argc = 0;
   } else {
     while (true) {
-      if (argc >= 4) {
+      if (argc >= kMaxArgs) {
         return false;
       }
       if (!parseExpr(s, pos, ctx, args[argc])) {
@@ -71,117 +191,12 @@ bool parseFunction(const String& name, const String& s, int& pos, const ExprCont
     }
   }
 
-  const float degToRad = static_cast<float>(M_PI / 180.0);
-  const float a = args[0];
-  const float b = args[1];
-  if (name == "sin") {
-    if (argc != 1) return false;
-    out = sinf(a * degToRad);
-    return true;
-  }
-  if (name == "cos") {
-    if (argc != 1) return false;
-    out = cosf(a * degToRad);
-    return true;
-  }
-  if (name == "tan") {
-    if (argc != 1) return false;
-    out = tanf(a * degToRad);
-    return true;
-  }
-  if (name == "asin") {
-    if (argc != 1) return false;
-    out = asinf(a) / degToRad;
-    return true;
-  }
-  if (name == "acos") {
-    if (argc != 1) return false;
-    out = acosf(a) / degToRad;
-    return true;
-  }
-  if (name == "atan") {
-    if (argc != 1) return false;
-    out = atanf(a) / degToRad;
-    return true;
-  }
-  if (name == "abs") {
-    if (argc != 1) return false;
-    out = fabsf(a);
-    return true;
-  }
-  if (name == "sqrt") {
-    if (argc != 1 || a < 0.0f) return false;
-    out = sqrtf(a);
-    return true;
-  }
-  if (name == "floor") {
-    if (argc != 1) return false;
-    out = floorf(a);
-    return true;
-  }
-  if (name == "ceil") {
-    if (argc != 1) return false;
-    out = ceilf(a);
-    return true;
-  }
-  if (name == "round") {
-    if (argc != 1) return false;
-    out = roundf(a);
-    return true;
-  }
-  if (name == "min") {
-    if (argc != 2) return false;
-    out = fminf(a, b);
-    return true;
-  }
-  if (name == "max") {
-    if (argc != 2) return false;
-    out = fmaxf(a, b);
-    return true;
-  }
-  if (name == "pow") {
-    if (argc != 2) return false;
-    out = powf(a, b);
-    return true;
-  }
-  if (name == "rad") {
-    if (argc != 1) return false;
-    out = a * degToRad;
-    return true;
-  }
-  if (name == "deg") {
-    if (argc != 1) return false;
-    out = a / degToRad;
-    return true;
-  }
-  if (name == "haversine_m") {
-    if (argc != 4) return false;
-    const float lat1 = args[0];
-    const float lon1 = args[1];
-    const float lat2 = args[2];
-    const float lon2 = args[3];
-    const float dLat = (lat2 - lat1) * degToRad;
-    const float dLon = (lon2 - lon1) * degToRad;
-    const float s1 = sinf(dLat * 0.5f);
-    const float s2 = sinf(dLon * 0.5f);
-    float hv = (s1 * s1) + cosf(lat1 * degToRad) * cosf(lat2 * degToRad) * (s2 * s2);
-    hv = fmaxf(0.0f, fminf(1.0f, hv));
-    const float c = 2.0f * atan2f(sqrtf(hv), sqrtf(fmaxf(0.0f, 1.0f - hv)));
-    out = 6371000.0f * c;
-    return true;
-  }
-  if (name == "meters_to_miles") {
-    if (argc != 1) return false;
-    out = a * 0.000621371f;
-    return true;
-  }
-  if (name == "miles_to_meters") {
-    if (argc != 1) return false;
-    out = a * 1609.344f;
-    return true;
+  ExprFn fn = ExprFn::kSin;
+  uint8_t arity = 0;
+  if (!lookupFunction(name, fn, arity) || argc != arity) {
+    return false;
   }
-
-  return false;
+  return applyFunction(fn, args, out);
 }
 
 bool resolveVariable(const ExprContext& ctx, const String& name, float& out) {
@@ -302,6 +317,209 @@ bool parseExpr(const String& s, int& pos, const ExprContext& ctx, float& out) {
   return true;
 }
 
+constexpr size_t kMaxExprStack = 16;
+constexpr size_t kMaxExprSlots = 32;
+
+// Recursive-descent compiler with the same grammar as parseExpr/parseTerm/parseFactor above,
+// emitting postfix code instead of evaluating.
+class ExprCompiler {
+ public:
+  ExprCompiler(const String& s, CompiledExpr& out) : s_(s), out_(out) {}
+
+  bool compile(String& error) {
+    bool ok = expr();
+    if (ok) {
+      skipSpaces(s_, pos_);
+      ok = pos_ == s_.length();
+    }
+    if (!ok) {
+      error = error_.isEmpty() ? String("expr syntax error at ") + String(pos_) : error_;
+    }
+    return ok;
+  }
+
+ private:
+  bool fail(const char* message) {
+    if (error_.isEmpty()) {
+      error_ = message;
+    }
+    return false;
+  }
+
+  bool emit(ExprOp op, int stackDelta, uint8_t operand = 0, ExprFn fn = ExprFn::kSin) {
+    ExprInstr instr;
+    instr.op = op;
+    instr.fn = fn;
+    instr.operand = operand;
+    out_.code.push_back(instr);
+    depth_ += stackDelta;
+    if (depth_ > static_cast<int>(kMaxExprStack)) {
+      return fail("expr too deep");
+    }
+    if (depth_ > out_.maxStack) {
+      out_.maxStack = static_cast<uint8_t>(depth_);
+    }
+    return true;
+  }
+
+  bool emitConst(float value) {
+    if (out_.constants.size() >= kMaxExprSlots) {
+      return fail("expr has too many constants");
+    }
+    out_.constants.push_back(value);
+    return emit(ExprOp::kConst, 1, static_cast<uint8_t>(out_.constants.size() - 1));
+  }
+
+  bool emitVar(const String& name) {
+    for (size_t i = 0; i < out_.vars.size(); ++i) {
+      if (out_.vars[i] == name) {
+        return emit(ExprOp::kVar, 1, static_cast<uint8_t>(i));
+      }
+    }
+    if (out_.vars.size() >= kMaxExprSlots) {
+      return fail("expr has too many variables");
+    }
+    out_.vars.push_back(name);
+    return emit(ExprOp::kVar, 1, static_cast<uint8_t>(out_.vars.size() - 1));
+  }
+
+  bool function(const String& name) {
+    ExprFn fn = ExprFn::kSin;
+    uint8_t arity = 0;
+    if (!lookupFunction(name, fn, arity)) {
+      return fail("expr unknown function");
+    }
+    ++pos_;
+    skipSpaces(s_, pos_);
+
+    int argc = 0;
+    if (pos_ < s_.length() && s_[pos_] == ')') {
+      ++pos_;
+    } else {
+      while (true) {
+        if (argc >= kMaxArgs) {
+          return false;
+        }
+        if (!expr()) {
+          return false;
+        }
+        ++argc;
+        skipSpaces(s_, pos_);
+        if (pos_ < s_.length() && s_[pos_] == ',') {
+          ++pos_;
+          skipSpaces(s_, pos_);
+          continue;
+        }
+        if (pos_ >= s_.length() || s_[pos_] != ')') {
+          return false;
+        }
+        ++pos_;
+        break;
+      }
+    }
+    if (argc != arity) {
+      return fail("expr wrong argument count");
+    }
+    return emit(ExprOp::kCall, 1 - argc, static_cast<uint8_t>(argc), fn);
+  }
+
+  bool factor() {
+    skipSpaces(s_, pos_);
+    if (pos_ >= s_.length()) {
+      return false;
+    }
+
+    if (s_[pos_] == '(') {
+      ++pos_;
+      if (!expr()) {
+        return false;
+      }
+      skipSpaces(s_, pos_);
+      if (pos_ >= s_.length() || s_[pos_] != ')') {
+        return false;
+      }
+      ++pos_;
+      return true;
+    }
+
+    if (s_[pos_] == '+' || s_[pos_] == '-') {
+      const char sign = s_[pos_++];
+      if (!factor()) {
+        return false;
+      }
+      return sign == '-' ? emit(ExprOp::kNeg, 0) : true;
+    }
+
+    if ((s_[pos_] >= '0' && s_[pos_] <= '9') || s_[pos_] == '.') {
+      const int start = pos_;
+      while (pos_ < s_.length() && ((s_[pos_] >= '0' && s_[pos_] <= '9') || s_[pos_] == '.')) {
+        ++pos_;
+      }
+      return emitConst(s_.substring(start, pos_).toFloat());
+    }
+
+    String ident;
+    if (parseIdentifier(s_, pos_, ident)) {
+      skipSpaces(s_, pos_);
+      if (pos_ < s_.length() && s_[pos_] == '(') {
+        return function(ident);
+      }
+      if (ident == "pi") {
+        return emitConst(static_cast<float>(M_PI));
+      }
+      return emitVar(ident);
+    }
+
+    return false;
+  }
+
+  bool term() {
+    if (!factor()) {
+      return false;
+    }
+    for (;;) {
+      skipSpaces(s_, pos_);
+      if (pos_ >= s_.length() || (s_[pos_] != '*' && s_[pos_] != '/' && s_[pos_] != '%')) {
+        break;
+      }
+      const char op = s_[pos_++];
+      if (!factor()) {
+        return false;
+      }
+      if (!emit(op == '*' ? ExprOp::kMul : (op == '/' ? ExprOp::kDiv : ExprOp::kMod), -1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool expr() {
+    if (!term()) {
+      return false;
+    }
+    for (;;) {
+      skipSpaces(s_, pos_);
+      if (pos_ >= s_.length() || (s_[pos_] != '+' && s_[pos_] != '-')) {
+        break;
+      }
+      const char op = s_[pos_++];
+      if (!term()) {
+        return false;
+      }
+      if (!emit(op == '+' ? ExprOp::kAdd : ExprOp::kSub, -1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const String& s_;
+  CompiledExpr& out_;
+  int pos_ = 0;
+  int depth_ = 0;
+  String error_;
+};
+
 }  // namespace
 
 bool evalExpression(const String& expr, const ExprContext& ctx, float& out) {
@@ -318,4 +536,95 @@ bool evalExpression(const String& expr, const ExprContext& ctx, float& out) {
   return true;
 }
 
+bool compileExpression(const String& expr, CompiledExpr& out, String* error) {
+  out = CompiledExpr();
+  String err;
+  ExprCompiler compiler(expr, out);
+  if (!compiler.compile(err)) {
+    out = CompiledExpr();
+    if (error != nullptr) {
+      *error = err;
+    }
+    return false;
+  }
+  out.valid = true;
+  return true;
+}
+
+bool evalCompiled(const CompiledExpr& expr, const ExprContext& ctx, float& out) {
+  if (!expr.valid) {
+    return false;
+  }
+  float stack[kMaxExprStack];
+  float vars[kMaxExprSlots];
+  uint32_t resolved = 0;
+  size_t sp = 0;
+
+  for (const ExprInstr& instr : expr.code) {
+    switch (instr.op) {
+      case ExprOp::kConst:
+        stack[sp++] = expr.constants[instr.operand];
+        break;
+      case ExprOp::kVar: {
+        const uint32_t bit = 1UL << instr.operand;
+        if ((resolved & bit) == 0) {
+          if (!ctx.resolver || !ctx.resolver(ctx.ctx, expr.vars[instr.operand], vars[instr.operand])) {
+            return false;
+          }
+          resolved |= bit;
+        }
+        stack[sp++] = vars[instr.operand];
+        break;
+      }
+      case ExprOp::kNeg:
+        stack[sp - 1] = -stack[sp - 1];
+        break;
+      case ExprOp::kAdd:
+        --sp;
+        stack[sp - 1] += stack[sp];
+        break;
+      case ExprOp::kSub:
+        --sp;
+        stack[sp - 1] -= stack[sp];
+        break;
+      case ExprOp::kMul:
+        --sp;
+        stack[sp - 1] *= stack[sp];
+        break;
+      case ExprOp::kDiv:
+        --sp;
+        if (fabsf(stack[sp]) < 0.000001f) {
+          return false;
+        }
+        stack[sp - 1] /= stack[sp];
+        break;
+      case ExprOp::kMod:
+        --sp;
+        if (fabsf(stack[sp]) < 0.000001f) {
+          return false;
+        }
+        stack[sp - 1] = fmodf(stack[sp - 1], stack[sp]);
+        break;
+      case ExprOp::kCall: {
+        const uint8_t argc = instr.operand;
+        float args[kMaxArgs] = {0.0f, 0.0f, 0.0f, 0.0f};
+        sp -= argc;
+        for (uint8_t i = 0; i < argc; ++i) {
+          args[i] = stack[sp + i];
+        }
+        if (!applyFunction(instr.fn, args, stack[sp])) {
+          return false;
+        }
+        ++sp;
+        break;
+      }
+    }
+  }
+  if (sp != 1) {
+    return false;
+  }
+  out = stack[0];
+  return true;
+}
+
 }  // namespace dsl
@@ -2,6 +2,8 @@
 
 #include <Arduino.h>
 
+#include <vector>
+
 namespace dsl {
 
 using VarResolver = bool (*)(void* ctx, const String& name, float& out);
@@ -13,4 +15,58 @@ struct ExprContext {
 
 bool evalExpression(const String& expr, const ExprContext& ctx, float& out);
 
+enum class ExprOp : uint8_t {
+  kConst,
+  kVar,
+  kNeg,
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kMod,
+  kCall,
+};
+
+enum class ExprFn : uint8_t {
+  kSin,
+  kCos,
+  kTan,
+  kAsin,
+  kAcos,
+  kAtan,
+  kAbs,
+  kSqrt,
+  kFloor,
+  kCeil,
+  kRound,
+  kMin,
+  kMax,
+  kPow,
+  kRad,
+  kDeg,
+  kHaversineM,
+  kMetersToMiles,
+  kMilesToMeters,
+};
+
+struct ExprInstr {
+  ExprOp op = ExprOp::kConst;
+  ExprFn fn = ExprFn::kSin;
+  // Constant index for kConst, variable slot for kVar, argument count for kCall.
+  uint8_t operand = 0;
+};
+
+// Postfix program produced by compileExpression. Variables are interned into slots and each
+// slot is resolved at most once per evaluation.
+struct CompiledExpr {
+  std::vector<ExprInstr> code;
+  std::vector<float> constants;
+  std::vector<String> vars;
+  uint8_t maxStack = 0;
+  bool valid = false;
+};
+
+bool compileExpression(const String& expr, CompiledExpr& out, String* error = nullptr);
+bool evalCompiled(const CompiledExpr& expr, const ExprContext& ctx, float& out);
+
 }  // namespace dsl
@@ -0,0 +1,298 @@
+#include "dsl/DslFetchFilter.h"
+
+#include <map>
+#include <vector>
+
+namespace dsl {
+namespace {
+
+struct FilterNode {
+  enum class Kind : uint8_t { kEmpty, kAll, kObject, kArray };
+  Kind kind = Kind::kEmpty;
+  std::map<String, FilterNode> members;
+  // Single element filter when kind == kArray.
+  std::vector<FilterNode> element;
+};
+
+void keepAll(FilterNode& node) {
+  node.kind = FilterNode::Kind::kAll;
+  node.members.clear();
+  node.element.clear();
+}
+
+// Returns the child for `key`, or nullptr when the subtree is already kept in full.
+FilterNode* objectChild(FilterNode& node, const String& key) {
+  if (node.kind == FilterNode::Kind::kAll) {
+    return nullptr;
+  }
+  if (node.kind == FilterNode::Kind::kArray) {
+    // The same value is addressed both as array and object; keep it whole.
+    keepAll(node);
+    return nullptr;
+  }
+  node.kind = FilterNode::Kind::kObject;
+  return &node.members[key];
+}
+
+FilterNode* arrayElement(FilterNode& node) {
+  if (node.kind == FilterNode::Kind::kAll) {
+    return nullptr;
+  }
+  if (node.kind == FilterNode::Kind::kObject) {
+    keepAll(node);
+    return nullptr;
+  }
+  node.kind = FilterNode::Kind::kArray;
+  if (node.element.empty()) {
+    node.element.emplace_back();
+  }
+  return &node.element.front();
+}
+
+// Walks `path` (resolveVariantPath syntax) from `node`. Returns the node the path ends on, or
+// nullptr when nothing needs to be added (already covered, or the path can never resolve).
+FilterNode* descend(FilterNode& node, const String& path) {
+  String workPath = path;
+  workPath.trim();
+  FilterNode* current = &node;
+  int segStart = 0;
+  while (segStart < workPath.length()) {
+    int segEnd = workPath.indexOf('.', segStart);
+    if (segEnd < 0) {
+      segEnd = workPath.length();
+    }
+    const String seg = workPath.substring(segStart, segEnd);
+    if (seg.isEmpty()) {
+      return nullptr;
+    }
+    int pos = seg.indexOf('[');
+    if (pos < 0) {
+      pos = seg.length();
+    }
+    const String key = seg.substring(0, pos);
+    if (!key.isEmpty()) {
+      current = objectChild(*current, key);
+      if (current == nullptr) {
+        return nullptr;
+      }
+    }
+    while (pos < seg.length()) {
+      const int close = seg.indexOf(']', pos + 1);
+      if (seg[pos] != '[' || close < 0) {
+        return nullptr;
+      }
+      current = arrayElement(*current);
+      if (current == nullptr) {
+        return nullptr;
+      }
+      pos = close + 1;
+    }
+    segStart = segEnd + 1;
+  }
+  return current;
+}
+
+void addPath(FilterNode& root, const String& path) {
+  FilterNode* leaf = descend(root, path);
+  if (leaf != nullptr) {
+    keepAll(*leaf);
+  }
+}
+
+bool isNumericArg(const String& arg) {
+  bool hasDigit = false;
+  for (int i = 0; i < arg.length(); ++i) {
+    const char c = arg[i];
+    if (c >= '0' && c <= '9') {
+      hasDigit = true;
+    } else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') {
+      return false;
+    }
+  }
+  return hasDigit;
+}
+
+// Mirrors DslWidget::resolveSortVariant: sort_num/sort_alpha(array, key[, order]) and
+// distance_sort/sort_distance(array, lat, lon[, order]), followed by an optional tail path
+// applied to the sorted array.
+void addSortPath(FilterNode& root, const String& path, int argsStart, bool distanceSort) {
+  const int close = path.indexOf(')', argsStart);
+  if (close < 0) {
+    return;
+  }
+  const String argsRaw = path.substring(argsStart, close);
+  std::vector<String> args;
+  int start = 0;
+  while (start <= argsRaw.length()) {
+    int comma = argsRaw.indexOf(',', start);
+    if (comma < 0) {
+      comma = argsRaw.length();
+    }
+    String part = argsRaw.substring(start, comma);
+    part.trim();
+    args.push_back(part);
+    if (comma >= argsRaw.length()) {
+      break;
+    }
+    start = comma + 1;
+  }
+  if (args.empty() || args[0].isEmpty()) {
+    return;
+  }
+
+  FilterNode* arrayNode = descend(root, args[0]);
+  if (arrayNode == nullptr) {
+    return;
+  }
+  FilterNode* element = arrayElement(*arrayNode);
+  if (element == nullptr) {
+    return;
+  }
+
+  if (distanceSort) {
+    addPath(*element, "lat");
+    addPath(*element, "lon");
+    for (size_t i = 1; i < args.size() && i < 3; ++i) {
+      if (!isNumericArg(args[i])) {
+        addPath(root, args[i]);
+      }
+    }
+  } else if (args.size() >= 2) {
+    const String& keyPath = args[1];
+    if (keyPath.isEmpty() || keyPath == "." || keyPath == "*") {
+      keepAll(*element);
+    } else {
+      addPath(*element, keyPath);
+    }
+  }
+
+  String tail = path.substring(close + 1);
+  tail.trim();
+  if (tail.startsWith(".")) {
+    tail = tail.substring(1);
+  }
+  if (tail.isEmpty()) {
+    keepAll(*element);
+    return;
+  }
+  // The tail starts at the sorted array, so its leading "[n]" selects an element.
+  if (!tail.startsWith("[")) {
+    return;
+  }
+  const int idxClose = tail.indexOf(']');
+  if (idxClose < 0) {
+    return;
+  }
+  String rest = tail.substring(idxClose + 1);
+  if (rest.startsWith(".")) {
+    rest = rest.substring(1);
+  }
+  if (rest.isEmpty()) {
+    keepAll(*element);
+  } else {
+    addPath(*element, rest);
+  }
+}
+
+bool addAnyPath(FilterNode& root, const String& rawPath) {
+  String path = rawPath;
+  path.trim();
+  if (path.isEmpty() || path.startsWith("computed.")) {
+    return true;
+  }
+  if (path.indexOf("{{") >= 0) {
+    return false;
+  }
+  if (path.startsWith("sort_num(")) {
+    addSortPath(root, path, 9, false);
+  } else if (path.startsWith("sort_alpha(")) {
+    addSortPath(root, path, 11, false);
+  } else if (path.startsWith("distance_sort(") || path.startsWith("sort_distance(")) {
+    addSortPath(root, path, 14, true);
+  } else {
+    addPath(root, path);
+  }
+  return true;
+}
+
+void emitArray(const FilterNode& node, JsonArray out);
+
+void emitObject(const FilterNode& node, JsonObject out) {
+  for (const auto& kv : node.members) {
+    const FilterNode& child = kv.second;
+    switch (child.kind) {
+      case FilterNode::Kind::kAll:
+        out[kv.first] = true;
+        break;
+      case FilterNode::Kind::kObject:
+        emitObject(child, out[kv.first].to<JsonObject>());
+        break;
+      case FilterNode::Kind::kArray:
+        emitArray(child, out[kv.first].to<JsonArray>());
+        break;
+      case FilterNode::Kind::kEmpty:
+        break;
+    }
+  }
+}
+
+void emitArray(const FilterNode& node, JsonArray out) {
+  if (node.element.empty()) {
+    return;
+  }
+  const FilterNode& element = node.element.front();
+  switch (element.kind) {
+    case FilterNode::Kind::kAll:
+      out.add(true);
+      break;
+    case FilterNode::Kind::kObject:
+      emitObject(element, out.add<JsonObject>());
+      break;
+    case FilterNode::Kind::kArray:
+      emitArray(element, out.add<JsonArray>());
+      break;
+    case FilterNode::Kind::kEmpty:
+      break;
+  }
+}
+
+}  // namespace
+
+bool buildFetchFilter(const Document& doc, JsonDocument& out) {
+  return buildFetchFilter(std::vector<const Document*>{&doc}, out);
+}
+
+bool buildFetchFilter(const std::vector<const Document*>& docs, JsonDocument& out) {
+  out.clear();
+  FilterNode root;
+  for (const Document* doc : docs) {
+    for (const auto& pair : doc->fields) {
+      if (!addAnyPath(root, pair.second.path)) {
+        return false;
+      }
+    }
+    for (const Node& node : doc->nodes) {
+      if (node.type != NodeType::kLabel || node.path.isEmpty()) {
+        continue;
+      }
+      if (!addAnyPath(root, node.path)) {
+        return false;
+      }
+    }
+  }
+
+  switch (root.kind) {
+    case FilterNode::Kind::kObject:
+      emitObject(root, out.to<JsonObject>());
+      return true;
+    case FilterNode::Kind::kArray:
+      emitArray(root, out.to<JsonArray>());
+      return true;
+    case FilterNode::Kind::kAll:
+    case FilterNode::Kind::kEmpty:
+      break;
+  }
+  return false;
+}
+
+}  // namespace dsl
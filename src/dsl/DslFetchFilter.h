@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <vector>
+
+#include "dsl/DslModel.h"
+
+namespace dsl {
+
+// Builds an ArduinoJson DeserializationOption::Filter document that keeps only the members
+// reachable from the document's field paths, label paths and sort transforms. Array indices
+// keep the whole array (ArduinoJson applies one element filter to every element).
+// Returns false when the paths cannot be mapped statically (runtime "{{...}}" templates, no
+// paths at all); callers should then deserialize unfiltered.
+bool buildFetchFilter(const Document& doc, JsonDocument& out);
+// One filter for a response shared by several documents: keeps what any of them reads.
+bool buildFetchFilter(const std::vector<const Document*>& docs, JsonDocument& out);
+
+}  // namespace dsl
@@ -6,6 +6,9 @@
 #include <map>
 #include <vector>
 
+#include "dsl/DslExpr.h"
+#include "dsl/DslTemplate.h"
+
 namespace dsl {
 
 struct FormatSpec {
@@ -21,6 +24,7 @@ struct FormatSpec {
 struct FieldSpec {
   String path;
   FormatSpec format;
+  TemplatePlan pathPlan;
 };
 
 struct TouchAction {
@@ -57,6 +61,9 @@ struct ModalSpec {
   uint16_t titleColor565 = 0xFFFF;
   uint16_t bgColor565 = 0x0000;
   uint16_t borderColor565 = 0x7BEF;
+
+  TemplatePlan titlePlan;
+  TemplatePlan textPlan;
 };
 
 enum class NodeType : uint8_t {
@@ -106,6 +113,14 @@ struct Node {
   int16_t radius = 0;
   int16_t length = 0;
   int16_t thickness = 1;
+  // "aa": 2x2 supersampled edges on arcs, moon phase and lines, blended towards bg.
+  bool antialias = false;
+
+  // Compiled from text/path when the widget loads the document.
+  TemplatePlan textPlan;
+  TemplatePlan pathPlan;
+  // Compiled from angleExpr unless it carries runtime "{{...}}" templates.
+  CompiledExpr angleProgram;
 };
 
 struct Document {
@@ -113,6 +128,8 @@ struct Document {
   String source = "http";
   String url;
   std::map<String, String> headers;
+  // source "sse": event type to take; empty takes every event.
+  String event;
   TouchAction onTouch;
   std::vector<TouchRegion> touchRegions;
   std::vector<ModalSpec> modals;
@@ -120,6 +137,9 @@ struct Document {
   uint32_t pollMs = 30000;
   std::map<String, FieldSpec> fields;
   std::vector<Node> nodes;
+
+  TemplatePlan urlPlan;
+  std::map<String, TemplatePlan> headerPlans;
 };
 
 }  // namespace dsl
@@ -17,8 +17,9 @@ bool parseHexColor565(const String& hex, uint16_t& outColor) {
     return false;
   }
 
+  const String digits = hex.substring(1);
   char* endPtr = nullptr;
-  const long value = strtol(hex.substring(1).c_str(), &endPtr, 16);
+  const long value = strtol(digits.c_str(), &endPtr, 16);
   if (endPtr == nullptr || *endPtr != '\0' || value < 0 || value > 0xFFFFFF) {
     return false;
   }
@@ -333,6 +334,7 @@ void applyNode(JsonObjectConst nodeJson, dsl::Document& out, const VarContext* c
   const String valign = nodeJson["valign"] | String();
   n.datum = parseDatum(align, valign);
   readBool(nodeJson["wrap"], n.wrap);
+  readBool(nodeJson["aa"], n.antialias);
   readInt16(nodeJson["line_height"], ctx, n.lineHeight);
   readInt16(nodeJson["max_lines"], ctx, n.maxLines);
   const String overflow = nodeJson["overflow"] | String();
@@ -467,6 +469,7 @@ bool Parser::parseFile(const String& path, Document& out, String* error) {
         }
       }
     }
+    out.event = data["event"] | String();
     out.debug = data["debug"] | out.debug;
     out.pollMs = data["poll_ms"] | out.pollMs;
 
@@ -0,0 +1,121 @@
+#include "dsl/DslTemplate.h"
+
+namespace dsl {
+namespace {
+
+constexpr size_t kMaxTemplateLength = 0xFFFF;
+
+RuntimeKey classifyKey(const String& key) {
+  if (key == "geo.lat") {
+    return RuntimeKey::kGeoLat;
+  }
+  if (key == "geo.lon") {
+    return RuntimeKey::kGeoLon;
+  }
+  if (key == "geo.tz") {
+    return RuntimeKey::kGeoTz;
+  }
+  if (key == "geo.label") {
+    return RuntimeKey::kGeoLabel;
+  }
+  if (key == "geo.offset_min") {
+    return RuntimeKey::kGeoOffsetMin;
+  }
+  if (key.startsWith("setting.")) {
+    return RuntimeKey::kSetting;
+  }
+  if (key == "pref.clock_24h") {
+    return RuntimeKey::kPrefClock24h;
+  }
+  if (key == "pref.temp_unit") {
+    return RuntimeKey::kPrefTempUnit;
+  }
+  if (key == "pref.distance_unit") {
+    return RuntimeKey::kPrefDistanceUnit;
+  }
+  return RuntimeKey::kNone;
+}
+
+bool isConditionalCall(const String& expr) {
+  const int lparen = expr.indexOf('(');
+  if (lparen <= 0 || !expr.endsWith(")")) {
+    return false;
+  }
+  String fn = expr.substring(0, lparen);
+  fn.trim();
+  fn.toLowerCase();
+  return fn == "if_eq" || fn == "if_ne" || fn == "if_true" || fn == "if_gt" || fn == "if_gte" ||
+         fn == "if_lt" || fn == "if_lte";
+}
+
+void pushLiteral(TemplatePlan& out, int offset, int length) {
+  if (length <= 0) {
+    return;
+  }
+  TemplateToken token;
+  token.kind = TemplateTokenKind::kLiteral;
+  token.offset = static_cast<uint16_t>(offset);
+  token.length = static_cast<uint16_t>(length);
+  out.tokens.push_back(token);
+}
+
+}  // namespace
+
+uint16_t TemplateSlots::intern(const String& key) {
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    if (keys_[i] == key) {
+      return static_cast<uint16_t>(i);
+    }
+  }
+  keys_.push_back(key);
+  return static_cast<uint16_t>(keys_.size() - 1);
+}
+
+bool compileTemplate(const String& source, TemplateSlots& slots, TemplatePlan& out) {
+  out = TemplatePlan();
+  if (source.length() > kMaxTemplateLength) {
+    return false;
+  }
+
+  int cursor = 0;
+  int start = source.indexOf("{{");
+  while (start >= 0) {
+    const int end = source.indexOf("}}", start + 2);
+    if (end < 0) {
+      break;
+    }
+    pushLiteral(out, cursor, start - cursor);
+
+    const String raw = source.substring(start + 2, end);
+    String key = raw;
+    key.trim();
+
+    TemplateToken token;
+    if (isConditionalCall(key)) {
+      token.kind = TemplateTokenKind::kExpression;
+      token.slot = slots.intern("{{" + key + "}}");
+      token.rawSlot = token.slot;
+    } else {
+      token.kind = TemplateTokenKind::kKey;
+      token.runtime = classifyKey(key);
+      token.rawSlot = slots.intern(raw);
+      token.slot = token.runtime == RuntimeKey::kSetting ? slots.intern(key.substring(8))
+                                                         : slots.intern(key);
+    }
+    out.tokens.push_back(token);
+    out.hasBindings = true;
+
+    cursor = end + 2;
+    start = source.indexOf("{{", cursor);
+  }
+  pushLiteral(out, cursor, static_cast<int>(source.length()) - cursor);
+
+  if (slots.size() > 0xFFFF) {
+    out = TemplatePlan();
+    return false;
+  }
+  out.compiled = true;
+  return true;
+}
+
+}  // namespace dsl
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <vector>
+
+namespace dsl {
+
+// Template keys that resolve from runtime state instead of widget values.
+enum class RuntimeKey : uint8_t {
+  kNone,
+  kGeoLat,
+  kGeoLon,
+  kGeoTz,
+  kGeoLabel,
+  kGeoOffsetMin,
+  kSetting,
+  kPrefClock24h,
+  kPrefTempUnit,
+  kPrefDistanceUnit,
+};
+
+enum class TemplateTokenKind : uint8_t {
+  kLiteral,
+  kKey,
+  // Conditional helper such as if_eq(...); evaluated by the runtime interpreter.
+  kExpression,
+};
+
+struct TemplateToken {
+  TemplateTokenKind kind = TemplateTokenKind::kLiteral;
+  RuntimeKey runtime = RuntimeKey::kNone;
+  // Literal span within the template source.
+  uint16_t offset = 0;
+  uint16_t length = 0;
+  // Key exactly as written between the braces, and trimmed. For kSetting the trimmed slot holds
+  // the setting name; for kExpression it holds the whole "{{...}}" text.
+  uint16_t rawSlot = 0;
+  uint16_t slot = 0;
+};
+
+// "{{...}}" template compiled once at load. Literal spans index into the source string the plan
+// was built from, so the source must outlive the plan unchanged.
+struct TemplatePlan {
+  std::vector<TemplateToken> tokens;
+  bool compiled = false;
+  bool hasBindings = false;
+};
+
+// Interns binding keys into slot indices shared by all plans of one widget.
+class TemplateSlots {
+ public:
+  uint16_t intern(const String& key);
+  const String& key(uint16_t slot) const { return keys_[slot]; }
+  size_t size() const { return keys_.size(); }
+  void clear() { keys_.clear(); }
+
+ private:
+  std::vector<String> keys_;
+};
+
+// Returns false (leaving out.compiled == false) when the template cannot be represented, in
+// which case callers fall back to interpreting the source string.
+bool compileTemplate(const String& source, TemplateSlots& slots, TemplatePlan& out);
+
+}  // namespace dsl
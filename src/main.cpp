@@ -26,6 +26,7 @@
 #include "platform/Prefs.h"
 #include "platform/Platform.h"
 #include "services/GeoIpService.h"
+#include "widgets/DslRuntimeCaches.h"
 
 TFT_eSPI tft = TFT_eSPI();
 XPT2046_Touchscreen touch(TOUCH_CS, TOUCH_IRQ);
@@ -73,6 +74,8 @@ struct LayoutOption {
 };
 
 boot::BaselineState gBaselineState;
+bool gFirstPaintMarked = false;
+bool gFreshPaintMarked = false;
 
 void baselineMark(const char* stage) {
   boot::mark(gBaselineState, stage, AppConfig::kBaselineMetricsEnabled);
@@ -84,6 +87,22 @@ void baselineLoopMark(uint32_t nowMs) {
                  AppConfig::kBaselineLoopLogPeriodMs);
 }
 
+// Boot layout only; later layout switches are reported by DisplayManager's "[paint]" lines.
+void baselinePaintMarks() {
+  if (gFreshPaintMarked) {
+    return;
+  }
+  const DisplayManager::PaintMilestones paint = displayManager.paintMilestones();
+  if (!gFirstPaintMarked && paint.firstPaintMs != 0) {
+    gFirstPaintMarked = true;
+    baselineMark("first_paint");
+  }
+  if (paint.freshPaintMs != 0) {
+    gFreshPaintMarked = true;
+    baselineMark("fresh_paint");
+  }
+}
+
 String layoutPathForProfile(int profile) {
   return profile == 1 ? String(AppConfig::kLayoutPathB) : String(AppConfig::kLayoutPathA);
 }
@@ -347,6 +366,13 @@ void maybeLogHeapTelemetry(uint32_t nowMs) {
   Serial.printf("[heap] free=%u min=%u largest=%u uptime_s=%lu\n",
                 static_cast<unsigned>(freeHeap), static_cast<unsigned>(minFree),
                 static_cast<unsigned>(largest), static_cast<unsigned long>(nowMs / 1000UL));
+  const DslIconCacheStats icons = dslIconCacheStats();
+  Serial.printf("[icons] builtin=%u hits=%u misses=%u evictions=%u entries=%u bytes=%u "
+                "psram=%u\n",
+                static_cast<unsigned>(icons.builtinHits), static_cast<unsigned>(icons.hits),
+                static_cast<unsigned>(icons.misses), static_cast<unsigned>(icons.evictions),
+                static_cast<unsigned>(icons.entries), static_cast<unsigned>(icons.bytes),
+                static_cast<unsigned>(icons.psramBytes));
 }
 
 bool runLayoutPicker() {
@@ -1185,5 +1211,6 @@ void loop() {
   }
 
   displayManager.loop(nowMs);
+  baselinePaintMarks();
   platform::sleepMs(AppConfig::kLoopDelayMs);
 }
@@ -0,0 +1,56 @@
+#include "platform/IconPack.h"
+
+#include <esp_idf_version.h>
+#include <esp_partition.h>
+#if ESP_IDF_VERSION_MAJOR < 5
+#include <esp_spi_flash.h>
+#endif
+
+namespace {
+constexpr const char* kPartitionLabel = "icons";
+bool sTried = false;
+const uint8_t* sBlob = nullptr;
+}  // namespace
+
+namespace platform::iconpack {
+
+bool begin() {
+  if (sTried) {
+    return sBlob != nullptr;
+  }
+  sTried = true;
+  const esp_partition_t* partition =
+      esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, kPartitionLabel);
+  if (partition == nullptr) {
+    return false;
+  }
+  const void* mapped = nullptr;
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_partition_mmap_handle_t handle = 0;
+  if (esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &mapped,
+                         &handle) != ESP_OK) {
+    return false;
+  }
+#else
+  spi_flash_mmap_handle_t handle = 0;
+  if (esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &mapped, &handle) !=
+      ESP_OK) {
+    return false;
+  }
+#endif
+  if (format::validate(static_cast<const uint8_t*>(mapped), partition->size) == 0) {
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_munmap(handle);
+#else
+    spi_flash_munmap(handle);
+#endif
+    return false;
+  }
+  // Mapped for the life of the firmware.
+  sBlob = static_cast<const uint8_t*>(mapped);
+  return true;
+}
+
+bool find(const char* path, Icon& out) { return begin() && format::find(sBlob, path, out); }
+
+}  // namespace platform::iconpack
@@ -0,0 +1,486 @@
+#include "services/HaWebSocket.h"
+
+#include <esp_crt_bundle.h>
+#include <esp_websocket_client.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <map>
+#include <time.h>
+#include <vector>
+
+namespace {
+
+constexpr size_t kMaxMessageBytes = 16 * 1024;
+constexpr int kBufferBytes = 2048;
+constexpr int kTaskStackBytes = 6144;
+constexpr int kReconnectMs = 5000;
+constexpr int kNetworkTimeoutMs = 10000;
+constexpr int kPingIntervalS = 20;
+constexpr int kPingPongTimeoutS = 45;
+constexpr uint32_t kSendTimeoutMs = 2000;
+
+struct Entity {
+  uint16_t refs = 0;
+  uint32_t revision = 0;
+  String state;
+  JsonDocument attributes;
+  double lastChanged = 0;
+  double lastUpdated = 0;
+};
+
+struct Connection {
+  String key;
+  String uri;
+  String token;
+  esp_websocket_client_handle_t client = nullptr;
+  std::map<String, Entity> entities;
+  uint32_t handles = 0;
+  haws::Link link = haws::Link::kConnecting;
+  bool authed = false;
+  bool stopped = false;
+  uint32_t nextId = 1;
+  uint32_t subscriptionId = 0;
+  // Socket task only: the text message being reassembled.
+  String rx;
+  bool rxOverflow = false;
+};
+
+struct HandleEntry {
+  Connection* conn = nullptr;
+  String entityId;
+};
+
+SemaphoreHandle_t sMutex = nullptr;
+std::map<String, Connection*> sConnections;
+std::map<haws::Handle, HandleEntry> sHandles;
+haws::Handle sNextHandle = 1;
+haws::Stats sStats;
+
+class Lock {
+ public:
+  Lock() { xSemaphoreTake(sMutex, portMAX_DELAY); }
+  ~Lock() { xSemaphoreGive(sMutex); }
+};
+
+uint32_t nextRevision(uint32_t revision) { return revision + 1 == 0 ? 1 : revision + 1; }
+
+// http[s]://host[:port][/] -> ws[s]://host[:port]/api/websocket
+String websocketUri(String baseUrl) {
+  while (baseUrl.endsWith("/")) {
+    baseUrl.remove(baseUrl.length() - 1);
+  }
+  if (baseUrl.startsWith("https://")) {
+    return "wss://" + baseUrl.substring(8) + "/api/websocket";
+  }
+  if (baseUrl.startsWith("http://")) {
+    return "ws://" + baseUrl.substring(7) + "/api/websocket";
+  }
+  return String();
+}
+
+// HA REST timestamps: 2025-10-09T18:26:40.123456+00:00
+String isoTime(double epochS) {
+  if (epochS <= 0) {
+    return String();
+  }
+  time_t secs = static_cast<time_t>(epochS);
+  long micros = static_cast<long>((epochS - static_cast<double>(secs)) * 1e6 + 0.5);
+  if (micros >= 1000000) {
+    ++secs;
+    micros -= 1000000;
+  }
+  struct tm tmv;
+  gmtime_r(&secs, &tmv);
+  char buf[40];
+  snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d.%06ld+00:00", tmv.tm_year + 1900,
+           tmv.tm_mon + 1, tmv.tm_mday, tmv.tm_hour, tmv.tm_min, tmv.tm_sec, micros);
+  return String(buf);
+}
+
+// Under the lock. Builds a subscribe_entities for every referenced entity and, when it
+// replaces an earlier subscription, the matching unsubscribe_events.
+void buildSubscribe(Connection& conn, String& subscribe, String& unsubscribe) {
+  JsonDocument msg;
+  JsonArray ids = msg["entity_ids"].to<JsonArray>();
+  for (const auto& kv : conn.entities) {
+    if (kv.second.refs > 0) {
+      ids.add(kv.first);
+    }
+  }
+  if (ids.size() == 0) {
+    return;
+  }
+  const uint32_t previous = conn.subscriptionId;
+  conn.subscriptionId = conn.nextId++;
+  msg["id"] = conn.subscriptionId;
+  msg["type"] = "subscribe_entities";
+  serializeJson(msg, subscribe);
+  ++sStats.subscribes;
+  if (previous != 0) {
+    JsonDocument unsub;
+    unsub["id"] = conn.nextId++;
+    unsub["type"] = "unsubscribe_events";
+    unsub["subscription"] = previous;
+    serializeJson(unsub, unsubscribe);
+  }
+}
+
+void send(Connection& conn, const String& text) {
+  if (text.isEmpty()) {
+    return;
+  }
+  esp_websocket_client_send_text(conn.client, text.c_str(), static_cast<int>(text.length()),
+                                 pdMS_TO_TICKS(kSendTimeoutMs));
+}
+
+// Under the lock. Compressed states from subscribe_entities: "a" full states, "c" changes
+// ("+" set, "-" removed attributes) and "r" removed entities.
+void applyEvent(Connection& conn, JsonObjectConst event) {
+  for (JsonPairConst kv : event["a"].as<JsonObjectConst>()) {
+    auto it = conn.entities.find(String(kv.key().c_str()));
+    if (it == conn.entities.end()) {
+      continue;
+    }
+    Entity& entity = it->second;
+    JsonObjectConst full = kv.value();
+    entity.state = full["s"] | "";
+    entity.attributes.clear();
+    entity.attributes.set(full["a"]);
+    entity.lastChanged = full["lc"] | 0.0;
+    entity.lastUpdated = full["lu"] | entity.lastChanged;
+    entity.revision = nextRevision(entity.revision);
+  }
+  for (JsonPairConst kv : event["c"].as<JsonObjectConst>()) {
+    auto it = conn.entities.find(String(kv.key().c_str()));
+    if (it == conn.entities.end()) {
+      continue;
+    }
+    Entity& entity = it->second;
+    JsonObjectConst plus = kv.value()["+"];
+    JsonArrayConst minus = kv.value()["-"]["a"];
+    if (!plus["s"].isNull()) {
+      entity.state = plus["s"] | "";
+    }
+    if (!plus["lc"].isNull()) {
+      entity.lastChanged = plus["lc"] | 0.0;
+      entity.lastUpdated = entity.lastChanged;
+    } else if (!plus["lu"].isNull()) {
+      entity.lastUpdated = plus["lu"] | 0.0;
+    }
+    JsonObjectConst changed = plus["a"];
+    if (!changed.isNull() || !minus.isNull()) {
+      // Rebuilt rather than edited in place: a document never reclaims replaced strings.
+      JsonDocument merged;
+      JsonObject attrs = merged.to<JsonObject>();
+      for (JsonPairConst attr : entity.attributes.as<JsonObjectConst>()) {
+        bool removed = !changed[attr.key()].isNull();
+        for (JsonVariantConst key : minus) {
+          removed = removed || key.as<String>() == attr.key().c_str();
+        }
+        if (!removed) {
+          attrs[attr.key()] = attr.value();
+        }
+      }
+      for (JsonPairConst attr : changed) {
+        attrs[attr.key()] = attr.value();
+      }
+      entity.attributes = std::move(merged);
+    }
+    entity.revision = nextRevision(entity.revision);
+  }
+  for (JsonVariantConst removed : event["r"].as<JsonArrayConst>()) {
+    auto it = conn.entities.find(removed.as<String>());
+    if (it == conn.entities.end()) {
+      continue;
+    }
+    // Deleted in HA; show it the way HA shows entities it no longer has.
+    it->second.state = "unavailable";
+    it->second.attributes.clear();
+    it->second.revision = nextRevision(it->second.revision);
+  }
+}
+
+void handleMessage(Connection& conn, const String& text) {
+  JsonDocument msg;
+  if (deserializeJson(msg, text)) {
+    return;
+  }
+  const String type = msg["type"] | "";
+  String reply;
+  String unsubscribe;
+  if (type == "auth_required") {
+    JsonDocument auth;
+    auth["type"] = "auth";
+    auth["access_token"] = conn.token;
+    serializeJson(auth, reply);
+  } else if (type == "auth_ok") {
+    Lock lock;
+    conn.authed = true;
+    conn.subscriptionId = 0;
+    buildSubscribe(conn, reply, unsubscribe);
+  } else if (type == "auth_invalid") {
+    {
+      Lock lock;
+      conn.link = haws::Link::kAuthFailed;
+      ++sStats.authFailures;
+    }
+    Serial.printf("[ha_ws] auth rejected by %s: %s\n", conn.uri.c_str(),
+                  msg["message"] | "");
+  } else if (type == "result") {
+    if (!(msg["success"] | false)) {
+      Serial.printf("[ha_ws] request %u failed: %s\n", static_cast<unsigned>(msg["id"] | 0),
+                    (msg["error"]["message"] | String("?")).c_str());
+    }
+  } else if (type == "event") {
+    const uint32_t id = msg["id"] | 0;
+    Lock lock;
+    ++sStats.messages;
+    if (id == conn.subscriptionId) {
+      applyEvent(conn, msg["event"].as<JsonObjectConst>());
+      conn.link = haws::Link::kLive;
+    }
+  }
+  send(conn, reply);
+}
+
+void onEvent(void* arg, esp_event_base_t base, int32_t eventId, void* eventData) {
+  (void)base;
+  Connection& conn = *static_cast<Connection*>(arg);
+  const auto* data = static_cast<const esp_websocket_event_data_t*>(eventData);
+  switch (eventId) {
+    case WEBSOCKET_EVENT_CONNECTED: {
+      Lock lock;
+      conn.authed = false;
+      conn.link = haws::Link::kConnecting;
+      ++sStats.connects;
+      break;
+    }
+    case WEBSOCKET_EVENT_DISCONNECTED:
+    case WEBSOCKET_EVENT_CLOSED: {
+      Lock lock;
+      const bool wasUp = conn.authed;
+      conn.authed = false;
+      if (conn.link != haws::Link::kAuthFailed) {
+        conn.link = haws::Link::kDown;
+      }
+      if (wasUp) {
+        Serial.printf("[ha_ws] disconnected from %s\n", conn.uri.c_str());
+      }
+      break;
+    }
+    case WEBSOCKET_EVENT_DATA: {
+      // Text messages may arrive split across frames (continuations, op 0) and each frame in
+      // buffer-sized pieces (payload_offset).
+      if (data->op_code == 0x1 && data->payload_offset == 0) {
+        conn.rx = "";
+        conn.rxOverflow = false;
+      } else if (data->op_code != 0x0 && data->op_code != 0x1) {
+        break;
+      }
+      if (conn.rx.length() + data->data_len > kMaxMessageBytes) {
+        conn.rxOverflow = true;
+      } else if (!conn.rxOverflow) {
+        conn.rx.concat(data->data_ptr, data->data_len);
+      }
+      if (!data->fin || data->payload_offset + data->data_len < data->payload_len) {
+        break;
+      }
+      if (conn.rxOverflow) {
+        Lock lock;
+        ++sStats.dropped;
+      } else {
+        handleMessage(conn, conn.rx);
+      }
+      conn.rx = "";
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+Connection* openConnection(const String& key, const String& uri, const String& token) {
+  auto* conn = new Connection();
+  conn->key = key;
+  conn->uri = uri;
+  conn->token = token;
+  esp_websocket_client_config_t cfg = {};
+  cfg.uri = conn->uri.c_str();
+  cfg.task_stack = kTaskStackBytes;
+  cfg.buffer_size = kBufferBytes;
+  cfg.reconnect_timeout_ms = kReconnectMs;
+  cfg.network_timeout_ms = kNetworkTimeoutMs;
+  cfg.ping_interval_sec = kPingIntervalS;
+  cfg.pingpong_timeout_sec = kPingPongTimeoutS;
+  cfg.crt_bundle_attach = arduino_esp_crt_bundle_attach;
+  conn->client = esp_websocket_client_init(&cfg);
+  if (conn->client == nullptr) {
+    delete conn;
+    return nullptr;
+  }
+  esp_websocket_register_events(conn->client, WEBSOCKET_EVENT_ANY, onEvent, conn);
+  if (esp_websocket_client_start(conn->client) != ESP_OK) {
+    esp_websocket_client_destroy(conn->client);
+    delete conn;
+    return nullptr;
+  }
+  Serial.printf("[ha_ws] connecting %s\n", conn->uri.c_str());
+  return conn;
+}
+
+}  // namespace
+
+namespace haws {
+
+Handle subscribe(const String& baseUrl, const String& token, const String& entityId) {
+  const String uri = websocketUri(baseUrl);
+  if (uri.isEmpty() || entityId.isEmpty()) {
+    return 0;
+  }
+  if (sMutex == nullptr) {
+    sMutex = xSemaphoreCreateMutex();
+  }
+  const String key = uri + "|" + token;
+  Connection* conn = nullptr;
+  {
+    Lock lock;
+    auto it = sConnections.find(key);
+    if (it != sConnections.end()) {
+      conn = it->second;
+    }
+  }
+  if (conn == nullptr) {
+    // Registered before it starts, so the socket task always finds its entities.
+    conn = openConnection(key, uri, token);
+    if (conn == nullptr) {
+      return 0;
+    }
+  }
+
+  String subscribe;
+  String unsubscribe;
+  Handle handle;
+  {
+    Lock lock;
+    sConnections[key] = conn;
+    Entity& entity = conn->entities[entityId];
+    // A new entity on a live socket needs the subscription widened; otherwise the next
+    // auth_ok subscribes to everything.
+    if (entity.refs++ == 0 && conn->authed) {
+      buildSubscribe(*conn, subscribe, unsubscribe);
+    }
+    ++conn->handles;
+    handle = sNextHandle++;
+    sHandles[handle] = HandleEntry{conn, entityId};
+  }
+  send(*conn, subscribe);
+  send(*conn, unsubscribe);
+  return handle;
+}
+
+void unsubscribe(Handle handle) {
+  if (sMutex == nullptr || handle == 0) {
+    return;
+  }
+  Connection* closing = nullptr;
+  {
+    Lock lock;
+    auto it = sHandles.find(handle);
+    if (it == sHandles.end()) {
+      return;
+    }
+    Connection* conn = it->second.conn;
+    auto entity = conn->entities.find(it->second.entityId);
+    // Deltas for entities nobody reads any more are ignored until the next resubscribe.
+    if (entity != conn->entities.end() && --entity->second.refs == 0) {
+      conn->entities.erase(entity);
+    }
+    sHandles.erase(it);
+    if (--conn->handles == 0) {
+      sConnections.erase(conn->key);
+      closing = conn;
+    }
+  }
+  if (closing != nullptr) {
+    // Joins the socket task, so it must not hold the lock its event handler takes.
+    esp_websocket_client_destroy(closing->client);
+    Serial.printf("[ha_ws] closed %s\n", closing->uri.c_str());
+    delete closing;
+  }
+}
+
+uint32_t revision(Handle handle) {
+  if (sMutex == nullptr) {
+    return 0;
+  }
+  Lock lock;
+  auto it = sHandles.find(handle);
+  if (it == sHandles.end()) {
+    return 0;
+  }
+  auto entity = it->second.conn->entities.find(it->second.entityId);
+  return entity == it->second.conn->entities.end() ? 0 : entity->second.revision;
+}
+
+bool read(Handle handle, uint32_t& seen, JsonDocument& out) {
+  if (sMutex == nullptr) {
+    return false;
+  }
+  Lock lock;
+  auto it = sHandles.find(handle);
+  if (it == sHandles.end()) {
+    return false;
+  }
+  auto found = it->second.conn->entities.find(it->second.entityId);
+  if (found == it->second.conn->entities.end() || found->second.revision == 0 ||
+      found->second.revision == seen) {
+    return false;
+  }
+  const Entity& entity = found->second;
+  out.clear();
+  out["entity_id"] = it->second.entityId;
+  out["state"] = entity.state;
+  out["attributes"] = entity.attributes.as<JsonObjectConst>();
+  out["last_changed"] = isoTime(entity.lastChanged);
+  out["last_updated"] = isoTime(entity.lastUpdated);
+  seen = entity.revision;
+  return true;
+}
+
+Link link(Handle handle) {
+  if (sMutex == nullptr) {
+    return Link::kConnecting;
+  }
+  esp_websocket_client_handle_t stopClient = nullptr;
+  Link state;
+  {
+    Lock lock;
+    auto it = sHandles.find(handle);
+    if (it == sHandles.end()) {
+      return Link::kDown;
+    }
+    Connection& conn = *it->second.conn;
+    state = conn.link;
+    // Retrying a rejected token only fills HA's log with failed logins (and may get the
+    // device banned), so stop until the widgets come back with another one.
+    if (state == Link::kAuthFailed && !conn.stopped) {
+      conn.stopped = true;
+      stopClient = conn.client;
+    }
+  }
+  if (stopClient != nullptr) {
+    esp_websocket_client_stop(stopClient);
+  }
+  return state;
+}
+
+Stats stats() {
+  if (sMutex == nullptr) {
+    return Stats();
+  }
+  Lock lock;
+  return sStats;
+}
+
+}  // namespace haws
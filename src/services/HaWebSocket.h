@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// One authenticated Home Assistant WebSocket per instance (REST base URL + token), shared by
+// every `source: "ha_ws"` widget. The connection subscribes to the union of its widgets'
+// entities with subscribe_entities and folds the pushed states and deltas into a copy of
+// each entity, which widgets read back shaped like GET /api/states/<entity_id>, so DSL field
+// paths are the same as for the polled source. The socket reconnects and resubscribes on its
+// own; a rejected token stops it for good (a new token means a new connection).
+// All calls come from widget code, which DisplayManager serializes; the socket task only
+// touches entity state under the service's lock.
+namespace haws {
+
+enum class Link : uint8_t {
+  kConnecting = 0,
+  kLive,        // authenticated and subscribed
+  kDown,        // lost, reconnecting
+  kAuthFailed,
+};
+
+using Handle = uint32_t;
+
+struct Stats {
+  uint32_t connects = 0;
+  uint32_t authFailures = 0;
+  uint32_t subscribes = 0;
+  uint32_t messages = 0;
+  uint32_t dropped = 0;  // messages over kMaxMessageBytes
+};
+
+// Adds `entityId` to the connection for (baseUrl, token), opening it when needed. baseUrl is
+// the REST base (http[s]://host[:port]). Returns 0 when it is not one.
+Handle subscribe(const String& baseUrl, const String& token, const String& entityId);
+// The connection closes with its last handle.
+void unsubscribe(Handle handle);
+
+// Bumped for every change pushed for the entity; 0 until its first state arrives.
+uint32_t revision(Handle handle);
+// Copies the entity into `out` when its revision differs from `seen`, and updates `seen`.
+bool read(Handle handle, uint32_t& seen, JsonDocument& out);
+Link link(Handle handle);
+
+Stats stats();
+
+}  // namespace haws
@@ -0,0 +1,230 @@
+#include "services/HttpConnectionPool.h"
+
+#include <esp_crt_bundle.h>
+
+#include <vector>
+
+namespace {
+constexpr size_t kMaxPooledClients = 4;
+constexpr size_t kMaxTlsSessions = 2;
+constexpr uint32_t kIdleTimeoutMs = 30000U;
+// Sessions are shared between JSON polls and tap actions, so they use one timeout.
+constexpr int kSessionTimeoutMs = 5000;
+
+struct Slot {
+  String origin;
+  esp_http_client_handle_t client = nullptr;
+  http_event_handle_cb handler = nullptr;
+  bool tls = false;
+  bool connected = false;
+  bool busy = false;
+  uint32_t lastUsedMs = 0;
+};
+
+std::vector<Slot> sSlots;
+
+// "scheme://host:port", lowercased, with the default port filled in.
+String originOf(const String& url, bool& tls) {
+  tls = url.startsWith("https://");
+  const int schemeEnd = url.indexOf("://");
+  if (schemeEnd < 0) {
+    return String();
+  }
+  const int hostStart = schemeEnd + 3;
+  int hostEnd = hostStart;
+  while (hostEnd < url.length() && url[hostEnd] != '/' && url[hostEnd] != '?' &&
+         url[hostEnd] != '#') {
+    ++hostEnd;
+  }
+  String authority = url.substring(hostStart, hostEnd);
+  const int at = authority.lastIndexOf('@');
+  if (at >= 0) {
+    authority = authority.substring(at + 1);
+  }
+  if (authority.isEmpty()) {
+    return String();
+  }
+  if (authority.indexOf(':') < 0) {
+    authority += tls ? ":443" : ":80";
+  }
+  String origin = url.substring(0, hostStart) + authority;
+  origin.toLowerCase();
+  return origin;
+}
+
+esp_http_client_handle_t createClient(const String& url, http_event_handle_cb handler) {
+  esp_http_client_config_t cfg = {};
+  cfg.url = url.c_str();
+  cfg.event_handler = handler;
+  cfg.timeout_ms = kSessionTimeoutMs;
+  cfg.disable_auto_redirect = true;
+  cfg.keep_alive_enable = true;
+  cfg.buffer_size = 1024;
+  cfg.buffer_size_tx = 512;
+  cfg.skip_cert_common_name_check = false;
+  cfg.crt_bundle_attach = arduino_esp_crt_bundle_attach;
+  return esp_http_client_init(&cfg);
+}
+
+void destroySlot(Slot& slot) {
+  if (slot.client != nullptr) {
+    esp_http_client_cleanup(slot.client);
+    slot.client = nullptr;
+  }
+  slot.connected = false;
+}
+
+void disconnectSlot(Slot& slot) {
+  if (slot.client != nullptr && slot.connected) {
+    esp_http_client_close(slot.client);
+  }
+  slot.connected = false;
+}
+
+void expireIdle(uint32_t nowMs) {
+  for (auto it = sSlots.begin(); it != sSlots.end();) {
+    if (!it->busy && nowMs - it->lastUsedMs >= kIdleTimeoutMs) {
+      destroySlot(*it);
+      it = sSlots.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+// Least recently used idle slot matching the predicate, or -1.
+template <typename Pred>
+int oldestIdle(Pred pred) {
+  int found = -1;
+  for (size_t i = 0; i < sSlots.size(); ++i) {
+    const Slot& slot = sSlots[i];
+    if (slot.busy || !pred(slot)) {
+      continue;
+    }
+    if (found < 0 || static_cast<int32_t>(slot.lastUsedMs - sSlots[found].lastUsedMs) < 0) {
+      found = static_cast<int>(i);
+    }
+  }
+  return found;
+}
+}  // namespace
+
+namespace httppool {
+
+bool acquire(const String& url, http_event_handle_cb handler, Lease& out) {
+  out = Lease();
+  const uint32_t nowMs = millis();
+  expireIdle(nowMs);
+
+  bool tls = false;
+  const String origin = originOf(url, tls);
+  if (!origin.isEmpty()) {
+    for (size_t i = 0; i < sSlots.size(); ++i) {
+      Slot& slot = sSlots[i];
+      if (slot.busy || slot.origin != origin || slot.handler != handler) {
+        continue;
+      }
+      if (esp_http_client_set_url(slot.client, url.c_str()) != ESP_OK) {
+        continue;
+      }
+      slot.busy = true;
+      out.client = slot.client;
+      out.reused = slot.connected;
+      return true;
+    }
+
+    if (tls) {
+      size_t openTls = 0;
+      for (const Slot& slot : sSlots) {
+        if (slot.tls && slot.connected) {
+          ++openTls;
+        }
+      }
+      if (openTls >= kMaxTlsSessions) {
+        const int victim = oldestIdle([](const Slot& s) { return s.tls && s.connected; });
+        if (victim >= 0) {
+          disconnectSlot(sSlots[victim]);
+        }
+      }
+    }
+
+    int index = -1;
+    if (sSlots.size() < kMaxPooledClients) {
+      sSlots.push_back(Slot());
+      index = static_cast<int>(sSlots.size()) - 1;
+    } else {
+      index = oldestIdle([](const Slot&) { return true; });
+      if (index >= 0) {
+        destroySlot(sSlots[index]);
+      }
+    }
+    if (index >= 0) {
+      Slot& slot = sSlots[index];
+      slot.client = createClient(url, handler);
+      if (slot.client == nullptr) {
+        sSlots.erase(sSlots.begin() + index);
+        return false;
+      }
+      slot.handler = handler;
+      slot.origin = origin;
+      slot.tls = tls;
+      slot.connected = false;
+      slot.busy = true;
+      out.client = slot.client;
+      return true;
+    }
+  }
+
+  // Unparseable URL or every slot busy: one-off client, cleaned up on release.
+  out.client = createClient(url, handler);
+  return out.client != nullptr;
+}
+
+void release(Lease& lease, bool keepAlive) {
+  if (lease.client == nullptr) {
+    return;
+  }
+  auto it = sSlots.begin();
+  while (it != sSlots.end() && it->client != lease.client) {
+    ++it;
+  }
+  if (it == sSlots.end()) {
+    esp_http_client_cleanup(lease.client);
+    lease = Lease();
+    return;
+  }
+
+  Slot& slot = *it;
+  if (keepAlive) {
+    slot.connected = true;
+  } else {
+    esp_http_client_close(slot.client);
+    slot.connected = false;
+  }
+  slot.busy = false;
+  slot.lastUsedMs = millis();
+  lease = Lease();
+}
+
+bool hasOpenSession(const String& url) {
+  bool tls = false;
+  const String origin = originOf(url, tls);
+  const uint32_t nowMs = millis();
+  for (const Slot& slot : sSlots) {
+    if (!slot.busy && slot.connected && slot.origin == origin &&
+        nowMs - slot.lastUsedMs < kIdleTimeoutMs) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void closeIdle() {
+  for (Slot& slot : sSlots) {
+    if (!slot.busy) {
+      disconnectSlot(slot);
+    }
+  }
+}
+
+}  // namespace httppool
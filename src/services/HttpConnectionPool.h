@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_http_client.h>
+
+// Keep-alive esp_http_client handles keyed by origin (scheme://host:port), so widgets polling
+// the same server share one TCP/TLS session instead of handshaking on every request. Idle
+// sessions close after kIdleTimeoutMs, and at most kMaxTlsSessions TLS connections stay open.
+// Callers hold httpgate::Guard for the whole lease; the pool has no lock of its own.
+namespace httppool {
+
+struct Lease {
+  esp_http_client_handle_t client = nullptr;
+  // True when the connection was left open by an earlier request and may have gone stale.
+  bool reused = false;
+};
+
+// Hands out a client already pointed at `url`. Clients keep the event handler they were
+// created with, so slots only match requests passing the same `handler`; set per-request
+// state through esp_http_client_set_user_data(). Falls back to a one-off client when every
+// slot is busy. Returns false only if no client could be created.
+bool acquire(const String& url, http_event_handle_cb handler, Lease& out);
+
+// Returns the client. `keepAlive` leaves its connection open for the next request to the same
+// origin; pass false after transport errors, redirects or a "Connection: close" response.
+void release(Lease& lease, bool keepAlive);
+
+// True when an idle connection to url's origin is open, i.e. no new handshake is needed.
+bool hasOpenSession(const String& url);
+
+// Closes idle connections to free their TLS buffers, e.g. before a heap-hungry handshake.
+void closeIdle();
+
+}  // namespace httppool
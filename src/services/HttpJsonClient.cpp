@@ -1,13 +1,17 @@
 #include "services/HttpJsonClient.h"
+#include "services/HttpConnectionPool.h"
 #include "services/HttpTransportGate.h"
+#include "services/PollScheduler.h"
 
+#include <algorithm>
 #include <cstdlib>
-#include <esp_crt_bundle.h>
+#include <cstring>
 #include <esp_err.h>
 #include <esp_heap_caps.h>
 #include <esp_http_client.h>
 #include <WiFi.h>
 #include <string>
+#include <vector>
 
 #include "platform/Net.h"
 
@@ -15,8 +19,8 @@ namespace {
 constexpr uint32_t kMinLargestBlockForTls = 14000U;
 constexpr uint8_t kTransportFailureRecoveryThreshold = 6U;
 constexpr uint32_t kRecoveryAttemptCooldownMs = 15000U;
-constexpr uint32_t kTransportOutageCooldownMs = 12000U;
-constexpr uint8_t kTransportOutageThreshold = 6U;
+constexpr uint8_t kMaxRedirects = 5U;
+constexpr size_t kPreviewBytes = 120U;
 
 String heapDiag() {
   const uint32_t freeHeap = ESP.getFreeHeap();
@@ -26,33 +30,6 @@ String heapDiag() {
          ", heap_largest=" + String(largest);
 }
 
-String extractLikelyJson(const String& payload) {
-  int startObj = payload.indexOf('{');
-  int startArr = payload.indexOf('[');
-
-  int start = -1;
-  if (startObj >= 0 && startArr >= 0) {
-    start = (startObj < startArr) ? startObj : startArr;
-  } else if (startObj >= 0) {
-    start = startObj;
-  } else if (startArr >= 0) {
-    start = startArr;
-  }
-
-  if (start < 0) {
-    return payload;
-  }
-
-  int endObj = payload.lastIndexOf('}');
-  int endArr = payload.lastIndexOf(']');
-  int end = (endObj > endArr) ? endObj : endArr;
-  if (end < start) {
-    return payload.substring(start);
-  }
-
-  return payload.substring(start, end + 1);
-}
-
 String compactPreview(const String& payload, size_t maxLen = 120) {
   String out = payload;
   out.replace('\n', ' ');
@@ -65,13 +42,15 @@ String compactPreview(const String& payload, size_t maxLen = 120) {
 }
 
 struct HttpCapture {
-  String body;
   String contentType;
   String contentLength;
   String transferEncoding;
   String contentEncoding;
   String location;
   String retryAfter;
+  String etag;
+  String lastModified;
+  bool connectionClose = false;
 };
 
 esp_err_t httpEventHandler(esp_http_client_event_t* evt) {
@@ -99,12 +78,12 @@ esp_err_t httpEventHandler(esp_http_client_event_t* evt) {
         cap->location = value;
       } else if (key == "retry-after") {
         cap->retryAfter = value;
-      }
-      break;
-    }
-    case HTTP_EVENT_ON_DATA: {
-      if (evt->data != nullptr && evt->data_len > 0) {
-        cap->body.concat(static_cast<const char*>(evt->data), evt->data_len);
+      } else if (key == "etag") {
+        cap->etag = value;
+      } else if (key == "last-modified") {
+        cap->lastModified = value;
+      } else if (key == "connection") {
+        cap->connectionClose = value.equalsIgnoreCase("close");
       }
       break;
     }
@@ -114,50 +93,117 @@ esp_err_t httpEventHandler(esp_http_client_event_t* evt) {
   return ESP_OK;
 }
 
-uint8_t sTransportFailureStreak = 0;
-uint32_t sLastRecoveryAttemptMs = 0;
-uint32_t sTransportOutageUntilMs = 0;
+// ArduinoJson reader over esp_http_client_read(). Keeps one small chunk buffer plus the first
+// bytes of the body for error previews, so no full copy of the response is ever held.
+class HttpBodyReader {
+ public:
+  explicit HttpBodyReader(esp_http_client_handle_t client) : client_(client) {}
 
-void resetTransportFailureStreak() { sTransportFailureStreak = 0; }
+  int read() {
+    if (pos_ >= len_ && !fill()) {
+      return -1;
+    }
+    return static_cast<uint8_t>(buf_[pos_++]);
+  }
 
-void noteTransportFailureAndMaybeRecover() {
-  if (sTransportFailureStreak < 255) {
-    ++sTransportFailureStreak;
+  size_t readBytes(char* out, size_t length) {
+    size_t copied = 0;
+    while (copied < length) {
+      if (pos_ >= len_ && !fill()) {
+        break;
+      }
+      const size_t take = std::min(length - copied, len_ - pos_);
+      memcpy(out + copied, buf_ + pos_, take);
+      pos_ += take;
+      copied += take;
+    }
+    return copied;
   }
-  if (sTransportFailureStreak >= kTransportOutageThreshold) {
-    const uint32_t nowMs = millis();
-    const uint32_t nextUntil = nowMs + kTransportOutageCooldownMs;
-    if (static_cast<int32_t>(nextUntil - sTransportOutageUntilMs) > 0) {
-      sTransportOutageUntilMs = nextUntil;
+
+  // Skips a UTF-8 BOM or any preamble before the first '{' or '['.
+  bool skipToJson() {
+    for (;;) {
+      if (pos_ >= len_ && !fill()) {
+        return false;
+      }
+      const char c = buf_[pos_];
+      if (c == '{' || c == '[') {
+        return true;
+      }
+      ++pos_;
     }
   }
-  if (sTransportFailureStreak < kTransportFailureRecoveryThreshold) {
-    return;
+
+  void drain() {
+    while (fill()) {
+    }
+  }
+
+  size_t bytesRead() const { return total_; }
+  const String& head() const { return head_; }
+
+ private:
+  bool fill() {
+    if (eof_) {
+      return false;
+    }
+    const int n = esp_http_client_read(client_, buf_, sizeof(buf_));
+    if (n <= 0) {
+      eof_ = true;
+      return false;
+    }
+    if (head_.length() < static_cast<int>(kPreviewBytes)) {
+      const size_t room = kPreviewBytes - head_.length();
+      head_.concat(buf_, std::min(room, static_cast<size_t>(n)));
+    }
+    pos_ = 0;
+    len_ = static_cast<size_t>(n);
+    total_ += len_;
+    return true;
   }
 
+  esp_http_client_handle_t client_;
+  char buf_[512];
+  size_t pos_ = 0;
+  size_t len_ = 0;
+  size_t total_ = 0;
+  bool eof_ = false;
+  String head_;
+};
+
+bool isRedirectStatus(int statusCode) {
+  return statusCode == 301 || statusCode == 302 || statusCode == 303 || statusCode == 307 ||
+         statusCode == 308;
+}
+
+uint32_t sLastRecoveryAttemptMs = 0;
+
+// The failure streak and the outage cooldown live in PollScheduler, which also holds widget
+// polls during an outage; a long enough streak additionally forces a WiFi reconnect here.
+uint8_t noteTransportFailureAndMaybeRecover() {
   const uint32_t nowMs = millis();
-  if (static_cast<int32_t>(nowMs - sLastRecoveryAttemptMs) < static_cast<int32_t>(kRecoveryAttemptCooldownMs)) {
-    return;
+  const uint8_t streak = PollScheduler::shared().noteTransportFailure(nowMs);
+  if (streak < kTransportFailureRecoveryThreshold) {
+    return streak;
+  }
+  if (nowMs - sLastRecoveryAttemptMs < kRecoveryAttemptCooldownMs) {
+    return streak;
   }
 
   sLastRecoveryAttemptMs = nowMs;
   Serial.printf("[http] transport failure streak=%u, forcing WiFi reconnect\n",
-                static_cast<unsigned>(sTransportFailureStreak));
+                static_cast<unsigned>(streak));
   WiFi.disconnect(false, false);
   delay(60);
   WiFi.reconnect();
+  return streak;
 }
 
 bool inTransportOutageCooldown(String* errorMessage, HttpFetchMeta* meta, uint32_t startMs) {
-  if (sTransportOutageUntilMs == 0) {
-    return false;
-  }
-  const uint32_t nowMs = millis();
-  if (static_cast<int32_t>(nowMs - sTransportOutageUntilMs) >= 0) {
-    sTransportOutageUntilMs = 0;
+  const uint32_t remainingMs = PollScheduler::shared().outageRemainingMs(millis());
+  if (remainingMs == 0) {
     return false;
   }
-  const uint32_t remainingMs = sTransportOutageUntilMs - nowMs;
   if (meta != nullptr) {
     meta->statusCode = -3;
     meta->transportReason = "transport-cooldown";
@@ -170,40 +216,143 @@ bool inTransportOutageCooldown(String* errorMessage, HttpFetchMeta* meta, uint32
   return true;
 }
 
-void clearTransportOutageCooldown() {
-  sTransportOutageUntilMs = 0;
-}
-
-void clearTransportFailureState() {
-  resetTransportFailureStreak();
-  clearTransportOutageCooldown();
-}
-
 void noteSuccessfulHttpResponse() {
-  clearTransportFailureState();
+  PollScheduler::shared().noteTransportSuccess();
 }
 
 void noteTransportFailureAndReason(const String& transportReason) {
-  noteTransportFailureAndMaybeRecover();
+  const uint8_t streak = noteTransportFailureAndMaybeRecover();
   if (transportReason.length() > 0) {
-    Serial.printf("[http] transport fail streak=%u reason='%s'\n",
-                  static_cast<unsigned>(sTransportFailureStreak), transportReason.c_str());
+    Serial.printf("[http] transport fail streak=%u reason='%s'\n", static_cast<unsigned>(streak),
+                  transportReason.c_str());
   }
 }
 
 void noteBeginFailureAndReason(const char* reason) {
-  noteTransportFailureAndMaybeRecover();
+  const uint8_t streak = noteTransportFailureAndMaybeRecover();
   if (reason != nullptr && reason[0] != '\0') {
-    Serial.printf("[http] begin fail streak=%u reason='%s'\n",
-                  static_cast<unsigned>(sTransportFailureStreak), reason);
+    Serial.printf("[http] begin fail streak=%u reason='%s'\n", static_cast<unsigned>(streak),
+                  reason);
+  }
+}
+
+// One request on a pooled client. Per-request headers and the capture pointer are removed
+// again before the client goes back to the pool; the connection is only kept when
+// keepAlive() was called after the response was read to the end.
+class PooledRequest {
+ public:
+  explicit PooledRequest(HttpCapture& cap) : cap_(cap) {}
+  ~PooledRequest() {
+    if (lease_.client == nullptr) {
+      return;
+    }
+    esp_http_client_set_user_data(lease_.client, nullptr);
+    for (const String& name : extraHeaders_) {
+      esp_http_client_delete_header(lease_.client, name.c_str());
+    }
+    httppool::release(lease_, keepAlive_);
+  }
+
+  bool begin(const String& url) {
+    if (!httppool::acquire(url, httpEventHandler, lease_)) {
+      return false;
+    }
+    esp_http_client_set_user_data(lease_.client, &cap_);
+    return true;
+  }
+
+  esp_http_client_handle_t client() const { return lease_.client; }
+
+  void setExtraHeader(const String& name, const String& value) {
+    esp_http_client_set_header(lease_.client, name.c_str(), value.c_str());
+    extraHeaders_.push_back(name);
+  }
+
+  // Sends the request line, headers and `body`, then reads the response headers. Returns the
+  // status code, or -1 with `err` set. A kept-alive connection the server has since dropped
+  // fails here, so that case is retried once on a fresh connection: always when the request
+  // never fully went out, otherwise only when `idempotent`, since the server may have acted on
+  // it before the connection dropped (a toggle would flip back).
+  int send(const String& body, bool idempotent, int& contentLength, esp_err_t& err) {
+    for (;;) {
+      err = esp_http_client_open(lease_.client, static_cast<int>(body.length()));
+      if (err == ESP_OK && !body.isEmpty() &&
+          esp_http_client_write(lease_.client, body.c_str(), static_cast<int>(body.length())) !=
+              static_cast<int>(body.length())) {
+        err = ESP_FAIL;
+      }
+      const bool sent = err == ESP_OK;
+      int status = -1;
+      if (sent) {
+        contentLength = esp_http_client_fetch_headers(lease_.client);
+        status = esp_http_client_get_status_code(lease_.client);
+      }
+      if (status > 0 || !lease_.reused || (sent && !idempotent)) {
+        return sent ? status : -1;
+      }
+      esp_http_client_close(lease_.client);
+      lease_.reused = false;
+      cap_ = HttpCapture();
+    }
+  }
+
+  void keepAlive() {
+    keepAlive_ = !cap_.connectionClose && esp_http_client_is_complete_data_received(lease_.client);
+  }
+
+ private:
+  HttpCapture& cap_;
+  httppool::Lease lease_;
+  std::vector<String> extraHeaders_;
+  bool keepAlive_ = false;
+};
+
+// Sets caller-supplied headers, skipping anything that could split the header block.
+void applyExtraHeaders(PooledRequest& request, const std::map<String, String>* extraHeaders) {
+  if (extraHeaders == nullptr) {
+    return;
+  }
+  for (const auto& kv : *extraHeaders) {
+    String name = kv.first;
+    name.trim();
+    if (name.isEmpty()) {
+      continue;
+    }
+    if (name.indexOf('\r') >= 0 || name.indexOf('\n') >= 0) {
+      continue;
+    }
+    String value = kv.second;
+    value.replace("\r", "");
+    value.replace("\n", "");
+    if (value.isEmpty()) {
+      continue;
+    }
+    request.setExtraHeader(name, value);
+  }
+}
+
+// TLS needs a large contiguous block for the handshake; an open pooled session does not.
+bool tlsPreflightBlocked(const String& url, uint32_t& largest) {
+  if (!url.startsWith("https://") || httppool::hasOpenSession(url)) {
+    return false;
+  }
+  largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  if (largest >= kMinLargestBlockForTls) {
+    return false;
   }
+  // Idle sessions to other hosts hold TLS buffers; drop them and look again.
+  httppool::closeIdle();
+  largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  return largest < kMinLargestBlockForTls;
 }
 
 }  // namespace
 
 bool HttpJsonClient::get(const String& url, JsonDocument& outDoc,
                          String* errorMessage, HttpFetchMeta* meta,
-                         const std::map<String, String>* extraHeaders) const {
+                         const std::map<String, String>* extraHeaders,
+                         const JsonDocument* filter,
+                         const HttpValidators* validators) const {
   if (meta != nullptr) {
     *meta = HttpFetchMeta();
   }
@@ -219,22 +368,6 @@ bool HttpJsonClient::get(const String& url, JsonDocument& outDoc,
     return false;
   }
 
-  if (url.startsWith("https://")) {
-    const uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
-    if (largest < kMinLargestBlockForTls) {
-      if (meta != nullptr) {
-        meta->statusCode = -2;
-        meta->transportReason = "tls-preflight-low-largest-block";
-        meta->elapsedMs = millis() - startMs;
-      }
-      if (errorMessage != nullptr) {
-        *errorMessage = "TLS preflight blocked: largest block too small (" + String(largest) +
-                        " < " + String(kMinLargestBlockForTls) + "), " + heapDiag();
-      }
-      return false;
-    }
-  }
-
   httpgate::Guard guard(7000);
   if (!guard.locked()) {
     if (errorMessage != nullptr) {
@@ -243,55 +376,63 @@ bool HttpJsonClient::get(const String& url, JsonDocument& outDoc,
     return false;
   }
 
+  uint32_t largest = 0;
+  if (tlsPreflightBlocked(url, largest)) {
+    if (meta != nullptr) {
+      meta->statusCode = -2;
+      meta->transportReason = "tls-preflight-low-largest-block";
+      meta->elapsedMs = millis() - startMs;
+    }
+    if (errorMessage != nullptr) {
+      *errorMessage = "TLS preflight blocked: largest block too small (" + String(largest) +
+                      " < " + String(kMinLargestBlockForTls) + "), " + heapDiag();
+    }
+    return false;
+  }
+
   HttpCapture cap;
-  esp_http_client_config_t cfg = {};
-  cfg.url = url.c_str();
-  cfg.timeout_ms = 3500;
-  cfg.disable_auto_redirect = false;
-  cfg.max_redirection_count = 5;
-  cfg.event_handler = httpEventHandler;
-  cfg.user_data = &cap;
-  cfg.buffer_size = 1024;
-  cfg.buffer_size_tx = 512;
-  cfg.skip_cert_common_name_check = false;
-  cfg.crt_bundle_attach = arduino_esp_crt_bundle_attach;
-
-  esp_http_client_handle_t client = esp_http_client_init(&cfg);
-  if (client == nullptr) {
+  PooledRequest request(cap);
+  if (!request.begin(url)) {
     noteBeginFailureAndReason("esp_http_client_init failed");
     if (errorMessage != nullptr) {
       *errorMessage = "HTTP init failed";
     }
     return false;
   }
+  esp_http_client_handle_t client = request.client();
 
   esp_http_client_set_method(client, HTTP_METHOD_GET);
   esp_http_client_set_header(client, "Accept", "application/json");
   esp_http_client_set_header(client, "User-Agent", "CoStar-ESP32/1.0");
   esp_http_client_set_header(client, "Accept-Encoding", "identity");
-  if (extraHeaders != nullptr) {
-    for (const auto& kv : *extraHeaders) {
-      String name = kv.first;
-      name.trim();
-      if (name.isEmpty()) {
-        continue;
-      }
-      if (name.indexOf('\r') >= 0 || name.indexOf('\n') >= 0) {
-        continue;
-      }
-      String value = kv.second;
-      value.replace("\r", "");
-      value.replace("\n", "");
-      if (value.isEmpty()) {
-        continue;
-      }
-      esp_http_client_set_header(client, name.c_str(), value.c_str());
+  applyExtraHeaders(request, extraHeaders);
+  if (validators != nullptr) {
+    if (!validators->etag.isEmpty()) {
+      request.setExtraHeader("If-None-Match", validators->etag);
+    }
+    if (!validators->lastModified.isEmpty()) {
+      request.setExtraHeader("If-Modified-Since", validators->lastModified);
     }
   }
 
-  const esp_err_t performErr = esp_http_client_perform(client);
-  const int statusCode = (performErr == ESP_OK) ? esp_http_client_get_status_code(client) : -1;
-  const int contentLengthBytes = esp_http_client_get_content_length(client);
+  // open/fetch_headers/read instead of perform(): perform() would buffer the whole body before
+  // we see it. Redirects are followed here because auto-redirect only applies to perform().
+  esp_err_t performErr = ESP_OK;
+  int statusCode = -1;
+  int contentLengthBytes = -1;
+  uint8_t hop = 0;
+  for (;; ++hop) {
+    // Headers the final response leaves out must not keep a redirect's values.
+    cap = HttpCapture();
+    statusCode = request.send(String(), true, contentLengthBytes, performErr);
+    if (performErr != ESP_OK || !isRedirectStatus(statusCode) || hop >= kMaxRedirects) {
+      break;
+    }
+    HttpBodyReader(client).drain();
+    esp_http_client_set_redirection(client);
+    esp_http_client_close(client);
+  }
+  HttpBodyReader reader(client);
 
   if (meta != nullptr) {
     meta->statusCode = statusCode;
@@ -317,7 +458,6 @@ bool HttpJsonClient::get(const String& url, JsonDocument& outDoc,
                       String(statusCode) + " reason='" + transportReason +
                       "' (may fail before request reaches server), " + heapDiag();
     }
-    esp_http_client_cleanup(client);
     return false;
   }
 
@@ -337,12 +477,30 @@ bool HttpJsonClient::get(const String& url, JsonDocument& outDoc,
     }
   }
 
+  if (statusCode == 304 && validators != nullptr && !validators->empty()) {
+    reader.drain();
+    if (meta != nullptr) {
+      meta->notModified = true;
+      meta->contentLengthBytes = 0;
+      // A 304 may refresh the validators; keep the old ones for any it leaves out.
+      meta->validators.etag = cap.etag.isEmpty() ? validators->etag : cap.etag;
+      meta->validators.lastModified =
+          cap.lastModified.isEmpty() ? validators->lastModified : cap.lastModified;
+      meta->elapsedMs = millis() - startMs;
+    }
+    if (hop == 0) {
+      request.keepAlive();
+    }
+    return true;
+  }
+
   if (statusCode < 200 || statusCode >= 300) {
-    String errorPayload = cap.body;
+    reader.drain();
+    const String& errorPayload = reader.head();
     if (meta != nullptr) {
       meta->contentType = contentType;
       meta->contentLengthBytes = contentLengthBytes;
-      meta->payloadBytes = errorPayload.length();
+      meta->payloadBytes = reader.bytesRead();
       meta->retryAfter = retryAfter;
       meta->elapsedMs = millis() - startMs;
     }
@@ -352,22 +510,36 @@ bool HttpJsonClient::get(const String& url, JsonDocument& outDoc,
                       "', preview='" + compactPreview(errorPayload, 120) + "', " +
                       heapDiag();
     }
-    esp_http_client_cleanup(client);
+    if (hop == 0) {
+      request.keepAlive();
+    }
     return false;
   }
 
-  String payload = cap.body;
-  esp_http_client_cleanup(client);
+  const bool haveJson = reader.skipToJson();
+  DeserializationError err = DeserializationError::EmptyInput;
+  if (haveJson) {
+    err = filter != nullptr
+              ? deserializeJson(outDoc, reader, DeserializationOption::Filter(*filter))
+              : deserializeJson(outDoc, reader);
+  }
+  // Read any trailing bytes so the connection can carry the next request.
+  reader.drain();
+  if (hop == 0) {
+    request.keepAlive();
+  }
 
   if (meta != nullptr) {
     meta->contentType = contentType;
     meta->contentLengthBytes = contentLengthBytes;
-    meta->payloadBytes = payload.length();
+    meta->payloadBytes = reader.bytesRead();
     meta->retryAfter = retryAfter;
+    meta->validators.etag = cap.etag;
+    meta->validators.lastModified = cap.lastModified;
     meta->elapsedMs = millis() - startMs;
   }
 
-  if (payload.length() == 0) {
+  if (reader.bytesRead() == 0) {
     if (errorMessage != nullptr) {
       *errorMessage = "Empty payload (status=" + String(statusCode) +
                       ", content-type='" + contentType + "', content-length='" +
@@ -378,21 +550,112 @@ bool HttpJsonClient::get(const String& url, JsonDocument& outDoc,
     return false;
   }
 
-  payload.trim();
-  if (payload.startsWith("\xEF\xBB\xBF")) {
-    payload = payload.substring(3);
-  }
-
-  String jsonBody = extractLikelyJson(payload);
-  const DeserializationError err = deserializeJson(outDoc, jsonBody);
   if (err) {
     if (errorMessage != nullptr) {
       *errorMessage = "JSON parse failed (" + String(err.c_str()) +
-                      "), bytes=" + String(payload.length()) + ", preview='" +
-                      compactPreview(payload) + "', " + heapDiag();
+                      "), bytes=" + String(static_cast<unsigned long>(reader.bytesRead())) +
+                      ", preview='" + compactPreview(reader.head()) + "', " + heapDiag();
+    }
+    return false;
+  }
+
+  return true;
+}
+
+bool HttpJsonClient::send(const String& method, const String& url, const String& body,
+                          const String& contentType,
+                          const std::map<String, String>* extraHeaders, int* statusOut,
+                          String* errorMessage) const {
+  if (statusOut != nullptr) {
+    *statusOut = 0;
+  }
+  esp_http_client_method_t httpMethod = HTTP_METHOD_POST;
+  if (method == "GET") {
+    httpMethod = HTTP_METHOD_GET;
+  } else if (method == "PUT") {
+    httpMethod = HTTP_METHOD_PUT;
+  } else if (method == "PATCH") {
+    httpMethod = HTTP_METHOD_PATCH;
+  } else if (method == "DELETE") {
+    httpMethod = HTTP_METHOD_DELETE;
+  } else if (method != "POST") {
+    if (errorMessage != nullptr) {
+      *errorMessage = "unsupported method " + method;
     }
     return false;
   }
 
+  const uint32_t startMs = millis();
+  if (inTransportOutageCooldown(errorMessage, nullptr, startMs)) {
+    return false;
+  }
+  if (!platform::net::isConnected()) {
+    if (errorMessage != nullptr) {
+      *errorMessage = "WiFi disconnected";
+    }
+    return false;
+  }
+
+  httpgate::Guard guard(7000);
+  if (!guard.locked()) {
+    if (errorMessage != nullptr) {
+      *errorMessage = "HTTP busy (transport gate timeout)";
+    }
+    return false;
+  }
+  uint32_t largest = 0;
+  if (tlsPreflightBlocked(url, largest)) {
+    if (errorMessage != nullptr) {
+      *errorMessage = "TLS preflight blocked: largest block too small (" + String(largest) + ")";
+    }
+    return false;
+  }
+
+  HttpCapture cap;
+  PooledRequest request(cap);
+  if (!request.begin(url)) {
+    noteBeginFailureAndReason("esp_http_client_init failed");
+    if (errorMessage != nullptr) {
+      *errorMessage = "HTTP begin failed";
+    }
+    return false;
+  }
+  esp_http_client_handle_t client = request.client();
+  esp_http_client_set_method(client, httpMethod);
+  esp_http_client_set_header(client, "Accept", "*/*");
+  esp_http_client_set_header(client, "User-Agent", "CoStar-ESP32/1.0");
+  esp_http_client_set_header(client, "Accept-Encoding", "identity");
+  if (!body.isEmpty()) {
+    request.setExtraHeader("Content-Type", contentType);
+  }
+  applyExtraHeaders(request, extraHeaders);
+
+  esp_err_t err = ESP_OK;
+  int contentLength = -1;
+  const bool idempotent = httpMethod == HTTP_METHOD_GET || httpMethod == HTTP_METHOD_HEAD;
+  const int status = request.send(body, idempotent, contentLength, err);
+  if (statusOut != nullptr) {
+    *statusOut = status;
+  }
+  if (err != ESP_OK || status <= 0) {
+    const String reason = err != ESP_OK ? String(esp_err_to_name(err)) : String("no-http-status");
+    noteTransportFailureAndReason(reason);
+    if (errorMessage != nullptr) {
+      *errorMessage = "status=" + String(status) + " reason='" + reason + "'";
+    }
+    return false;
+  }
+  noteSuccessfulHttpResponse();
+
+  HttpBodyReader reader(client);
+  reader.drain();
+  request.keepAlive();
+  if (status < 200 || status >= 300) {
+    if (errorMessage != nullptr) {
+      *errorMessage = "status=" + String(status) + " body='" + compactPreview(reader.head(), 72) +
+                      "'";
+    }
+    return false;
+  }
   return true;
 }
@@ -5,8 +5,20 @@
 
 #include <map>
 
+// Cache validators from an earlier 2xx response, replayed as If-None-Match/If-Modified-Since.
+struct HttpValidators {
+  String etag;
+  String lastModified;
+
+  bool empty() const { return etag.isEmpty() && lastModified.isEmpty(); }
+};
+
 struct HttpFetchMeta {
   int statusCode = 0;
+  // 304 to a conditional request: outDoc was left untouched and the body was never read.
+  bool notModified = false;
+  // Validators sent with the response, to pass back on the next poll of the same URL.
+  HttpValidators validators;
   int contentLengthBytes = -1;
   size_t payloadBytes = 0;
   String contentType;
@@ -15,9 +27,22 @@ struct HttpFetchMeta {
   uint32_t elapsedMs = 0;
 };
 
+// Requests go through services/HttpConnectionPool, so consecutive requests to one origin
+// reuse its TCP/TLS session.
 class HttpJsonClient {
  public:
+  // The body is deserialized straight from the socket. When `filter` is set it is passed to
+  // ArduinoJson as DeserializationOption::Filter, so only the selected members reach outDoc.
+  // With `validators` the request is conditional; a 304 returns true with meta->notModified.
   bool get(const String& url, JsonDocument& outDoc, String* errorMessage = nullptr,
            HttpFetchMeta* meta = nullptr,
-           const std::map<String, String>* extraHeaders = nullptr) const;
+           const std::map<String, String>* extraHeaders = nullptr,
+           const JsonDocument* filter = nullptr,
+           const HttpValidators* validators = nullptr) const;
+
+  // Sends a request whose response body is not needed (tap actions). Returns true on 2xx;
+  // otherwise errorMessage carries the status and a short preview of the response body.
+  bool send(const String& method, const String& url, const String& body,
+            const String& contentType, const std::map<String, String>* extraHeaders,
+            int* statusOut = nullptr, String* errorMessage = nullptr) const;
 };
@@ -0,0 +1,144 @@
+#include "services/HttpRequestQueue.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <utility>
+#include <vector>
+
+namespace {
+struct Job {
+  httpq::Priority priority = httpq::Priority::kPrefetch;
+  uint32_t seq = 0;
+  String key;
+  std::shared_ptr<void> result;
+  httpq::RunFn run;
+  std::vector<httpq::DoneFn> done;
+};
+
+constexpr size_t kMaxQueuedJobs = 24;
+constexpr uint32_t kWorkerStackBytes = 8192;
+
+SemaphoreHandle_t sQueueMutex = nullptr;
+TaskHandle_t sWorkerHandle = nullptr;
+std::vector<std::shared_ptr<Job>> sQueued;
+std::shared_ptr<Job> sRunning;
+uint32_t sNextSeq = 0;
+
+bool runsBefore(const Job& a, const Job& b) {
+  if (a.priority != b.priority) {
+    return static_cast<uint8_t>(a.priority) < static_cast<uint8_t>(b.priority);
+  }
+  return static_cast<int32_t>(a.seq - b.seq) < 0;
+}
+
+std::shared_ptr<Job> takeNextJob() {
+  xSemaphoreTake(sQueueMutex, portMAX_DELAY);
+  std::shared_ptr<Job> next;
+  auto best = sQueued.end();
+  for (auto it = sQueued.begin(); it != sQueued.end(); ++it) {
+    if (best == sQueued.end() || runsBefore(**it, **best)) {
+      best = it;
+    }
+  }
+  if (best != sQueued.end()) {
+    next = *best;
+    sQueued.erase(best);
+    sRunning = next;
+  }
+  xSemaphoreGive(sQueueMutex);
+  return next;
+}
+
+void workerLoop(void* arg) {
+  (void)arg;
+  for (;;) {
+    std::shared_ptr<Job> job = takeNextJob();
+    if (!job) {
+      // submitErased() notifies after queueing. The count keeps a job queued since the take
+      // above from being missed; a stale notification only costs one empty pass.
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
+
+    job->run(job->result.get());
+
+    // Subscribers may still attach while run() is in progress; collect them under the lock.
+    std::vector<httpq::DoneFn> done;
+    xSemaphoreTake(sQueueMutex, portMAX_DELAY);
+    done.swap(job->done);
+    sRunning.reset();
+    xSemaphoreGive(sQueueMutex);
+
+    const std::shared_ptr<const void> result = job->result;
+    for (const auto& fn : done) {
+      if (fn) {
+        fn(result);
+      }
+    }
+  }
+}
+}  // namespace
+
+namespace httpq {
+
+bool begin() {
+  if (sQueueMutex == nullptr) {
+    sQueueMutex = xSemaphoreCreateMutex();
+  }
+  if (sQueueMutex == nullptr) {
+    return false;
+  }
+  if (sWorkerHandle == nullptr) {
+    xTaskCreatePinnedToCore(workerLoop, "http-worker", kWorkerStackBytes, nullptr, 1,
+                            &sWorkerHandle, 0);
+  }
+  return sWorkerHandle != nullptr;
+}
+
+bool submitErased(Priority priority, const String& key, std::shared_ptr<void> result, RunFn run,
+                  DoneFn done) {
+  if (sQueueMutex == nullptr || sWorkerHandle == nullptr || !run) {
+    return false;
+  }
+
+  xSemaphoreTake(sQueueMutex, portMAX_DELAY);
+  if (!key.isEmpty()) {
+    if (sRunning && sRunning->key == key) {
+      sRunning->done.push_back(std::move(done));
+      xSemaphoreGive(sQueueMutex);
+      return true;
+    }
+    for (const auto& queued : sQueued) {
+      if (queued->key != key) {
+        continue;
+      }
+      if (static_cast<uint8_t>(priority) < static_cast<uint8_t>(queued->priority)) {
+        queued->priority = priority;
+      }
+      queued->done.push_back(std::move(done));
+      xSemaphoreGive(sQueueMutex);
+      return true;
+    }
+  }
+
+  if (sQueued.size() >= kMaxQueuedJobs) {
+    xSemaphoreGive(sQueueMutex);
+    return false;
+  }
+
+  std::shared_ptr<Job> job = std::make_shared<Job>();
+  job->priority = priority;
+  job->seq = sNextSeq++;
+  job->key = key;
+  job->result = std::move(result);
+  job->run = std::move(run);
+  job->done.push_back(std::move(done));
+  sQueued.push_back(std::move(job));
+  xSemaphoreGive(sQueueMutex);
+  xTaskNotifyGive(sWorkerHandle);
+  return true;
+}
+
+}  // namespace httpq
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <functional>
+#include <memory>
+
+// Single outbound request worker shared by widget fetches, tap actions and icon downloads.
+// Jobs run one at a time on a dedicated task, highest priority first, so a slow icon
+// download never holds up rendering and never sits ahead of a queued tap action.
+namespace httpq {
+
+// Lower values run first; equal priorities run in submission order.
+enum class Priority : uint8_t {
+  kTapAction = 0,
+  kVisibleData = 1,
+  kIcon = 2,
+  kPrefetch = 3,
+};
+
+using RunFn = std::function<void(void* result)>;
+using DoneFn = std::function<void(const std::shared_ptr<const void>& result)>;
+
+// Starts the worker task. Safe to call more than once; submit() fails until it has run.
+bool begin();
+
+// Type-erased form of submit(); callers should use the template below.
+bool submitErased(Priority priority, const String& key, std::shared_ptr<void> result, RunFn run,
+                  DoneFn done);
+
+// Queues `run` on the worker and calls `done` with its result once it returns. Both run on the
+// worker task, so `done` should only hand the result off. When `key` is not empty and a job
+// with the same key is already queued or running, `done` is attached to that job instead (its
+// priority is raised if needed) and `run` is dropped. Returns false if the queue is full or
+// begin() has not been called.
+template <typename Result>
+bool submit(Priority priority, const String& key, std::function<void(Result&)> run,
+            std::function<void(const std::shared_ptr<const Result>&)> done) {
+  return submitErased(
+      priority, key, std::make_shared<Result>(),
+      [run](void* result) { run(*static_cast<Result*>(result)); },
+      [done](const std::shared_ptr<const void>& result) {
+        done(std::static_pointer_cast<const Result>(result));
+      });
+}
+
+}  // namespace httpq
@@ -0,0 +1,358 @@
+#include "services/PollScheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "AppConfig.h"
+
+namespace {
+
+constexpr time_t kClockSetEpoch = 1609459200;  // 2021-01-01
+// A source that stopped asking (its widget went away mid-wait) no longer holds its place.
+constexpr uint32_t kWaiterStaleMs = 1000;
+constexpr uint32_t kMinJitterPollMs = 5000;
+
+bool before(uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) < 0; }
+
+long long daysFromCivil(int year, int mon, int day) {
+  year -= mon <= 2 ? 1 : 0;
+  const long long era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(year - era * 400);
+  const unsigned doy = (153 * (mon + (mon > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<long long>(doe) - 719468;
+}
+
+// IMF-fixdate, e.g. "Wed, 21 Oct 2015 07:28:00 GMT", as epoch seconds; -1 if malformed.
+long long parseHttpDate(const String& text) {
+  static const char kMonths[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  int day = 0;
+  int year = 0;
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+  char month[4] = {};
+  if (sscanf(text.c_str(), "%*3s, %d %3s %d %d:%d:%d", &day, month, &year, &hour, &minute,
+             &second) != 6) {
+    return -1;
+  }
+  const char* found = strstr(kMonths, month);
+  if (strlen(month) != 3 || found == nullptr || (found - kMonths) % 3 != 0) {
+    return -1;
+  }
+  const int mon = static_cast<int>((found - kMonths) / 3) + 1;
+  if (day < 1 || day > 31 || year < 1970 || hour > 23 || minute > 59 || second > 60) {
+    return -1;
+  }
+  return daysFromCivil(year, mon, day) * 86400LL + hour * 3600LL + minute * 60LL + second;
+}
+
+}  // namespace
+
+PollScheduler::PollScheduler(uint32_t seed) : rng_(seed == 0 ? 1 : seed) {}
+
+PollScheduler& PollScheduler::shared() {
+  static PollScheduler scheduler(static_cast<uint32_t>(random(1, 0x7FFFFFFF)));
+  return scheduler;
+}
+
+String PollScheduler::hostOf(const String& url) {
+  const int schemeEnd = url.indexOf("://");
+  const int start = schemeEnd < 0 ? 0 : schemeEnd + 3;
+  int end = start;
+  while (end < static_cast<int>(url.length()) && url[end] != '/' && url[end] != '?' &&
+         url[end] != '#' && url[end] != ':') {
+    ++end;
+  }
+  String host = url.substring(start, end);
+  const int at = host.lastIndexOf('@');
+  if (at >= 0) {
+    host = host.substring(at + 1);
+  }
+  host.toLowerCase();
+  return host;
+}
+
+PollScheduler::SourceId PollScheduler::add(const String& url, uint32_t pollMs) {
+  const SourceId id = nextId_++;
+  if (nextId_ == 0) {
+    nextId_ = 1;
+  }
+  Source& source = sources_[id];
+  source.host = hostOf(url);
+  source.pollMs = pollMs;
+  ++hosts_[source.host].sources;
+  return id;
+}
+
+void PollScheduler::remove(SourceId id) {
+  auto it = sources_.find(id);
+  if (it == sources_.end()) {
+    return;
+  }
+  auto host = hosts_.find(it->second.host);
+  if (host != hosts_.end()) {
+    if (host->second.sources > 0) {
+      --host->second.sources;
+    }
+    host->second.probing = host->second.probing && !it->second.granted;
+    // A backing-off host is remembered across layout switches.
+    if (host->second.sources == 0 && host->second.failureStreak == 0) {
+      hosts_.erase(host);
+    }
+  }
+  sources_.erase(it);
+}
+
+void PollScheduler::setPollMs(SourceId id, uint32_t pollMs) {
+  auto it = sources_.find(id);
+  if (it == sources_.end()) {
+    return;
+  }
+  Source& source = it->second;
+  source.pollMs = pollMs;
+  // A faster interval takes effect now rather than after the slower one runs out.
+  const uint32_t due = source.lastGrantMs + pollMs;
+  if (source.started && !source.granted && before(due, source.nextDueMs)) {
+    source.nextDueMs = due;
+  }
+}
+
+uint32_t PollScheduler::nextRandom() {
+  rng_ ^= rng_ << 13;
+  rng_ ^= rng_ >> 17;
+  rng_ ^= rng_ << 5;
+  return rng_;
+}
+
+uint32_t PollScheduler::jitterMs(uint32_t pollMs) {
+  if (pollMs < kMinJitterPollMs) {
+    return 0;
+  }
+  const uint32_t jitterMax = std::max(1000U, pollMs / 10U);
+  return nextRandom() % (jitterMax + 1);
+}
+
+uint32_t PollScheduler::backoffMs(uint8_t streak) {
+  const uint8_t shift = streak > 16 ? 16 : (streak == 0 ? 0 : streak - 1);
+  const uint64_t full = std::min<uint64_t>(
+      static_cast<uint64_t>(AppConfig::kPollBackoffBaseMs) << shift, AppConfig::kPollBackoffMaxMs);
+  // Half fixed, half random, so hosts failing together do not come back together.
+  const uint32_t half = static_cast<uint32_t>(full / 2);
+  return half + nextRandom() % (half + 1);
+}
+
+bool PollScheduler::budgetAvailable(uint32_t nowMs) const {
+  if (!budgetStarted_ || !before(nowMs, budgetTatMs_)) {
+    return true;
+  }
+  const uint32_t window = (AppConfig::kPollBudgetBurst - 1U) * AppConfig::kPollBudgetIntervalMs;
+  return budgetTatMs_ - nowMs <= window;
+}
+
+bool PollScheduler::firstInLine(SourceId id, const Source& source, uint32_t nowMs) const {
+  const uint32_t since = source.waitingSinceMs != 0 ? source.waitingSinceMs : nowMs;
+  for (const auto& kv : sources_) {
+    const Source& other = kv.second;
+    if (kv.first == id || other.waitingSinceMs == 0 || other.granted ||
+        nowMs - other.askedMs > kWaiterStaleMs) {
+      continue;
+    }
+    if (before(other.waitingSinceMs, since) || (other.waitingSinceMs == since && kv.first < id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PollScheduler::acquire(SourceId id, uint32_t nowMs, bool force) {
+  auto it = sources_.find(id);
+  if (it == sources_.end()) {
+    return true;
+  }
+  Source& source = it->second;
+  if (source.granted) {
+    return false;
+  }
+  source.askedMs = nowMs;
+  if (!force && source.started && before(nowMs, source.nextDueMs)) {
+    source.waitingSinceMs = 0;
+    return false;
+  }
+  if (outageRemainingMs(nowMs) > 0) {
+    return false;
+  }
+  Host& host = hosts_[source.host];
+  if (host.backoffUntilMs != 0) {
+    if (before(nowMs, host.backoffUntilMs)) {
+      return false;
+    }
+    host.backoffUntilMs = 0;
+  }
+  // After a backoff one request probes the host; the rest wait for its answer.
+  if (host.failureStreak > 0 && host.probing) {
+    return false;
+  }
+  if (!budgetAvailable(nowMs) || !firstInLine(id, source, nowMs)) {
+    if (source.waitingSinceMs == 0) {
+      source.waitingSinceMs = nowMs == 0 ? 1 : nowMs;
+    }
+    return false;
+  }
+
+  if (source.waitingSinceMs != 0) {
+    ++stats_.budgetDelayed;
+    stats_.maxBudgetWaitMs = std::max(stats_.maxBudgetWaitMs, nowMs - source.waitingSinceMs);
+    source.waitingSinceMs = 0;
+  }
+  budgetTatMs_ =
+      (budgetStarted_ && before(nowMs, budgetTatMs_) ? budgetTatMs_ : nowMs) +
+      AppConfig::kPollBudgetIntervalMs;
+  budgetStarted_ = true;
+  source.started = true;
+  source.granted = true;
+  source.lastGrantMs = nowMs;
+  source.nextDueMs = nowMs + source.pollMs + jitterMs(source.pollMs);
+  host.probing = host.failureStreak > 0;
+  ++stats_.granted;
+  return true;
+}
+
+void PollScheduler::complete(SourceId id, uint32_t nowMs, bool ok, int statusCode,
+                             const String& retryAfter) {
+  auto it = sources_.find(id);
+  if (it == sources_.end()) {
+    return;
+  }
+  Source& source = it->second;
+  source.granted = false;
+  Host& host = hosts_[source.host];
+  host.probing = false;
+  if (ok) {
+    if (host.failureStreak > 0) {
+      Serial.printf("[poll] host=%s recovered after %u failures\n", source.host.c_str(),
+                    static_cast<unsigned>(host.failureStreak));
+    }
+    host.failureStreak = 0;
+    host.backoffUntilMs = 0;
+    return;
+  }
+  if (statusCode == -2) {
+    // TLS preflight: our heap was short, the host never saw the request.
+    source.nextDueMs = nowMs + AppConfig::kPollLocalRetryMs;
+    return;
+  }
+  if (statusCode == -3) {
+    // Transport outage; acquire() holds every source until it ends.
+    source.nextDueMs = nowMs;
+    return;
+  }
+  const bool hostFault = statusCode <= 0 || statusCode == 429 || statusCode >= 500;
+  if (!hostFault) {
+    // Other errors (404, a body that did not parse) wait for the next poll as usual.
+    return;
+  }
+
+  ++stats_.hostFailures;
+  if (host.failureStreak < 255) {
+    ++host.failureStreak;
+  }
+  uint32_t waitMs = backoffMs(host.failureStreak);
+  if (statusCode == 429 || statusCode == 503) {
+    const uint32_t retryAfterMs = parseRetryAfterMs(retryAfter, time(nullptr));
+    if (retryAfterMs > 0) {
+      ++stats_.retryAfters;
+      waitMs = std::min(retryAfterMs, AppConfig::kPollRetryAfterMaxMs);
+    }
+  }
+  const uint32_t until = nowMs + waitMs;
+  if (host.backoffUntilMs == 0 || before(host.backoffUntilMs, until)) {
+    host.backoffUntilMs = until;
+  }
+  // Retry when the host allows it, not a whole poll interval later.
+  source.nextDueMs = nowMs;
+  Serial.printf("[poll] host=%s backoff_ms=%lu streak=%u status=%d\n", source.host.c_str(),
+                static_cast<unsigned long>(host.backoffUntilMs - nowMs),
+                static_cast<unsigned>(host.failureStreak), statusCode);
+}
+
+void PollScheduler::cancel(SourceId id) {
+  auto it = sources_.find(id);
+  if (it == sources_.end() || !it->second.granted) {
+    return;
+  }
+  Source& source = it->second;
+  source.granted = false;
+  source.nextDueMs = source.lastGrantMs;
+  hosts_[source.host].probing = false;
+}
+
+uint32_t PollScheduler::nextDueMs(SourceId id) const {
+  auto it = sources_.find(id);
+  return it == sources_.end() ? 0 : it->second.nextDueMs;
+}
+
+uint8_t PollScheduler::noteTransportFailure(uint32_t nowMs) {
+  uint8_t streak = transportStreak_.load();
+  while (streak < 255 && !transportStreak_.compare_exchange_weak(streak, streak + 1)) {
+  }
+  streak = streak < 255 ? streak + 1 : 255;
+  if (streak >= AppConfig::kTransportOutageThreshold) {
+    const uint32_t until = nowMs + AppConfig::kTransportOutageCooldownMs;
+    const uint32_t current = outageUntilMs_.load();
+    if (current == 0 || !before(nowMs, current)) {
+      outages_.fetch_add(1);
+    }
+    if (current == 0 || before(current, until)) {
+      outageUntilMs_.store(until == 0 ? 1 : until);
+    }
+  }
+  return streak;
+}
+
+void PollScheduler::noteTransportSuccess() {
+  transportStreak_.store(0);
+  outageUntilMs_.store(0);
+}
+
+uint32_t PollScheduler::outageRemainingMs(uint32_t nowMs) const {
+  const uint32_t until = outageUntilMs_.load();
+  if (until == 0 || !before(nowMs, until)) {
+    return 0;
+  }
+  return until - nowMs;
+}
+
+PollScheduler::Stats PollScheduler::stats() const {
+  Stats out = stats_;
+  out.outages = outages_.load();
+  return out;
+}
+
+uint32_t PollScheduler::parseRetryAfterMs(const String& value, time_t now) {
+  String text = value;
+  text.trim();
+  if (text.isEmpty()) {
+    return 0;
+  }
+  bool digits = true;
+  for (size_t i = 0; i < text.length() && digits; ++i) {
+    digits = text[i] >= '0' && text[i] <= '9';
+  }
+  if (digits) {
+    const unsigned long seconds = strtoul(text.c_str(), nullptr, 10);
+    if (seconds == 0) {
+      return 0;
+    }
+    return seconds > 4294967UL ? 0xFFFFFFFFU : static_cast<uint32_t>(seconds * 1000UL);
+  }
+  const long long at = parseHttpDate(text);
+  if (at < 0 || now < kClockSetEpoch || at <= static_cast<long long>(now)) {
+    return 0;
+  }
+  const long long deltaS = at - static_cast<long long>(now);
+  return deltaS > 4294967LL ? 0xFFFFFFFFU : static_cast<uint32_t>(deltaS * 1000LL);
+}
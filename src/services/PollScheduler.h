@@ -0,0 +1,106 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <atomic>
+#include <map>
+#include <time.h>
+
+// Decides when polled sources (one per DslWidget shared source) may request. Each source is
+// due one poll interval after its last request plus a little jitter, so sources with the same
+// interval drift apart. On top of that:
+//  - failures back off per host, doubling from kPollBackoffBaseMs with jitter; once the
+//    backoff expires a single source probes the host before the others follow;
+//  - a Retry-After header holds the whole host for as long as it asks;
+//  - requests draw from a global budget of kPollBudgetBurst back to back, then one per
+//    kPollBudgetIntervalMs, handed to the longest waiting source first;
+//  - kTransportOutageThreshold transport failures in a row (reported by HttpJsonClient) stop
+//    all requests for kTransportOutageCooldownMs.
+// Sources are only touched from widget code, which DisplayManager serializes; the transport
+// calls may come from any task.
+class PollScheduler {
+ public:
+  using SourceId = uint32_t;
+
+  struct Stats {
+    uint32_t granted = 0;
+    uint32_t budgetDelayed = 0;   // grants that first had to wait for the budget
+    uint32_t maxBudgetWaitMs = 0;
+    uint32_t hostFailures = 0;
+    uint32_t retryAfters = 0;     // failures that carried a usable Retry-After
+    uint32_t outages = 0;
+  };
+
+  explicit PollScheduler(uint32_t seed = 1);
+
+  // The scheduler used by widgets and HttpJsonClient.
+  static PollScheduler& shared();
+
+  // Registers a source polling `url` (only its host matters). Ids are never 0.
+  SourceId add(const String& url, uint32_t pollMs);
+  void remove(SourceId id);
+  void setPollMs(SourceId id, uint32_t pollMs);
+
+  // True when `id` may send a request now: it is due (or `force` is set, for first fetches
+  // and refreshes after a tap), its host is not backing off, no transport outage is on and
+  // the budget has room. A granted request must be followed by complete() or cancel().
+  bool acquire(SourceId id, uint32_t nowMs, bool force = false);
+  // Outcome of a granted request: statusCode as in HttpFetchMeta, ok when it was applied.
+  void complete(SourceId id, uint32_t nowMs, bool ok, int statusCode, const String& retryAfter);
+  // The granted request never went out (e.g. the request queue was full); the source stays
+  // due.
+  void cancel(SourceId id);
+  uint32_t nextDueMs(SourceId id) const;
+
+  // Transport layer. noteTransportFailure() returns the failure streak.
+  uint8_t noteTransportFailure(uint32_t nowMs);
+  void noteTransportSuccess();
+  uint32_t outageRemainingMs(uint32_t nowMs) const;
+
+  Stats stats() const;
+
+  // Retry-After as delta-seconds or an HTTP date (needs `now` from a set clock). 0 when
+  // missing or unparseable.
+  static uint32_t parseRetryAfterMs(const String& value, time_t now);
+  // Lowercased host of url, without scheme, port or path.
+  static String hostOf(const String& url);
+
+ private:
+  struct Host {
+    uint32_t sources = 0;
+    uint8_t failureStreak = 0;
+    uint32_t backoffUntilMs = 0;
+    bool probing = false;
+  };
+
+  struct Source {
+    String host;
+    uint32_t pollMs = 0;
+    bool started = false;
+    uint32_t nextDueMs = 0;
+    uint32_t lastGrantMs = 0;
+    bool granted = false;
+    // Last acquire() turned down by the budget alone; 0 when not waiting.
+    uint32_t waitingSinceMs = 0;
+    uint32_t askedMs = 0;
+  };
+
+  uint32_t nextRandom();
+  uint32_t jitterMs(uint32_t pollMs);
+  uint32_t backoffMs(uint8_t streak);
+  bool budgetAvailable(uint32_t nowMs) const;
+  bool firstInLine(SourceId id, const Source& source, uint32_t nowMs) const;
+
+  std::map<SourceId, Source> sources_;
+  std::map<String, Host> hosts_;
+  SourceId nextId_ = 1;
+  // GCRA form of the token bucket: the time the budget is fully spent up to.
+  uint32_t budgetTatMs_ = 0;
+  bool budgetStarted_ = false;
+  uint32_t rng_;
+  Stats stats_;
+
+  std::atomic<uint8_t> transportStreak_{0};
+  std::atomic<uint32_t> outageUntilMs_{0};
+  std::atomic<uint32_t> outages_{0};
+};
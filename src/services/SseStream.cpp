@@ -0,0 +1,476 @@
+#include "services/SseStream.h"
+
+#include <esp_crt_bundle.h>
+#include <esp_http_client.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <strings.h>
+
+#include "services/HttpTransportGate.h"
+
+namespace {
+
+constexpr size_t kMaxEventBytes = 8 * 1024;
+constexpr int kTaskStackBytes = 6144;
+constexpr int kConnectTimeoutMs = 10000;
+// esp_http_client_read() keeps reading until its buffer is full, so stream reads time out
+// after a short slice to hand partial buffers (and close requests) over promptly.
+constexpr int kReadSliceMs = 100;
+constexpr size_t kReadBytes = 256;
+// Servers keep idle streams open with comment lines; this much silence means a dead link.
+constexpr uint32_t kIdleTimeoutMs = 90000;
+constexpr uint32_t kReconnectMs = 3000;
+constexpr uint32_t kMinReconnectMs = 250;
+constexpr uint32_t kMaxReconnectMs = 60000;
+
+struct Subscriber {
+  String event;
+  uint32_t revision = 0;
+  String data;
+};
+
+struct EventStream {
+  String key;
+  String url;
+  std::map<String, String> headers;
+  std::map<sse::Handle, Subscriber> subs;
+  // Latest data per event type some subscriber took, for subscribers joining a live stream.
+  std::map<String, String> latest;
+  String latestType;
+  sse::Link link = sse::Link::kConnecting;
+  // No handles left; the task deletes the stream on its way out.
+  bool closing = false;
+  bool taskDone = false;
+
+  // Stream task only.
+  String contentType;
+  String lastEventId;
+  String idBuffer;
+  uint32_t retryMs = kReconnectMs;
+  String line;
+  size_t lineBytes = 0;
+  bool afterCr = false;
+  String eventType;
+  String data;
+  bool overflow = false;
+};
+
+enum class Attempt : uint8_t {
+  kLost,
+  kRejected,
+  kClosing,
+};
+
+SemaphoreHandle_t sMutex = nullptr;
+std::map<String, EventStream*> sStreams;
+std::map<sse::Handle, EventStream*> sHandles;
+sse::Handle sNextHandle = 1;
+sse::Stats sStats;
+
+class Lock {
+ public:
+  Lock() { xSemaphoreTake(sMutex, portMAX_DELAY); }
+  ~Lock() { xSemaphoreGive(sMutex); }
+};
+
+uint32_t nextRevision(uint32_t revision) { return revision + 1 == 0 ? 1 : revision + 1; }
+
+bool isClosing(EventStream& s) {
+  Lock lock;
+  return s.closing;
+}
+
+void setLink(EventStream& s, sse::Link link) {
+  Lock lock;
+  s.link = link;
+}
+
+void resetParser(EventStream& s) {
+  s.idBuffer = s.lastEventId;
+  s.line = "";
+  s.lineBytes = 0;
+  s.afterCr = false;
+  s.eventType = "";
+  s.data = "";
+  s.overflow = false;
+}
+
+void dispatch(EventStream& s) {
+  s.lastEventId = s.idBuffer;
+  if (s.overflow) {
+    Lock lock;
+    ++sStats.dropped;
+  } else if (!s.data.isEmpty()) {
+    s.data.remove(s.data.length() - 1);
+    const String type = s.eventType.isEmpty() ? String("message") : s.eventType;
+    Lock lock;
+    ++sStats.events;
+    bool taken = false;
+    for (auto& kv : s.subs) {
+      Subscriber& sub = kv.second;
+      if (sub.event.isEmpty() || sub.event == type) {
+        sub.data = s.data;
+        sub.revision = nextRevision(sub.revision);
+        taken = true;
+      }
+    }
+    if (taken) {
+      s.latest[type] = s.data;
+      s.latestType = type;
+    }
+  }
+  s.eventType = "";
+  s.data = "";
+  s.overflow = false;
+}
+
+void endLine(EventStream& s) {
+  const bool blank = s.lineBytes == 0;
+  s.lineBytes = 0;
+  if (blank) {
+    dispatch(s);
+    return;
+  }
+  // Lines starting with ':' are comments, which servers send as keep-alives.
+  if (s.overflow || s.line[0] == ':') {
+    s.line = "";
+    return;
+  }
+  const int colon = s.line.indexOf(':');
+  String value;
+  if (colon >= 0) {
+    const int start = colon + 1 < static_cast<int>(s.line.length()) && s.line[colon + 1] == ' '
+                          ? colon + 2
+                          : colon + 1;
+    value = s.line.substring(start);
+    s.line.remove(colon);
+  }
+  if (s.line == "data") {
+    s.data += value;
+    s.data += '\n';
+  } else if (s.line == "event") {
+    s.eventType = value;
+  } else if (s.line == "id") {
+    s.idBuffer = value;
+  } else if (s.line == "retry" && !value.isEmpty()) {
+    bool digits = true;
+    for (size_t i = 0; i < value.length(); ++i) {
+      digits = digits && value[i] >= '0' && value[i] <= '9';
+    }
+    if (digits) {
+      const uint32_t ms = static_cast<uint32_t>(value.toInt());
+      s.retryMs = ms < kMinReconnectMs ? kMinReconnectMs : ms;
+      s.retryMs = s.retryMs > kMaxReconnectMs ? kMaxReconnectMs : s.retryMs;
+    }
+  }
+  s.line = "";
+}
+
+void appendLine(EventStream& s, const char* bytes, size_t len) {
+  if (len == 0) {
+    return;
+  }
+  s.lineBytes += len;
+  if (s.overflow) {
+    return;
+  }
+  if (s.line.length() + s.data.length() + len > kMaxEventBytes) {
+    // The rest of the event is skipped up to its blank line.
+    s.overflow = true;
+    s.line = "";
+    return;
+  }
+  s.line.concat(bytes, len);
+}
+
+// Lines end in CRLF, LF or CR, and may be split anywhere across reads.
+void feed(EventStream& s, const char* bytes, size_t len) {
+  size_t start = 0;
+  for (size_t i = 0; i < len; ++i) {
+    const char c = bytes[i];
+    if (c != '\r' && c != '\n') {
+      continue;
+    }
+    if (c == '\n' && i == start && s.afterCr) {
+      s.afterCr = false;
+      start = i + 1;
+      continue;
+    }
+    appendLine(s, bytes + start, i - start);
+    start = i + 1;
+    s.afterCr = c == '\r';
+    endLine(s);
+  }
+  if (start < len) {
+    appendLine(s, bytes + start, len - start);
+    s.afterCr = false;
+  }
+}
+
+esp_err_t onHttpEvent(esp_http_client_event_t* evt) {
+  if (evt == nullptr || evt->user_data == nullptr || evt->event_id != HTTP_EVENT_ON_HEADER ||
+      evt->header_key == nullptr || evt->header_value == nullptr) {
+    return ESP_OK;
+  }
+  if (strcasecmp(evt->header_key, "Content-Type") == 0) {
+    EventStream* s = static_cast<EventStream*>(evt->user_data);
+    s->contentType = evt->header_value;
+    s->contentType.toLowerCase();
+  }
+  return ESP_OK;
+}
+
+// One connection: request, response check, then events until the stream ends or closes.
+Attempt runStream(EventStream& s, esp_http_client_handle_t client, bool& wentLive) {
+  esp_http_client_set_timeout_ms(client, kConnectTimeoutMs);
+  esp_http_client_set_header(client, "Accept", "text/event-stream");
+  esp_http_client_set_header(client, "Cache-Control", "no-cache");
+  for (const auto& kv : s.headers) {
+    esp_http_client_set_header(client, kv.first.c_str(), kv.second.c_str());
+  }
+  const bool resume = !s.lastEventId.isEmpty();
+  if (resume) {
+    esp_http_client_set_header(client, "Last-Event-ID", s.lastEventId.c_str());
+  } else {
+    esp_http_client_delete_header(client, "Last-Event-ID");
+  }
+  s.contentType = "";
+
+  int status = -1;
+  {
+    // Shares the TLS handshake budget with the request worker.
+    httpgate::Guard gate(kConnectTimeoutMs);
+    if (!gate.locked() || esp_http_client_open(client, 0) != ESP_OK) {
+      return Attempt::kLost;
+    }
+    {
+      Lock lock;
+      ++sStats.connects;
+      sStats.resumes += resume ? 1 : 0;
+    }
+    if (esp_http_client_fetch_headers(client) >= 0) {
+      status = esp_http_client_get_status_code(client);
+    }
+  }
+  if (status != 200 || !s.contentType.startsWith("text/event-stream")) {
+    Serial.printf("[sse] %s status=%d type='%s'\n", s.url.c_str(), status,
+                  s.contentType.c_str());
+    return status <= 0 || status == 429 || status >= 500 ? Attempt::kLost : Attempt::kRejected;
+  }
+
+  resetParser(s);
+  setLink(s, sse::Link::kLive);
+  wentLive = true;
+  Serial.printf("[sse] live %s%s%s\n", s.url.c_str(), resume ? " last_id=" : "",
+                resume ? s.lastEventId.c_str() : "");
+  esp_http_client_set_timeout_ms(client, kReadSliceMs);
+  char buf[kReadBytes];
+  uint32_t lastByteMs = millis();
+  for (;;) {
+    if (isClosing(s)) {
+      return Attempt::kClosing;
+    }
+    const int n = esp_http_client_read(client, buf, sizeof(buf));
+    if (n > 0) {
+      feed(s, buf, static_cast<size_t>(n));
+      lastByteMs = millis();
+      continue;
+    }
+    // An empty slice reads 0 on ESP-IDF 4 and -ESP_ERR_HTTP_EAGAIN on 5; only kIdleTimeoutMs
+    // of those ends the attempt. A partial event at the end of a stream is discarded.
+    const bool failed = n < 0 && n != -ESP_ERR_HTTP_EAGAIN;
+    if (failed || esp_http_client_is_complete_data_received(client) ||
+        millis() - lastByteMs >= kIdleTimeoutMs) {
+      return Attempt::kLost;
+    }
+  }
+}
+
+void streamTask(void* arg) {
+  EventStream* s = static_cast<EventStream*>(arg);
+  esp_http_client_config_t cfg = {};
+  cfg.url = s->url.c_str();
+  cfg.timeout_ms = kConnectTimeoutMs;
+  cfg.event_handler = onHttpEvent;
+  cfg.user_data = s;
+  cfg.buffer_size = 1024;
+  cfg.buffer_size_tx = 512;
+  cfg.skip_cert_common_name_check = false;
+  cfg.crt_bundle_attach = arduino_esp_crt_bundle_attach;
+  esp_http_client_handle_t client = esp_http_client_init(&cfg);
+  // Attempts in a row that never got to read events.
+  uint32_t failures = 0;
+  bool rejected = client == nullptr;
+  while (!rejected && !isClosing(*s)) {
+    bool wentLive = false;
+    const Attempt attempt = runStream(*s, client, wentLive);
+    esp_http_client_close(client);
+    if (attempt == Attempt::kClosing) {
+      break;
+    }
+    if (attempt == Attempt::kRejected) {
+      rejected = true;
+      break;
+    }
+    setLink(*s, sse::Link::kDown);
+    failures = wentLive ? 0 : failures + 1;
+    const uint32_t doublings = failures == 0 ? 0 : failures - 1;
+    uint32_t waitMs = s->retryMs << (doublings < 5 ? doublings : 5);
+    waitMs = waitMs > kMaxReconnectMs ? kMaxReconnectMs : waitMs;
+    Serial.printf("[sse] lost %s, retry in %lums\n", s->url.c_str(),
+                  static_cast<unsigned long>(waitMs));
+    for (uint32_t waited = 0; waited < waitMs && !isClosing(*s); waited += kReadSliceMs) {
+      vTaskDelay(pdMS_TO_TICKS(kReadSliceMs));
+    }
+  }
+  if (client != nullptr) {
+    esp_http_client_cleanup(client);
+  }
+
+  bool owner;
+  {
+    Lock lock;
+    if (rejected) {
+      s->link = sse::Link::kFailed;
+    }
+    s->taskDone = true;
+    owner = s->closing;
+  }
+  if (owner) {
+    Serial.printf("[sse] closed %s\n", s->url.c_str());
+    delete s;
+  }
+  vTaskDelete(nullptr);
+}
+
+}  // namespace
+
+namespace sse {
+
+Handle open(const String& url, const std::map<String, String>& headers, const String& event) {
+  if (!url.startsWith("http://") && !url.startsWith("https://")) {
+    return 0;
+  }
+  if (sMutex == nullptr) {
+    sMutex = xSemaphoreCreateMutex();
+  }
+  String key = url;
+  for (const auto& kv : headers) {
+    key += "|" + kv.first + "=" + kv.second;
+  }
+  EventStream* start = nullptr;
+  Handle handle;
+  {
+    Lock lock;
+    EventStream*& stream = sStreams[key];
+    if (stream == nullptr) {
+      stream = new EventStream();
+      stream->key = key;
+      stream->url = url;
+      stream->headers = headers;
+      start = stream;
+    }
+    handle = sNextHandle++;
+    Subscriber& sub = stream->subs[handle];
+    sub.event = event;
+    const String& type = event.isEmpty() ? stream->latestType : event;
+    auto latest = stream->latest.find(type);
+    if (latest != stream->latest.end()) {
+      sub.data = latest->second;
+      sub.revision = 1;
+    }
+    sHandles[handle] = stream;
+  }
+  if (start != nullptr) {
+    // Subscribed before the task starts, so it never reads without a subscriber.
+    Serial.printf("[sse] connecting %s\n", url.c_str());
+    if (xTaskCreatePinnedToCore(streamTask, "sse", kTaskStackBytes, start, 1, nullptr, 0) !=
+        pdPASS) {
+      Lock lock;
+      start->link = Link::kFailed;
+      start->taskDone = true;
+    }
+  }
+  return handle;
+}
+
+void close(Handle handle) {
+  if (sMutex == nullptr || handle == 0) {
+    return;
+  }
+  EventStream* done = nullptr;
+  {
+    Lock lock;
+    auto it = sHandles.find(handle);
+    if (it == sHandles.end()) {
+      return;
+    }
+    EventStream* stream = it->second;
+    stream->subs.erase(handle);
+    sHandles.erase(it);
+    if (stream->subs.empty()) {
+      sStreams.erase(stream->key);
+      stream->closing = true;
+      // A running task sees `closing` within one read slice and deletes the stream itself.
+      if (stream->taskDone) {
+        done = stream;
+      }
+    }
+  }
+  if (done != nullptr) {
+    Serial.printf("[sse] closed %s\n", done->url.c_str());
+    delete done;
+  }
+}
+
+uint32_t revision(Handle handle) {
+  if (sMutex == nullptr) {
+    return 0;
+  }
+  Lock lock;
+  auto it = sHandles.find(handle);
+  if (it == sHandles.end()) {
+    return 0;
+  }
+  auto sub = it->second->subs.find(handle);
+  return sub == it->second->subs.end() ? 0 : sub->second.revision;
+}
+
+bool read(Handle handle, uint32_t& seen, String& out) {
+  if (sMutex == nullptr) {
+    return false;
+  }
+  Lock lock;
+  auto it = sHandles.find(handle);
+  if (it == sHandles.end()) {
+    return false;
+  }
+  auto sub = it->second->subs.find(handle);
+  if (sub == it->second->subs.end() || sub->second.revision == 0 ||
+      sub->second.revision == seen) {
+    return false;
+  }
+  out = sub->second.data;
+  seen = sub->second.revision;
+  return true;
+}
+
+Link link(Handle handle) {
+  if (sMutex == nullptr) {
+    return Link::kConnecting;
+  }
+  Lock lock;
+  auto it = sHandles.find(handle);
+  return it == sHandles.end() ? Link::kDown : it->second->link;
+}
+
+Stats stats() {
+  if (sMutex == nullptr) {
+    return Stats();
+  }
+  Lock lock;
+  return sStats;
+}
+
+}  // namespace sse
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <map>
+
+// Server-Sent Events streams for `source: "sse"` widgets. Each URL + header set gets one
+// streaming GET (Accept: text/event-stream) on its own task, shared by every widget that opens
+// it; events are parsed as bytes arrive and each subscriber keeps the data of the latest event
+// it takes. Lost streams reconnect after the server's `retry:` (kReconnectMs by default,
+// doubled per failed attempt) and resume with Last-Event-ID. A response other than 200
+// text/event-stream stops the stream for good, except 429 and 5xx, which are retried.
+// All calls come from widget code, which DisplayManager serializes; the stream tasks only
+// touch subscriber state under the service's lock.
+namespace sse {
+
+enum class Link : uint8_t {
+  kConnecting = 0,
+  kLive,    // response headers accepted, reading events
+  kDown,    // lost, reconnecting
+  kFailed,  // rejected by the server, not retried
+};
+
+using Handle = uint32_t;
+
+struct Stats {
+  uint32_t connects = 0;
+  uint32_t resumes = 0;  // connects that sent Last-Event-ID
+  uint32_t events = 0;
+  uint32_t dropped = 0;  // events over kMaxEventBytes
+};
+
+// Subscribes to the stream for (url, headers), opening it when needed. `event` takes only
+// events of that type ("message" for events without one); empty takes every event. Returns 0
+// when url is not http(s).
+Handle open(const String& url, const std::map<String, String>& headers, const String& event);
+// The stream closes with its last handle.
+void close(Handle handle);
+
+// Bumped for every event the handle takes; 0 until the first one.
+uint32_t revision(Handle handle);
+// Copies the latest event's data into `out` when its revision differs from `seen`, and
+// updates `seen`.
+bool read(Handle handle, uint32_t& seen, String& out);
+Link link(Handle handle);
+
+Stats stats();
+
+}  // namespace sse
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Packed icon format ("rgb565rle"), written by tools/icon_pack.py and the image proxy in place of
+// raw RGB565 whenever it is smaller. Icon files keep their names; a file shorter than
+// w * h * 2 bytes is packed, anything else is raw. DslWidget also keeps modal save-under pixels
+// in this format (see Encoder).
+//
+//   0  "CIC1"
+//   4  width, height (uint16 LE)
+//   8  palette size (uint16 LE); 0 means pixels are stored directly
+//  10  palette: RGB565 values as they appear in the raw format (uint16 LE each)
+//      then runs covering the pixels in row order:
+//        0x80 | (n - 1), value       n copies of one pixel (n <= 128)
+//        n - 1, value * n            n pixels as they are (n <= 128)
+//      where a value is one palette index byte, or a uint16 LE pixel without a palette.
+namespace iconcodec {
+
+constexpr size_t kHeaderBytes = 10;
+
+struct Header {
+  uint16_t w = 0;
+  uint16_t h = 0;
+  uint16_t paletteSize = 0;
+};
+
+inline uint16_t readLe16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline bool readHeader(const uint8_t* data, size_t len, Header& out) {
+  if (len < kHeaderBytes || data[0] != 'C' || data[1] != 'I' || data[2] != 'C' ||
+      data[3] != '1') {
+    return false;
+  }
+  out.w = readLe16(data + 4);
+  out.h = readLe16(data + 6);
+  out.paletteSize = readLe16(data + 8);
+  return out.paletteSize <= 256;
+}
+
+// Streams pixels out of a packed icon, so callers can decode strip by strip straight into the
+// buffer they push. `data` must stay valid while the decoder is used.
+class Decoder {
+ public:
+  Decoder(const uint8_t* data, size_t len) : data_(data), len_(len) {
+    Header header;
+    if (readHeader(data, len, header) && len >= kHeaderBytes + header.paletteSize * 2U) {
+      paletteSize_ = header.paletteSize;
+      pos_ = kHeaderBytes + paletteSize_ * 2U;
+    } else {
+      pos_ = len;
+    }
+  }
+
+  // Writes the next `count` pixels to `out` (or just skips them when out is null). False when
+  // the stream is malformed or ends early.
+  bool read(uint16_t* out, size_t count) {
+    while (count > 0) {
+      if (runLeft_ > 0) {
+        const size_t n = runLeft_ < count ? runLeft_ : count;
+        if (out != nullptr) {
+          for (size_t i = 0; i < n; ++i) {
+            out[i] = runValue_;
+          }
+          out += n;
+        }
+        runLeft_ -= n;
+        count -= n;
+        continue;
+      }
+      if (literalLeft_ > 0) {
+        const size_t n = literalLeft_ < count ? literalLeft_ : count;
+        for (size_t i = 0; i < n; ++i) {
+          uint16_t value = 0;
+          if (!nextValue(value)) {
+            return false;
+          }
+          if (out != nullptr) {
+            *out++ = value;
+          }
+        }
+        literalLeft_ -= n;
+        count -= n;
+        continue;
+      }
+      if (pos_ >= len_) {
+        return false;
+      }
+      const uint8_t token = data_[pos_++];
+      if ((token & 0x80) != 0) {
+        runLeft_ = (token & 0x7F) + 1U;
+        if (!nextValue(runValue_)) {
+          return false;
+        }
+      } else {
+        literalLeft_ = token + 1U;
+      }
+    }
+    return true;
+  }
+
+  // True once every run has been consumed and no bytes are left over.
+  bool finished() const { return runLeft_ == 0 && literalLeft_ == 0 && pos_ == len_; }
+
+ private:
+  bool nextValue(uint16_t& out) {
+    if (paletteSize_ > 0) {
+      if (pos_ >= len_ || data_[pos_] >= paletteSize_) {
+        return false;
+      }
+      out = readLe16(data_ + kHeaderBytes + data_[pos_] * 2U);
+      ++pos_;
+      return true;
+    }
+    if (pos_ + 2 > len_) {
+      return false;
+    }
+    out = readLe16(data_ + pos_);
+    pos_ += 2;
+    return true;
+  }
+
+  const uint8_t* data_;
+  size_t len_;
+  size_t pos_ = 0;
+  uint16_t paletteSize_ = 0;
+  size_t runLeft_ = 0;
+  size_t literalLeft_ = 0;
+  uint16_t runValue_ = 0;
+};
+
+// Packs pixels as they arrive, without a palette, so a screen region can be kept compactly
+// while it is rasterized strip by strip. Output stops at `maxBytes`; finish() then fails.
+class Encoder {
+ public:
+  Encoder(std::vector<uint8_t>& out, uint16_t w, uint16_t h, size_t maxBytes)
+      : out_(out), maxBytes_(maxBytes) {
+    out_.clear();
+    for (const char c : {'C', 'I', 'C', '1'}) {
+      put(static_cast<uint8_t>(c));
+    }
+    putValue(w);
+    putValue(h);
+    putValue(0);  // no palette
+  }
+
+  void write(const uint16_t* pixels, size_t count) {
+    for (size_t i = 0; i < count && !overflow_; ++i) {
+      if (runLength_ > 0 && pixels[i] == runValue_ && runLength_ < kMaxRun) {
+        ++runLength_;
+        continue;
+      }
+      closeRun();
+      runValue_ = pixels[i];
+      runLength_ = 1;
+    }
+  }
+
+  bool overflowed() const { return overflow_; }
+
+  // Flushes what is pending; false when the output hit maxBytes.
+  bool finish() {
+    closeRun();
+    flushLiteral();
+    return !overflow_;
+  }
+
+ private:
+  static constexpr size_t kMaxRun = 128;
+
+  void put(uint8_t b) {
+    if (out_.size() >= maxBytes_) {
+      overflow_ = true;
+      return;
+    }
+    out_.push_back(b);
+  }
+
+  void putValue(uint16_t value) {
+    put(static_cast<uint8_t>(value));
+    put(static_cast<uint8_t>(value >> 8));
+  }
+
+  void flushLiteral() {
+    if (literalLength_ == 0) {
+      return;
+    }
+    put(static_cast<uint8_t>(literalLength_ - 1));
+    for (size_t i = 0; i < literalLength_; ++i) {
+      putValue(literal_[i]);
+    }
+    literalLength_ = 0;
+  }
+
+  void closeRun() {
+    if (runLength_ >= 2) {
+      flushLiteral();
+      put(static_cast<uint8_t>(0x80 | (runLength_ - 1)));
+      putValue(runValue_);
+    } else if (runLength_ == 1) {
+      literal_[literalLength_++] = runValue_;
+      if (literalLength_ == kMaxRun) {
+        flushLiteral();
+      }
+    }
+    runLength_ = 0;
+  }
+
+  std::vector<uint8_t>& out_;
+  size_t maxBytes_;
+  bool overflow_ = false;
+  uint16_t runValue_ = 0;
+  size_t runLength_ = 0;
+  uint16_t literal_[kMaxRun];
+  size_t literalLength_ = 0;
+};
+
+// Whether `data` is a packed w x h icon whose runs cover exactly w * h pixels.
+inline bool validate(const uint8_t* data, size_t len, uint16_t w, uint16_t h) {
+  Header header;
+  if (!readHeader(data, len, header) || header.w != w || header.h != h) {
+    return false;
+  }
+  Decoder decoder(data, len);
+  return decoder.read(nullptr, static_cast<size_t>(w) * h) && decoder.finished();
+}
+
+}  // namespace iconcodec
@@ -1,4 +1,56 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
 void clearDslRuntimeCaches();
 
+// Icon cache (loadIcon in DslWidgetRender.cpp): LRU within a byte budget, which defaults to
+// COSTAR_ICON_CACHE_BYTES. Packed icons are held packed and count at their packed size.
+// Counters run since boot; bytes, psramBytes and entries are the current contents.
+struct DslIconCacheStats {
+  uint32_t hits = 0;
+  uint32_t misses = 0;
+  // Served from the memory-mapped built-in icon pack, bypassing the cache.
+  uint32_t builtinHits = 0;
+  uint32_t evictions = 0;
+  size_t bytes = 0;
+  size_t psramBytes = 0;
+  size_t entries = 0;
+};
+DslIconCacheStats dslIconCacheStats();
+// Evicts down to the new budget right away.
+void setDslIconCacheBudget(size_t bytes);
+
+// Modal save-under (DslWidget::render): pixels beneath an open modal are kept packed, up to
+// this many bytes per widget (COSTAR_SAVE_UNDER_BYTES by default), and put back on dismiss.
+// 0 disables it, so modals repaint the whole widget as they open and close.
+void setDslSaveUnderBudget(size_t bytes);
+
+// Per-widget field cache on LittleFS (DslWidgetCache.cpp), read by begin() and written after
+// fetches. On by default; the host tools turn it off unless asked so runs stay reproducible.
+void setDslFieldCacheEnabled(bool enabled);
+
+// Rendered-label bitmap cache (see drawCachedLabel in DslWidgetRender.cpp). Hits and misses
+// count label draws since boot; bytes and entries are the current contents.
+struct DslLabelCacheStats {
+  uint32_t hits = 0;
+  uint32_t misses = 0;
+  size_t bytes = 0;
+  size_t entries = 0;
+};
+DslLabelCacheStats dslLabelCacheStats();
+
+// Line breaks of one wrapped text block (see wrapLabelLines in DslWidgetRender.cpp), reused
+// while the text, font and wrap width stay the same.
+struct DslWrapMemo {
+  bool valid = false;
+  uint32_t textHash = 0;
+  size_t textLength = 0;
+  uint8_t font = 0;
+  int16_t width = 0;
+  // [start, end) byte offsets into the text, two per line.
+  std::vector<uint16_t> breaks;
+};
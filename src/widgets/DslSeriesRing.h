@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+// Sample history behind a sparkline node, sized once from the node width (one sample per plot
+// column) so a long-running series never grows. Appending overwrites the oldest sample and
+// keeps min/max up to date; they are only rescanned when the sample leaving was an extreme.
+class DslSeriesRing {
+ public:
+  void reset(size_t capacity) {
+    values_.reset(capacity > 0 ? new float[capacity] : nullptr);
+    capacity_ = capacity;
+    clear();
+  }
+
+  void clear() {
+    if (size_ > 0) {
+      ++revision_;
+    }
+    head_ = 0;
+    size_ = 0;
+    min_ = 0.0f;
+    max_ = 0.0f;
+  }
+
+  void push(float value) {
+    if (capacity_ == 0) {
+      return;
+    }
+    ++revision_;
+    if (size_ < capacity_) {
+      values_[(head_ + size_) % capacity_] = value;
+      ++size_;
+      if (size_ == 1 || value < min_) min_ = value;
+      if (size_ == 1 || value > max_) max_ = value;
+      return;
+    }
+    const float evicted = values_[head_];
+    values_[head_] = value;
+    head_ = (head_ + 1) % capacity_;
+    if (evicted <= min_ || evicted >= max_) {
+      rescan();
+      return;
+    }
+    if (value < min_) min_ = value;
+    if (value > max_) max_ = value;
+  }
+
+  // Makes the ring hold the newest samples of `values` (a whole series as received). When the
+  // series only moved on by a few samples, those are appended instead of reloading everything.
+  // Returns false when nothing changed.
+  bool assign(const float* values, size_t count) {
+    const size_t target = count < capacity_ ? count : capacity_;
+    for (size_t added = 0; added <= kMaxAppend && added <= target; ++added) {
+      const size_t keep = target - added;
+      // Samples older than `keep` can only drop out by overflowing a full ring.
+      if (keep > size_ || (keep < size_ && target < capacity_)) {
+        continue;
+      }
+      bool match = true;
+      const float* expected = values + (count - added - keep);
+      for (size_t i = 0; i < keep && match; ++i) {
+        match = at(size_ - keep + i) == expected[i];
+      }
+      if (!match) {
+        continue;
+      }
+      for (size_t i = count - added; i < count; ++i) {
+        push(values[i]);
+      }
+      return added > 0;
+    }
+    clear();
+    for (size_t i = count - target; i < count; ++i) {
+      push(values[i]);
+    }
+    return true;
+  }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  // 0 is the oldest sample.
+  float at(size_t index) const { return values_[(head_ + index) % capacity_]; }
+  float min() const { return min_; }
+  float max() const { return max_; }
+  // Changes whenever the contents do.
+  uint32_t revision() const { return revision_; }
+
+ private:
+  // Larger jumps between two received series reload the ring.
+  static constexpr size_t kMaxAppend = 8;
+
+  void rescan() {
+    min_ = at(0);
+    max_ = min_;
+    for (size_t i = 1; i < size_; ++i) {
+      const float v = at(i);
+      if (v < min_) min_ = v;
+      if (v > max_) max_ = v;
+    }
+  }
+
+  std::unique_ptr<float[]> values_;
+  size_t capacity_ = 0;
+  size_t head_ = 0;
+  size_t size_ = 0;
+  float min_ = 0.0f;
+  float max_ = 0.0f;
+  uint32_t revision_ = 0;
+};
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <utility>
+
+// Scanline fills for the DSL's curved and wide shapes (arc rings, moon phase, thick lines).
+// Shapes are sampled at pixel centres (or 2x2 per pixel when anti-aliased) and every run of
+// equal colour on a row goes out as one drawFastHLine, instead of one drawPixel per pixel.
+// Shape coordinates are relative to the origin pixel passed to fillShape().
+namespace spanraster {
+
+// Scales fg towards bg by coverage/4.
+inline uint16_t blend565(uint16_t fg, uint16_t bg, uint8_t coverage) {
+  const uint32_t a = coverage;
+  const uint32_t b = 4U - a;
+  const uint32_t r = (((fg >> 11) & 0x1F) * a + ((bg >> 11) & 0x1F) * b + 2U) / 4U;
+  const uint32_t g = (((fg >> 5) & 0x3F) * a + ((bg >> 5) & 0x3F) * b + 2U) / 4U;
+  const uint32_t bl = ((fg & 0x1F) * a + (bg & 0x1F) * b + 2U) / 4U;
+  return static_cast<uint16_t>((r << 11) | (g << 5) | bl);
+}
+
+// Annulus between radii r - thickness and r (matching the old per-angle plot), limited to the
+// clockwise sweep from startDeg to endDeg with 0 at 12 o'clock. Empty when endDeg < startDeg.
+class RingSector {
+ public:
+  RingSector(int32_t r, int32_t thickness, float startDeg, float endDeg) {
+    const float sweep = endDeg - startDeg;
+    empty_ = r <= 0 || sweep < 0.0f;
+    full_ = sweep >= 360.0f;
+    wide_ = sweep > 180.0f;
+    outer2_ = (r + 0.5f) * (r + 0.5f);
+    const int32_t inner = r - (thickness > 0 ? thickness : 1);
+    inner2_ = inner >= 0 ? (inner + 0.5f) * (inner + 0.5f) : -1.0f;
+    reach_ = r + 1;
+    const float s = startDeg * (3.14159265f / 180.0f);
+    const float e = endDeg * (3.14159265f / 180.0f);
+    sx_ = sinf(s);
+    sy_ = -cosf(s);
+    ex_ = sinf(e);
+    ey_ = -cosf(e);
+  }
+
+  int32_t top() const { return empty_ ? 1 : -reach_; }
+  int32_t bottom() const { return empty_ ? 0 : reach_; }
+
+  // Up to two conservative [lo, hi] column ranges for row dy; the hole is skipped.
+  int rowRanges(int32_t dy, int32_t (&lo)[2], int32_t (&hi)[2]) const {
+    const float ady = dy < 0 ? -dy : dy;
+    const float near = ady > 0.5f ? ady - 0.5f : 0.0f;
+    if (near * near > outer2_) {
+      return 0;
+    }
+    const int32_t outer = static_cast<int32_t>(sqrtf(outer2_ - near * near)) + 1;
+    const float far = ady + 0.5f;
+    const float hole2 = inner2_ - far * far;
+    const int32_t hole = hole2 > 0.0f ? static_cast<int32_t>(sqrtf(hole2)) - 1 : 0;
+    if (hole <= 0) {
+      lo[0] = -outer;
+      hi[0] = outer;
+      return 1;
+    }
+    lo[0] = -outer;
+    hi[0] = -hole;
+    lo[1] = hole;
+    hi[1] = outer;
+    return 2;
+  }
+
+  bool contains(float x, float y) const {
+    const float d2 = x * x + y * y;
+    if (d2 > outer2_ || d2 <= inner2_) {
+      return false;
+    }
+    if (full_) {
+      return true;
+    }
+    if (wide_) {
+      // Outside the (narrower than 180 degree) gap from end back round to start.
+      return !(cross(ex_, ey_, x, y) > 0.0f && cross(x, y, sx_, sy_) > 0.0f);
+    }
+    // The bisector test keeps a zero-width sweep from matching the opposite ray.
+    return cross(sx_, sy_, x, y) >= 0.0f && cross(x, y, ex_, ey_) >= 0.0f &&
+           x * (sx_ + ex_) + y * (sy_ + ey_) >= 0.0f;
+  }
+
+ private:
+  // Positive when b is clockwise of a on screen (y down).
+  static float cross(float ax, float ay, float bx, float by) { return ax * by - ay * bx; }
+
+  bool empty_ = false;
+  bool full_ = false;
+  bool wide_ = false;
+  float outer2_ = 0.0f;
+  float inner2_ = 0.0f;
+  int32_t reach_ = 0;
+  float sx_ = 0.0f;
+  float sy_ = 0.0f;
+  float ex_ = 0.0f;
+  float ey_ = 0.0f;
+};
+
+// Lit part of a moon disc of radius r: right of the terminator column while waxing, left of
+// it while waning.
+class LitDisc {
+ public:
+  LitDisc(int32_t r, float terminator, bool waxing)
+      : r_(r), r2_(static_cast<float>(r) * r), terminator_(terminator), waxing_(waxing) {}
+
+  int32_t top() const { return -r_; }
+  int32_t bottom() const { return r_; }
+
+  int rowRanges(int32_t dy, int32_t (&lo)[2], int32_t (&hi)[2]) const {
+    const float ady = dy < 0 ? -dy : dy;
+    const float near = ady > 0.25f ? ady - 0.25f : 0.0f;
+    if (near * near > r2_) {
+      return 0;
+    }
+    int32_t l = -(static_cast<int32_t>(sqrtf(r2_ - near * near)) + 1);
+    int32_t h = -l;
+    if (waxing_) {
+      l = std::max<int32_t>(l, static_cast<int32_t>(floorf(terminator_)));
+    } else {
+      h = std::min<int32_t>(h, static_cast<int32_t>(ceilf(terminator_)));
+    }
+    if (h < l) {
+      return 0;
+    }
+    lo[0] = l;
+    hi[0] = h;
+    return 1;
+  }
+
+  bool contains(float x, float y) const {
+    if (x * x + y * y > r2_) {
+      return false;
+    }
+    return waxing_ ? x > terminator_ : x < terminator_;
+  }
+
+ private:
+  int32_t r_;
+  float r2_;
+  float terminator_;
+  bool waxing_;
+};
+
+// Segment from the origin to (dx, dy), `width` pixels across, with square ends at both
+// endpoints.
+class WideLine {
+ public:
+  WideLine(float dx, float dy, float width) : half_(width * 0.5f) {
+    len_ = sqrtf(dx * dx + dy * dy);
+    if (len_ > 0.0001f) {
+      ux_ = dx / len_;
+      uy_ = dy / len_;
+    }
+    const float pad = half_ + 1.0f;
+    top_ = static_cast<int32_t>(floorf(std::min(0.0f, dy) - pad));
+    bottom_ = static_cast<int32_t>(ceilf(std::max(0.0f, dy) + pad));
+    left_ = static_cast<int32_t>(floorf(std::min(0.0f, dx) - pad));
+    right_ = static_cast<int32_t>(ceilf(std::max(0.0f, dx) + pad));
+  }
+
+  int32_t top() const { return len_ > 0.0001f ? top_ : 1; }
+  int32_t bottom() const { return len_ > 0.0001f ? bottom_ : 0; }
+
+  int rowRanges(int32_t dy, int32_t (&lo)[2], int32_t (&hi)[2]) const {
+    float x0 = static_cast<float>(left_);
+    float x1 = static_cast<float>(right_);
+    const float y = static_cast<float>(dy);
+    // Across the line: |x * -uy + y * ux| <= half; along it: 0 <= x * ux + y * uy <= len.
+    // Widened by half a pixel for off-centre samples.
+    if (!clampLinear(-uy_, y * ux_, -half_ - 0.5f, half_ + 0.5f, x0, x1) ||
+        !clampLinear(ux_, y * uy_, -0.5f, len_ + 0.5f, x0, x1)) {
+      return 0;
+    }
+    lo[0] = static_cast<int32_t>(floorf(x0)) - 1;
+    hi[0] = static_cast<int32_t>(ceilf(x1)) + 1;
+    return 1;
+  }
+
+  bool contains(float x, float y) const {
+    const float across = y * ux_ - x * uy_;
+    const float along = x * ux_ + y * uy_;
+    return across >= -half_ && across <= half_ && along >= 0.0f && along <= len_;
+  }
+
+ private:
+  // Narrows [x0, x1] to the x where lo <= a * x + b <= hi; false if nothing is left.
+  static bool clampLinear(float a, float b, float lo, float hi, float& x0, float& x1) {
+    if (fabsf(a) < 1e-6f) {
+      return b >= lo && b <= hi;
+    }
+    float p = (lo - b) / a;
+    float q = (hi - b) / a;
+    if (p > q) {
+      std::swap(p, q);
+    }
+    x0 = std::max(x0, p);
+    x1 = std::min(x1, q);
+    return x0 <= x1;
+  }
+
+  float half_;
+  float len_ = 0.0f;
+  float ux_ = 0.0f;
+  float uy_ = 0.0f;
+  int32_t top_ = 0;
+  int32_t bottom_ = 0;
+  int32_t left_ = 0;
+  int32_t right_ = 0;
+};
+
+// Fills `shape` around (originX, originY). With antialias, edge pixels get 2x2 supersampled
+// coverage and are blended towards bg, the colour the shape is drawn over.
+template <typename Gfx, typename Shape>
+void fillShape(Gfx& gfx, int32_t originX, int32_t originY, const Shape& shape, uint16_t color,
+               bool antialias, uint16_t bg) {
+  for (int32_t dy = shape.top(); dy <= shape.bottom(); ++dy) {
+    int32_t lo[2];
+    int32_t hi[2];
+    const int ranges = shape.rowRanges(dy, lo, hi);
+    for (int i = 0; i < ranges; ++i) {
+      bool inRun = false;
+      int32_t runStart = 0;
+      uint16_t runColor = 0;
+      for (int32_t dx = lo[i]; dx <= hi[i] + 1; ++dx) {
+        uint8_t coverage = 0;
+        if (dx <= hi[i]) {
+          const float fx = static_cast<float>(dx);
+          const float fy = static_cast<float>(dy);
+          if (antialias) {
+            coverage = static_cast<uint8_t>(shape.contains(fx - 0.25f, fy - 0.25f)) +
+                       static_cast<uint8_t>(shape.contains(fx + 0.25f, fy - 0.25f)) +
+                       static_cast<uint8_t>(shape.contains(fx - 0.25f, fy + 0.25f)) +
+                       static_cast<uint8_t>(shape.contains(fx + 0.25f, fy + 0.25f));
+          } else {
+            coverage = shape.contains(fx, fy) ? 4 : 0;
+          }
+        }
+        const uint16_t c = coverage >= 4 ? color : blend565(color, bg, coverage);
+        if (inRun && (coverage == 0 || c != runColor)) {
+          gfx.drawFastHLine(originX + runStart, originY + dy, dx - runStart, runColor);
+          inRun = false;
+        }
+        if (coverage > 0 && !inRun) {
+          inRun = true;
+          runStart = dx;
+          runColor = c;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace spanraster
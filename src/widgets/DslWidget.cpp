@@ -79,6 +79,14 @@ DslWidget::DslWidget(const WidgetConfig& cfg) : Widget(cfg) {
     }
   }
 
+  auto rowsIt = config_.settings.find("sprite_rows");
+  if (rowsIt != config_.settings.end()) {
+    const long parsed = rowsIt->second.toInt();
+    if (parsed > 0 && parsed <= 0x7FFF) {
+      spriteRowsSetting_ = static_cast<int16_t>(parsed);
+    }
+  }
+
   auto debugIt = config_.settings.find("debug");
   if (debugIt != config_.settings.end()) {
     const String value = debugIt->second;
@@ -100,6 +108,9 @@ DslWidget::DslWidget(const WidgetConfig& cfg) : Widget(cfg) {
 }
 
 DslWidget::~DslWidget() {
+  leaveSharedSource();
+  releaseHaEntity();
+  releaseSseStream();
   if (sprite_ != nullptr) {
     sprite_->deleteSprite();
     delete sprite_;
@@ -108,12 +119,17 @@ DslWidget::~DslWidget() {
 }
 void DslWidget::begin() {
   Widget::begin();
+  releaseHaEntity();
+  releaseSseStream();
+  fieldsFromCache_ = false;
+  hasFreshFields_ = false;
   dslLoaded_ = loadDslModel();
+  nodePaint_.clear();
+  repaintAll_ = true;
   if (dslLoaded_) {
     // Force first DSL fetch immediately; do not wait full poll interval.
     const uint32_t nowMs = millis();
     lastFetchMs_ = (nowMs > dsl_.pollMs) ? (nowMs - dsl_.pollMs) : 0;
-    nextFetchMs_ = nowMs;
     const uint32_t autoDelay = autoStartDelayMs(widgetName(), dslPath_, dsl_.source);
     const uint32_t totalDelay = startDelayMs_ + autoDelay;
     firstFetchNotBeforeMs_ = nowMs + totalDelay;
@@ -125,6 +141,14 @@ void DslWidget::begin() {
                     static_cast<unsigned long>(totalDelay));
     }
     firstFetch_ = true;
+    if (dsl_.source == "http" || dsl_.source == "adsb_nearest") {
+      joinSharedSource(*buildFetchRequest());
+    }
+    // Draw the last fields we had until the first fetch replaces them.
+    fieldsFromCache_ = loadFieldCache();
+    if (fieldsFromCache_) {
+      status_ = "stale";
+    }
   }
 }
 
@@ -146,6 +170,10 @@ bool DslWidget::loadDslModel() {
   if (debugOverride_) {
     dsl_.debug = true;
   }
+  compileBindingPlans();
+  compileExpressions();
+  sizeSeriesRings();
+  buildFetchFilter();
   hasTapHttpAction_ = (parseTapActionType() == "http");
   if (!hasTapHttpAction_) {
     for (const auto& region : dsl_.touchRegions) {
@@ -159,6 +187,54 @@ bool DslWidget::loadDslModel() {
   return true;
 }
 
+void DslWidget::compileBindingPlans() {
+  bindingSlots_.clear();
+  dsl::compileTemplate(dsl_.url, bindingSlots_, dsl_.urlPlan);
+  dsl_.headerPlans.clear();
+  for (const auto& kv : dsl_.headers) {
+    dsl::compileTemplate(kv.second, bindingSlots_, dsl_.headerPlans[kv.first]);
+  }
+  for (auto& pair : dsl_.fields) {
+    dsl::compileTemplate(pair.second.path, bindingSlots_, pair.second.pathPlan);
+  }
+  for (auto& node : dsl_.nodes) {
+    dsl::compileTemplate(node.text, bindingSlots_, node.textPlan);
+    dsl::compileTemplate(node.path, bindingSlots_, node.pathPlan);
+  }
+  for (auto& modal : dsl_.modals) {
+    dsl::compileTemplate(modal.title, bindingSlots_, modal.titlePlan);
+    dsl::compileTemplate(modal.text, bindingSlots_, modal.textPlan);
+  }
+}
+
+void DslWidget::sizeSeriesRings() {
+  seriesValues_.clear();
+  for (const auto& node : dsl_.nodes) {
+    if (node.type != dsl::NodeType::kSparkline || node.key.isEmpty()) {
+      continue;
+    }
+    // One sample per plot column; n samples span n - 1 segments.
+    const size_t capacity = static_cast<size_t>(std::max<int16_t>(node.w - 2, 1)) + 1;
+    DslSeriesRing& ring = seriesValues_[node.key];
+    if (capacity > ring.capacity()) {
+      ring.reset(capacity);
+    }
+  }
+}
+
+void DslWidget::compileExpressions() {
+  for (auto& node : dsl_.nodes) {
+    if (node.angleExpr.isEmpty() || node.angleExpr.indexOf("{{") >= 0) {
+      continue;
+    }
+    String err;
+    if (!dsl::compileExpression(node.angleExpr, node.angleProgram, &err)) {
+      platform::logf("[%s] [%s] angle_expr rejected: %s expr='%s'\n", widgetName().c_str(),
+                    logTimestamp().c_str(), err.c_str(), node.angleExpr.c_str());
+    }
+  }
+}
+
 String DslWidget::parseTapActionType() const {
   if (!dsl_.onTouch.action.isEmpty()) {
     String action = dsl_.onTouch.action;
@@ -566,7 +642,13 @@ std::map<String, String> DslWidget::resolveHttpHeaders() const {
     if (key.isEmpty()) {
       continue;
     }
-    const String value = bindRuntimeTemplate(kv.second);
+    String value;
+    auto pit = dsl_.headerPlans.find(kv.first);
+    if (pit != dsl_.headerPlans.end()) {
+      bindPlan(pit->second, kv.second, false, value);
+    } else {
+      value = bindRuntimeTemplate(kv.second);
+    }
     if (value.isEmpty()) {
       continue;
     }
@@ -575,23 +657,22 @@ std::map<String, String> DslWidget::resolveHttpHeaders() const {
   return resolved;
 }
 
-uint32_t DslWidget::computeAdsbJitterMs(uint32_t pollMs) const {
-  if (pollMs < 5000U) {
-    return 0;
-  }
-  const uint32_t jitterMax = std::max(1000U, pollMs / 10U);
-  return static_cast<uint32_t>(random(0, static_cast<long>(jitterMax + 1)));
-}
-
 bool DslWidget::applyFieldsFromDoc(const JsonDocument& doc, bool& changed) {
   int resolvedCount = 0;
   int missingCount = 0;
   int seriesCount = 0;
+  auto clearSeries = [&](const String& key) {
+    auto it = seriesValues_.find(key);
+    if (it != seriesValues_.end()) {
+      it->second.clear();
+    }
+  };
 
+  String path;
   for (const auto& pair : dsl_.fields) {
     const String& key = pair.first;
     const dsl::FieldSpec& spec = pair.second;
-    const String path = bindRuntimeTemplate(spec.path);
+    bindPlan(spec.pathPlan, spec.path, false, path);
 
     if (path.startsWith("computed.")) {
       String computed;
@@ -606,7 +687,7 @@ bool DslWidget::applyFieldsFromDoc(const JsonDocument& doc, bool& changed) {
           values_[key] = "";
           changed = true;
         }
-        seriesValues_[key].clear();
+        clearSeries(key);
         continue;
       }
 
@@ -639,7 +720,7 @@ bool DslWidget::applyFieldsFromDoc(const JsonDocument& doc, bool& changed) {
         values_[key] = "";
         changed = true;
       }
-      seriesValues_[key].clear();
+      clearSeries(key);
       continue;
     }
     ++resolvedCount;
@@ -647,16 +728,16 @@ bool DslWidget::applyFieldsFromDoc(const JsonDocument& doc, bool& changed) {
     if (v.is<JsonArrayConst>()) {
       ++seriesCount;
       const JsonArrayConst arr = v.as<JsonArrayConst>();
-      std::vector<float> series;
-      series.reserve(arr.size());
+      std::vector<float>& series = seriesScratch_;
+      series.clear();
       for (JsonVariantConst el : arr) {
         if (el.is<float>() || el.is<double>() || el.is<long>() || el.is<int>()) {
           series.push_back(el.as<float>());
         }
       }
 
-      if (seriesValues_[key] != series) {
-        seriesValues_[key] = series;
+      auto ring = seriesValues_.find(key);
+      if (ring != seriesValues_.end() && ring->second.assign(series.data(), series.size())) {
         changed = true;
       }
 
@@ -687,6 +768,12 @@ bool DslWidget::applyFieldsFromDoc(const JsonDocument& doc, bool& changed) {
       values_[key] = formatted;
       changed = true;
     }
+    // A sparkline on a single number plots its history, one sample per applied payload.
+    auto ring = numeric ? seriesValues_.find(key) : seriesValues_.end();
+    if (ring != seriesValues_.end()) {
+      ring->second.push(static_cast<float>(numericValue));
+      changed = true;
+    }
   }
 
   if (dsl_.debug) {
@@ -730,7 +817,7 @@ bool DslWidget::applyFieldsFromDoc(const JsonDocument& doc, bool& changed) {
     if (node.type != dsl::NodeType::kLabel || node.path.isEmpty()) {
       continue;
     }
-    const String path = bindRuntimeTemplate(node.path);
+    bindPlan(node.pathPlan, node.path, false, path);
     JsonVariantConst v;
     String text;
     if (resolveVariant(doc, path, v)) {
@@ -1235,3 +1322,94 @@ String DslWidget::bindTemplate(const String& input) const {
 
   return bindRuntimeTemplate(out);
 }
+
+// Plan-driven equivalent of bindTemplate (valuesFirst) / bindRuntimeTemplate. Keys resolve
+// straight into `out`, so a warm buffer binds without allocating. Substituted values are not
+// rescanned for further "{{...}}" markers.
+void DslWidget::bindPlan(const dsl::TemplatePlan& plan, const String& source, bool valuesFirst,
+                         String& out) const {
+  if (!plan.compiled) {
+    out = valuesFirst ? bindTemplate(source) : bindRuntimeTemplate(source);
+    return;
+  }
+  out = "";
+  if (!plan.hasBindings) {
+    out.concat(source.c_str(), source.length());
+    return;
+  }
+
+  const char* src = source.c_str();
+  char num[24];
+  for (const dsl::TemplateToken& token : plan.tokens) {
+    if (token.kind == dsl::TemplateTokenKind::kLiteral) {
+      out.concat(src + token.offset, token.length);
+      continue;
+    }
+    if (token.kind == dsl::TemplateTokenKind::kExpression) {
+      out += bindRuntimeTemplate(bindingSlots_.key(token.slot));
+      continue;
+    }
+    if (valuesFirst) {
+      auto rit = values_.find(bindingSlots_.key(token.rawSlot));
+      if (rit != values_.end()) {
+        out += rit->second;
+        continue;
+      }
+    }
+
+    const String& key = bindingSlots_.key(token.slot);
+    switch (token.runtime) {
+      case dsl::RuntimeKey::kGeoLat:
+        snprintf(num, sizeof(num), "%.4f", static_cast<double>(RuntimeGeo::latitude));
+        out += num;
+        continue;
+      case dsl::RuntimeKey::kGeoLon:
+        snprintf(num, sizeof(num), "%.4f", static_cast<double>(RuntimeGeo::longitude));
+        out += num;
+        continue;
+      case dsl::RuntimeKey::kGeoTz:
+        out += RuntimeGeo::timezone;
+        continue;
+      case dsl::RuntimeKey::kGeoLabel:
+        out += RuntimeGeo::label;
+        continue;
+      case dsl::RuntimeKey::kGeoOffsetMin:
+        snprintf(num, sizeof(num), "%d", RuntimeGeo::utcOffsetMinutes);
+        out += num;
+        continue;
+      case dsl::RuntimeKey::kSetting: {
+        if (key == "radius_nm" && RuntimeSettings::adsbRadiusNm > 0) {
+          snprintf(num, sizeof(num), "%u", static_cast<unsigned>(RuntimeSettings::adsbRadiusNm));
+          out += num;
+          continue;
+        }
+        auto it = config_.settings.find(key);
+        if (it != config_.settings.end()) {
+          out += it->second;
+        }
+        continue;
+      }
+      case dsl::RuntimeKey::kPrefClock24h:
+        out += RuntimeSettings::use24HourClock ? "true" : "false";
+        continue;
+      case dsl::RuntimeKey::kPrefTempUnit:
+        out += RuntimeSettings::useFahrenheit ? "F" : "C";
+        continue;
+      case dsl::RuntimeKey::kPrefDistanceUnit:
+        out += RuntimeSettings::useMiles ? "mi" : "km";
+        continue;
+      case dsl::RuntimeKey::kNone:
+        break;
+    }
+
+    auto vit = values_.find(key);
+    if (vit != values_.end()) {
+      out += vit->second;
+      continue;
+    }
+    auto pit = pathValues_.find(key);
+    if (pit != pathValues_.end()) {
+      out += pit->second;
+    }
+  }
+}
@@ -0,0 +1,330 @@
+#include "widgets/DslWidget.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "AppConfig.h"
+#include "platform/Fs.h"
+#include "platform/Platform.h"
+
+// Last applied fields of each data widget, kept on LittleFS so a reboot or layout switch can
+// draw them right away (marked stale) instead of waiting for the first fetch. One file per
+// DSL path + bound URL:
+//
+//   "CFC1", u32 saved_at (epoch s, 0 when the clock was not set), str dsl_path, str url,
+//   u16 n, n x (str key, str value)            values_
+//   u16 n, n x (str path, str value)           pathValues_
+//   u16 n, n x (str key, u16 count, f32[count]) sparkline series, oldest first
+//
+// where str is u16 length + bytes, all little-endian.
+
+namespace {
+
+constexpr char kFieldCacheDir[] = "/dsl_cache";
+constexpr char kFieldCacheMagic[4] = {'C', 'F', 'C', '1'};
+// Anything bigger is not a cache file this code wrote.
+constexpr size_t kFieldCacheMaxBytes = 16 * 1024;
+constexpr time_t kClockSetEpoch = 1609459200;  // 2021-01-01
+bool sFieldCacheEnabled = true;
+
+uint32_t fnv1a32(const String& text) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < text.length(); ++i) {
+    hash ^= static_cast<uint8_t>(text[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+String fieldCachePath(const String& dslPath, const String& url) {
+  char name[16];
+  snprintf(name, sizeof(name), "/%08lx.bin",
+           static_cast<unsigned long>(fnv1a32(dslPath + "|" + url)));
+  return String(kFieldCacheDir) + name;
+}
+
+class Writer {
+ public:
+  explicit Writer(std::vector<uint8_t>& out) : out_(out) {}
+
+  void bytes(const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    out_.insert(out_.end(), p, p + len);
+  }
+  void u16(uint16_t v) {
+    const uint8_t b[2] = {static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8)};
+    bytes(b, sizeof(b));
+  }
+  void u32(uint32_t v) {
+    u16(static_cast<uint16_t>(v));
+    u16(static_cast<uint16_t>(v >> 16));
+  }
+  void f32(float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    u32(bits);
+  }
+  void str(const String& s) {
+    const size_t len = s.length() > 0xFFFF ? 0xFFFF : s.length();
+    u16(static_cast<uint16_t>(len));
+    bytes(s.c_str(), len);
+  }
+
+ private:
+  std::vector<uint8_t>& out_;
+};
+
+// Every read fails once the input runs out, so a truncated file is rejected as a whole.
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  bool bytes(void* out, size_t len) {
+    if (size_ - pos_ < len) {
+      return false;
+    }
+    memcpy(out, data_ + pos_, len);
+    pos_ += len;
+    return true;
+  }
+  bool u16(uint16_t& v) {
+    uint8_t b[2];
+    if (!bytes(b, sizeof(b))) {
+      return false;
+    }
+    v = static_cast<uint16_t>(b[0] | (b[1] << 8));
+    return true;
+  }
+  bool u32(uint32_t& v) {
+    uint16_t lo = 0;
+    uint16_t hi = 0;
+    if (!u16(lo) || !u16(hi)) {
+      return false;
+    }
+    v = static_cast<uint32_t>(lo) | (static_cast<uint32_t>(hi) << 16);
+    return true;
+  }
+  bool f32(float& v) {
+    uint32_t bits = 0;
+    if (!u32(bits)) {
+      return false;
+    }
+    memcpy(&v, &bits, sizeof(v));
+    return true;
+  }
+  bool str(String& s) {
+    uint16_t len = 0;
+    if (!u16(len) || size_ - pos_ < len) {
+      return false;
+    }
+    s = String();
+    s.reserve(len);
+    for (uint16_t i = 0; i < len; ++i) {
+      s += static_cast<char>(data_[pos_ + i]);
+    }
+    pos_ += len;
+    return true;
+  }
+  bool done() const { return pos_ == size_; }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t pos_ = 0;
+};
+
+bool readMap(Reader& in, std::map<String, String>& out) {
+  uint16_t count = 0;
+  if (!in.u16(count)) {
+    return false;
+  }
+  for (uint16_t i = 0; i < count; ++i) {
+    String key;
+    String value;
+    if (!in.str(key) || !in.str(value)) {
+      return false;
+    }
+    out[key] = value;
+  }
+  return true;
+}
+
+void writeMap(Writer& out, const std::map<String, String>& values) {
+  const size_t count = values.size() > 0xFFFF ? 0xFFFF : values.size();
+  out.u16(static_cast<uint16_t>(count));
+  size_t written = 0;
+  for (const auto& kv : values) {
+    if (written++ == count) {
+      break;
+    }
+    out.str(kv.first);
+    out.str(kv.second);
+  }
+}
+
+}  // namespace
+
+void setDslFieldCacheEnabled(bool enabled) { sFieldCacheEnabled = enabled; }
+
+bool DslWidget::fieldCacheable() const {
+  return sFieldCacheEnabled && dslLoaded_ &&
+         (dsl_.source == "http" || dsl_.source == "adsb_nearest" || dsl_.source == "ha_ws" ||
+          dsl_.source == "sse");
+}
+
+bool DslWidget::loadFieldCache() {
+  if (!fieldCacheable()) {
+    return false;
+  }
+  String url;
+  bindPlan(dsl_.urlPlan, dsl_.url, false, url);
+  const String path = fieldCachePath(dslPath_, url);
+  platform::fs::File f = platform::fs::open(path, FILE_READ);
+  if (!f || f.isDirectory()) {
+    return false;
+  }
+  const size_t size = f.size();
+  if (size < sizeof(kFieldCacheMagic) || size > kFieldCacheMaxBytes) {
+    f.close();
+    return false;
+  }
+  std::vector<uint8_t> data(size);
+  const size_t read = f.read(data.data(), size);
+  f.close();
+  if (read != size) {
+    return false;
+  }
+
+  Reader in(data.data(), data.size());
+  char magic[sizeof(kFieldCacheMagic)];
+  uint32_t savedAt = 0;
+  String cachedDsl;
+  String cachedUrl;
+  if (!in.bytes(magic, sizeof(magic)) || memcmp(magic, kFieldCacheMagic, sizeof(magic)) != 0 ||
+      !in.u32(savedAt) || !in.str(cachedDsl) || !in.str(cachedUrl) || cachedDsl != dslPath_ ||
+      cachedUrl != url) {
+    return false;
+  }
+  const time_t now = time(nullptr);
+  if (savedAt != 0 && now > kClockSetEpoch &&
+      now - static_cast<time_t>(savedAt) > static_cast<time_t>(AppConfig::kFieldCacheMaxAgeS)) {
+    if (dsl_.debug) {
+      platform::logf("[%s] [%s] field cache too old (%lus)\n", widgetName().c_str(),
+                     logTimestamp().c_str(), static_cast<unsigned long>(now - savedAt));
+    }
+    return false;
+  }
+
+  std::map<String, String> values;
+  std::map<String, String> pathValues;
+  if (!readMap(in, values) || !readMap(in, pathValues)) {
+    return false;
+  }
+  uint16_t seriesCount = 0;
+  if (!in.u16(seriesCount)) {
+    return false;
+  }
+  std::map<String, std::vector<float>> series;
+  for (uint16_t i = 0; i < seriesCount; ++i) {
+    String key;
+    uint16_t count = 0;
+    if (!in.str(key) || !in.u16(count)) {
+      return false;
+    }
+    std::vector<float>& samples = series[key];
+    samples.resize(count);
+    for (uint16_t s = 0; s < count; ++s) {
+      if (!in.f32(samples[s])) {
+        return false;
+      }
+    }
+  }
+  if (!in.done()) {
+    return false;
+  }
+
+  values_ = std::move(values);
+  pathValues_ = std::move(pathValues);
+  for (const auto& kv : series) {
+    // Rings follow the current DSL; series it no longer draws are dropped.
+    auto ring = seriesValues_.find(kv.first);
+    if (ring != seriesValues_.end()) {
+      ring->second.assign(kv.second.data(), kv.second.size());
+    }
+  }
+  if (dsl_.debug) {
+    platform::logf("[%s] [%s] field cache loaded %s values=%u bytes=%u\n", widgetName().c_str(),
+                   logTimestamp().c_str(), path.c_str(), static_cast<unsigned>(values_.size()),
+                   static_cast<unsigned>(size));
+  }
+  return true;
+}
+
+void DslWidget::saveFieldCache(const String& url, uint32_t nowMs) {
+  if (!fieldCacheDirty_ || !fieldCacheable()) {
+    return;
+  }
+  // The first save of a boot replaces whatever the stale copy was; later ones are spaced out
+  // to spare the flash.
+  if (fieldCacheSavedMs_ != 0 && nowMs - fieldCacheSavedMs_ < AppConfig::kFieldCacheWriteMinMs) {
+    return;
+  }
+  fieldCacheDirty_ = false;
+  fieldCacheSavedMs_ = nowMs == 0 ? 1 : nowMs;
+
+  std::vector<uint8_t> data;
+  Writer out(data);
+  out.bytes(kFieldCacheMagic, sizeof(kFieldCacheMagic));
+  const time_t now = time(nullptr);
+  out.u32(now > kClockSetEpoch ? static_cast<uint32_t>(now) : 0);
+  out.str(dslPath_);
+  out.str(url);
+  writeMap(out, values_);
+  writeMap(out, pathValues_);
+  uint16_t seriesCount = 0;
+  for (const auto& kv : seriesValues_) {
+    if (kv.second.size() > 0) {
+      ++seriesCount;
+    }
+  }
+  out.u16(seriesCount);
+  for (const auto& kv : seriesValues_) {
+    const DslSeriesRing& ring = kv.second;
+    if (ring.size() == 0) {
+      continue;
+    }
+    out.str(kv.first);
+    out.u16(static_cast<uint16_t>(ring.size()));
+    for (size_t i = 0; i < ring.size(); ++i) {
+      out.f32(ring.at(i));
+    }
+  }
+  if (data.size() > kFieldCacheMaxBytes) {
+    return;
+  }
+
+  if (!platform::fs::exists(kFieldCacheDir) && !platform::fs::mkdir(kFieldCacheDir)) {
+    return;
+  }
+  const String path = fieldCachePath(dslPath_, url);
+  const String tempPath = path + ".tmp";
+  platform::fs::File f = platform::fs::open(tempPath, FILE_WRITE);
+  if (!f || f.isDirectory()) {
+    return;
+  }
+  const size_t written = f.write(data.data(), data.size());
+  f.close();
+  if (written != data.size()) {
+    platform::fs::remove(tempPath);
+    return;
+  }
+  platform::fs::remove(path);
+  if (!platform::fs::rename(tempPath, path)) {
+    platform::fs::remove(tempPath);
+    return;
+  }
+  if (dsl_.debug) {
+    platform::logf("[%s] [%s] field cache saved %s bytes=%u\n", widgetName().c_str(),
+                   logTimestamp().c_str(), path.c_str(), static_cast<unsigned>(data.size()));
+  }
+}
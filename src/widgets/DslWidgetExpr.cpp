@@ -10,23 +10,29 @@ bool DslWidget::getNumeric(const String& key, float& out) const {
 
   const String& text = it->second;
   bool hasDigit = false;
-  String filtered;
-  filtered.reserve(text.length());
+  // Numeric values are short; filter into a stack buffer so clock hands resolve without
+  // touching the heap.
+  char filtered[32];
+  size_t n = 0;
   for (int i = 0; i < text.length(); ++i) {
     const char c = text[i];
     if ((c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+') {
-      filtered += c;
+      if (n + 1 >= sizeof(filtered)) {
+        break;
+      }
+      filtered[n++] = c;
       if (c >= '0' && c <= '9') {
         hasDigit = true;
       }
     }
   }
+  filtered[n] = '\0';
 
   if (!hasDigit) {
     return false;
   }
 
-  out = filtered.toFloat();
+  out = static_cast<float>(atof(filtered));
   return true;
 }
 
@@ -35,10 +41,13 @@ bool DslWidget::resolveNumericVar(void* ctx, const String& name, float& out) {
   return widget->getNumeric(name, out);
 }
 
-bool DslWidget::evaluateAngleExpr(const String& expr, float& outDegrees) const {
-  const String e = bindRuntimeTemplate(expr);
+bool DslWidget::evaluateAngleExpr(const dsl::Node& node, float& outDegrees) const {
   dsl::ExprContext ctx;
   ctx.resolver = &DslWidget::resolveNumericVar;
   ctx.ctx = const_cast<DslWidget*>(this);
+  if (node.angleProgram.valid) {
+    return dsl::evalCompiled(node.angleProgram, ctx, outDegrees);
+  }
+  const String e = bindRuntimeTemplate(node.angleExpr);
   return dsl::evalExpression(e, ctx, outDegrees);
 }
@@ -1,15 +1,18 @@
 #include "widgets/DslWidget.h"
 
-#include <HTTPClient.h>
-#include <WiFiClientSecure.h>
-
 #include <algorithm>
+#include <atomic>
 #include <math.h>
 #include <time.h>
 
 #include "RuntimeGeo.h"
 #include "RuntimeSettings.h"
+#include "dsl/DslFetchFilter.h"
 #include "platform/Net.h"
+#include "services/HaWebSocket.h"
+#include "services/HttpRequestQueue.h"
+#include "services/PollScheduler.h"
+#include "services/SseStream.h"
 
 namespace {
 bool inferOffsetFromTimezone(const String& tz, int& outMinutes) {
@@ -63,8 +66,231 @@ String describeTransportStage(const HttpFetchMeta& meta) {
   }
   return "transport-failure (no-http-status)";
 }
+// Aircraft members read by buildAdsbNearestDoc.
+const char* const kAdsbAircraftKeys[] = {
+    "lat", "lon", "dst", "flight", "callsign", "hex", "t",
+    "type", "destination", "route", "to", "alt_baro", "altitude",
+};
+
+String hashHex(const String& text) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < text.length(); ++i) {
+    hash ^= static_cast<uint8_t>(text[i]);
+    hash *= 16777619u;
+  }
+  char buf[9];
+  snprintf(buf, sizeof(buf), "%08lx", static_cast<unsigned long>(hash));
+  return String(buf);
+}
 }  // namespace
 
+// Everything the worker needs to run a fetch, resolved on the widget side beforehand.
+struct DslWidget::FetchRequest {
+  String widget;
+  bool debug = false;
+  String source;
+  String url;
+  std::map<String, String> headers;
+  String fallbackUrlHttps;
+  String fallbackUrlHttp;
+  JsonDocument filter;
+  bool hasFilter = false;
+  HttpValidators validators;
+};
+
+struct DslWidget::FetchOutcome {
+  JsonDocument doc;
+  String error;
+  HttpFetchMeta meta;
+  String url;
+};
+
+struct DslWidget::TapRequest {
+  String url;
+  String method;
+  String body;
+  String contentType;
+  std::map<String, String> headers;
+};
+
+struct DslWidget::TapOutcome {
+  bool ok = false;
+  String error;
+};
+
+// Filled by the tap completion callback, drained by collectNetResults(). The ready flag is
+// published after the result, and the widget keeps at most one tap queued.
+struct DslWidget::NetInbox {
+  std::atomic<bool> tapReady{false};
+  std::shared_ptr<const TapOutcome> tap;
+};
+
+// Registry entries live as long as they have members. Membership, the merged filter and the
+// submit bookkeeping are only touched by widget code, which DisplayManager serializes; the
+// request worker publishes results through `latest`, `generation`, `inFlight` and the
+// validators with their generation (the latter only while inFlight is set, so submitters
+// read them after it clears).
+struct DslWidget::SharedSource {
+  struct Published {
+    std::shared_ptr<const FetchOutcome> outcome;
+    uint32_t generation = 0;
+  };
+
+  String key;
+  String source;
+  std::vector<DslWidget*> members;
+  // Fastest member poll interval.
+  uint32_t pollMs = 0;
+  JsonDocument filter;
+  bool hasFilter = false;
+  String filterKey;
+  bool submitted = false;
+  PollScheduler::SourceId pollId = 0;
+  // Last result reported to the scheduler; the first member to apply a result reports it.
+  uint32_t reportedGeneration = 0;
+  // Members that applied `latest`; it is dropped once all have, to free the document.
+  uint32_t seenGeneration = 0;
+  size_t seenCount = 0;
+
+  std::atomic<bool> inFlight{false};
+  std::atomic<uint32_t> generation{0};
+  // std::atomic_load / std::atomic_store only.
+  std::shared_ptr<const Published> latest;
+  // Validators from the last response, replayed while the URL is unchanged and the source has
+  // a single member (a 304 only helps members that applied the previous body).
+  HttpValidators validators;
+  String validatorsUrl;
+  // Generation of the body the validators belong to.
+  uint32_t validatorsGeneration = 0;
+  // Widget code only: `generation` when the last member joined. Bodies published before that
+  // were not applied by the newcomer, so their validators are not replayed.
+  uint32_t validatorsFloor = 0;
+
+  static std::map<String, std::shared_ptr<SharedSource>> registry;
+
+  void refresh();
+  void publish(const std::shared_ptr<const FetchOutcome>& outcome);
+  void noteSeen(const std::shared_ptr<const Published>& published, uint32_t nowMs);
+};
+
+std::map<String, std::shared_ptr<DslWidget::SharedSource>> DslWidget::SharedSource::registry;
+
+void DslWidget::SharedSource::refresh() {
+  if (members.empty()) {
+    return;
+  }
+  pollMs = 0;
+  for (const DslWidget* member : members) {
+    if (pollMs == 0 || member->dsl_.pollMs < pollMs) {
+      pollMs = member->dsl_.pollMs;
+    }
+  }
+  PollScheduler::shared().setPollMs(pollId, pollMs);
+  filter.clear();
+  hasFilter = false;
+  if (members.size() == 1 || source != "http") {
+    // adsb_nearest filters are the same fixed aircraft keys for every member.
+    hasFilter = members.front()->hasFetchFilter_;
+    if (hasFilter) {
+      filter = members.front()->fetchFilter_;
+    }
+  } else {
+    // Unfiltered as soon as one member needs the whole response.
+    hasFilter = true;
+    std::vector<const dsl::Document*> docs;
+    for (const DslWidget* member : members) {
+      hasFilter = hasFilter && member->hasFetchFilter_;
+      docs.push_back(&member->dsl_);
+    }
+    hasFilter = hasFilter && dsl::buildFetchFilter(docs, filter);
+  }
+  filterKey = "";
+  if (hasFilter) {
+    String serialized;
+    serializeJson(filter, serialized);
+    filterKey = hashHex(serialized);
+  }
+}
+
+void DslWidget::SharedSource::publish(const std::shared_ptr<const FetchOutcome>& outcome) {
+  const HttpFetchMeta& meta = outcome->meta;
+  const uint32_t nextGeneration = generation.load() + 1;
+  if (outcome->error.isEmpty()) {
+    if (!meta.notModified) {
+      validators = meta.validators;
+      validatorsUrl = validators.empty() ? String() : outcome->url;
+      validatorsGeneration = nextGeneration;
+    } else if (outcome->url == validatorsUrl) {
+      validators = meta.validators;
+    }
+  }
+  auto next = std::make_shared<Published>();
+  next->outcome = outcome;
+  next->generation = nextGeneration;
+  std::atomic_store(&latest, std::shared_ptr<const Published>(std::move(next)));
+  generation.fetch_add(1);
+  inFlight.store(false);
+}
+
+void DslWidget::SharedSource::noteSeen(const std::shared_ptr<const Published>& published,
+                                       uint32_t nowMs) {
+  if (reportedGeneration != published->generation) {
+    reportedGeneration = published->generation;
+    const FetchOutcome& outcome = *published->outcome;
+    PollScheduler::shared().complete(pollId, nowMs, outcome.error.isEmpty(),
+                                     outcome.meta.statusCode, outcome.meta.retryAfter);
+  }
+  if (seenGeneration != published->generation) {
+    seenGeneration = published->generation;
+    seenCount = 0;
+  }
+  if (++seenCount < members.size()) {
+    return;
+  }
+  // Unless a newer result landed meanwhile.
+  std::shared_ptr<const Published> expected = published;
+  std::atomic_compare_exchange_strong(&latest, &expected, std::shared_ptr<const Published>());
+}
+
+bool DslWidget::wantsImmediateUpdate() const {
+  if (tapActionPending_ || forceFetchNow_) {
+    return true;
+  }
+  if (netInbox_ && netInbox_->tapReady.load()) {
+    return true;
+  }
+  if (sharedSource_ && sharedSource_->generation.load() != sharedSeen_) {
+    return true;
+  }
+  if (haHandle_ != 0 && haws::revision(haHandle_) != haSeen_) {
+    return true;
+  }
+  if (sseHandle_ != 0 && sse::revision(sseHandle_) != sseSeen_) {
+    return true;
+  }
+  return awaitingRemoteIcon_ && remoteIconGeneration() != iconGenerationSeen_;
+}
+
+void DslWidget::buildFetchFilter() {
+  fetchFilter_.clear();
+  hasFetchFilter_ = false;
+  if (dsl_.source == "adsb_nearest") {
+    // Fields apply to the derived nearest-aircraft doc, so filter the raw feed by what
+    // buildAdsbNearestDoc reads instead.
+    JsonObject aircraft = fetchFilter_["ac"].to<JsonArray>().add<JsonObject>();
+    for (const char* key : kAdsbAircraftKeys) {
+      aircraft[key] = true;
+    }
+    hasFetchFilter_ = true;
+  } else if (dsl_.source == "http" || dsl_.source == "sse") {
+    hasFetchFilter_ = dsl::buildFetchFilter(dsl_, fetchFilter_);
+  }
+  if (dsl_.debug) {
+    platform::logf("[%s] [%s] fetch filter %s\n", widgetName().c_str(), logTimestamp().c_str(),
+                   hasFetchFilter_ ? "on" : "off");
+  }
+}
+
 std::map<String, String> DslWidget::resolveTapHeaders(const dsl::TouchAction& action) const {
   std::map<String, String> headers;
   for (const auto& kv : action.headers) {
@@ -99,7 +325,7 @@ std::map<String, String> DslWidget::resolveTapHeaders(const dsl::TouchAction& ac
   return headers;
 }
 
-bool DslWidget::executeTapAction(String& errorOut) {
+bool DslWidget::submitTapAction(String& errorOut) {
   dsl::TouchAction action;
   if (hasPendingTouchAction_) {
     action = pendingTouchAction_;
@@ -113,7 +339,9 @@ bool DslWidget::executeTapAction(String& errorOut) {
     return false;
   }
 
-  String url = action.url;
+  auto request = std::make_shared<TapRequest>();
+  String& url = request->url;
+  url = action.url;
   if (url.isEmpty()) {
     errorOut = "tap_url missing";
     return false;
@@ -124,7 +352,8 @@ bool DslWidget::executeTapAction(String& errorOut) {
     return false;
   }
 
-  String method = action.method;
+  String& method = request->method;
+  method = action.method;
   if (method.isEmpty()) {
     method = "POST";
   }
@@ -134,10 +363,10 @@ bool DslWidget::executeTapAction(String& errorOut) {
     method = "POST";
   }
 
-  String body = action.body;
-  body = bindTemplate(body);
+  request->body = bindTemplate(action.body);
 
-  String contentType = action.contentType;
+  String& contentType = request->contentType;
+  contentType = action.contentType;
   if (contentType.isEmpty()) {
     contentType = "application/json";
   }
@@ -146,68 +375,35 @@ bool DslWidget::executeTapAction(String& errorOut) {
   if (contentType.isEmpty()) {
     contentType = "application/json";
   }
+  request->headers = resolveTapHeaders(action);
 
-  if (!platform::net::isConnected()) {
-    errorOut = "WiFi disconnected";
-    return false;
-  }
-
-  HTTPClient http;
-  WiFiClientSecure secureClient;
-  bool begun = false;
-  if (url.startsWith("https://")) {
-    secureClient.setInsecure();
-    begun = http.begin(secureClient, url);
-  } else {
-    begun = http.begin(url);
-  }
-  if (!begun) {
-    errorOut = "HTTP begin failed";
-    return false;
-  }
-
-  http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
-  http.setRedirectLimit(5);
-  http.setConnectTimeout(4500);
-  http.setTimeout(6500);
-  http.useHTTP10(true);
-  http.setReuse(false);
-  http.addHeader("User-Agent", "CoStar-ESP32/1.0");
-  const std::map<String, String> headers = resolveTapHeaders(action);
-  for (const auto& kv : headers) {
-    if (kv.first.isEmpty() || kv.second.isEmpty()) {
-      continue;
-    }
-    http.addHeader(kv.first, kv.second);
+  if (!netInbox_) {
+    netInbox_ = std::make_shared<NetInbox>();
   }
-  if (!body.isEmpty()) {
-    http.addHeader("Content-Type", contentType);
-  }
-
-  int status = 0;
-  if (method == "GET") {
-    status = http.GET();
-  } else if (method == "POST") {
-    status = http.POST(body);
-  } else if (method == "PUT") {
-    status = http.PUT(body);
-  } else if (method == "PATCH") {
-    status = http.sendRequest("PATCH", body);
-  } else if (method == "DELETE") {
-    status = http.sendRequest("DELETE", body);
-  } else {
-    status = http.sendRequest(method.c_str(), body);
+  std::shared_ptr<NetInbox> inbox = netInbox_;
+  // Taps are never deduplicated: two presses are two requests.
+  const bool queued = httpq::submit<TapOutcome>(
+      httpq::Priority::kTapAction, String(),
+      [request](TapOutcome& outcome) { outcome.ok = executeTapAction(*request, outcome.error); },
+      [inbox](const std::shared_ptr<const TapOutcome>& outcome) {
+        inbox->tap = outcome;
+        inbox->tapReady.store(true);
+      });
+  if (!queued) {
+    errorOut = "request queue full";
   }
+  return queued;
+}
 
-  if (status < 200 || status >= 300) {
-    const String response = http.getString();
-    errorOut = "status=" + String(status) + " body='" + clipText(response, 72) + "'";
-    http.end();
+bool DslWidget::executeTapAction(const TapRequest& request, String& errorOut) {
+  if (!platform::net::isConnected()) {
+    errorOut = "WiFi disconnected";
     return false;
   }
-
-  http.end();
-  return true;
+  // Shares the pooled session with this host's polls, so a tap skips the TLS handshake.
+  HttpJsonClient http;
+  return http.send(request.method, request.url, request.body, request.contentType,
+                   request.headers.empty() ? nullptr : &request.headers, nullptr, &errorOut);
 }
 
 bool DslWidget::buildLocalTimeDoc(JsonDocument& outDoc, String& error) const {
@@ -266,7 +462,7 @@ bool DslWidget::buildLocalTimeDoc(JsonDocument& outDoc, String& error) const {
   return true;
 }
 
-float DslWidget::distanceKm(float lat1, float lon1, float lat2, float lon2) const {
+float DslWidget::distanceKm(float lat1, float lon1, float lat2, float lon2) {
   constexpr float kDegToRad = 3.14159265f / 180.0f;
   constexpr float kEarthRadiusKm = 6371.0f;
   const float dLat = (lat2 - lat1) * kDegToRad;
@@ -279,7 +475,7 @@ float DslWidget::distanceKm(float lat1, float lon1, float lat2, float lon2) cons
 }
 
 bool DslWidget::buildAdsbNearestDoc(const JsonDocument& rawDoc, JsonDocument& outDoc,
-                                    String& error) const {
+                                    String& error) {
   JsonArrayConst ac = rawDoc["ac"].as<JsonArrayConst>();
   if (ac.isNull()) {
     ac = rawDoc.as<JsonArrayConst>();
@@ -410,121 +606,172 @@ bool DslWidget::buildAdsbNearestDoc(const JsonDocument& rawDoc, JsonDocument& ou
   return true;
 }
 
-bool DslWidget::update(uint32_t nowMs) {
-  if (!dslLoaded_) {
-    return false;
+std::shared_ptr<DslWidget::FetchRequest> DslWidget::buildFetchRequest() const {
+  auto request = std::make_shared<FetchRequest>();
+  request->widget = widgetName();
+  request->debug = dsl_.debug;
+  request->source = dsl_.source;
+  bindPlan(dsl_.urlPlan, dsl_.url, false, request->url);
+
+  if (dsl_.source == "adsb_nearest") {
+    String radiusNm;
+    if (RuntimeSettings::adsbRadiusNm > 0) {
+      radiusNm = String(RuntimeSettings::adsbRadiusNm);
+    } else if (config_.settings.count("radius_nm")) {
+      radiusNm = config_.settings.at("radius_nm");
+    } else {
+      radiusNm = "40";
+    }
+    const String point = String(RuntimeGeo::latitude, 4) + "/" +
+                         String(RuntimeGeo::longitude, 4) + "/" + radiusNm;
+    request->fallbackUrlHttps = "https://api.airplanes.live/v2/point/" + point;
+    request->fallbackUrlHttp = "http://api.airplanes.live/v2/point/" + point;
+  } else {
+    request->headers = resolveHttpHeaders();
   }
-  if (modalVisible_ && modalDismissAtMs_ != 0 &&
-      static_cast<int32_t>(nowMs - modalDismissAtMs_) >= 0) {
-    modalVisible_ = false;
-    activeModalId_ = "";
-    modalDismissAtMs_ = 0;
-    return true;
+  return request;
+}
+
+void DslWidget::joinSharedSource(const FetchRequest& request) {
+  String key = dsl_.source + "|" + request.url + "|" + request.fallbackUrlHttps;
+  for (const auto& kv : request.headers) {
+    key += "|" + kv.first + "=" + kv.second;
   }
-  if (firstFetch_ && startDelayMs_ > 0 &&
-      static_cast<int32_t>(nowMs - firstFetchNotBeforeMs_) < 0) {
-    return false;
+  if (sharedSource_ && sharedSource_->key == key) {
+    return;
+  }
+  leaveSharedSource();
+  std::shared_ptr<SharedSource>& entry = SharedSource::registry[key];
+  if (!entry) {
+    entry = std::make_shared<SharedSource>();
+    entry->key = key;
+    entry->source = dsl_.source;
+    entry->pollId = PollScheduler::shared().add(
+        request.url.isEmpty() ? request.fallbackUrlHttps : request.url, dsl_.pollMs);
+  } else {
+    // Results published before joining are not ours; 304s would assume we applied them. The
+    // validators themselves may be mid-write on the worker, so only the floor moves here.
+    entry->validatorsFloor = entry->generation.load();
+  }
+  entry->members.push_back(this);
+  entry->refresh();
+  sharedSource_ = entry;
+  sharedSeen_ = entry->generation.load();
+  if (dsl_.debug && entry->members.size() > 1) {
+    platform::logf("[%s] [%s] shared source members=%u poll=%lums filter %s\n",
+                   widgetName().c_str(), logTimestamp().c_str(),
+                   static_cast<unsigned>(entry->members.size()),
+                   static_cast<unsigned long>(entry->pollMs), entry->hasFilter ? "on" : "off");
   }
+}
 
-  if (tapActionPending_) {
-    String actionError;
-    if (!executeTapAction(actionError)) {
-      status_ = "tap err";
-      if (dsl_.debug) {
-        platform::logf("[%s] [%s] TAP err=%s\n", widgetName().c_str(), logTimestamp().c_str(),
-                      clipText(actionError, 120).c_str());
-      }
-    } else {
-      status_ = "ok";
-      if (dsl_.debug) {
-        platform::logf("[%s] [%s] TAP ok\n", widgetName().c_str(), logTimestamp().c_str());
-      }
-    }
-    tapActionPending_ = false;
-    hasPendingTouchAction_ = false;
-    forceFetchNow_ = true;
+void DslWidget::leaveSharedSource() {
+  if (!sharedSource_) {
+    return;
   }
+  std::vector<DslWidget*>& members = sharedSource_->members;
+  members.erase(std::remove(members.begin(), members.end(), this), members.end());
+  if (members.empty()) {
+    PollScheduler::shared().remove(sharedSource_->pollId);
+    SharedSource::registry.erase(sharedSource_->key);
+  } else {
+    sharedSource_->refresh();
+  }
+  sharedSource_.reset();
+  sharedSeen_ = 0;
+}
 
-  if (!forceFetchNow_) {
-    if (dsl_.source == "adsb_nearest") {
-      if (adsbBackoffUntilMs_ != 0 && static_cast<int32_t>(nowMs - adsbBackoffUntilMs_) < 0) {
-        return false;
-      }
-      if (nextFetchMs_ == 0) {
-        nextFetchMs_ = nowMs;
-      }
-      if (!firstFetch_ && static_cast<int32_t>(nowMs - nextFetchMs_) < 0) {
-        return false;
-      }
-    } else if (dsl_.source == "http" && httpBackoffUntilMs_ != 0 &&
-               static_cast<int32_t>(nowMs - httpBackoffUntilMs_) < 0) {
+bool DslWidget::submitFetch(uint32_t nowMs) {
+  std::shared_ptr<FetchRequest> request = buildFetchRequest();
+  PollScheduler& scheduler = PollScheduler::shared();
+  const PollScheduler::SourceId grantedId = sharedSource_->pollId;
+  // Normally joined in begin(); a URL bound to runtime settings may have moved since.
+  joinSharedSource(*request);
+  std::shared_ptr<SharedSource> shared = sharedSource_;
+  if (shared->pollId != grantedId) {
+    // update() was granted a request for the old source.
+    scheduler.cancel(grantedId);
+    if (!scheduler.acquire(shared->pollId, nowMs, true)) {
       return false;
-    } else if (nowMs - lastFetchMs_ < dsl_.pollMs) {
-      if (!firstFetch_) {
-        return false;
-      }
     }
   }
-  lastFetchMs_ = nowMs;
-  if (dsl_.source == "adsb_nearest") {
-    nextFetchMs_ = nowMs + dsl_.pollMs + computeAdsbJitterMs(dsl_.pollMs);
-  }
-  firstFetch_ = false;
-  forceFetchNow_ = false;
 
-  JsonDocument doc;
-  String error;
-  HttpFetchMeta fetchMeta;
+  const String& resolvedUrl = request->url;
+  if (shared->hasFilter) {
+    request->filter = shared->filter;
+    request->hasFilter = true;
+  }
+  if (dsl_.source == "http" && shared->members.size() == 1 && !shared->inFlight.load() &&
+      shared->validatorsGeneration > shared->validatorsFloor &&
+      resolvedUrl == shared->validatorsUrl) {
+    request->validators = shared->validators;
+  }
 
-  if (dsl_.source == "local_time") {
-    if (!buildLocalTimeDoc(doc, error)) {
-      if (dsl_.debug) {
-        platform::logf("[%s] - [%s] - DSL local_time error: %s\n", widgetName().c_str(),
-                      logTimestamp().c_str(), error.c_str());
-      }
+  if (dsl_.debug) {
+    platform::logf("[%s] [%s] URL %s\n", widgetName().c_str(), logTimestamp().c_str(),
+                  clipText(resolvedUrl, 88).c_str());
+    if (!request->headers.empty()) {
+      platform::logf("[%s] [%s] HTTP headers=%u\n", widgetName().c_str(),
+                    logTimestamp().c_str(), static_cast<unsigned>(request->headers.size()));
     }
-  } else if (dsl_.source == "adsb_nearest") {
-    const String resolvedUrl = bindRuntimeTemplate(dsl_.url);
+  }
+
+  // The job key also covers the filter, so a request already queued with a narrower filter
+  // is not reused.
+  String jobKey = shared->key + "|" + shared->filterKey;
+  // A 304 is only meaningful to widgets holding the same validators.
+  if (!request->validators.empty()) {
+    jobKey += "|" + request->validators.etag + "|" + request->validators.lastModified;
+  }
+
+  shared->inFlight.store(true);
+  const bool queued = httpq::submit<FetchOutcome>(
+      httpq::Priority::kVisibleData, jobKey,
+      [request](FetchOutcome& outcome) { runFetch(*request, outcome); },
+      [shared](const std::shared_ptr<const FetchOutcome>& outcome) { shared->publish(outcome); });
+  if (!queued) {
+    shared->inFlight.store(false);
+    scheduler.cancel(shared->pollId);
+    return false;
+  }
+  shared->submitted = true;
+  return true;
+}
+
+void DslWidget::runFetch(const FetchRequest& request, FetchOutcome& outcome) {
+  HttpJsonClient http;
+  const String& resolvedUrl = request.url;
+  const JsonDocument* filter = request.hasFilter ? &request.filter : nullptr;
+  JsonDocument& doc = outcome.doc;
+  String& error = outcome.error;
+  HttpFetchMeta& fetchMeta = outcome.meta;
+  outcome.url = resolvedUrl;
+
+  if (request.source == "adsb_nearest") {
     String altTransportUrl = resolvedUrl;
     if (altTransportUrl.startsWith("https://")) {
       altTransportUrl.replace("https://", "http://");
     }
-    String radiusNm;
-    if (RuntimeSettings::adsbRadiusNm > 0) {
-      radiusNm = String(RuntimeSettings::adsbRadiusNm);
-    } else if (config_.settings.count("radius_nm")) {
-      radiusNm = config_.settings.at("radius_nm");
-    } else {
-      radiusNm = "40";
-    }
-    const String fallbackUrlHttps = "https://api.airplanes.live/v2/point/" +
-                                    String(RuntimeGeo::latitude, 4) + "/" +
-                                    String(RuntimeGeo::longitude, 4) + "/" + radiusNm;
-    const String fallbackUrlHttp = "http://api.airplanes.live/v2/point/" +
-                                   String(RuntimeGeo::latitude, 4) + "/" +
-                                   String(RuntimeGeo::longitude, 4) + "/" + radiusNm;
-    if (dsl_.debug) {
-      platform::logf("[%s] [%s] URL %s\n", widgetName().c_str(), logTimestamp().c_str(),
-                    clipText(resolvedUrl, 88).c_str());
-    }
+    const String& fallbackUrlHttps = request.fallbackUrlHttps;
+    const String& fallbackUrlHttp = request.fallbackUrlHttp;
     JsonDocument rawDoc;
     bool gotRaw = false;
     bool fetchedFromFallback = false;
 
     if (resolvedUrl.isEmpty()) {
       error = "resolved URL empty";
-    } else if (http_.get(resolvedUrl, rawDoc, &error, &fetchMeta)) {
+    } else if (http.get(resolvedUrl, rawDoc, &error, &fetchMeta, nullptr, filter)) {
       gotRaw = true;
     } else {
       if (altTransportUrl != resolvedUrl) {
-        if (dsl_.debug) {
-          platform::logf("[%s] [%s] ADSB retry http %s\n",
-                        widgetName().c_str(), logTimestamp().c_str(), altTransportUrl.c_str());
+        if (request.debug) {
+          platform::logf("[%s] [%s] ADSB retry http %s\n", request.widget.c_str(),
+                        logTimestamp().c_str(), altTransportUrl.c_str());
         }
         String altErr;
         HttpFetchMeta altMeta;
         JsonDocument altDoc;
-        if (http_.get(altTransportUrl, altDoc, &altErr, &altMeta)) {
+        if (http.get(altTransportUrl, altDoc, &altErr, &altMeta, nullptr, filter)) {
           rawDoc = altDoc;
           fetchMeta = altMeta;
           error = "";
@@ -537,15 +784,17 @@ bool DslWidget::update(uint32_t nowMs) {
     }
 
     if (!gotRaw) {
-      if (dsl_.debug) {
-        platform::logf("[%s] [%s] ADSB fallback %s\n", widgetName().c_str(),
+      if (request.debug) {
+        platform::logf("[%s] [%s] ADSB fallback %s\n", request.widget.c_str(),
                       logTimestamp().c_str(), clipText(fallbackUrlHttps, 72).c_str());
       }
       String fallbackError;
       HttpFetchMeta fallbackMeta;
       JsonDocument fallbackDoc;
-      if (http_.get(fallbackUrlHttps, fallbackDoc, &fallbackError, &fallbackMeta) ||
-          http_.get(fallbackUrlHttp, fallbackDoc, &fallbackError, &fallbackMeta)) {
+      if (http.get(fallbackUrlHttps, fallbackDoc, &fallbackError, &fallbackMeta, nullptr,
+                   filter) ||
+          http.get(fallbackUrlHttp, fallbackDoc, &fallbackError, &fallbackMeta, nullptr,
+                   filter)) {
         rawDoc = fallbackDoc;
         fetchMeta = fallbackMeta;
         error = "";
@@ -557,90 +806,360 @@ bool DslWidget::update(uint32_t nowMs) {
       }
     }
 
-    if (gotRaw) {
-      logHttpFetchResult(fetchMeta.statusCode, fetchMeta.contentLengthBytes);
-      if (!buildAdsbNearestDoc(rawDoc, doc, error) && !fetchedFromFallback) {
-        if (dsl_.debug) {
-          platform::logf("[%s] [%s] ADSB parse err=%s\n", widgetName().c_str(),
-                        logTimestamp().c_str(), clipText(error, 86).c_str());
-        }
-        String fallbackError;
-        HttpFetchMeta fallbackMeta;
-        JsonDocument fallbackDoc;
-        if ((http_.get(fallbackUrlHttps, fallbackDoc, &fallbackError, &fallbackMeta) ||
-             http_.get(fallbackUrlHttp, fallbackDoc, &fallbackError, &fallbackMeta)) &&
-            buildAdsbNearestDoc(fallbackDoc, doc, fallbackError)) {
-          fetchMeta = fallbackMeta;
-          error = "";
-        } else {
-          error = "primary_parse=" + error + ", fallback=" + fallbackError;
-          fetchMeta = fallbackMeta;
-        }
+    if (gotRaw && !buildAdsbNearestDoc(rawDoc, doc, error) && !fetchedFromFallback) {
+      if (request.debug) {
+        platform::logf("[%s] [%s] ADSB parse err=%s\n", request.widget.c_str(),
+                      logTimestamp().c_str(), clipText(error, 86).c_str());
+      }
+      String fallbackError;
+      HttpFetchMeta fallbackMeta;
+      JsonDocument fallbackDoc;
+      if ((http.get(fallbackUrlHttps, fallbackDoc, &fallbackError, &fallbackMeta, nullptr,
+                    filter) ||
+           http.get(fallbackUrlHttp, fallbackDoc, &fallbackError, &fallbackMeta, nullptr,
+                    filter)) &&
+          buildAdsbNearestDoc(fallbackDoc, doc, fallbackError)) {
+        fetchMeta = fallbackMeta;
+        error = "";
+      } else {
+        error = "primary_parse=" + error + ", fallback=" + fallbackError;
+        fetchMeta = fallbackMeta;
       }
     }
-    if (!error.isEmpty()) {
-      logHttpFetchResult(fetchMeta.statusCode, fetchMeta.contentLengthBytes);
+    return;
+  }
+
+  const std::map<String, String>* headersPtr =
+      request.headers.empty() ? nullptr : &request.headers;
+  const HttpValidators* validators = request.validators.empty() ? nullptr : &request.validators;
+  if (resolvedUrl.isEmpty()) {
+    error = "resolved URL empty";
+  } else if (!http.get(resolvedUrl, doc, &error, &fetchMeta, headersPtr, filter, validators)) {
+    const bool retryForEmptyPayload = error.startsWith("Empty payload");
+    const bool retryForTransport = fetchMeta.statusCode <= 0 && fetchMeta.statusCode != -2 &&
+                                   fetchMeta.statusCode != -3;
+    if (retryForEmptyPayload || retryForTransport) {
+      if (request.debug && retryForTransport) {
+        Serial.printf("[%s] [%s] DSL retry after transport failure code=%d reason='%s'\n",
+                      request.widget.c_str(), logTimestamp().c_str(), fetchMeta.statusCode,
+                      fetchMeta.transportReason.c_str());
+      }
+      delay(retryForTransport ? 140 : 40);
+      JsonDocument retryDoc;
+      String retryError;
+      HttpFetchMeta retryMeta;
+      if (http.get(resolvedUrl, retryDoc, &retryError, &retryMeta, headersPtr, filter,
+                   validators)) {
+        doc = retryDoc;
+        fetchMeta = retryMeta;
+        error = "";
+      } else {
+        error = retryError;
+        fetchMeta = retryMeta;
+      }
+    }
+  }
+}
+
+bool DslWidget::collectNetResults(uint32_t nowMs) {
+  if (netInbox_ && netInbox_->tapReady.load()) {
+    std::shared_ptr<const TapOutcome> tap = std::move(netInbox_->tap);
+    netInbox_->tapReady.store(false);
+    tapInFlight_ = false;
+    if (tap && tap->ok) {
+      status_ = "ok";
       if (dsl_.debug) {
-        if (fetchMeta.statusCode <= 0) {
-          platform::logf("[%s] [%s] ADSB %s code=%d reason='%s' elapsed=%lums\n",
-                         widgetName().c_str(), logTimestamp().c_str(),
-                         describeTransportStage(fetchMeta).c_str(), fetchMeta.statusCode,
-                         fetchMeta.transportReason.c_str(),
-                         static_cast<unsigned long>(fetchMeta.elapsedMs));
-        }
-        platform::logf(
-            "[%s] [%s] ADSB err=%s status=%d bytes=%u ctype='%s'\n", widgetName().c_str(),
-            logTimestamp().c_str(), clipText(error, 140).c_str(), fetchMeta.statusCode,
-            static_cast<unsigned>(fetchMeta.payloadBytes), fetchMeta.contentType.c_str());
+        platform::logf("[%s] [%s] TAP ok\n", widgetName().c_str(), logTimestamp().c_str());
+      }
+    } else {
+      status_ = "tap err";
+      if (dsl_.debug) {
+        platform::logf("[%s] [%s] TAP err=%s\n", widgetName().c_str(), logTimestamp().c_str(),
+                      tap ? clipText(tap->error, 120).c_str() : "");
       }
     }
-  } else if (dsl_.source == "http") {
-    const String resolvedUrl = bindRuntimeTemplate(dsl_.url);
-    const std::map<String, String> resolvedHeaders = resolveHttpHeaders();
-    const std::map<String, String>* headersPtr =
-        resolvedHeaders.empty() ? nullptr : &resolvedHeaders;
+    forceFetchNow_ = true;
+  }
+
+  bool changed = false;
+  if (sharedSource_ && sharedSource_->generation.load() != sharedSeen_) {
+    // `latest` is stored before the counter moves, so it is never older than `generation`.
+    const uint32_t generation = sharedSource_->generation.load();
+    std::shared_ptr<const SharedSource::Published> published =
+        std::atomic_load(&sharedSource_->latest);
+    sharedSeen_ = published ? published->generation : generation;
+    fetchInFlight_ = false;
+    if (published) {
+      firstFetch_ = false;
+      changed = applyFetchOutcome(*published->outcome, nowMs);
+      sharedSource_->noteSeen(published, nowMs);
+    }
+  }
+  return changed;
+}
+
+bool DslWidget::update(uint32_t nowMs) {
+  if (!dslLoaded_) {
+    return false;
+  }
+  bool changed = collectNetResults(nowMs);
+  if (awaitingRemoteIcon_ && remoteIconGeneration() != iconGenerationSeen_) {
+    // A remote icon download finished; redraw so render() can pick it up from flash.
+    awaitingRemoteIcon_ = false;
+    changed = true;
+  }
+  if (modalVisible_ && modalDismissAtMs_ != 0 &&
+      static_cast<int32_t>(nowMs - modalDismissAtMs_) >= 0) {
+    modalVisible_ = false;
+    activeModalId_ = "";
+    modalDismissAtMs_ = 0;
+    return true;
+  }
+  if (firstFetch_ && startDelayMs_ > 0 &&
+      static_cast<int32_t>(nowMs - firstFetchNotBeforeMs_) < 0) {
+    return changed;
+  }
+
+  if (tapActionPending_ && !tapInFlight_) {
+    String actionError;
+    if (submitTapAction(actionError)) {
+      tapInFlight_ = true;
+    } else {
+      status_ = "tap err";
+      if (dsl_.debug) {
+        platform::logf("[%s] [%s] TAP err=%s\n", widgetName().c_str(), logTimestamp().c_str(),
+                      clipText(actionError, 120).c_str());
+      }
+      forceFetchNow_ = true;
+    }
+    tapActionPending_ = false;
+    hasPendingTouchAction_ = false;
+  }
+  if (dsl_.source == "ha_ws" || dsl_.source == "sse") {
+    // Pushed: a tap's effect arrives as a delta or event, there is nothing to refresh.
+    forceFetchNow_ = false;
+    return (dsl_.source == "sse" ? updateSseStream(nowMs) : updateHaEntity(nowMs)) || changed;
+  }
+  // The refresh after a tap waits for the tap request itself to land.
+  if (tapInFlight_ || fetchInFlight_) {
+    return changed;
+  }
+  if (dsl_.source == "http" || dsl_.source == "adsb_nearest") {
+    // Another member of the shared source has a request out; its result reaches this widget
+    // through collectNetResults().
+    if (!forceFetchNow_ && sharedSource_->inFlight.load()) {
+      return changed;
+    }
+    // A widget joining a source that already polls waits for its next result.
+    const bool force = forceFetchNow_ || (firstFetch_ && !sharedSource_->submitted);
+    if (!PollScheduler::shared().acquire(sharedSource_->pollId, nowMs, force)) {
+      return changed;
+    }
+    if (!submitFetch(nowMs)) {
+      if (dsl_.debug) {
+        platform::logf("[%s] [%s] DSL fetch not queued\n", widgetName().c_str(),
+                       logTimestamp().c_str());
+      }
+      return changed;
+    }
+    fetchInFlight_ = true;
+    firstFetch_ = false;
+    forceFetchNow_ = false;
+    return changed;
+  }
+
+  if (!forceFetchNow_ && !firstFetch_ && nowMs - lastFetchMs_ < dsl_.pollMs) {
+    return changed;
+  }
+  lastFetchMs_ = nowMs;
+  firstFetch_ = false;
+  forceFetchNow_ = false;
+
+  FetchOutcome outcome;
+  if (dsl_.source == "local_time") {
+    if (!buildLocalTimeDoc(outcome.doc, outcome.error)) {
+      if (dsl_.debug) {
+        platform::logf("[%s] - [%s] - DSL local_time error: %s\n", widgetName().c_str(),
+                      logTimestamp().c_str(), outcome.error.c_str());
+      }
+    }
+  } else {
+    outcome.error = "unsupported source: " + dsl_.source;
     if (dsl_.debug) {
-      platform::logf("[%s] [%s] URL %s\n", widgetName().c_str(), logTimestamp().c_str(),
-                    clipText(resolvedUrl, 88).c_str());
-      if (!resolvedHeaders.empty()) {
-        platform::logf("[%s] [%s] HTTP headers=%u\n", widgetName().c_str(),
-                      logTimestamp().c_str(), static_cast<unsigned>(resolvedHeaders.size()));
+      platform::logf("[%s] - [%s] - DSL config error: %s\n", widgetName().c_str(),
+                    logTimestamp().c_str(), outcome.error.c_str());
+    }
+  }
+  if (applyFetchOutcome(outcome, nowMs)) {
+    changed = true;
+  }
+  return changed;
+}
+
+bool DslWidget::updateHaEntity(uint32_t nowMs) {
+  String url;
+  bindPlan(dsl_.urlPlan, dsl_.url, false, url);
+  if (haHandle_ == 0) {
+    // A bad url or token stays bad until the layout changes; retry at poll_ms, not per tick.
+    if (!firstFetch_ && nowMs - lastFetchMs_ < dsl_.pollMs) {
+      return false;
+    }
+    lastFetchMs_ = nowMs;
+    firstFetch_ = false;
+    // Same settings as the polled source: <base>/api/states/<entity_id> and a bearer token.
+    const int marker = url.indexOf("/api/states/");
+    String token;
+    const std::map<String, String> headers = resolveHttpHeaders();
+    auto auth = headers.find("Authorization");
+    if (auth != headers.end() && auth->second.startsWith("Bearer ")) {
+      token = auth->second.substring(7);
+    }
+    if (marker > 0) {
+      haHandle_ = haws::subscribe(url.substring(0, marker), token, url.substring(marker + 12));
+    }
+    if (haHandle_ == 0) {
+      FetchOutcome outcome;
+      outcome.error = "ha_ws url must be <base>/api/states/<entity_id>: " + url;
+      if (dsl_.debug) {
+        platform::logf("[%s] [%s] HA ws config error: %s\n", widgetName().c_str(),
+                       logTimestamp().c_str(), clipText(outcome.error, 120).c_str());
       }
+      return applyFetchOutcome(outcome, nowMs);
     }
-    if (resolvedUrl.isEmpty()) {
-      error = "resolved URL empty";
-    } else if (!http_.get(resolvedUrl, doc, &error, &fetchMeta, headersPtr)) {
-      const bool retryForEmptyPayload = error.startsWith("Empty payload");
-      const bool retryForTransport = fetchMeta.statusCode <= 0 && fetchMeta.statusCode != -2 &&
-                                     fetchMeta.statusCode != -3;
-      if (retryForEmptyPayload || retryForTransport) {
-        if (dsl_.debug && retryForTransport) {
-          Serial.printf("[%s] [%s] DSL retry after transport failure code=%d reason='%s'\n",
-                        widgetName().c_str(), logTimestamp().c_str(), fetchMeta.statusCode,
-                        fetchMeta.transportReason.c_str());
-        }
-        delay(retryForTransport ? 140 : 40);
-        JsonDocument retryDoc;
-        String retryError;
-        HttpFetchMeta retryMeta;
-        if (http_.get(resolvedUrl, retryDoc, &retryError, &retryMeta, headersPtr)) {
-          doc = retryDoc;
-          fetchMeta = retryMeta;
-          error = "";
-        } else {
-          error = retryError;
-          fetchMeta = retryMeta;
-        }
+    haSeen_ = 0;
+  }
+
+  bool changed = false;
+  FetchOutcome outcome;
+  outcome.url = url;
+  if (haws::read(haHandle_, haSeen_, outcome.doc)) {
+    if (dsl_.debug) {
+      platform::logf("[%s] [%s] HA ws state=%s rev=%lu\n", widgetName().c_str(),
+                     logTimestamp().c_str(), outcome.doc["state"] | "",
+                     static_cast<unsigned long>(haSeen_));
+    }
+    changed = applyFetchOutcome(outcome, nowMs);
+  }
+  // Fields keep their last values while the socket is away; only the status shows it.
+  const haws::Link link = haws::link(haHandle_);
+  const char* next = nullptr;
+  if (link == haws::Link::kAuthFailed) {
+    next = "auth err";
+  } else if (link == haws::Link::kDown) {
+    next = "net err";
+  }
+  if (next != nullptr && status_ != next) {
+    status_ = next;
+    changed = true;
+  }
+  return changed;
+}
+
+void DslWidget::releaseHaEntity() {
+  haws::unsubscribe(haHandle_);
+  haHandle_ = 0;
+  haSeen_ = 0;
+}
+
+bool DslWidget::updateSseStream(uint32_t nowMs) {
+  String url;
+  bindPlan(dsl_.urlPlan, dsl_.url, false, url);
+  if (sseHandle_ == 0) {
+    // As for ha_ws: a bad url stays bad until the layout changes, so retry at poll_ms.
+    if (!firstFetch_ && nowMs - lastFetchMs_ < dsl_.pollMs) {
+      return false;
+    }
+    lastFetchMs_ = nowMs;
+    firstFetch_ = false;
+    sseHandle_ = sse::open(url, resolveHttpHeaders(), dsl_.event);
+    if (sseHandle_ == 0) {
+      FetchOutcome outcome;
+      outcome.error = "sse url must be http(s): " + url;
+      if (dsl_.debug) {
+        platform::logf("[%s] [%s] SSE config error: %s\n", widgetName().c_str(),
+                       logTimestamp().c_str(), clipText(outcome.error, 120).c_str());
       }
+      return applyFetchOutcome(outcome, nowMs);
+    }
+    sseSeen_ = 0;
+  }
+
+  bool changed = false;
+  String data;
+  if (sse::read(sseHandle_, sseSeen_, data)) {
+    FetchOutcome outcome;
+    outcome.url = url;
+    const DeserializationError err =
+        hasFetchFilter_
+            ? deserializeJson(outcome.doc, data, DeserializationOption::Filter(fetchFilter_))
+            : deserializeJson(outcome.doc, data);
+    if (dsl_.debug) {
+      platform::logf("[%s] [%s] SSE event rev=%lu bytes=%u\n", widgetName().c_str(),
+                     logTimestamp().c_str(), static_cast<unsigned long>(sseSeen_),
+                     static_cast<unsigned>(data.length()));
+    }
+    if (!err) {
+      changed = applyFetchOutcome(outcome, nowMs);
+    } else {
+      // A bad event leaves the fields alone; the next good one clears the status.
+      platform::logf("[%s] [%s] SSE event json err=%s data=%s\n", widgetName().c_str(),
+                     logTimestamp().c_str(), err.c_str(), clipText(data, 80).c_str());
+      changed = status_ != "data err";
+      status_ = "data err";
     }
+  }
+  // Fields keep their last values while the stream is away; only the status shows it.
+  const sse::Link link = sse::link(sseHandle_);
+  const char* next = nullptr;
+  if (link == sse::Link::kFailed) {
+    next = "http err";
+  } else if (link == sse::Link::kDown) {
+    next = "net err";
+  } else if (link == sse::Link::kLive && status_ == "net err" && hasFreshFields_) {
+    // Resumed with nothing missed: the fields on screen are current again.
+    next = "ok";
+  }
+  if (next != nullptr && status_ != next) {
+    status_ = next;
+    changed = true;
+  }
+  return changed;
+}
+
+void DslWidget::releaseSseStream() {
+  sse::close(sseHandle_);
+  sseHandle_ = 0;
+  sseSeen_ = 0;
+}
 
+bool DslWidget::applyFetchOutcome(const FetchOutcome& outcome, uint32_t nowMs) {
+  const String& error = outcome.error;
+  const HttpFetchMeta& fetchMeta = outcome.meta;
+
+  if (dsl_.source == "adsb_nearest") {
+    logHttpFetchResult(fetchMeta.statusCode, fetchMeta.contentLengthBytes);
+    if (!error.isEmpty() && dsl_.debug) {
+      if (fetchMeta.statusCode <= 0) {
+        platform::logf("[%s] [%s] ADSB %s code=%d reason='%s' elapsed=%lums\n",
+                       widgetName().c_str(), logTimestamp().c_str(),
+                       describeTransportStage(fetchMeta).c_str(), fetchMeta.statusCode,
+                       fetchMeta.transportReason.c_str(),
+                       static_cast<unsigned long>(fetchMeta.elapsedMs));
+      }
+      platform::logf(
+          "[%s] [%s] ADSB err=%s status=%d bytes=%u ctype='%s'\n", widgetName().c_str(),
+          logTimestamp().c_str(), clipText(error, 140).c_str(), fetchMeta.statusCode,
+          static_cast<unsigned>(fetchMeta.payloadBytes), fetchMeta.contentType.c_str());
+    }
+  } else if (dsl_.source == "http") {
+    logHttpFetchResult(fetchMeta.statusCode, fetchMeta.contentLengthBytes);
     if (!error.isEmpty()) {
-      logHttpFetchResult(fetchMeta.statusCode, fetchMeta.contentLengthBytes);
       if (fetchMeta.statusCode <= 0) {
         platform::logf("[%s] [%s] DSL %s url=%s code=%d reason='%s' elapsed=%lums\n",
                        widgetName().c_str(), logTimestamp().c_str(),
-                       describeTransportStage(fetchMeta).c_str(), clipText(resolvedUrl, 96).c_str(),
-                       fetchMeta.statusCode, fetchMeta.transportReason.c_str(),
+                       describeTransportStage(fetchMeta).c_str(),
+                       clipText(outcome.url, 96).c_str(), fetchMeta.statusCode,
+                       fetchMeta.transportReason.c_str(),
                        static_cast<unsigned long>(fetchMeta.elapsedMs));
       }
       if (dsl_.debug) {
@@ -660,103 +1179,36 @@ bool DslWidget::update(uint32_t nowMs) {
             logTimestamp().c_str(), clipText(error, 140).c_str(), fetchMeta.statusCode,
             static_cast<unsigned>(fetchMeta.payloadBytes), fetchMeta.contentType.c_str());
       }
-    } else {
-      logHttpFetchResult(fetchMeta.statusCode, fetchMeta.contentLengthBytes);
-      if (dsl_.debug) {
-        platform::logf("[%s] [%s] DSL ok url=%s bytes=%u\n", widgetName().c_str(),
-                      logTimestamp().c_str(), clipText(resolvedUrl, 70).c_str(),
-                      static_cast<unsigned>(fetchMeta.payloadBytes));
-      }
-    }
-  } else {
-    error = "unsupported source: " + dsl_.source;
-    if (dsl_.debug) {
-      platform::logf("[%s] - [%s] - DSL config error: %s\n", widgetName().c_str(),
-                    logTimestamp().c_str(), error.c_str());
+    } else if (dsl_.debug && fetchMeta.notModified) {
+      platform::logf("[%s] [%s] DSL not modified url=%s\n", widgetName().c_str(),
+                     logTimestamp().c_str(), clipText(outcome.url, 70).c_str());
+    } else if (dsl_.debug) {
+      platform::logf("[%s] [%s] DSL ok url=%s bytes=%u\n", widgetName().c_str(),
+                    logTimestamp().c_str(), clipText(outcome.url, 70).c_str(),
+                    static_cast<unsigned>(fetchMeta.payloadBytes));
     }
   }
 
+  // Retries and backoff after errors are up to PollScheduler (see SharedSource::noteSeen).
   if (!error.isEmpty()) {
-    if (dsl_.source == "adsb_nearest") {
-      adsbFailureStreak_ = static_cast<uint8_t>(adsbFailureStreak_ < 7 ? adsbFailureStreak_ + 1 : 7);
-      uint32_t backoffMs = dsl_.pollMs;
-      if (fetchMeta.statusCode <= 0) {
-        // Transport-level failures benefit from a stronger cooldown.
-        const uint8_t shift = adsbFailureStreak_ > 3 ? 3 : adsbFailureStreak_;
-        backoffMs = dsl_.pollMs << shift;
-        if (backoffMs > 120000U) {
-          backoffMs = 120000U;
-        }
-      } else if (fetchMeta.statusCode == 429 || fetchMeta.statusCode == 503) {
-        backoffMs = dsl_.pollMs * 4U;
-        if (backoffMs > 120000U) {
-          backoffMs = 120000U;
-        }
-      }
-      adsbBackoffUntilMs_ = nowMs + backoffMs;
-      if (dsl_.debug) {
-        platform::logf("[%s] [%s] ADSB cooldown %lus streak=%u status=%d\n",
-                      widgetName().c_str(), logTimestamp().c_str(),
-                      static_cast<unsigned long>(backoffMs / 1000UL),
-                      static_cast<unsigned>(adsbFailureStreak_), fetchMeta.statusCode);
-      }
-    }
-    if (dsl_.source == "http") {
-      httpFailureStreak_ = static_cast<uint8_t>(httpFailureStreak_ < 7 ? httpFailureStreak_ + 1 : 7);
-      uint32_t backoffMs = dsl_.pollMs;
-      if (fetchMeta.statusCode == -2) {
-        // TLS preflight low-largest-block should retry soon after memory churn settles.
-        backoffMs = 5000U;
-      } else if (fetchMeta.statusCode == -3) {
-        // Global transport cooldown already throttles requests; keep widget retry short.
-        backoffMs = 4000U;
-      } else if (fetchMeta.statusCode <= 0) {
-        // Transport errors should retry from a short base independent of poll interval.
-        const uint8_t shift = httpFailureStreak_ > 4 ? 4 : httpFailureStreak_;
-        backoffMs = 3000U << shift;  // 6s, 12s, 24s, 48s, 96s
-        if (backoffMs > 30000U) {
-          backoffMs = 30000U;
-        }
-      } else if (fetchMeta.statusCode == 429 || fetchMeta.statusCode == 503) {
-        backoffMs = dsl_.pollMs * 4U;
-        if (backoffMs > 120000U) {
-          backoffMs = 120000U;
-        }
-      }
-      httpBackoffUntilMs_ = nowMs + backoffMs;
-      if (dsl_.debug) {
-        Serial.printf("[%s] [%s] HTTP cooldown %lus streak=%u status=%d\n",
-                      widgetName().c_str(), logTimestamp().c_str(),
-                      static_cast<unsigned long>(backoffMs / 1000UL),
-                      static_cast<unsigned>(httpFailureStreak_), fetchMeta.statusCode);
-      }
-    }
-
     const String next = "net err";
     const bool changed = (status_ != next);
     status_ = next;
     return changed;
   }
 
-  if (dsl_.source == "adsb_nearest") {
-    if (dsl_.debug && adsbFailureStreak_ > 0) {
-      platform::logf("[%s] [%s] ADSB recovered after %u failures\n", widgetName().c_str(),
-                    logTimestamp().c_str(), static_cast<unsigned>(adsbFailureStreak_));
-    }
-    adsbFailureStreak_ = 0;
-    adsbBackoffUntilMs_ = 0;
-  }
-  if (dsl_.source == "http") {
-    if (dsl_.debug && httpFailureStreak_ > 0) {
-      Serial.printf("[%s] [%s] HTTP recovered after %u failures\n", widgetName().c_str(),
-                    logTimestamp().c_str(), static_cast<unsigned>(httpFailureStreak_));
+  bool changed = false;
+  // Unchanged payload: the fields already hold these values, so skip the diff entirely.
+  if (!fetchMeta.notModified) {
+    applyFieldsFromDoc(outcome.doc, changed);
+    // The first fetch rewrites the cache even when nothing changed, to refresh its age.
+    if (changed || !hasFreshFields_) {
+      fieldCacheDirty_ = true;
     }
-    httpFailureStreak_ = 0;
-    httpBackoffUntilMs_ = 0;
   }
-
-  bool changed = false;
-  applyFieldsFromDoc(doc, changed);
+  fieldsFromCache_ = false;
+  hasFreshFields_ = true;
+  saveFieldCache(outcome.url, nowMs);
 
   if (status_ != "ok") {
     status_ = "ok";
@@ -1,34 +1,91 @@
 #include "widgets/DslWidget.h"
+#include "widgets/DslIconCodec.h"
 #include "widgets/DslRuntimeCaches.h"
+#include "widgets/DslSpanRaster.h"
 
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <list>
 #include <math.h>
 #include <map>
+#include <memory>
 #include <string.h>
+#include <time.h>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <HTTPClient.h>
 #include <WiFiClientSecure.h>
+#include <esp_heap_caps.h>
 
 #include "platform/Fs.h"
+#include "platform/IconPack.h"
 #include "platform/Net.h"
+#include "services/HttpRequestQueue.h"
 #include "services/HttpTransportGate.h"
+#include "services/PollScheduler.h"
+
+#ifndef COSTAR_ICON_CACHE_BYTES
+#define COSTAR_ICON_CACHE_BYTES (48 * 1024)
+#endif
+#ifndef COSTAR_SAVE_UNDER_BYTES
+#define COSTAR_SAVE_UNDER_BYTES (24 * 1024)
+#endif
 
 namespace {
+struct IconDataFree {
+  void operator()(uint8_t* data) const { heap_caps_free(data); }
+};
+
 struct IconCacheEntry {
   String key;
+  uint32_t hash = 0;
   int16_t w = 0;
   int16_t h = 0;
-  std::vector<uint16_t> pixels;
+  // The file as read: w * h RGB565 pixels, or a packed icon (DslIconCodec.h) that is decoded
+  // while it is drawn. In PSRAM when the board has it.
+  std::unique_ptr<uint8_t[], IconDataFree> data;
+  size_t bytes = 0;
+  bool packed = false;
+  bool psram = false;
+};
+
+// An icon ready to draw: a cache entry, or a built-in icon straight from the mapped icon pack.
+struct IconView {
+  int16_t w = 0;
+  int16_t h = 0;
+  const uint8_t* data = nullptr;
+  size_t bytes = 0;
+  bool packed = false;
 };
 
-constexpr size_t kMaxIconCache = 12;
-std::vector<IconCacheEntry> sIconCache;
+// Loaded icons, most recently used first, indexed by the hash of "path#WxH". Evicted from the
+// back once the byte budget is exceeded.
+std::list<IconCacheEntry> sIconCache;
+std::unordered_map<uint32_t, std::list<IconCacheEntry>::iterator> sIconIndex;
+size_t sIconCacheBytes = 0;
+size_t sIconCacheBudget = COSTAR_ICON_CACHE_BYTES;
+DslIconCacheStats sIconCacheStats;
+// Owned by the request worker; other tasks only ask for a reset through the flag below.
 std::map<String, uint32_t> sRemoteIconRetryAfterMs;
+std::atomic<bool> sRemoteIconRetryResetPending{false};
+// Bumped whenever a remote icon lands in the flash cache, so waiting widgets redraw.
+std::atomic<uint32_t> sRemoteIconGeneration{0};
 constexpr uint32_t kRemoteIconRetryMs = 30000U;
 constexpr uint32_t kRemoteIconIoTimeoutMs = 10000U;
 constexpr char kIconCacheDir[] = "/icon_cache";
+// Packed icons are decoded into this buffer and pushed a strip of rows at a time.
+constexpr size_t kIconBlitPixels = 1024;
+uint16_t sIconBlit[kIconBlitPixels];
+// Larger widgets render through a strip sprite of kSpriteBandRows rows instead of a full one,
+// which rarely fits in internal RAM next to WiFi/TLS buffers.
+constexpr size_t kMaxFullSpriteBytes = 32 * 1024;
+constexpr int16_t kSpriteBandRows = 16;
+// Most a widget may hold, packed, of the pixels under its open modal; 0 turns save-under off.
+size_t sSaveUnderBudget = COSTAR_SAVE_UNDER_BYTES;
 
 void pruneRemoteIconRetryMap(uint32_t nowMs) {
   for (auto it = sRemoteIconRetryAfterMs.begin(); it != sRemoteIconRetryAfterMs.end();) {
@@ -57,15 +114,17 @@ bool hasEmptyIconQuery(const String& path) {
   return next == '&' || next == '#';
 }
 
-uint32_t fnv1a32(const String& text) {
-  uint32_t hash = 2166136261u;
-  for (size_t i = 0; i < text.length(); ++i) {
-    hash ^= static_cast<uint8_t>(text[i]);
+uint32_t fnv1aMix(uint32_t hash, const void* data, size_t len) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < len; ++i) {
+    hash ^= bytes[i];
     hash *= 16777619u;
   }
   return hash;
 }
 
+uint32_t fnv1a32(const String& text) { return fnv1aMix(2166136261u, text.c_str(), text.length()); }
+
 String remoteIconCachePath(const String& url, int16_t w, int16_t h) {
   const uint32_t hash = fnv1a32(url);
   char hashHex[9];
@@ -81,85 +140,129 @@ bool ensureIconCacheDir() {
   return platform::fs::mkdir(kIconCacheDir);
 }
 
-const IconCacheEntry* findIcon(const String& key) {
-  for (const auto& entry : sIconCache) {
-    if (entry.key == key) {
-      return &entry;
-    }
+const IconCacheEntry* findIcon(const String& key, uint32_t hash) {
+  auto it = sIconIndex.find(hash);
+  if (it == sIconIndex.end() || it->second->key != key) {
+    ++sIconCacheStats.misses;
+    return nullptr;
   }
-  return nullptr;
+  ++sIconCacheStats.hits;
+  sIconCache.splice(sIconCache.begin(), sIconCache, it->second);
+  return &sIconCache.front();
+}
+
+void eraseIcon(std::list<IconCacheEntry>::iterator it) {
+  sIconCacheBytes -= it->bytes;
+  sIconIndex.erase(it->hash);
+  sIconCache.erase(it);
 }
 
-bool loadIconPixelsFromFile(const String& filePath, const String& cacheKey,
-                            int16_t w, int16_t h) {
+// Evicts least recently used icons until `bytes` more fit the budget. An icon larger than the
+// whole budget still gets cached, alone.
+void makeIconRoom(size_t bytes) {
+  while (!sIconCache.empty() && sIconCacheBytes + bytes > sIconCacheBudget) {
+    eraseIcon(std::prev(sIconCache.end()));
+    ++sIconCacheStats.evictions;
+  }
+}
+
+// Raw icons are exactly w * h * 2 bytes; a shorter file has to be a packed w x h icon.
+const IconCacheEntry* loadIconFromFile(const String& filePath, const String& cacheKey,
+                                       uint32_t hash, int16_t w, int16_t h) {
   platform::fs::File f = platform::fs::open(filePath, FILE_READ);
   if (!f || f.isDirectory()) {
-    return false;
+    return nullptr;
   }
 
   const size_t expected = static_cast<size_t>(w) * static_cast<size_t>(h) * 2U;
-  if (f.size() < expected) {
+  const size_t fileSize = f.size();
+  const bool packed = fileSize < expected;
+  if (packed && fileSize < iconcodec::kHeaderBytes) {
     f.close();
-    return false;
+    return nullptr;
+  }
+  const size_t bytes = packed ? fileSize : expected;
+
+  // A different key under the same hash is replaced rather than chained.
+  auto clash = sIconIndex.find(hash);
+  if (clash != sIconIndex.end()) {
+    eraseIcon(clash->second);
   }
+  makeIconRoom(bytes);
 
   IconCacheEntry entry;
   entry.key = cacheKey;
+  entry.hash = hash;
   entry.w = w;
   entry.h = h;
-  entry.pixels.resize(static_cast<size_t>(w) * static_cast<size_t>(h));
-  const size_t read = f.read(reinterpret_cast<uint8_t*>(entry.pixels.data()), expected);
+  entry.bytes = bytes;
+  entry.packed = packed;
+  entry.data.reset(static_cast<uint8_t*>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM)));
+  entry.psram = entry.data != nullptr;
+  if (!entry.data) {
+    entry.data.reset(static_cast<uint8_t*>(heap_caps_malloc(bytes, MALLOC_CAP_8BIT)));
+  }
+  if (!entry.data) {
+    f.close();
+    return nullptr;
+  }
+  const size_t read = f.read(entry.data.get(), bytes);
   f.close();
-  if (read != expected) {
-    return false;
+  if (read != bytes) {
+    return nullptr;
   }
-
-  if (sIconCache.size() >= kMaxIconCache) {
-    sIconCache.erase(sIconCache.begin());
+  if (packed && !iconcodec::validate(entry.data.get(), bytes, static_cast<uint16_t>(w),
+                                     static_cast<uint16_t>(h))) {
+    return nullptr;
   }
-  sIconCache.push_back(std::move(entry));
-  return true;
+
+  sIconCacheBytes += bytes;
+  sIconCache.push_front(std::move(entry));
+  sIconIndex[hash] = sIconCache.begin();
+  return &sIconCache.front();
 }
 
-uint32_t parseRetryAfterMs(const String& retryAfter) {
-  if (retryAfter.isEmpty()) {
-    return kRemoteIconRetryMs;
+IconView viewOf(const IconCacheEntry& entry) {
+  IconView view;
+  view.w = entry.w;
+  view.h = entry.h;
+  view.data = entry.data.get();
+  view.bytes = entry.bytes;
+  view.packed = entry.packed;
+  return view;
+}
+
+template <typename Gfx>
+void blitIcon(Gfx& gfx, int32_t x, int32_t y, const IconView& icon) {
+  if (!icon.packed) {
+    gfx.pushImage(x, y, icon.w, icon.h, reinterpret_cast<const uint16_t*>(icon.data));
+    return;
   }
-  bool hasDigit = false;
-  for (size_t i = 0; i < retryAfter.length(); ++i) {
-    const char c = retryAfter[i];
-    if (c >= '0' && c <= '9') {
-      hasDigit = true;
-      continue;
-    }
-    if (c == ' ' || c == '\t') {
-      continue;
+  iconcodec::Decoder decoder(icon.data, icon.bytes);
+  const int16_t stripRows =
+      static_cast<int16_t>(std::max<size_t>(1, kIconBlitPixels / static_cast<size_t>(icon.w)));
+  for (int16_t row = 0; row < icon.h; row += stripRows) {
+    const int16_t rows = std::min<int16_t>(stripRows, icon.h - row);
+    if (!decoder.read(sIconBlit, static_cast<size_t>(icon.w) * rows)) {
+      return;
     }
-    return kRemoteIconRetryMs;
+    gfx.pushImage(x, y + row, icon.w, rows, sIconBlit);
   }
-  if (!hasDigit) {
-    return kRemoteIconRetryMs;
-  }
-  const long seconds = retryAfter.toInt();
-  if (seconds <= 0) {
+}
+
+uint32_t parseRetryAfterMs(const String& retryAfter) {
+  const uint32_t ms = PollScheduler::parseRetryAfterMs(retryAfter, time(nullptr));
+  if (ms == 0) {
     return kRemoteIconRetryMs;
   }
-  const uint32_t ms = static_cast<uint32_t>(seconds) * 1000U;
-  if (ms < 1000U) {
-    return 1000U;
-  }
-  if (ms > 300000U) {
-    return 300000U;
-  }
-  return ms;
+  return std::min<uint32_t>(std::max<uint32_t>(ms, 1000U), 300000U);
 }
 
 bool fetchRemoteIconToFile(const String& url, const String& outPath, int16_t w, int16_t h) {
-  if (!platform::net::isConnected()) {
-    return false;
+  if (sRemoteIconRetryResetPending.exchange(false)) {
+    sRemoteIconRetryAfterMs.clear();
   }
-  httpgate::Guard gate(12000);
-  if (!gate.locked()) {
+  if (!platform::net::isConnected()) {
     return false;
   }
 
@@ -171,6 +274,11 @@ bool fetchRemoteIconToFile(const String& url, const String& outPath, int16_t w,
     return false;
   }
 
+  httpgate::Guard gate(12000);
+  if (!gate.locked()) {
+    return false;
+  }
+
   const size_t expected = static_cast<size_t>(w) * static_cast<size_t>(h) * 2U;
   if (expected == 0) {
     return false;
@@ -196,9 +304,10 @@ bool fetchRemoteIconToFile(const String& url, const String& outPath, int16_t w,
   http.setTimeout(7000);
   http.useHTTP10(true);
   http.setReuse(false);
-  const char* headerKeys[] = {"Retry-After", "Content-Length"};
-  http.collectHeaders(headerKeys, 2);
-  http.addHeader("Accept", "application/octet-stream");
+  const char* headerKeys[] = {"Retry-After", "Content-Length", "X-Image-Format"};
+  http.collectHeaders(headerKeys, 3);
+  // The image proxy answers with a packed icon when it is smaller than the raw pixels.
+  http.addHeader("Accept", "application/x-costar-icon, application/octet-stream");
   const int status = http.GET();
   if (status != HTTP_CODE_OK) {
     const uint32_t retryMs =
@@ -210,11 +319,18 @@ bool fetchRemoteIconToFile(const String& url, const String& outPath, int16_t w,
   }
 
   const int contentLength = http.getSize();
-  if (contentLength > 0 && static_cast<size_t>(contentLength) < expected) {
+  const bool packed = http.header("X-Image-Format") == "rgb565rle";
+  // Raw bodies must hold every pixel; packed ones are read to their end (or connection close)
+  // and are never larger than the raw pixels.
+  if (contentLength > 0 && static_cast<size_t>(contentLength) < expected &&
+      (!packed || static_cast<size_t>(contentLength) < iconcodec::kHeaderBytes)) {
     sRemoteIconRetryAfterMs[url] = nowMs + kRemoteIconRetryMs;
     http.end();
     return false;
   }
+  const size_t limit = packed && contentLength > 0 && static_cast<size_t>(contentLength) < expected
+                           ? static_cast<size_t>(contentLength)
+                           : expected;
 
   const String tempPath = outPath + ".tmp";
   platform::fs::remove(tempPath);
@@ -227,10 +343,11 @@ bool fetchRemoteIconToFile(const String& url, const String& outPath, int16_t w,
 
   WiFiClient* stream = http.getStreamPtr();
   size_t total = 0;
+  uint8_t head[iconcodec::kHeaderBytes];
   uint32_t ioStartMs = millis();
   uint32_t lastByteMs = ioStartMs;
   while ((http.connected() || (stream && stream->available() > 0)) &&
-         (millis() - ioStartMs) < kRemoteIconIoTimeoutMs && total < expected) {
+         (millis() - ioStartMs) < kRemoteIconIoTimeoutMs && total < limit) {
     if (stream == nullptr) {
       break;
     }
@@ -238,8 +355,8 @@ bool fetchRemoteIconToFile(const String& url, const String& outPath, int16_t w,
     if (available > 0) {
       uint8_t buf[128];
       size_t toRead = available > sizeof(buf) ? sizeof(buf) : available;
-      if (total + toRead > expected) {
-        toRead = expected - total;
+      if (total + toRead > limit) {
+        toRead = limit - total;
       }
       const int readCount = stream->readBytes(reinterpret_cast<char*>(buf), toRead);
       if (readCount > 0) {
@@ -251,6 +368,9 @@ bool fetchRemoteIconToFile(const String& url, const String& outPath, int16_t w,
           sRemoteIconRetryAfterMs[url] = nowMs + kRemoteIconRetryMs;
           return false;
         }
+        for (size_t i = total; i < sizeof(head) && i < total + written; ++i) {
+          head[i] = buf[i - total];
+        }
         total += written;
         lastByteMs = millis();
       }
@@ -265,7 +385,14 @@ bool fetchRemoteIconToFile(const String& url, const String& outPath, int16_t w,
   out.close();
   http.end();
 
-  if (total != expected) {
+  iconcodec::Header header;
+  const bool complete =
+      packed ? total < expected && (contentLength <= 0 || total == limit) &&
+                   iconcodec::readHeader(head, total < sizeof(head) ? total : sizeof(head),
+                                         header) &&
+                   header.w == static_cast<uint16_t>(w) && header.h == static_cast<uint16_t>(h)
+             : total == expected;
+  if (!complete) {
     platform::fs::remove(tempPath);
     sRemoteIconRetryAfterMs[url] = nowMs + kRemoteIconRetryMs;
     return false;
@@ -282,38 +409,57 @@ bool fetchRemoteIconToFile(const String& url, const String& outPath, int16_t w,
   return true;
 }
 
-const IconCacheEntry* loadIcon(const String& path, int16_t w, int16_t h) {
-  if (path.isEmpty() || w <= 0 || h <= 0) {
-    return nullptr;
-  }
-  const String key = path + "#" + String(w) + "x" + String(h);
-  if (const IconCacheEntry* cached = findIcon(key)) {
-    return cached;
-  }
-  if (!isRemoteIconPath(path)) {
-    if (loadIconPixelsFromFile(path, key, w, h)) {
-      return &sIconCache.back();
-    }
-    return nullptr;
+// Downloads run on the request worker; loadIcon() reports them as pending and the widget
+// redraws once sRemoteIconGeneration moves.
+void requestRemoteIcon(const String& url, const String& cachePath, int16_t w, int16_t h,
+                       bool* pending) {
+  const bool queued = httpq::submit<bool>(
+      httpq::Priority::kIcon, "icon|" + cachePath,
+      [url, cachePath, w, h](bool& ok) { ok = fetchRemoteIconToFile(url, cachePath, w, h); },
+      [](const std::shared_ptr<const bool>& ok) {
+        if (*ok) {
+          sRemoteIconGeneration.fetch_add(1);
+        }
+      });
+  if (queued && pending != nullptr) {
+    *pending = true;
   }
-  if (hasEmptyIconQuery(path)) {
-    return nullptr;
+}
+
+bool loadIcon(const String& path, int16_t w, int16_t h, bool* pending, IconView& out) {
+  if (path.isEmpty() || w <= 0 || h <= 0) {
+    return false;
   }
-  if (!ensureIconCacheDir()) {
-    return nullptr;
+  const bool remote = isRemoteIconPath(path);
+  platform::iconpack::Icon builtin;
+  if (!remote && platform::iconpack::find(path.c_str(), builtin) && builtin.w == w &&
+      builtin.h == h) {
+    ++sIconCacheStats.builtinHits;
+    out.w = w;
+    out.h = h;
+    out.data = builtin.data;
+    out.bytes = builtin.bytes;
+    out.packed = builtin.bytes < static_cast<size_t>(w) * static_cast<size_t>(h) * 2U;
+    return true;
   }
 
-  const String cachePath = remoteIconCachePath(path, w, h);
-  if (loadIconPixelsFromFile(cachePath, key, w, h)) {
-    return &sIconCache.back();
-  }
-  if (!fetchRemoteIconToFile(path, cachePath, w, h)) {
-    return nullptr;
+  const String key = path + "#" + String(w) + "x" + String(h);
+  const uint32_t hash = fnv1a32(key);
+  const IconCacheEntry* entry = findIcon(key, hash);
+  if (entry == nullptr && !remote) {
+    entry = loadIconFromFile(path, key, hash, w, h);
+  } else if (entry == nullptr && !hasEmptyIconQuery(path) && ensureIconCacheDir()) {
+    const String cachePath = remoteIconCachePath(path, w, h);
+    entry = loadIconFromFile(cachePath, key, hash, w, h);
+    if (entry == nullptr) {
+      requestRemoteIcon(path, cachePath, w, h, pending);
+    }
   }
-  if (!loadIconPixelsFromFile(cachePath, key, w, h)) {
-    return nullptr;
+  if (entry == nullptr) {
+    return false;
   }
-  return &sIconCache.back();
+  out = viewOf(*entry);
+  return true;
 }
 
 bool isCenterDatum(uint8_t datum) {
@@ -396,6 +542,84 @@ void safeDrawString(Gfx& gfx, const String& text, int16_t x, int16_t y, uint8_t
   gfx.drawString(buf, x, y, safeFontId(font));
 }
 
+// Advance widths of printable ASCII per font, read once from textWidth. Text widths in the
+// TFT_eSPI fonts are plain sums of glyph advances, so lines can be measured incrementally.
+struct GlyphAdvances {
+  bool ready = false;
+  uint8_t advance[95] = {};
+};
+GlyphAdvances sGlyphAdvances[9];
+
+bool isWrapSeparator(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Measures text the way safeDrawString draws it, from the per-font advance table. Bytes
+// outside printable ASCII (UTF-8 sequences, control characters) are measured as one unit
+// through textWidth.
+template <typename Gfx>
+class TextMeasure {
+ public:
+  TextMeasure(Gfx& gfx, uint8_t font) : gfx_(gfx), font_(safeFontId(font)) {
+    GlyphAdvances& table = sGlyphAdvances[font_];
+    if (!table.ready) {
+      char glyph[2] = {0, 0};
+      for (int c = 32; c < 127; ++c) {
+        glyph[0] = static_cast<char>(c);
+        table.advance[c - 32] = static_cast<uint8_t>(gfx.textWidth(glyph, font_));
+      }
+      table.ready = true;
+    }
+    advance_ = table.advance;
+  }
+
+  int32_t space() const { return advance_[0]; }
+
+  // Width of the character unit at text[i] (at most `end`); `len` receives its byte length.
+  int32_t unit(const char* text, size_t i, size_t end, size_t& len) {
+    const uint8_t c = static_cast<uint8_t>(text[i]);
+    if (c >= 32 && c < 127) {
+      len = 1;
+      return advance_[c - 32];
+    }
+    len = 1;
+    if (c >= 0xF0) {
+      len = 4;
+    } else if (c >= 0xE0) {
+      len = 3;
+    } else if (c >= 0xC0) {
+      len = 2;
+    }
+    len = std::min(len, end - i);
+    char buf[5];
+    memcpy(buf, text + i, len);
+    buf[len] = '\0';
+    return gfx_.textWidth(buf, font_);
+  }
+
+  // Width of text[start, end) with separator runs drawn as one space.
+  int32_t width(const char* text, size_t start, size_t end) {
+    int32_t w = 0;
+    size_t i = start;
+    while (i < end) {
+      if (isWrapSeparator(text[i])) {
+        while (i < end && isWrapSeparator(text[i])) {
+          ++i;
+        }
+        w += space();
+        continue;
+      }
+      size_t len = 0;
+      w += unit(text, i, end, len);
+      i += len;
+    }
+    return w;
+  }
+
+ private:
+  Gfx& gfx_;
+  const uint8_t font_;
+  const uint8_t* advance_ = nullptr;
+};
+
 template <typename Gfx>
 String ellipsizeToWidth(Gfx& gfx, const String& text, uint8_t font, int16_t maxWidth) {
   if (maxWidth <= 0) {
@@ -406,293 +630,952 @@ String ellipsizeToWidth(Gfx& gfx, const String& text, uint8_t font, int16_t maxW
   }
 
   const String dots = "...";
-  if (textWidthPx(gfx, dots, font) > maxWidth) {
+  TextMeasure<Gfx> measure(gfx, font);
+  const int32_t dotsW = measure.width(dots.c_str(), 0, dots.length());
+  if (dotsW > maxWidth) {
     for (int i = dots.length(); i > 0; --i) {
-      const String candidate = dots.substring(0, i);
-      if (textWidthPx(gfx, candidate, font) <= maxWidth) {
-        return candidate;
+      if (measure.width(dots.c_str(), 0, i) <= maxWidth) {
+        return dots.substring(0, i);
       }
     }
     return String();
   }
 
-  for (int len = text.length(); len > 0; --len) {
-    const String candidate = text.substring(0, len) + dots;
-    if (textWidthPx(gfx, candidate, font) <= maxWidth) {
-      return candidate;
+  // Longest prefix that still fits in front of the dots; widths only grow with length.
+  const char* raw = text.c_str();
+  const size_t n = text.length();
+  size_t best = 0;
+  int32_t w = dotsW;
+  for (size_t i = 0; i < n;) {
+    size_t len = 0;
+    w += measure.unit(raw, i, n, len);
+    if (w > maxWidth) {
+      break;
     }
+    i += len;
+    best = i;
   }
-  return dots;
+  if (best == 0) {
+    return dots;
+  }
+  return text.substring(0, best) + dots;
 }
 
+// Greedy word wrap into [start, end) byte ranges of `text`, one pair per line in `breaks`.
+// Words are split on spaces, tabs and CRs and joined back with single spaces (see
+// wrappedLine); '\n' always ends a line; a word wider than maxWidth is split by character.
+// Every character is measured once.
+template <typename Gfx>
+void wrapLineBreaks(Gfx& gfx, const String& text, uint8_t font, int16_t maxWidth,
+                    std::vector<uint16_t>& breaks) {
+  breaks.clear();
+  TextMeasure<Gfx> measure(gfx, font);
+  const char* raw = text.c_str();
+  // Offsets are 16-bit; labels are far shorter (safeDrawString draws at most 160 bytes).
+  const size_t n = std::min<size_t>(text.length(), 0xFFFF);
+  bool haveLine = false;
+  size_t lineStart = 0;
+  size_t lineEnd = 0;
+  int32_t lineW = 0;
+
+  auto pushLine = [&](size_t start, size_t end) {
+    breaks.push_back(static_cast<uint16_t>(start));
+    breaks.push_back(static_cast<uint16_t>(end));
+  };
+  auto startLine = [&](size_t start, size_t end, int32_t w) {
+    haveLine = true;
+    lineStart = start;
+    lineEnd = end;
+    lineW = w;
+  };
+  auto placeLongWord = [&](size_t start, size_t end) {
+    while (start < end) {
+      size_t pieceEnd = start;
+      int32_t pieceW = 0;
+      while (pieceEnd < end) {
+        size_t len = 0;
+        const int32_t w = measure.unit(raw, pieceEnd, end, len);
+        if (pieceEnd > start && pieceW + w > maxWidth) {
+          break;
+        }
+        pieceW += w;
+        pieceEnd += len;
+      }
+      if (pieceEnd < end) {
+        pushLine(start, pieceEnd);
+      } else {
+        startLine(start, pieceEnd, pieceW);
+      }
+      start = pieceEnd;
+    }
+  };
+  auto placeWord = [&](size_t start, size_t end, int32_t w) {
+    if (haveLine) {
+      if (lineW + measure.space() + w <= maxWidth) {
+        lineEnd = end;
+        lineW += measure.space() + w;
+        return;
+      }
+      pushLine(lineStart, lineEnd);
+      haveLine = false;
+    }
+    if (w <= maxWidth) {
+      startLine(start, end, w);
+    } else {
+      placeLongWord(start, end);
+    }
+  };
+
+  size_t i = 0;
+  while (i < n) {
+    const char c = raw[i];
+    if (c == '\n') {
+      pushLine(haveLine ? lineStart : i, haveLine ? lineEnd : i);
+      haveLine = false;
+      ++i;
+      continue;
+    }
+    if (isWrapSeparator(c)) {
+      ++i;
+      continue;
+    }
+    const size_t wordStart = i;
+    int32_t wordW = 0;
+    while (i < n && raw[i] != '\n' && !isWrapSeparator(raw[i])) {
+      size_t len = 0;
+      wordW += measure.unit(raw, i, n, len);
+      i += len;
+    }
+    placeWord(wordStart, i, wordW);
+  }
+  if (haveLine || breaks.empty()) {
+    pushLine(haveLine ? lineStart : 0, haveLine ? lineEnd : 0);
+  }
+}
+
+// text[start, end) with each run of separators collapsed to one space.
+String wrappedLine(const String& text, uint16_t start, uint16_t end) {
+  String line;
+  line.reserve(end - start);
+  bool gap = false;
+  for (uint16_t i = start; i < end; ++i) {
+    const char c = text[i];
+    if (isWrapSeparator(c)) {
+      gap = true;
+      continue;
+    }
+    if (gap) {
+      line += ' ';
+      gap = false;
+    }
+    line += c;
+  }
+  return line;
+}
+
+// Wrapped lines of `text`. With a memo, line breaks are reused while text, font and width are
+// unchanged, so an unchanged label is not measured again.
 template <typename Gfx>
 std::vector<String> wrapLabelLines(Gfx& gfx, const String& text, uint8_t font,
-                                   int16_t maxWidth) {
+                                   int16_t maxWidth, DslWrapMemo* memo = nullptr) {
   std::vector<String> lines;
   if (maxWidth <= 0) {
     lines.push_back(text);
     return lines;
   }
 
-  String currentLine;
-  String currentWord;
+  const uint32_t hash = fnv1a32(text);
+  std::vector<uint16_t> scratch;
+  std::vector<uint16_t>* breaks = &scratch;
+  if (memo != nullptr) {
+    breaks = &memo->breaks;
+    if (!memo->valid || memo->textHash != hash || memo->textLength != text.length() ||
+        memo->font != font || memo->width != maxWidth) {
+      wrapLineBreaks(gfx, text, font, maxWidth, memo->breaks);
+      memo->valid = true;
+      memo->textHash = hash;
+      memo->textLength = text.length();
+      memo->font = font;
+      memo->width = maxWidth;
+    }
+  } else {
+    wrapLineBreaks(gfx, text, font, maxWidth, scratch);
+  }
 
-  auto placeWord = [&](const String& word) {
-    if (word.isEmpty()) {
-      return;
+  lines.reserve(breaks->size() / 2);
+  for (size_t i = 0; i + 1 < breaks->size(); i += 2) {
+    lines.push_back(wrappedLine(text, (*breaks)[i], (*breaks)[i + 1]));
+  }
+  return lines;
+}
+
+// Word-wrapped label block: `node.w` wide, at most max_lines (or as many as fit in node.h).
+template <typename Gfx>
+void drawWrappedLabel(Gfx& gfx, const dsl::Node& node, const String& labelText, uint8_t font,
+                      int16_t x, int16_t y, DslWrapMemo* memo) {
+  int16_t lineHeight = node.lineHeight > 0 ? node.lineHeight : gfx.fontHeight(font);
+  if (lineHeight <= 0) {
+    lineHeight = 10;
+  }
+
+  int16_t maxLines = node.maxLines > 0 ? node.maxLines : 0;
+  if (node.h > 0) {
+    const int16_t fromHeight = node.h / lineHeight;
+    if (fromHeight > 0) {
+      maxLines = (maxLines > 0) ? std::min(maxLines, fromHeight) : fromHeight;
     }
+  }
 
-    auto placeLongWord = [&](const String& longWord) {
-      int start = 0;
-      while (start < longWord.length()) {
-        int bestEnd = start;
-        for (int end = start + 1; end <= longWord.length(); ++end) {
-          const String piece = longWord.substring(start, end);
-          if (textWidthPx(gfx, piece, font) <= maxWidth) {
-            bestEnd = end;
-            continue;
-          }
-          break;
-        }
-        if (bestEnd == start) {
-          bestEnd = start + 1;
-        }
+  std::vector<String> lines = wrapLabelLines(gfx, labelText, font, node.w, memo);
+  bool truncated = false;
+  if (maxLines > 0 && lines.size() > static_cast<size_t>(maxLines)) {
+    lines.resize(static_cast<size_t>(maxLines));
+    truncated = true;
+  }
+  if (truncated && !lines.empty() && node.overflow == dsl::OverflowMode::kEllipsis) {
+    lines.back() = ellipsizeToWidth(gfx, lines.back(), font, node.w);
+  }
 
-        const String piece = longWord.substring(start, bestEnd);
-        start = bestEnd;
-        if (start < longWord.length()) {
-          lines.push_back(piece);
-        } else {
-          currentLine = piece;
-        }
-      }
-    };
+  const int16_t blockHeight = static_cast<int16_t>(lines.size()) * lineHeight;
+  int16_t startY = y;
+  if (isMiddleDatum(node.datum)) {
+    startY = y - (blockHeight / 2);
+  } else if (isBottomDatum(node.datum)) {
+    startY = y - blockHeight;
+  }
 
-    if (currentLine.isEmpty()) {
-      if (textWidthPx(gfx, word, font) <= maxWidth) {
-        currentLine = word;
-      } else {
-        placeLongWord(word);
-      }
-      return;
+  gfx.setTextDatum(topLineDatum(node.datum));
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (lines[i].length() == 0) {
+      continue;
+    }
+    const int16_t lineY = startY + static_cast<int16_t>(i) * lineHeight;
+    safeDrawString(gfx, lines[i], x, lineY, font);
+  }
+}
+
+// Forwards node drawing to Gfx (or only measures it when draw is false) and records the
+// bounding box of everything drawn, in Gfx coordinates.
+template <typename Gfx>
+class PaintTracker {
+ public:
+  PaintTracker(Gfx& gfx, bool draw) : gfx_(gfx), draw_(draw) {}
+
+  void reset() { empty_ = true; }
+  bool drawing() const { return draw_; }
+  // Raw bounds [x0, x1) x [y0, y1) in Gfx coordinates; false if nothing was drawn.
+  bool bounds(int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const {
+    x0 = x0_;
+    y0 = y0_;
+    x1 = x1_;
+    y1 = y1_;
+    return !empty_;
+  }
+  // Bounds relative to (originX, originY), clamped to w x h; false if nothing was drawn there.
+  template <typename Rect>
+  bool boundsIn(int32_t originX, int32_t originY, int16_t w, int16_t h, Rect& out) const {
+    if (empty_) {
+      return false;
+    }
+    const int32_t x0 = std::max<int32_t>(x0_ - originX, 0);
+    const int32_t y0 = std::max<int32_t>(y0_ - originY, 0);
+    const int32_t x1 = std::min<int32_t>(x1_ - originX, w);
+    const int32_t y1 = std::min<int32_t>(y1_ - originY, h);
+    if (x1 <= x0 || y1 <= y0) {
+      return false;
+    }
+    out.x = static_cast<int16_t>(x0);
+    out.y = static_cast<int16_t>(y0);
+    out.w = static_cast<int16_t>(x1 - x0);
+    out.h = static_cast<int16_t>(y1 - y0);
+    return true;
+  }
+
+  int16_t fontHeight(uint8_t font) { return gfx_.fontHeight(font); }
+  int16_t textWidth(const char* text, uint8_t font) { return gfx_.textWidth(text, font); }
+  bool getSwapBytes() { return gfx_.getSwapBytes(); }
+  void setSwapBytes(bool swap) {
+    if (draw_) gfx_.setSwapBytes(swap);
+  }
+  void setTextColor(uint16_t fg, uint16_t bg) {
+    if (draw_) gfx_.setTextColor(fg, bg);
+  }
+  void setTextDatum(uint8_t datum) {
+    datum_ = datum;
+    if (draw_) gfx_.setTextDatum(datum);
+  }
+
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    note(x, y, w, h);
+    if (draw_) gfx_.fillRect(x, y, w, h, color);
+  }
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    note(x, y, w, h);
+    if (draw_) gfx_.drawRect(x, y, w, h, color);
+  }
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+    note(x, y, w, 1);
+    if (draw_) gfx_.drawFastHLine(x, y, w, color);
+  }
+  void drawPixel(int32_t x, int32_t y, uint32_t color) {
+    note(x, y, 1, 1);
+    if (draw_) gfx_.drawPixel(x, y, color);
+  }
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+    note(std::min(x0, x1), std::min(y0, y1), abs(x1 - x0) + 1, abs(y1 - y0) + 1);
+    if (draw_) gfx_.drawLine(x0, y0, x1, y1, color);
+  }
+  void drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {
+    note(x - r, y - r, 2 * r + 1, 2 * r + 1);
+    if (draw_) gfx_.drawCircle(x, y, r, color);
+  }
+  void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {
+    note(x - r, y - r, 2 * r + 1, 2 * r + 1);
+    if (draw_) gfx_.fillCircle(x, y, r, color);
+  }
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+    note(x, y, w, h);
+    if (draw_) gfx_.pushImage(x, y, w, h, data);
+  }
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data,
+                 uint16_t transp) {
+    note(x, y, w, h);
+    if (draw_) gfx_.pushImage(x, y, w, h, data, transp);
+  }
+  int16_t drawString(const char* text, int32_t x, int32_t y, uint8_t font) {
+    const int32_t w = gfx_.textWidth(text, font);
+    const int32_t h = gfx_.fontHeight(font);
+    int32_t left = x;
+    if (isCenterDatum(datum_)) {
+      left -= w / 2;
+    } else if (isRightDatum(datum_)) {
+      left -= w;
+    }
+    // Baseline datums put descenders below y; allow for them without knowing the font's
+    // baseline offset.
+    const bool baseline = datum_ >= L_BASELINE;
+    int32_t top = y;
+    if (isMiddleDatum(datum_)) {
+      top -= h / 2;
+    } else if (isBottomDatum(datum_) || baseline) {
+      top -= h;
     }
+    // One pixel of slack for glyph overhang and rounding.
+    note(left - 1, top - 1, w + 2, (baseline ? h * 2 : h) + 2);
+    if (draw_) {
+      return gfx_.drawString(text, x, y, font);
+    }
+    return static_cast<int16_t>(w);
+  }
 
-    const String candidate = currentLine + " " + word;
-    if (textWidthPx(gfx, candidate, font) <= maxWidth) {
-      currentLine = candidate;
+ private:
+  void note(int32_t x, int32_t y, int32_t w, int32_t h) {
+    if (w <= 0 || h <= 0) {
+      return;
+    }
+    if (empty_) {
+      x0_ = x;
+      y0_ = y;
+      x1_ = x + w;
+      y1_ = y + h;
+      empty_ = false;
       return;
     }
+    x0_ = std::min(x0_, x);
+    y0_ = std::min(y0_, y);
+    x1_ = std::max(x1_, x + w);
+    y1_ = std::max(y1_, y + h);
+  }
 
-    lines.push_back(currentLine);
-    currentLine = "";
-    if (textWidthPx(gfx, word, font) <= maxWidth) {
-      currentLine = word;
-    } else {
-      placeLongWord(word);
+  Gfx& gfx_;
+  const bool draw_;
+  uint8_t datum_ = TL_DATUM;
+  bool empty_ = true;
+  int32_t x0_ = 0;
+  int32_t y0_ = 0;
+  int32_t x1_ = 0;
+  int32_t y1_ = 0;
+};
+
+template <typename Rect>
+bool rectEmpty(const Rect& r) {
+  return r.w <= 0 || r.h <= 0;
+}
+
+template <typename Rect>
+bool rectsIntersect(const Rect& a, const Rect& b) {
+  return !rectEmpty(a) && !rectEmpty(b) && a.x < b.x + b.w && b.x < a.x + a.w &&
+         a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+template <typename Rect>
+bool rectContains(const Rect& outer, const Rect& inner) {
+  return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.w <= outer.x + outer.w &&
+         inner.y + inner.h <= outer.y + outer.h;
+}
+
+template <typename Rect>
+Rect rectUnion(const Rect& a, const Rect& b) {
+  if (rectEmpty(a)) return b;
+  if (rectEmpty(b)) return a;
+  Rect out;
+  out.x = std::min(a.x, b.x);
+  out.y = std::min(a.y, b.y);
+  out.w = static_cast<int16_t>(std::max(a.x + a.w, b.x + b.w) - out.x);
+  out.h = static_cast<int16_t>(std::max(a.y + a.h, b.y + b.h) - out.y);
+  return out;
+}
+
+// Adds r to the repaint list, folding it into every rectangle it overlaps. Past `maxRects`
+// everything collapses into one bounding box.
+template <typename Rect, size_t N>
+void addRepaintRect(Rect (&rects)[N], size_t& count, Rect r) {
+  if (rectEmpty(r)) {
+    return;
+  }
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (size_t i = 0; i < count; ++i) {
+      if (rectsIntersect(rects[i], r)) {
+        r = rectUnion(rects[i], r);
+        rects[i] = rects[--count];
+        merged = true;
+        break;
+      }
     }
-  };
+  }
+  if (count < N) {
+    rects[count++] = r;
+    return;
+  }
+  for (size_t i = 1; i < count; ++i) {
+    rects[0] = rectUnion(rects[0], rects[i]);
+  }
+  rects[0] = rectUnion(rects[0], r);
+  count = 1;
+}
 
-  auto flushWord = [&]() {
-    placeWord(currentWord);
-    currentWord = "";
-  };
+template <typename Gfx>
+bool measuringOnly(const Gfx&) {
+  return false;
+}
 
-  for (int i = 0; i < text.length(); ++i) {
-    const char c = text[i];
-    if (c == '\n') {
-      flushWord();
-      lines.push_back(currentLine);
-      currentLine = "";
-      continue;
+template <typename Gfx>
+bool measuringOnly(const PaintTracker<Gfx>& tracker) {
+  return !tracker.drawing();
+}
+
+// Everything a label's pixels depend on besides its text and position.
+struct LabelStyle {
+  uint8_t font = 0;
+  uint16_t fg = 0;
+  uint16_t bg = 0;
+  uint8_t datum = 0;
+  bool wrap = false;
+  int16_t wrapW = 0;
+  int16_t wrapH = 0;
+  int16_t lineHeight = 0;
+  int16_t maxLines = 0;
+  uint8_t overflow = 0;
+
+  bool operator==(const LabelStyle& o) const {
+    return font == o.font && fg == o.fg && bg == o.bg && datum == o.datum && wrap == o.wrap &&
+           wrapW == o.wrapW && wrapH == o.wrapH && lineHeight == o.lineHeight &&
+           maxLines == o.maxLines && overflow == o.overflow;
+  }
+};
+
+uint32_t labelHash(const LabelStyle& style, const String& text) {
+  const int16_t fields[] = {style.font,     static_cast<int16_t>(style.fg),
+                            static_cast<int16_t>(style.bg), style.datum,
+                            style.wrap,     style.wrapW,
+                            style.wrapH,    style.lineHeight,
+                            style.maxLines, style.overflow};
+  return fnv1aMix(fnv1aMix(2166136261u, fields, sizeof(fields)), text.c_str(), text.length());
+}
+
+// A label rendered once into a bitmap; pixels equal to `transparent` were not drawn.
+struct LabelCacheEntry {
+  uint32_t hash = 0;
+  LabelStyle style;
+  String text;
+  // Bitmap origin relative to the label's anchor point.
+  int16_t offsetX = 0;
+  int16_t offsetY = 0;
+  int16_t w = 0;
+  int16_t h = 0;
+  uint16_t transparent = 0;
+  // Byte-swapped like icon pixels, so both go out through setSwapBytes(true).
+  std::vector<uint16_t> pixels;
+  uint32_t lastUse = 0;
+};
+
+struct LabelSighting {
+  uint32_t hash = 0;
+  uint32_t tick = 0;
+  // Bitmap size once measured, so a label that did not fit is not measured again.
+  size_t bytes = 0;
+};
+
+constexpr size_t kLabelCacheBytes = 24 * 1024;
+constexpr size_t kMaxLabelBitmapBytes = 6 * 1024;
+// A label is only cached once it is drawn again while still among the last kLabelSeenSlots
+// misses, so text that changes every frame (clock digits, counters) never pays for a bitmap.
+constexpr size_t kLabelSeenSlots = 32;
+std::vector<LabelCacheEntry> sLabelCache;
+size_t sLabelCacheBytes = 0;
+// Advances on every label draw; entry and sighting ages are measured in it.
+uint32_t sLabelCacheTick = 0;
+LabelSighting sLabelSeen[kLabelSeenSlots];
+size_t sLabelSeenNext = 0;
+DslLabelCacheStats sLabelCacheStats;
+
+uint16_t swap565(uint16_t c) { return static_cast<uint16_t>((c >> 8) | (c << 8)); }
+
+template <typename Gfx>
+void pushLabelBitmap(Gfx& gfx, const LabelCacheEntry& entry, int32_t x, int32_t y) {
+  const bool swap = gfx.getSwapBytes();
+  gfx.setSwapBytes(true);
+  gfx.pushImage(x + entry.offsetX, y + entry.offsetY, entry.w, entry.h, entry.pixels.data(),
+                entry.transparent);
+  gfx.setSwapBytes(swap);
+}
+
+// The earlier sighting of a missed label, or nullptr (recording this one) if it is new.
+LabelSighting* labelSeenBefore(uint32_t hash) {
+  for (LabelSighting& seen : sLabelSeen) {
+    if (seen.hash == hash && seen.tick != 0) {
+      return &seen;
     }
-    if (c == ' ' || c == '\t' || c == '\r') {
-      flushWord();
-      continue;
+  }
+  sLabelSeen[sLabelSeenNext] = LabelSighting{hash, sLabelCacheTick, 0};
+  sLabelSeenNext = (sLabelSeenNext + 1) % kLabelSeenSlots;
+  return nullptr;
+}
+
+// Bytes reserveLabelBytes could free up for a label last seen at `seenTick`.
+size_t labelBytesAvailable(uint32_t seenTick) {
+  size_t bytes = kLabelCacheBytes - sLabelCacheBytes;
+  for (const LabelCacheEntry& entry : sLabelCache) {
+    if (entry.lastUse <= seenTick) {
+      bytes += entry.pixels.size() * sizeof(uint16_t);
     }
-    currentWord += c;
   }
+  return bytes;
+}
 
-  flushWord();
-  if (!currentLine.isEmpty() || lines.empty()) {
-    lines.push_back(currentLine);
+// Makes room for `bytes`, evicting least recently used entries, but only ones last used
+// before `seenTick`: an entry reused more recently than the newcomer stays, so a working set
+// larger than the budget keeps part of itself cached instead of cycling through all of it.
+bool reserveLabelBytes(size_t bytes, uint32_t seenTick) {
+  while (sLabelCacheBytes + bytes > kLabelCacheBytes) {
+    if (sLabelCache.empty()) {
+      return false;
+    }
+    auto oldest = std::min_element(
+        sLabelCache.begin(), sLabelCache.end(),
+        [](const LabelCacheEntry& a, const LabelCacheEntry& b) { return a.lastUse < b.lastUse; });
+    if (oldest->lastUse > seenTick) {
+      return false;
+    }
+    sLabelCacheBytes -= oldest->pixels.size() * sizeof(uint16_t);
+    sLabelCache.erase(oldest);
   }
-  return lines;
+  return true;
+}
+
+// Draws the label anchored at (x, y) from the bitmap cache, rendering it into a scratch sprite
+// on a repeat miss. Returns false when the caller should draw it directly instead.
+// `draw(gfx, x, y)` must draw the label the uncached way.
+template <typename Gfx, typename Draw>
+bool drawCachedLabel(TFT_eSPI& parent, Gfx& gfx, const LabelStyle& style, const String& text,
+                     int16_t x, int16_t y, Draw&& draw) {
+  const bool measuring = measuringOnly(gfx);
+  if (!measuring) {
+    ++sLabelCacheTick;
+  }
+  const uint32_t hash = labelHash(style, text);
+  for (LabelCacheEntry& entry : sLabelCache) {
+    if (entry.hash == hash && entry.style == style && entry.text == text) {
+      if (!measuring) {
+        entry.lastUse = sLabelCacheTick;
+        ++sLabelCacheStats.hits;
+      }
+      pushLabelBitmap(gfx, entry, x, y);
+      return true;
+    }
+  }
+  if (measuring) {
+    return false;
+  }
+  ++sLabelCacheStats.misses;
+  LabelSighting* seen = labelSeenBefore(hash);
+  if (seen == nullptr) {
+    return false;
+  }
+  const uint32_t seenTick = seen->tick;
+  seen->tick = sLabelCacheTick;
+  // Skip measuring when the label cannot be admitted anyway.
+  const size_t available = labelBytesAvailable(seenTick);
+  if (available == 0 || seen->bytes > std::min(available, kMaxLabelBitmapBytes)) {
+    return false;
+  }
+
+  PaintTracker<Gfx> measure(gfx, false);
+  draw(measure, x, y);
+  int32_t x0 = 0;
+  int32_t y0 = 0;
+  int32_t x1 = 0;
+  int32_t y1 = 0;
+  if (!measure.bounds(x0, y0, x1, y1)) {
+    return false;
+  }
+  const int32_t w = x1 - x0;
+  const int32_t h = y1 - y0;
+  const size_t bytes = static_cast<size_t>(w) * static_cast<size_t>(h) * sizeof(uint16_t);
+  seen->bytes = bytes;
+  if (w <= 0 || h <= 0 || bytes > kMaxLabelBitmapBytes || bytes > available ||
+      !reserveLabelBytes(bytes, seenTick)) {
+    return false;
+  }
+
+  LabelCacheEntry entry;
+  entry.hash = hash;
+  entry.style = style;
+  entry.text = text;
+  entry.offsetX = static_cast<int16_t>(x0 - x);
+  entry.offsetY = static_cast<int16_t>(y0 - y);
+  entry.w = static_cast<int16_t>(w);
+  entry.h = static_cast<int16_t>(h);
+  entry.transparent = TFT_TRANSPARENT;
+  while (entry.transparent == style.fg || entry.transparent == style.bg) {
+    ++entry.transparent;
+  }
+  TFT_eSprite scratch(&parent);
+  scratch.setColorDepth(16);
+  if (scratch.createSprite(entry.w, entry.h) == nullptr) {
+    return false;
+  }
+  scratch.fillSprite(entry.transparent);
+  draw(scratch, static_cast<int16_t>(x - x0), static_cast<int16_t>(y - y0));
+  entry.pixels.resize(static_cast<size_t>(w) * static_cast<size_t>(h));
+  for (int32_t row = 0; row < h; ++row) {
+    for (int32_t col = 0; col < w; ++col) {
+      entry.pixels[static_cast<size_t>(row) * w + col] = swap565(scratch.readPixel(col, row));
+    }
+  }
+  scratch.deleteSprite();
+
+  entry.lastUse = sLabelCacheTick;
+  sLabelCacheBytes += bytes;
+  sLabelCache.push_back(std::move(entry));
+  pushLabelBitmap(gfx, sLabelCache.back(), x, y);
+  return true;
 }
 }  // namespace
 
 void clearDslRuntimeCaches() {
+  sIconIndex.clear();
   sIconCache.clear();
-  sIconCache.shrink_to_fit();
-  sRemoteIconRetryAfterMs.clear();
+  sIconCacheBytes = 0;
+  sLabelCache.clear();
+  sLabelCache.shrink_to_fit();
+  sLabelCacheBytes = 0;
+  for (LabelSighting& seen : sLabelSeen) {
+    seen = LabelSighting{};
+  }
+  sRemoteIconRetryResetPending.store(true);
 }
 
-void DslWidget::render(TFT_eSPI& tft) {
-  auto drawPanelTo = [&](auto& gfx) {
-    gfx.fillRect(0, 0, config_.w, config_.h, TFT_BLACK);
-    if (config_.drawBorder) {
-      gfx.drawRect(0, 0, config_.w, config_.h, TFT_DARKGREY);
+void setDslSaveUnderBudget(size_t bytes) { sSaveUnderBudget = bytes; }
+
+void setDslIconCacheBudget(size_t bytes) {
+  sIconCacheBudget = bytes;
+  makeIconRoom(0);
+}
+
+DslIconCacheStats dslIconCacheStats() {
+  DslIconCacheStats stats = sIconCacheStats;
+  stats.bytes = sIconCacheBytes;
+  stats.entries = sIconCache.size();
+  for (const IconCacheEntry& entry : sIconCache) {
+    if (entry.psram) {
+      stats.psramBytes += entry.bytes;
     }
-  };
+  }
+  return stats;
+}
 
-  auto renderNodes = [&](auto& gfx, int16_t baseX, int16_t baseY, int16_t clipW, int16_t clipH) {
-    for (const auto& node : dsl_.nodes) {
-      const int16_t x = baseX + node.x;
-      const int16_t y = baseY + node.y;
+DslLabelCacheStats dslLabelCacheStats() {
+  DslLabelCacheStats stats = sLabelCacheStats;
+  stats.bytes = sLabelCacheBytes;
+  stats.entries = sLabelCache.size();
+  return stats;
+}
 
-      if (node.type == dsl::NodeType::kLabel) {
-        if ((node.font < 1 || node.font > 8) && dsl_.debug) {
-          platform::logf("[%s] [%s] invalid font id=%u; using 2\n", widgetName().c_str(),
-                        logTimestamp().c_str(), static_cast<unsigned>(node.font));
-        }
-        const uint8_t font = safeFontId(node.font);
-        gfx.setTextColor(node.color565, TFT_BLACK);
-        String labelText = bindTemplate(node.text);
-        if (!node.path.isEmpty()) {
-          String valueText;
-          auto it = pathValues_.find(node.path);
-          if (it != pathValues_.end()) {
-            valueText = it->second;
-          }
-          if (node.text.isEmpty()) {
-            labelText = valueText;
-          } else {
-            labelText.replace("{{value}}", valueText);
-          }
-        }
-        if (!node.wrap || node.w <= 0) {
-          gfx.setTextDatum(node.datum);
-          safeDrawString(gfx, labelText, x, y, font);
-          continue;
-        }
+uint32_t DslWidget::remoteIconGeneration() { return sRemoteIconGeneration.load(); }
 
-        int16_t lineHeight = node.lineHeight > 0 ? node.lineHeight : gfx.fontHeight(font);
-        if (lineHeight <= 0) {
-          lineHeight = 10;
-        }
+uint32_t DslWidget::nodeSignature(const dsl::Node& node, const NodePaint& paint,
+                                  uint32_t iconGeneration) const {
+  static const String kNoValue;
+  uint32_t hash = 2166136261u;
+  auto mixText = [&](const String& text) {
+    hash = fnv1aMix(hash, text.c_str(), text.length() + 1);
+  };
+  float number = 0.0f;
+  auto mixNumber = [&](bool ok) {
+    const float v = ok ? number : NAN;
+    hash = fnv1aMix(hash, &v, sizeof(v));
+  };
+  auto valueOrEmpty = [&](const std::map<String, String>& map, const String& key) -> const String& {
+    auto it = map.find(key);
+    return it != map.end() ? it->second : kNoValue;
+  };
+  // Plans whose bindings are plain value keys hash the bound values directly; anything that
+  // resolves from runtime state or expressions is bound in full.
+  auto mixPlan = [&](const dsl::TemplatePlan& plan, const String& source) {
+    if (plan.compiled && !plan.hasBindings) {
+      return;
+    }
+    bool direct = plan.compiled;
+    for (size_t i = 0; direct && i < plan.tokens.size(); ++i) {
+      const dsl::TemplateToken& token = plan.tokens[i];
+      direct = token.kind != dsl::TemplateTokenKind::kExpression &&
+               (token.kind != dsl::TemplateTokenKind::kKey ||
+                token.runtime == dsl::RuntimeKey::kNone ||
+                values_.count(bindingSlots_.key(token.rawSlot)) != 0);
+    }
+    if (!direct) {
+      bindPlan(plan, source, true, bindScratch_);
+      mixText(bindScratch_);
+      return;
+    }
+    for (const dsl::TemplateToken& token : plan.tokens) {
+      if (token.kind != dsl::TemplateTokenKind::kKey) {
+        continue;
+      }
+      auto it = values_.find(bindingSlots_.key(token.rawSlot));
+      if (it != values_.end()) {
+        mixText(it->second);
+        continue;
+      }
+      const String& key = bindingSlots_.key(token.slot);
+      auto vit = values_.find(key);
+      mixText(vit != values_.end() ? vit->second : valueOrEmpty(pathValues_, key));
+    }
+  };
 
-        int16_t maxLines = node.maxLines > 0 ? node.maxLines : 0;
-        if (node.h > 0) {
-          const int16_t fromHeight = node.h / lineHeight;
-          if (fromHeight > 0) {
-            maxLines = (maxLines > 0) ? std::min(maxLines, fromHeight) : fromHeight;
-          }
-        }
+  switch (node.type) {
+    case dsl::NodeType::kLabel:
+      mixPlan(node.textPlan, node.text);
+      if (!node.path.isEmpty()) {
+        mixText(valueOrEmpty(pathValues_, node.path));
+      }
+      break;
+    case dsl::NodeType::kValueBox:
+      mixPlan(node.textPlan, node.text);
+      if (!node.key.isEmpty()) {
+        mixText(valueOrEmpty(values_, node.key));
+      }
+      break;
+    case dsl::NodeType::kProgress:
+      mixNumber(!node.key.isEmpty() && getNumeric(node.key, number));
+      break;
+    case dsl::NodeType::kSparkline: {
+      auto it = seriesValues_.find(node.key);
+      const uint32_t revision = it != seriesValues_.end() ? it->second.revision() : 0U;
+      hash = fnv1aMix(hash, &revision, sizeof(revision));
+      break;
+    }
+    case dsl::NodeType::kLine:
+      if (!node.angleExpr.isEmpty()) {
+        mixNumber(evaluateAngleExpr(node, number));
+      } else if (!node.key.isEmpty()) {
+        mixNumber(getNumeric(node.key, number));
+      }
+      break;
+    case dsl::NodeType::kIcon:
+      if (node.path.isEmpty()) {
+        mixPlan(node.textPlan, node.text);
+      } else {
+        mixPlan(node.pathPlan, node.path);
+      }
+      // A remote icon that was still downloading may have landed since.
+      if (paint.iconPending) {
+        hash = fnv1aMix(hash, &iconGeneration, sizeof(iconGeneration));
+      }
+      break;
+    case dsl::NodeType::kMoonPhase: {
+      bool havePhase = !node.key.isEmpty() && getNumeric(node.key, number);
+      if (!havePhase) {
+        havePhase = computeMoonPhaseFraction(number);
+      }
+      mixNumber(havePhase);
+      break;
+    }
+    default:
+      break;
+  }
+  return hash;
+}
 
-        std::vector<String> lines = wrapLabelLines(gfx, labelText, font, node.w);
-        bool truncated = false;
-        if (maxLines > 0 && lines.size() > static_cast<size_t>(maxLines)) {
-          lines.resize(static_cast<size_t>(maxLines));
-          truncated = true;
-        }
-        if (truncated && !lines.empty() && node.overflow == dsl::OverflowMode::kEllipsis) {
-          lines.back() = ellipsizeToWidth(gfx, lines.back(), font, node.w);
-        }
+void DslWidget::render(TFT_eSPI& tft) {
+  // Snapshot before any icon is requested so a download that lands mid-render still counts.
+  const uint32_t iconGeneration = remoteIconGeneration();
+  auto drawPanelTo = [&](auto& gfx, int16_t baseX, int16_t baseY) {
+    gfx.fillRect(baseX, baseY, config_.w, config_.h, TFT_BLACK);
+    if (config_.drawBorder) {
+      gfx.drawRect(baseX, baseY, config_.w, config_.h, TFT_DARKGREY);
+    }
+  };
 
-        const int16_t blockHeight = static_cast<int16_t>(lines.size()) * lineHeight;
-        int16_t startY = y;
-        if (isMiddleDatum(node.datum)) {
-          startY = y - (blockHeight / 2);
-        } else if (isBottomDatum(node.datum)) {
-          startY = y - blockHeight;
-        }
+  auto drawNode = [&](auto& gfx, const dsl::Node& node, int16_t baseX, int16_t baseY,
+                      int16_t clipW, int16_t clipH, bool& iconPending) {
+    const int16_t x = baseX + node.x;
+    const int16_t y = baseY + node.y;
 
-        gfx.setTextDatum(topLineDatum(node.datum));
-        for (size_t i = 0; i < lines.size(); ++i) {
-          if (lines[i].length() == 0) {
-            continue;
-          }
-          const int16_t lineY = startY + static_cast<int16_t>(i) * lineHeight;
-          safeDrawString(gfx, lines[i], x, lineY, font);
+    if (node.type == dsl::NodeType::kLabel) {
+      if ((node.font < 1 || node.font > 8) && dsl_.debug) {
+        platform::logf("[%s] [%s] invalid font id=%u; using 2\n", widgetName().c_str(),
+                      logTimestamp().c_str(), static_cast<unsigned>(node.font));
+      }
+      const uint8_t font = safeFontId(node.font);
+      String& labelText = bindScratch_;
+      bindPlan(node.textPlan, node.text, true, labelText);
+      if (!node.path.isEmpty()) {
+        static const String kNoValue;
+        auto it = pathValues_.find(node.path);
+        const String& valueText = (it != pathValues_.end()) ? it->second : kNoValue;
+        if (node.text.isEmpty()) {
+          labelText = valueText;
+        } else {
+          labelText.replace("{{value}}", valueText);
         }
-        continue;
       }
-
-      if (node.type == dsl::NodeType::kValueBox) {
-        if ((node.font < 1 || node.font > 8) && dsl_.debug) {
-          platform::logf("[%s] [%s] invalid font id=%u; using 2\n", widgetName().c_str(),
-                        logTimestamp().c_str(), static_cast<unsigned>(node.font));
+      const bool wrap = node.wrap && node.w > 0;
+      DslWrapMemo* wrapMemo = nullptr;
+      const size_t nodeIndex = static_cast<size_t>(&node - dsl_.nodes.data());
+      if (wrap && nodeIndex < nodePaint_.size()) {
+        wrapMemo = &nodePaint_[nodeIndex].wrap;
+      }
+      auto drawLabel = [&](auto& g, int16_t ax, int16_t ay) {
+        g.setTextColor(node.color565, TFT_BLACK);
+        if (!wrap) {
+          g.setTextDatum(node.datum);
+          safeDrawString(g, labelText, ax, ay, font);
+          return;
         }
-        const uint8_t font = safeFontId(node.font);
-        gfx.fillRect(x, y, node.w, node.h, node.bg565);
-        gfx.drawRect(x, y, node.w, node.h, node.color565);
-        gfx.setTextColor(node.color565, node.bg565);
-        gfx.setTextDatum(TL_DATUM);
-        if (!node.text.isEmpty()) {
-          safeDrawString(gfx, bindTemplate(node.text), x + 4, y + 4, 1);
+        drawWrappedLabel(g, node, labelText, font, ax, ay, wrapMemo);
+      };
+      // Baseline datums hang glyphs below the measured box; draw those directly.
+      if (node.datum < L_BASELINE) {
+        LabelStyle style;
+        style.font = font;
+        style.fg = node.color565;
+        style.bg = TFT_BLACK;
+        style.datum = node.datum;
+        if (wrap) {
+          style.wrap = true;
+          style.wrapW = node.w;
+          style.wrapH = node.h;
+          style.lineHeight = node.lineHeight;
+          style.maxLines = node.maxLines;
+          style.overflow = static_cast<uint8_t>(node.overflow);
+        }
+        if (drawCachedLabel(tft, gfx, style, labelText, x, y, drawLabel)) {
+          return;
         }
-        const String value = node.key.isEmpty() ? String() : values_[node.key];
-        safeDrawString(gfx, value, x + 4, y + 16, font);
-        continue;
       }
+      drawLabel(gfx, x, y);
+      return;
+    }
 
-      if (node.type == dsl::NodeType::kProgress) {
-        gfx.fillRect(x, y, node.w, node.h, node.bg565);
-        gfx.drawRect(x, y, node.w, node.h, node.color565);
+    if (node.type == dsl::NodeType::kValueBox) {
+      if ((node.font < 1 || node.font > 8) && dsl_.debug) {
+        platform::logf("[%s] [%s] invalid font id=%u; using 2\n", widgetName().c_str(),
+                      logTimestamp().c_str(), static_cast<unsigned>(node.font));
+      }
+      const uint8_t font = safeFontId(node.font);
+      gfx.fillRect(x, y, node.w, node.h, node.bg565);
+      gfx.drawRect(x, y, node.w, node.h, node.color565);
+      gfx.setTextColor(node.color565, node.bg565);
+      gfx.setTextDatum(TL_DATUM);
+      if (!node.text.isEmpty()) {
+        bindPlan(node.textPlan, node.text, true, bindScratch_);
+        safeDrawString(gfx, bindScratch_, x + 4, y + 4, 1);
+      }
+      const String value = node.key.isEmpty() ? String() : values_[node.key];
+      safeDrawString(gfx, value, x + 4, y + 16, font);
+      return;
+    }
 
-        float value = 0.0f;
-        if (node.key.isEmpty() || !getNumeric(node.key, value) || node.max <= node.min) {
-          continue;
-        }
+    if (node.type == dsl::NodeType::kProgress) {
+      gfx.fillRect(x, y, node.w, node.h, node.bg565);
+      gfx.drawRect(x, y, node.w, node.h, node.color565);
 
-        float ratio = (value - node.min) / (node.max - node.min);
-        if (ratio < 0.0f) ratio = 0.0f;
-        if (ratio > 1.0f) ratio = 1.0f;
+      float value = 0.0f;
+      if (node.key.isEmpty() || !getNumeric(node.key, value) || node.max <= node.min) {
+        return;
+      }
 
-        const int16_t innerW = node.w - 4;
-        const int16_t fillW = static_cast<int16_t>(innerW * ratio);
-        gfx.fillRect(x + 2, y + 2, fillW, node.h - 4, node.color565);
+      float ratio = (value - node.min) / (node.max - node.min);
+      if (ratio < 0.0f) ratio = 0.0f;
+      if (ratio > 1.0f) ratio = 1.0f;
 
-        gfx.setTextColor(TFT_WHITE, node.bg565);
-        gfx.setTextDatum(MC_DATUM);
-        safeDrawString(gfx, String(value, 1), x + node.w / 2, y + node.h / 2, 1);
-        continue;
-      }
+      const int16_t innerW = node.w - 4;
+      const int16_t fillW = static_cast<int16_t>(innerW * ratio);
+      gfx.fillRect(x + 2, y + 2, fillW, node.h - 4, node.color565);
 
-      if (node.type == dsl::NodeType::kSparkline) {
-        gfx.fillRect(x, y, node.w, node.h, node.bg565);
-        gfx.drawRect(x, y, node.w, node.h, node.color565);
+      gfx.setTextColor(TFT_WHITE, node.bg565);
+      gfx.setTextDatum(MC_DATUM);
+      safeDrawString(gfx, String(value, 1), x + node.w / 2, y + node.h / 2, 1);
+      return;
+    }
 
-        auto it = seriesValues_.find(node.key);
-        if (it == seriesValues_.end() || it->second.size() < 2) {
-          continue;
-        }
+    if (node.type == dsl::NodeType::kSparkline) {
+      gfx.fillRect(x, y, node.w, node.h, node.bg565);
+      gfx.drawRect(x, y, node.w, node.h, node.color565);
 
-        const std::vector<float>& s = it->second;
-        float minV = node.min;
-        float maxV = node.max;
-        if (maxV <= minV) {
-          minV = s[0];
-          maxV = s[0];
-          for (float v : s) {
-            if (v < minV) minV = v;
-            if (v > maxV) maxV = v;
-          }
-          if (fabsf(maxV - minV) < 0.001f) {
-            maxV = minV + 1.0f;
-          }
-        }
+      auto it = seriesValues_.find(node.key);
+      if (it == seriesValues_.end() || it->second.size() < 2) {
+        return;
+      }
 
-        const int16_t plotW = node.w - 2;
-        const int16_t plotH = node.h - 2;
-        for (size_t i = 1; i < s.size(); ++i) {
-          const float x0f = static_cast<float>(i - 1) / static_cast<float>(s.size() - 1);
-          const float x1f = static_cast<float>(i) / static_cast<float>(s.size() - 1);
-          const float y0f = (s[i - 1] - minV) / (maxV - minV);
-          const float y1f = (s[i] - minV) / (maxV - minV);
-
-          const int16_t x0 = x + 1 + static_cast<int16_t>(x0f * plotW);
-          const int16_t x1 = x + 1 + static_cast<int16_t>(x1f * plotW);
-          const int16_t y0 = y + node.h - 2 - static_cast<int16_t>(y0f * plotH);
-          const int16_t y1 = y + node.h - 2 - static_cast<int16_t>(y1f * plotH);
-          gfx.drawLine(x0, y0, x1, y1, node.color565);
+      // The ring holds at most one sample per plot column, so this is bounded by the node width
+      // however long the series runs.
+      const DslSeriesRing& s = it->second;
+      float minV = node.min;
+      float maxV = node.max;
+      if (maxV <= minV) {
+        minV = s.min();
+        maxV = s.max();
+        if (fabsf(maxV - minV) < 0.001f) {
+          maxV = minV + 1.0f;
         }
-        continue;
       }
 
+      const int16_t plotW = node.w - 2;
+      const int16_t plotH = node.h - 2;
+      const float last = static_cast<float>(s.size() - 1);
+      int16_t x0 = x + 1;
+      int16_t y0 = y + node.h - 2 - static_cast<int16_t>((s.at(0) - minV) / (maxV - minV) * plotH);
+      for (size_t i = 1; i < s.size(); ++i) {
+        const float x1f = static_cast<float>(i) / last;
+        const float y1f = (s.at(i) - minV) / (maxV - minV);
+        const int16_t x1 = x + 1 + static_cast<int16_t>(x1f * plotW);
+        const int16_t y1 = y + node.h - 2 - static_cast<int16_t>(y1f * plotH);
+        gfx.drawLine(x0, y0, x1, y1, node.color565);
+        x0 = x1;
+        y0 = y1;
+      }
+      return;
+    }
+
     if (node.type == dsl::NodeType::kArc) {
       const int16_t r = node.radius > 0 ? node.radius : (node.w / 2);
       if (r <= 0) {
-        continue;
+        return;
       }
       const float startDeg = node.startDeg;
       const float endDeg = node.endDeg;
@@ -700,25 +1583,17 @@ void DslWidget::render(TFT_eSPI& tft) {
       if (span >= 359.0f && node.bg565 != TFT_BLACK) {
         gfx.fillCircle(x, y, r, node.bg565);
       }
-      const int thickness = node.thickness > 0 ? node.thickness : 1;
-      const float step = span > 120.0f ? 2.0f : 1.0f;
-      for (int t = 0; t < thickness; ++t) {
-        const int rr = r - t;
-        for (float a = startDeg; a <= endDeg; a += step) {
-          const float rad = (a - 90.0f) * (3.14159265f / 180.0f);
-          const int16_t px = x + static_cast<int16_t>(cosf(rad) * rr);
-          const int16_t py = y + static_cast<int16_t>(sinf(rad) * rr);
-          gfx.drawPixel(px, py, node.color565);
-        }
-      }
-      continue;
+      spanraster::fillShape(gfx, x, y,
+                            spanraster::RingSector(r, node.thickness, startDeg, endDeg),
+                            node.color565, node.antialias, node.bg565);
+      return;
     }
 
     if (node.type == dsl::NodeType::kLine) {
       float angleDeg = 0.0f;
       bool useAngle = false;
       if (!node.angleExpr.isEmpty()) {
-        useAngle = evaluateAngleExpr(node.angleExpr, angleDeg);
+        useAngle = evaluateAngleExpr(node, angleDeg);
       } else if (!node.key.isEmpty()) {
         useAngle = getNumeric(node.key, angleDeg);
       }
@@ -728,7 +1603,7 @@ void DslWidget::render(TFT_eSPI& tft) {
       if (useAngle) {
         const int16_t length = node.length > 0 ? node.length : node.radius;
         if (length <= 0) {
-          continue;
+          return;
         }
         const float radians = (angleDeg - 90.0f) * (3.14159265f / 180.0f);
         x2 = x + static_cast<int16_t>(cosf(radians) * length);
@@ -739,49 +1614,53 @@ void DslWidget::render(TFT_eSPI& tft) {
       }
 
       const int thickness = node.thickness > 0 ? node.thickness : 1;
-      const float dx = static_cast<float>(x2 - x);
-      const float dy = static_cast<float>(y2 - y);
-      const float len = sqrtf(dx * dx + dy * dy);
-      if (len < 0.0001f) {
-        continue;
+      if (thickness == 1 && !node.antialias) {
+        gfx.drawLine(x, y, x2, y2, node.color565);
+        return;
       }
-      const float nx = -dy / len;
-      const float ny = dx / len;
-      for (int i = -(thickness / 2); i <= (thickness / 2); ++i) {
-        const int16_t ox = static_cast<int16_t>(nx * i);
-        const int16_t oy = static_cast<int16_t>(ny * i);
-        gfx.drawLine(x + ox, y + oy, x2 + ox, y2 + oy, node.color565);
-      }
-      continue;
+      // Same weight as the old stack of offset lines: 2 * (thickness / 2) + 1 pixels.
+      const float width = static_cast<float>(2 * (thickness / 2) + 1);
+      spanraster::fillShape(gfx, x, y,
+                            spanraster::WideLine(static_cast<float>(x2 - x),
+                                                 static_cast<float>(y2 - y), width),
+                            node.color565, node.antialias, node.bg565);
+      return;
     }
 
-	    if (node.type == dsl::NodeType::kIcon) {
-	      const String rawPath = node.path.isEmpty() ? node.text : node.path;
-	      const String iconPath = bindTemplate(rawPath);
-	      if (iconPath.isEmpty()) {
-	        continue;
-	      }
-	      const IconCacheEntry* icon = loadIcon(iconPath, node.w, node.h);
-	      if (!icon) {
-	        continue;
-	      }
-	      if (icon->w <= 0 || icon->h <= 0) {
-	        continue;
-	      }
-	      const size_t needPixels = static_cast<size_t>(icon->w) * static_cast<size_t>(icon->h);
-	      if (icon->pixels.empty() || icon->pixels.size() < needPixels ||
-	          icon->pixels.data() == nullptr) {
-	        continue;
-	      }
-	      if (x < baseX || y < baseY || (x + icon->w) > (baseX + clipW) ||
-	          (y + icon->h) > (baseY + clipH)) {
-	        continue;
-	      }
-	      const bool swap = gfx.getSwapBytes();
-	      gfx.setSwapBytes(true);
-	      gfx.pushImage(x, y, icon->w, icon->h, icon->pixels.data());
-	      gfx.setSwapBytes(swap);
-	      continue;
+    if (node.type == dsl::NodeType::kIcon) {
+      if (node.path.isEmpty()) {
+        bindPlan(node.textPlan, node.text, true, bindScratch_);
+      } else {
+        bindPlan(node.pathPlan, node.path, true, bindScratch_);
+      }
+      const String& iconPath = bindScratch_;
+      if (iconPath.isEmpty()) {
+        return;
+      }
+      IconView icon;
+      const bool loaded = loadIcon(iconPath, node.w, node.h, &iconPending, icon);
+      if (iconPending) {
+        awaitingRemoteIcon_ = true;
+        iconGenerationSeen_ = iconGeneration;
+      }
+      if (!loaded) {
+        return;
+      }
+      if (icon.w <= 0 || icon.h <= 0) {
+        return;
+      }
+      if (!icon.data) {
+        return;
+      }
+      if (x < baseX || y < baseY || (x + icon.w) > (baseX + clipW) ||
+          (y + icon.h) > (baseY + clipH)) {
+        return;
+      }
+      const bool swap = gfx.getSwapBytes();
+      gfx.setSwapBytes(true);
+      blitIcon(gfx, x, y, icon);
+      gfx.setSwapBytes(swap);
+      return;
     }
 
     if (node.type == dsl::NodeType::kMoonPhase) {
@@ -794,12 +1673,12 @@ void DslWidget::render(TFT_eSPI& tft) {
         havePhase = computeMoonPhaseFraction(phase);
       }
       if (!havePhase) {
-        continue;
+        return;
       }
 
       const int16_t r = node.radius > 0 ? node.radius : (node.w > 0 ? node.w / 2 : 8);
       if (r <= 0) {
-        continue;
+        return;
       }
 
       const uint16_t bg = node.bg565 == TFT_BLACK ? TFT_BLACK : node.bg565;
@@ -813,24 +1692,14 @@ void DslWidget::render(TFT_eSPI& tft) {
         threshold = -r * (2.0f * phase - 1.0f);
       }
 
-      for (int16_t dy = -r; dy <= r; ++dy) {
-        for (int16_t dx = -r; dx <= r; ++dx) {
-          if (dx * dx + dy * dy > r * r) {
-            continue;
-          }
-          const bool lit = waxing ? (dx > threshold) : (dx < threshold);
-          if (lit) {
-            gfx.drawPixel(x + dx, y + dy, node.color565);
-          }
-        }
-      }
+      spanraster::fillShape(gfx, x, y, spanraster::LitDisc(r, threshold, waxing), node.color565,
+                            node.antialias, bg);
 
       if (node.thickness > 0) {
         gfx.drawCircle(x, y, r, node.color565);
       }
-      continue;
+      return;
     }
-  }
   };
 
   auto renderModal = [&](auto& gfx, int16_t baseX, int16_t baseY, int16_t clipW, int16_t clipH) {
@@ -867,14 +1736,16 @@ void DslWidget::render(TFT_eSPI& tft) {
     if (!modal->title.isEmpty()) {
       gfx.setTextColor(modal->titleColor565, modal->bgColor565);
       gfx.setTextDatum(TL_DATUM);
-      safeDrawString(gfx, bindTemplate(modal->title), x + 4, cursorY, titleFont);
+      bindPlan(modal->titlePlan, modal->title, true, bindScratch_);
+      safeDrawString(gfx, bindScratch_, x + 4, cursorY, titleFont);
       cursorY += gfx.fontHeight(titleFont) + 2;
       gfx.drawLine(x + 2, cursorY, x + mw - 3, cursorY, modal->borderColor565);
       cursorY += 3;
     }
 
     gfx.setTextColor(modal->textColor565, modal->bgColor565);
-    const String body = bindTemplate(modal->text);
+    bindPlan(modal->textPlan, modal->text, true, bindScratch_);
+    const String& body = bindScratch_;
     const int16_t textW = mw - 8;
     int16_t lineHeight = modal->lineHeight > 0 ? modal->lineHeight : gfx.fontHeight(bodyFont);
     if (lineHeight <= 0) {
@@ -889,7 +1760,7 @@ void DslWidget::render(TFT_eSPI& tft) {
       }
     }
 
-    std::vector<String> lines = wrapLabelLines(gfx, body, bodyFont, textW);
+    std::vector<String> lines = wrapLabelLines(gfx, body, bodyFont, textW, &modalWrap_);
     bool truncated = false;
     if (maxLines > 0 && lines.size() > static_cast<size_t>(maxLines)) {
       lines.resize(static_cast<size_t>(maxLines));
@@ -909,6 +1780,136 @@ void DslWidget::render(TFT_eSPI& tft) {
     }
   };
 
+  // Composes the widget area `rect` strip by strip and pushes it: with `capture` the panel and
+  // nodes are rasterized and packed into saveUnder_, otherwise saveUnder_ (holding exactly
+  // `rect`) is unpacked. `modal`, when set, is drawn on top. False when a buffer could not be
+  // had or saveUnder_ outgrew its budget; saveUnder_ is dropped then.
+  auto paintSaveUnder = [&](const PaintRect& rect, const dsl::ModalSpec* modal, bool capture) {
+    TFT_eSprite* strip = nullptr;
+    std::unique_ptr<TFT_eSprite> scratch;
+    int16_t bandRows = spriteRows_;
+    // Widget column held in sprite column 0.
+    int16_t stripX = 0;
+    if (useSprite_ && spriteReady_) {
+      strip = sprite_;
+    } else {
+      scratch.reset(new TFT_eSprite(&tft));
+      scratch->setColorDepth(16);
+      if (scratch->createSprite(rect.w, kSpriteBandRows) == nullptr) {
+        saveUnder_.clear();
+        saveUnder_.shrink_to_fit();
+        return false;
+      }
+      strip = scratch.get();
+      bandRows = kSpriteBandRows;
+      stripX = rect.x;
+    }
+    uint16_t* pixels = static_cast<uint16_t*>(strip->getPointer());
+    const int16_t stride = strip->width();
+    std::vector<uint8_t> unused;
+    iconcodec::Encoder encoder(capture ? saveUnder_ : unused, rect.w, rect.h,
+                               capture ? sSaveUnderBudget : 0);
+    iconcodec::Decoder decoder(capture ? nullptr : saveUnder_.data(),
+                               capture ? 0 : saveUnder_.size());
+    PaintTracker<TFT_eSprite> tracker(*strip, true);
+    bool ok = true;
+    for (int16_t top = rect.y; ok && top < rect.y + rect.h; top += bandRows) {
+      const PaintRect band{rect.x, top, rect.w,
+                           static_cast<int16_t>(std::min<int>(bandRows, rect.y + rect.h - top))};
+      const int16_t baseX = -stripX;
+      const int16_t originY = -top;
+      uint16_t* origin = pixels + (band.x - stripX);
+      strip->setViewport(band.x - stripX, 0, band.w, band.h, false);
+      if (capture) {
+        drawPanelTo(*strip, baseX, originY);
+        for (size_t i = 0; i < dsl_.nodes.size(); ++i) {
+          if (!rectsIntersect(nodePaint_[i].bounds, band)) {
+            continue;
+          }
+          tracker.reset();
+          bool pending = false;
+          drawNode(tracker, dsl_.nodes[i], baseX, originY, config_.w, config_.h, pending);
+        }
+        for (int16_t row = 0; row < band.h; ++row) {
+          encoder.write(origin + row * stride, band.w);
+        }
+        ok = !encoder.overflowed();
+      } else {
+        for (int16_t row = 0; ok && row < band.h; ++row) {
+          ok = decoder.read(origin + row * stride, band.w);
+        }
+      }
+      if (modal != nullptr) {
+        renderModal(*strip, baseX, originY, config_.w, config_.h);
+      }
+      strip->resetViewport();
+      if (ok) {
+        strip->pushSprite(config_.x + band.x, config_.y + band.y, band.x - stripX, 0, band.w,
+                          band.h);
+      }
+    }
+    if (capture) {
+      ok = encoder.finish();
+      saveUnderRect_ = rect;
+      if (dsl_.debug) {
+        platform::logf("[%s] [%s] modal save-under %dx%d %s (%u bytes)\n", widgetName().c_str(),
+                       logTimestamp().c_str(), rect.w, rect.h, ok ? "kept" : "over budget",
+                       static_cast<unsigned>(saveUnder_.size()));
+      }
+    }
+    if (!ok) {
+      saveUnder_.clear();
+      saveUnder_.shrink_to_fit();
+    }
+    return ok;
+  };
+
+  // Opens, updates and dismisses modals over a saved copy of the pixels beneath them, as long as
+  // no node under the modal changed since it opened. False means a full repaint is needed.
+  auto paintModalOverSaveUnder = [&](const dsl::ModalSpec* modal) {
+    bool underChanged = repaintAll_ || sSaveUnderBudget == 0;
+    for (size_t i = 0; i < dsl_.nodes.size() && !underChanged; ++i) {
+      const NodePaint& state = nodePaint_[i];
+      underChanged = !state.painted ||
+                     nodeSignature(dsl_.nodes[i], state, iconGeneration) != state.signature;
+    }
+    if (underChanged) {
+      saveUnder_.clear();
+      saveUnder_.shrink_to_fit();
+      return false;
+    }
+    if (modal == nullptr) {
+      const bool restored = !saveUnder_.empty() && paintSaveUnder(saveUnderRect_, nullptr, false);
+      saveUnder_.clear();
+      saveUnder_.shrink_to_fit();
+      return restored;
+    }
+    PaintTracker<TFT_eSPI> measure(tft, false);
+    renderModal(measure, 0, 0, config_.w, config_.h);
+    PaintRect bounds;
+    if (!measure.boundsIn(0, 0, config_.w, config_.h, bounds)) {
+      return false;
+    }
+    if (!saveUnder_.empty()) {
+      if (rectContains(saveUnderRect_, bounds)) {
+        return paintSaveUnder(saveUnderRect_, modal, false);
+      }
+      saveUnder_.clear();
+      saveUnder_.shrink_to_fit();
+      return false;
+    }
+    // A modal already painted without a save-under leaves no clean copy of what is beneath.
+    return paintedModal_ == nullptr && paintSaveUnder(bounds, modal, true);
+  };
+
+  auto drawStatusDot = [&]() {
+    const int16_t cx = config_.x + config_.w - 6;
+    const int16_t cy = config_.y + 6;
+    const uint16_t color =
+        status_ == "ok" ? TFT_GREEN : (status_ == "stale" ? TFT_YELLOW : TFT_RED);
+    tft.fillCircle(cx, cy, 2, color);
+  };
+
   if (!dslLoaded_) {
     drawPanel(tft, String("DSL"));
     const int16_t cx = config_.x + config_.w - 6;
@@ -917,30 +1918,173 @@ void DslWidget::render(TFT_eSPI& tft) {
     return;
   }
 
-  if (useSprite_) {
-    if (sprite_ == nullptr) {
-      sprite_ = new TFT_eSprite(&tft);
-      sprite_->setColorDepth(16);
-      spriteReady_ = (sprite_->createSprite(config_.w, config_.h) != nullptr);
+  if (useSprite_ && sprite_ == nullptr) {
+    sprite_ = new TFT_eSprite(&tft);
+    sprite_->setColorDepth(16);
+    const size_t fullBytes = static_cast<size_t>(config_.w) * config_.h * sizeof(uint16_t);
+    int16_t rows = config_.h;
+    if (spriteRowsSetting_ > 0) {
+      rows = std::min(spriteRowsSetting_, config_.h);
+    } else if (fullBytes > kMaxFullSpriteBytes) {
+      rows = std::min(kSpriteBandRows, config_.h);
+    }
+    spriteReady_ = (sprite_->createSprite(config_.w, rows) != nullptr);
+    if (!spriteReady_ && rows > kSpriteBandRows) {
+      rows = kSpriteBandRows;
+      spriteReady_ = (sprite_->createSprite(config_.w, rows) != nullptr);
+    }
+    spriteRows_ = spriteReady_ ? rows : 0;
+    if (dsl_.debug) {
+      platform::logf("[%s] [%s] sprite %dx%d %s\n", widgetName().c_str(),
+                     logTimestamp().c_str(), config_.w, rows,
+                     !spriteReady_ ? "failed; drawing direct"
+                                   : (rows < config_.h ? "strips" : "full"));
+    }
+    repaintAll_ = true;
+  }
+  if (nodePaint_.size() != dsl_.nodes.size()) {
+    nodePaint_.assign(dsl_.nodes.size(), NodePaint());
+    repaintAll_ = true;
+  }
+  const dsl::ModalSpec* modal = activeModal();
+  if ((modal != nullptr || paintedModal_ != nullptr) && paintModalOverSaveUnder(modal)) {
+    paintedModal_ = modal;
+    drawStatusDot();
+    return;
+  }
+  // Modals cover nodes without being tracked per node.
+  if (modal != nullptr || modal != paintedModal_) {
+    repaintAll_ = true;
+  }
+  paintedModal_ = modal;
+
+  // Repaints the nodes whose signature changed, plus whatever overlaps them. Each repaint
+  // rectangle is rasterized in strips of at most bandRows rows; with bandRows below the widget
+  // height gfx holds one strip, whose top row is widget row `shift`. present(strip, shift) is
+  // called once each strip is drawn.
+  auto paint = [&](auto& gfx, int16_t baseX, int16_t baseY, int16_t bandRows, auto&& present) {
+    using Gfx = typename std::remove_reference<decltype(gfx)>::type;
+    const int16_t w = config_.w;
+    const int16_t h = config_.h;
+    const bool banded = bandRows < h;
+    size_t dirtyNodes = 0;
+    for (size_t i = 0; i < dsl_.nodes.size(); ++i) {
+      NodePaint& state = nodePaint_[i];
+      const uint32_t signature = nodeSignature(dsl_.nodes[i], state, iconGeneration);
+      state.dirty = repaintAll_ || !state.painted || signature != state.signature;
+      state.signature = signature;
+      if (state.dirty) {
+        ++dirtyNodes;
+      }
+    }
+
+    constexpr size_t kMaxRepaintRects = 4;
+    PaintRect rects[kMaxRepaintRects];
+    size_t rectCount = 0;
+    // Strips skip nodes outside them, so they need every node's bounds even when repainting all.
+    const bool measured = !repaintAll_ || banded;
+    if (measured) {
+      // Measure where dirty nodes will land; their old and new boxes both need repainting.
+      PaintTracker<Gfx> measure(gfx, false);
+      for (size_t i = 0; i < dsl_.nodes.size(); ++i) {
+        NodePaint& state = nodePaint_[i];
+        if (!state.dirty) {
+          continue;
+        }
+        measure.reset();
+        bool pending = false;
+        drawNode(measure, dsl_.nodes[i], 0, 0, w, h, pending);
+        state.nextBounds = PaintRect();
+        measure.boundsIn(0, 0, w, h, state.nextBounds);
+        state.iconPending = pending;
+        addRepaintRect(rects, rectCount, rectUnion(state.bounds, state.nextBounds));
+      }
+      uint32_t area = 0;
+      for (size_t i = 0; i < rectCount; ++i) {
+        area += static_cast<uint32_t>(rects[i].w) * static_cast<uint32_t>(rects[i].h);
+      }
+      // Past this a single full push is cheaper than several clipped passes.
+      if (area * 10U >= static_cast<uint32_t>(w) * static_cast<uint32_t>(h) * 7U) {
+        repaintAll_ = true;
+      }
+    }
+    if (repaintAll_) {
+      rects[0] = PaintRect{0, 0, w, h};
+      rectCount = 1;
+    }
+
+    PaintTracker<Gfx> tracker(gfx, true);
+    size_t strips = 0;
+    for (size_t r = 0; r < rectCount; ++r) {
+      const PaintRect& rect = rects[r];
+      for (int16_t top = rect.y; top < rect.y + rect.h; top += bandRows) {
+        PaintRect strip{rect.x, top, rect.w,
+                        static_cast<int16_t>(std::min<int>(bandRows, rect.y + rect.h - top))};
+        const int16_t shift = banded ? top : 0;
+        const int16_t originY = baseY - shift;
+        const bool clip = banded || !repaintAll_;
+        if (clip) {
+          gfx.setViewport(baseX + strip.x, originY + strip.y, strip.w, strip.h, false);
+        }
+        drawPanelTo(gfx, baseX, originY);
+        for (size_t i = 0; i < dsl_.nodes.size(); ++i) {
+          NodePaint& state = nodePaint_[i];
+          if (measured && !rectsIntersect(state.dirty ? state.nextBounds : state.bounds, strip)) {
+            continue;
+          }
+          tracker.reset();
+          bool pending = false;
+          drawNode(tracker, dsl_.nodes[i], baseX, originY, w, h, pending);
+          if (state.dirty && !measured) {
+            state.bounds = PaintRect();
+            tracker.boundsIn(baseX, originY, w, h, state.bounds);
+            state.iconPending = pending;
+          }
+        }
+        if (repaintAll_) {
+          renderModal(gfx, baseX, originY, w, h);
+        }
+        if (clip) {
+          gfx.resetViewport();
+        }
+        present(strip, shift);
+        paintStats_.pixelsPushed +=
+            static_cast<uint32_t>(strip.w) * static_cast<uint32_t>(strip.h);
+        ++strips;
+      }
     }
-    if (spriteReady_) {
-      drawPanelTo(*sprite_);
-      renderNodes(*sprite_, 0, 0, config_.w, config_.h);
-      renderModal(*sprite_, 0, 0, config_.w, config_.h);
-      sprite_->pushSprite(config_.x, config_.y);
+    for (NodePaint& state : nodePaint_) {
+      if (state.dirty && measured) {
+        state.bounds = state.nextBounds;
+      }
+      state.painted = true;
+      state.dirty = false;
+    }
+
+    paintStats_.pixelsFullRepaint += static_cast<uint32_t>(w) * static_cast<uint32_t>(h);
+    if (repaintAll_) {
+      ++paintStats_.fullFrames;
     } else {
-      drawPanel(tft, dslLoaded_ ? dsl_.title : String("DSL"));
-      renderNodes(tft, config_.x, config_.y, config_.w, config_.h);
-      renderModal(tft, config_.x, config_.y, config_.w, config_.h);
+      ++paintStats_.partialFrames;
+    }
+    if (dsl_.debug && !repaintAll_ && rectCount > 0) {
+      platform::logf("[%s] [%s] paint partial nodes=%u rects=%u strips=%u px=%llu/%llu\n",
+                     widgetName().c_str(), logTimestamp().c_str(),
+                     static_cast<unsigned>(dirtyNodes), static_cast<unsigned>(rectCount),
+                     static_cast<unsigned>(strips),
+                     static_cast<unsigned long long>(paintStats_.pixelsPushed),
+                     static_cast<unsigned long long>(paintStats_.pixelsFullRepaint));
     }
+    repaintAll_ = false;
+  };
+
+  if (useSprite_ && spriteReady_) {
+    paint(*sprite_, 0, 0, spriteRows_, [&](const PaintRect& strip, int16_t shift) {
+      sprite_->pushSprite(config_.x + strip.x, config_.y + strip.y, strip.x, strip.y - shift,
+                          strip.w, strip.h);
+    });
   } else {
-    drawPanel(tft, dslLoaded_ ? dsl_.title : String("DSL"));
-    renderNodes(tft, config_.x, config_.y, config_.w, config_.h);
-    renderModal(tft, config_.x, config_.y, config_.w, config_.h);
+    paint(tft, config_.x, config_.y, config_.h, [](const PaintRect&, int16_t) {});
   }
-
-  const int16_t cx = config_.x + config_.w - 6;
-  const int16_t cy = config_.y + 6;
-  const uint16_t color = (status_ == "ok") ? TFT_GREEN : TFT_RED;
-  tft.fillCircle(cx, cy, 2, color);
+  drawStatusDot();
 }
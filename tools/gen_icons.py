@@ -2,6 +2,8 @@
 import math
 import os
 
+from icon_pack import pack_rgb565
+
 SIZE = 24
 
 
@@ -191,11 +193,10 @@ def icon_moon():
     return img
 
 
-def write_raw(path, img):
+def write_icon(path, img):
+    pixels = [val for row in img for val in row]
     with open(path, "wb") as f:
-        for row in img:
-            for val in row:
-                f.write(bytes([val & 0xFF, (val >> 8) & 0xFF]))
+        f.write(pack_rgb565(pixels, SIZE, SIZE))
 
 
 ICONS = {
@@ -218,7 +219,7 @@ def main():
     os.makedirs(out_dir, exist_ok=True)
     for name, fn in ICONS.items():
         img = fn()
-        write_raw(os.path.join(out_dir, name), img)
+        write_icon(os.path.join(out_dir, name), img)
 
 
 if __name__ == "__main__":
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Packed icon encoder (format described in src/widgets/DslIconCodec.h).
+
+Used by gen_icons.py and import_meteocons.py. Run directly to pack existing raw icons in
+place:
+
+    python3 tools/icon_pack.py data/icons/*.raw data/icons/meteocons/*.raw
+
+Raw icons must be square unless --size WxH is given. Files already packed are skipped.
+"""
+import argparse
+import math
+import struct
+import sys
+
+MAGIC = b"CIC1"
+MAX_RUN = 128
+
+
+def _runs(values):
+    """Yields ("run", value, n) and ("lit", values) tokens covering values."""
+    i = 0
+    n = len(values)
+    literal = []
+    while i < n:
+        run = 1
+        while i + run < n and run < MAX_RUN and values[i + run] == values[i]:
+            run += 1
+        if run >= 2:
+            if literal:
+                yield ("lit", literal)
+                literal = []
+            yield ("run", values[i], run)
+            i += run
+            continue
+        literal.append(values[i])
+        i += 1
+        if len(literal) == MAX_RUN:
+            yield ("lit", literal)
+            literal = []
+    if literal:
+        yield ("lit", literal)
+
+
+def pack_rgb565(pixels, width, height):
+    """Packs RGB565 pixel values (row order) and returns the bytes to store.
+
+    Falls back to raw little-endian RGB565 when packing does not save anything, so a file
+    shorter than width * height * 2 bytes is always packed.
+    """
+    if len(pixels) != width * height:
+        raise ValueError("expected %d pixels, got %d" % (width * height, len(pixels)))
+    raw = struct.pack("<%dH" % len(pixels), *pixels)
+
+    palette = []
+    index = {}
+    for value in pixels:
+        if value not in index:
+            index[value] = len(palette)
+            palette.append(value)
+    use_palette = len(palette) <= 256
+
+    out = bytearray(MAGIC)
+    out += struct.pack("<HHH", width, height, len(palette) if use_palette else 0)
+    if use_palette:
+        out += struct.pack("<%dH" % len(palette), *palette)
+
+    def value_bytes(value):
+        return bytes([index[value]]) if use_palette else struct.pack("<H", value)
+
+    for token in _runs(pixels):
+        if token[0] == "run":
+            out.append(0x80 | (token[2] - 1))
+            out += value_bytes(token[1])
+        else:
+            out.append(len(token[1]) - 1)
+            for value in token[1]:
+                out += value_bytes(value)
+
+    return bytes(out) if len(out) < len(raw) else raw
+
+
+def is_packed(data):
+    return data[:4] == MAGIC
+
+
+def _parse_size(text):
+    parts = text.lower().replace(",", "x").split("x")
+    if len(parts) != 2:
+        raise argparse.ArgumentTypeError("size must be WxH")
+    return int(parts[0]), int(parts[1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("files", nargs="+")
+    parser.add_argument("--size", type=_parse_size, help="icon size WxH (default: square)")
+    args = parser.parse_args()
+
+    total_before = 0
+    total_after = 0
+    for path in args.files:
+        with open(path, "rb") as f:
+            data = f.read()
+        if is_packed(data):
+            continue
+        if args.size:
+            width, height = args.size
+        else:
+            width = height = math.isqrt(len(data) // 2)
+        if width * height * 2 != len(data):
+            print("%s: %d bytes is not a %dx%d raw icon" % (path, len(data), width, height),
+                  file=sys.stderr)
+            return 1
+        pixels = struct.unpack("<%dH" % (width * height), data)
+        packed = pack_rgb565(pixels, width, height)
+        with open(path, "wb") as f:
+            f.write(packed)
+        total_before += len(data)
+        total_after += len(packed)
+        print("%s: %d -> %d bytes" % (path, len(data), len(packed)))
+    if total_before:
+        print("total: %d -> %d bytes" % (total_before, total_after))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
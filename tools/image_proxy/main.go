@@ -34,6 +34,9 @@ const (
 	defaultUserAgent   = "CoStar-ImageProxy/1.0"
 	maxOutputDimension = 320
 	defaultMdiBaseURL  = "https://cdn.jsdelivr.net/npm/@mdi/svg/svg"
+
+	packedIconMediaType = "application/x-costar-icon"
+	packedIconMaxRun    = 128
 )
 
 type serverConfig struct {
@@ -262,7 +265,8 @@ func rootHandler(w http.ResponseWriter, _ *http.Request) {
 		"GET /cmh?url=<image_url>&size=<n|WxH>\n" +
 			"GET /mdi?icon=<mdi_name>&size=<n|WxH>&color=<RRGGBB>\n" +
 			"GET /rssj?url=<rss_or_atom_url>&limit=<n>\n" +
-			"Returns raw rgb565 little-endian bytes.\n" +
+			"Returns raw rgb565 little-endian bytes, or the packed icon format with\n" +
+			"Accept: application/x-costar-icon when that is smaller.\n" +
 			"Response includes X-Cache: HIT or MISS.\n" +
 			"/cmh supports optional ua= and referer= query params.\n",
 	))
@@ -293,7 +297,7 @@ func (cfg serverConfig) convertHandler(w http.ResponseWriter, r *http.Request) {
 
 	if width > maxOutputDimension || height > maxOutputDimension {
 		resp := buildOversizeFallback(width, height)
-		writeRawResponse(w, resp, false)
+		writeRawResponse(w, r, resp, false)
 		return
 	}
 
@@ -301,7 +305,7 @@ func (cfg serverConfig) convertHandler(w http.ResponseWriter, r *http.Request) {
 	refererOverride := sanitizeHeaderValue(r.URL.Query().Get("referer"))
 	cacheKey := buildCMHCacheKey(srcURL, width, height, uaOverride, refererOverride)
 	if cached, ok := cfg.cache.get(cacheKey); ok {
-		writeRawResponse(w, cached, true)
+		writeRawResponse(w, r, cached, true)
 		return
 	}
 
@@ -323,7 +327,7 @@ func (cfg serverConfig) convertHandler(w http.ResponseWriter, r *http.Request) {
 	}
 	if srcImg.Bounds().Dx() > maxOutputDimension || srcImg.Bounds().Dy() > maxOutputDimension {
 		resp := buildOversizeFallback(width, height)
-		writeRawResponse(w, resp, false)
+		writeRawResponse(w, r, resp, false)
 		return
 	}
 
@@ -339,7 +343,7 @@ func (cfg serverConfig) convertHandler(w http.ResponseWriter, r *http.Request) {
 		storedAt:     time.Now(),
 	}
 	cfg.cache.set(cacheKey, resp)
-	writeRawResponse(w, resp, false)
+	writeRawResponse(w, r, resp, false)
 }
 
 func (cfg serverConfig) mdiHandler(w http.ResponseWriter, r *http.Request) {
@@ -371,7 +375,7 @@ func (cfg serverConfig) mdiHandler(w http.ResponseWriter, r *http.Request) {
 	if width > maxOutputDimension || height > maxOutputDimension {
 		resp := buildOversizeFallback(width, height)
 		resp.iconName = "mdi:oversize-fallback"
-		writeRawResponse(w, resp, false)
+		writeRawResponse(w, r, resp, false)
 		return
 	}
 
@@ -384,7 +388,7 @@ func (cfg serverConfig) mdiHandler(w http.ResponseWriter, r *http.Request) {
 	srcURL := fmt.Sprintf("%s/%s.svg", cfg.mdiBaseURL, url.PathEscape(iconName))
 	cacheKey := buildMDICacheKey(cfg.mdiBaseURL, iconName, color, width, height)
 	if cached, ok := cfg.cache.get(cacheKey); ok {
-		writeRawResponse(w, cached, true)
+		writeRawResponse(w, r, cached, true)
 		return
 	}
 
@@ -437,7 +441,7 @@ func (cfg serverConfig) mdiHandler(w http.ResponseWriter, r *http.Request) {
 		storedAt:     time.Now(),
 	}
 	cfg.cache.set(cacheKey, resp)
-	writeRawResponse(w, resp, false)
+	writeRawResponse(w, r, resp, false)
 }
 
 func (cfg serverConfig) rssJSONHandler(w http.ResponseWriter, r *http.Request) {
@@ -499,10 +503,32 @@ func buildMDICacheKey(base, icon, color string, width, height int) string {
 	return "mdi|" + base + "|" + icon + "|" + color + "|" + strconv.Itoa(width) + "x" + strconv.Itoa(height)
 }
 
-func writeRawResponse(w http.ResponseWriter, resp cachedResponse, cacheHit bool) {
-	w.Header().Set("Content-Type", "application/octet-stream")
+// acceptsPackedIcon reports whether the client asked for the packed icon format
+// (see src/widgets/DslIconCodec.h) via its Accept header.
+func acceptsPackedIcon(r *http.Request) bool {
+	for _, part := range strings.Split(r.Header.Get("Accept"), ",") {
+		mediaType := strings.TrimSpace(strings.SplitN(part, ";", 2)[0])
+		if strings.EqualFold(mediaType, packedIconMediaType) {
+			return true
+		}
+	}
+	return false
+}
+
+func writeRawResponse(w http.ResponseWriter, r *http.Request, resp cachedResponse, cacheHit bool) {
+	body := resp.raw
+	format := "rgb565le"
+	contentType := "application/octet-stream"
+	if acceptsPackedIcon(r) {
+		if packed := packRGB565LE(resp.raw, resp.width, resp.height); len(packed) < len(resp.raw) {
+			body = packed
+			format = "rgb565rle"
+			contentType = packedIconMediaType
+		}
+	}
+	w.Header().Set("Content-Type", contentType)
 	w.Header().Set("Cache-Control", "no-store")
-	w.Header().Set("X-Image-Format", "rgb565le")
+	w.Header().Set("X-Image-Format", format)
 	w.Header().Set("X-Width", strconv.Itoa(resp.width))
 	w.Header().Set("X-Height", strconv.Itoa(resp.height))
 	if resp.sourceFormat != "" {
@@ -529,8 +555,8 @@ func writeRawResponse(w http.ResponseWriter, resp cachedResponse, cacheHit bool)
 		}
 		w.Header().Set("X-Cache-Age-Seconds", strconv.Itoa(ageSec))
 	}
-	w.Header().Set("Content-Length", strconv.Itoa(len(resp.raw)))
-	_, _ = w.Write(resp.raw)
+	w.Header().Set("Content-Length", strconv.Itoa(len(body)))
+	_, _ = w.Write(body)
 }
 
 func clampOutputSize(width, height int) (int, int) {
@@ -914,6 +940,81 @@ func encodeRGB565LE(img image.Image) []byte {
 	return out
 }
 
+// packRGB565LE encodes raw little-endian RGB565 pixels in the packed icon format: an indexed
+// palette when the icon has at most 256 colours, run-length coded in row order. Mirrors
+// tools/icon_pack.py; callers fall back to the raw bytes when this is not smaller.
+func packRGB565LE(raw []byte, width, height int) []byte {
+	count := width * height
+	if count <= 0 || len(raw) != count*2 {
+		return raw
+	}
+	pixels := make([]uint16, count)
+	for i := range pixels {
+		pixels[i] = uint16(raw[2*i]) | uint16(raw[2*i+1])<<8
+	}
+
+	index := make(map[uint16]int)
+	palette := make([]uint16, 0, 16)
+	for _, v := range pixels {
+		if _, ok := index[v]; !ok {
+			index[v] = len(palette)
+			palette = append(palette, v)
+		}
+	}
+	usePalette := len(palette) <= 256
+
+	out := make([]byte, 0, len(raw)/2)
+	out = append(out, 'C', 'I', 'C', '1',
+		byte(width), byte(width>>8), byte(height), byte(height>>8))
+	if usePalette {
+		out = append(out, byte(len(palette)), byte(len(palette)>>8))
+		for _, v := range palette {
+			out = append(out, byte(v), byte(v>>8))
+		}
+	} else {
+		out = append(out, 0, 0)
+	}
+	appendValue := func(v uint16) {
+		if usePalette {
+			out = append(out, byte(index[v]))
+		} else {
+			out = append(out, byte(v), byte(v>>8))
+		}
+	}
+
+	literal := make([]uint16, 0, packedIconMaxRun)
+	flushLiteral := func() {
+		if len(literal) == 0 {
+			return
+		}
+		out = append(out, byte(len(literal)-1))
+		for _, v := range literal {
+			appendValue(v)
+		}
+		literal = literal[:0]
+	}
+	for i := 0; i < count; {
+		run := 1
+		for i+run < count && run < packedIconMaxRun && pixels[i+run] == pixels[i] {
+			run++
+		}
+		if run >= 2 {
+			flushLiteral()
+			out = append(out, 0x80|byte(run-1))
+			appendValue(pixels[i])
+			i += run
+			continue
+		}
+		literal = append(literal, pixels[i])
+		i++
+		if len(literal) == packedIconMaxRun {
+			flushLiteral()
+		}
+	}
+	flushLiteral()
+	return out
+}
+
 func writeError(w http.ResponseWriter, status int, message string) {
 	w.Header().Set("Content-Type", "application/json; charset=utf-8")
 	w.WriteHeader(status)
@@ -6,6 +6,8 @@ import urllib.request
 from cairosvg import svg2png
 from PIL import Image
 
+from icon_pack import pack_rgb565
+
 SIZE = 28
 BASE_URL = "https://raw.githubusercontent.com/basmilius/weather-icons/dev/production/fill/svg-static/"
 
@@ -23,9 +25,8 @@ ICONS = {
 }
 
 
-def rgb565_bytes(r, g, b):
-    v = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
-    return bytes([v & 0xFF, (v >> 8) & 0xFF])
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
 
 
 def fetch_svg(name: str) -> bytes:
@@ -40,8 +41,8 @@ def render_svg(svg_bytes: bytes, size: int) -> Image.Image:
     return img
 
 
-def write_raw(img: Image.Image, path: str):
-    out = bytearray()
+def write_icon(img: Image.Image, path: str):
+    pixels = []
     for y in range(img.height):
         for x in range(img.width):
             r, g, b, a = img.getpixel((x, y))
@@ -49,9 +50,9 @@ def write_raw(img: Image.Image, path: str):
                 r = (r * a) // 255
                 g = (g * a) // 255
                 b = (b * a) // 255
-            out += rgb565_bytes(r, g, b)
+            pixels.append(rgb565(r, g, b))
     with open(path, "wb") as f:
-        f.write(out)
+        f.write(pack_rgb565(pixels, img.width, img.height))
 
 
 def main():
@@ -60,7 +61,7 @@ def main():
     for svg_name, raw_name in ICONS.items():
         svg = fetch_svg(svg_name)
         img = render_svg(svg, SIZE)
-        write_raw(img, os.path.join(out_dir, raw_name))
+        write_icon(img, os.path.join(out_dir, raw_name))
 
 
 if __name__ == "__main__":
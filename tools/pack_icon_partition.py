@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Packs the built-in icons under data/icons into one blob for the "icons" flash partition.
+
+Layout is described in include/platform/IconPack.h. Icons keep their LittleFS paths
+("/icons/meteocons/rain.raw") as lookup names; raw icons are packed with icon_pack.py when
+that is smaller. Raw icons must be square.
+
+    python3 tools/pack_icon_partition.py --data data --out build/icons.bin --max-size 0x10000
+"""
+import argparse
+import math
+import os
+import struct
+import sys
+
+from icon_pack import MAGIC as PACKED_MAGIC
+from icon_pack import pack_rgb565
+
+BLOB_MAGIC = b"CIPK"
+VERSION = 1
+HEADER = struct.Struct("<4sHHII")
+ENTRY = struct.Struct("<IIHHHHII")
+
+
+def fnv1a32(data):
+    h = 2166136261
+    for b in data:
+        h ^= b
+        h = (h * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def load_icon(path):
+    """Returns (width, height, bytes as they should be stored)."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] == PACKED_MAGIC:
+        width, height = struct.unpack_from("<HH", data, 4)
+        return width, height, data
+    side = math.isqrt(len(data) // 2)
+    if side * side * 2 != len(data):
+        raise ValueError("%s: %d bytes is not a square raw icon" % (path, len(data)))
+    pixels = struct.unpack("<%dH" % (side * side), data)
+    return side, side, pack_rgb565(pixels, side, side)
+
+
+def build(data_dir):
+    icons = []
+    icon_root = os.path.join(data_dir, "icons")
+    for dirpath, _, filenames in os.walk(icon_root):
+        for name in filenames:
+            if not name.endswith(".raw"):
+                continue
+            full = os.path.join(dirpath, name)
+            rel = "/" + os.path.relpath(full, data_dir).replace(os.sep, "/")
+            width, height, payload = load_icon(full)
+            key = rel.encode("utf-8")
+            icons.append((fnv1a32(key), key, width, height, payload))
+    icons.sort(key=lambda icon: (icon[0], icon[1]))
+    if len(icons) > 0xFFFF:
+        raise ValueError("too many icons: %d" % len(icons))
+
+    names_offset = HEADER.size + ENTRY.size * len(icons)
+    names = bytearray()
+    name_offsets = []
+    for icon in icons:
+        name_offsets.append(names_offset + len(names))
+        names += icon[1]
+
+    data = bytearray()
+    data_start = names_offset + len(names)
+    data_start += -data_start % 4
+    data_offsets = []
+    for icon in icons:
+        data += b"\0" * (-len(data) % 4)
+        data_offsets.append(data_start + len(data))
+        data += icon[4]
+
+    size = data_start + len(data)
+    blob = bytearray(HEADER.pack(BLOB_MAGIC, VERSION, len(icons), size, 0))
+    for icon, name_offset, data_offset in zip(icons, name_offsets, data_offsets):
+        blob += ENTRY.pack(icon[0], name_offset, len(icon[1]), icon[2], icon[3], 0, data_offset,
+                           len(icon[4]))
+    blob += names
+    blob += b"\0" * (data_start - len(blob))
+    blob += data
+    assert len(blob) == size
+    return bytes(blob), len(icons)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--data", default=os.path.join(os.path.dirname(__file__), "..", "data"))
+    parser.add_argument("--out", required=True)
+    parser.add_argument("--max-size", type=lambda v: int(v, 0), default=0,
+                        help="partition size; fail if the blob does not fit")
+    args = parser.parse_args()
+
+    try:
+        blob, count = build(args.data)
+    except ValueError as e:
+        print(e, file=sys.stderr)
+        return 1
+    if args.max_size and len(blob) > args.max_size:
+        print("icon pack is %d bytes, partition holds %d" % (len(blob), args.max_size),
+              file=sys.stderr)
+        return 1
+    out_dir = os.path.dirname(os.path.abspath(args.out))
+    os.makedirs(out_dir, exist_ok=True)
+    with open(args.out, "wb") as f:
+        f.write(blob)
+    print("icon pack: %d icons, %d bytes -> %s" % (count, len(blob), args.out))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())